@@ -486,6 +486,15 @@ void AEmitter::Update()
                 emitVel.Reset();
                 parentVel = pRootParent->GetVel() * (*eItr)->InheritsVelocity();
 
+                // Roll the random speed, angle and lifetime of every emission in one go instead of one number at a time per particle. The buffer is kept around so emitting doesn't allocate every update.
+                static thread_local std::vector<float> emissionRolls;
+                emissionRolls.resize(static_cast<size_t>(std::max(emissionCount, 0)) * 3);
+                float *speedRolls = emissionRolls.data();
+                float *angleRolls = speedRolls + emissionRolls.size() / 3;
+                float *lifetimeRolls = angleRolls + emissionRolls.size() / 3;
+                RandomNums(speedRolls, emissionRolls.size() / 3, 0.0F, 1.0F);
+                RandomNums(angleRolls, emissionRolls.size() / 3 * 2, -1.0F, 1.0F);
+
                 for (int i = 0; i < emissionCount; ++i)
                 {
                     velMin = (*eItr)->GetMinVelocity() * scale;
@@ -505,15 +514,14 @@ void AEmitter::Update()
 					} else {
 						pParticle->SetPos(m_Pos + RotateOffset((*eItr)->GetOffset()));
 					}
-    // TODO: Optimize making the random angles!")
-                    emitVel.SetXY(velMin + RandomNum(0.0F, velRange), 0.0F);
-					emitVel.RadRotate(m_EmitAngle.GetRadAngle() + spread * RandomNormalNum());
+                    emitVel.SetXY(velMin + velRange * speedRolls[i], 0.0F);
+					emitVel.RadRotate(m_EmitAngle.GetRadAngle() + spread * angleRolls[i]);
                     emitVel = RotateOffset(emitVel);
                     pParticle->SetVel(parentVel + emitVel);
 					pParticle->SetRotAngle(emitVel.GetAbsRadAngle() + (m_HFlipped ? -c_PI : 0));
 					pParticle->SetHFlipped(m_HFlipped);
 
-					if (pParticle->GetLifetime() != 0) { pParticle->SetLifetime(std::max(static_cast<int>(pParticle->GetLifetime() * (1.0F + ((*eItr)->GetLifeVariation() * RandomNormalNum()))), 1)); }
+					if (pParticle->GetLifetime() != 0) { pParticle->SetLifetime(std::max(static_cast<int>(pParticle->GetLifetime() * (1.0F + ((*eItr)->GetLifeVariation() * lifetimeRolls[i]))), 1)); }
                     pParticle->SetTeam(m_Team);
                     pParticle->SetIgnoresTeamHits(true);
 
@@ -27,6 +27,7 @@
 #include "Material.h"
 #include "MOPixel.h"
 #include "Scene.h"
+#include "PathFinder.h"
 #include "SettingsMan.h"
 #include "PerformanceMan.h"
 
@@ -124,6 +125,9 @@ void Actor::Clear() {
     m_MoveVector.Reset();
     m_MovePath.clear();
     m_UpdateMovePath = true;
+    m_PathRequestTicket = PathFinder::c_NoPathRequestTicket;
+    m_PathRequestEnd.Reset();
+    m_MovePathUnrefinedSize = 0;
     m_MoveProximityLimit = 100.0F;
     m_LateralMoveState = LAT_STILL;
     m_MoveOvershootTimer.Reset();
@@ -479,6 +483,8 @@ void Actor::Destroy(bool notInherited)
     for (deque<MovableObject *>::const_iterator itr = m_Inventory.begin(); itr != m_Inventory.end(); ++itr)
         delete (*itr);
 
+    CancelMovePathRequest();
+
     if (!notInherited)
         MOSRotating::Destroy();
     Clear();
@@ -758,6 +764,26 @@ void Actor::AddAIMOWaypoint(const MovableObject *pMOWaypoint)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  ClearAIWaypoints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes all AI waypoints and clears the current path to the current
+//                  waypoint. The AI Actor will stop in its tracks.
+
+void Actor::ClearAIWaypoints()
+{
+    // Any path still being calculated leads to where we no longer want to go
+    CancelMovePathRequest();
+
+    m_pMOMoveTarget = 0;
+    m_Waypoints.clear();
+    m_MovePath.clear();
+    m_MovePathUnrefinedSize = 0;
+    m_MoveTarget = m_Pos;
+    m_MoveVector.Reset();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SwapNextInventory
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1189,49 +1215,83 @@ MOID Actor::GetAIMOWaypointID()
 
 bool Actor::UpdateMovePath()
 {
-    // TODO: Do throttling of calls for this function over time??
+    Scene *pScene = g_SceneMan.GetScene();
+    bool requestLost = false;
 
+    // We asked for a path earlier, so see if it has arrived. Until it does, keep following the old one
+    if (m_PathRequestTicket != PathFinder::c_NoPathRequestTicket)
+    {
+        if (pScene->IsPathRequestPending(m_PathRequestTicket))
+            return false;
 
-    // Remove the material representation of all doors of this guy's team so he can navigate through them (they'll open for him)
-    g_MovableMan.OverrideMaterialDoors(true, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+        std::list<Vector> newMovePath;
+        int newMovePathUnrefinedSize = 0;
+        bool pathArrived = pScene->GetPathRequestResult(m_PathRequestTicket, newMovePath, newMovePathUnrefinedSize);
+        m_PathRequestTicket = PathFinder::c_NoPathRequestTicket;
+
+        if (pathArrived)
+        {
+            m_MovePath.swap(newMovePath);
+            m_MovePathUnrefinedSize = newMovePathUnrefinedSize;
+            ProcessNewMovePath();
+            return true;
+        }
+        // The request got lost, most likely because the scene's pathfinding was reset, so ask again below for the same destination, since any waypoint it was for has already been taken off the list
+        requestLost = true;
+    }
+
+    // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
+    Vector pathStart = g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10);
+    Vector pathEnd;
 
     // If we're following someone/thing, then never advance waypoints until that thing disappears
     if (g_MovableMan.ValidMO(m_pMOMoveTarget))
-        g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_pMOMoveTarget->GetPos(), m_MovePath, m_DigStrength);
-    else
+        pathEnd = m_pMOMoveTarget->GetPos();
+    // Pick up where the lost request left off
+    else if (requestLost)
+        pathEnd = m_PathRequestEnd;
+    // Do we currently have a path to a static target we would like to still pursue?
+    else if (m_MovePath.empty())
     {
-        // Do we currently have a path to a static target we would like to still pursue?
-        if (m_MovePath.empty())
+        // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
+        if (!m_Waypoints.empty())
         {
-            // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
-            if (!m_Waypoints.empty())
-            {
-                // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_Waypoints.front().first, m_MovePath, m_DigStrength);
-                // If the waypoint was tied to an MO to pursue, then load it into the current MO target
-                if (g_MovableMan.ValidMO(m_Waypoints.front().second))
-                    m_pMOMoveTarget = m_Waypoints.front().second;
-                else
-                    m_pMOMoveTarget = 0;
-                // We loaded the waypoint, no need to keep it
-                m_Waypoints.pop_front();
-            }
-            // Just try to get to the last Move Target
+            pathEnd = m_Waypoints.front().first;
+            // The waypoint is loaded right away rather than when the path arrives, so the current target can be read back as soon as it's set
+            // If the waypoint was tied to an MO to pursue, then load it into the current MO target
+            if (g_MovableMan.ValidMO(m_Waypoints.front().second))
+                m_pMOMoveTarget = m_Waypoints.front().second;
             else
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_MoveTarget, m_MovePath, m_DigStrength);
+                m_pMOMoveTarget = 0;
+            // We loaded the waypoint, no need to keep it
+            m_Waypoints.pop_front();
         }
-        // We had a path before trying to update, so use its last point as the final destination
+        // Just try to get to the last Move Target
         else
-            g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), Vector(m_MovePath.back()), m_MovePath, m_DigStrength);
+            pathEnd = m_MoveTarget;
     }
+    // We had a path before trying to update, so use its last point as the final destination
+    else
+        pathEnd = m_MovePath.back();
 
-    // Place back the material representation of all doors of this guy's team so they are as we found them
-    g_MovableMan.OverrideMaterialDoors(false, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+    // The scene takes care of letting us through our own team's doors when it gets around to calculating the path
+    m_PathRequestTicket = pScene->SubmitPathRequest(m_Team, pathStart, pathEnd, m_DigStrength);
+    m_PathRequestEnd = pathEnd;
+    // Keep the AI checking back until the new path has been picked up
+    m_UpdateMovePath = true;
+
+    return false;
+}
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ProcessNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prepares a freshly calculated move path for following and resets the
+//                  progress tracking towards it.
+
+void Actor::ProcessNewMovePath()
+{
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
     {
@@ -1261,18 +1321,40 @@ bool Actor::UpdateMovePath()
 
     // Don't let the guy walk in the wrong dir for a while if path requires him to start walking in opposite dir from where he's facing
     m_MoveOvershootTimer.SetElapsedSimTimeMS(1000);
+}
 
-    return true;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsWaitingOnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this is waiting for a path it requested to be calculated.
+
+bool Actor::IsWaitingOnNewMovePath() const
+{
+    return m_PathRequestTicket != PathFinder::c_NoPathRequestTicket;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about the path this is waiting on, if any.
+
+void Actor::CancelMovePathRequest()
+{
+    if (m_PathRequestTicket != PathFinder::c_NoPathRequestTicket && g_SceneMan.GetScene())
+        g_SceneMan.GetScene()->CancelPathRequest(m_PathRequestTicket);
+    m_PathRequestTicket = PathFinder::c_NoPathRequestTicket;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Actor::UpdateAIScripted() {
-    if (!m_ScriptedAIUpdate || m_AllLoadedScripts.empty() || m_ScriptPresetName.empty()) {
+    if (!m_ScriptedAIUpdate || !HasAnyScripts() || m_ScriptPresetName.empty()) {
         return false;
     }
 
-    int status = !g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false) ? ReloadScripts() : 0;
+    int status = !ScriptPresetTableExists() ? ReloadScripts() : 0;
     status = (status >= 0 && !ObjectScriptsInitialized()) ? InitializeObjectScripts() : status;
     g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ActorsAIUpdate);
     status = (status >= 0) ? RunScriptedFunctionInAppropriateScripts("UpdateAI", false, true) : status;
@@ -1371,6 +1453,8 @@ void Actor::VerifyMOIDs()
 
 void Actor::Update()
 {
+    PerformanceMan::ProfilingScope profilingScope("Actor::Update", GetPresetName());
+
     //TODO This should be after MOSRotating::Update call. It's here because this lets Attachable scripts affect their parent's control states, but this is a bad, hacky solution.
 	//See https://github.com/cortex-command-community/Cortex-Command-Community-Project-Source/commit/ea20b6d790cd4cbb41eb923057b3db9982f6545d
     m_Controller.Update();
@@ -1379,6 +1463,13 @@ void Actor::Update()
     // Hit Body update and handling
     MOSRotating::Update();
 
+    // Pick up the new move path as soon as it has been calculated, whether or not the AI is around to ask for it
+    if (m_PathRequestTicket != PathFinder::c_NoPathRequestTicket && !g_SceneMan.GetScene()->IsPathRequestPending(m_PathRequestTicket))
+        UpdateMovePath();
+    // Long paths only come refined through the first few clusters, so ask for the rest before running out of followable path
+    else if (m_PathRequestTicket == PathFinder::c_NoPathRequestTicket && m_MovePathUnrefinedSize > 0 && !m_MovePath.empty() && m_MovePath.size() <= static_cast<size_t>(m_MovePathUnrefinedSize + 1))
+        UpdateMovePath();
+
     // Update the viewpoint to be at least what the position is
     m_ViewPoint = m_Pos;
 
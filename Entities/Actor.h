@@ -693,7 +693,7 @@ ClassInfoGetters;
 // Arguments:       None.
 // Return value:    None.
 
-	void ClearAIWaypoints() { m_pMOMoveTarget = 0; m_Waypoints.clear(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
+	void ClearAIWaypoints();
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1088,17 +1088,27 @@ ClassInfoGetters;
 	int GetMovePathSize() const { return m_MovePath.size(); }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsWaitingOnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this is waiting for a path it requested to be calculated.
+//                  Until it arrives the old move path is kept and followed.
+// Arguments:       None.
+// Return value:    Whether a new move path has been requested but hasn't arrived yet.
+
+	bool IsWaitingOnNewMovePath() const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates this' move path RIGHT NOW. Will update the path to the
-//                  current waypoint, if any. CAVEAT: this only actually updates if a queue
-//                  index number passed in is sufficiently close to 0 to allow this to
-//                  compute, based on an internal global assessment of how often this very
-//                  expensive computation is allowed to run.
-// Arguments:       The queue number this was given the last time
-// Return value:    Whether the update was performed, or if it should be tried again next
-//                  frame.
+// Description:     Updates this' move path to the current waypoint, if any. The path is
+//                  calculated on the worker threads, so the first call only requests it
+//                  and the old path is kept until a later call picks the new one up.
+//                  Waiting Actors pick up their paths on their own during Update.
+// Arguments:       None.
+// Return value:    Whether a new path was picked up, or if it's still being calculated
+//                  and this should be tried again on a later frame.
 
     virtual bool UpdateMovePath();
 
@@ -1515,6 +1525,12 @@ protected:
     std::list<Vector> m_MovePath;
     // Whether it's time to update the path
     bool m_UpdateMovePath;
+    // The ticket of the path requested from the Scene that this is waiting on, if any. The old path is followed until the new one arrives
+    int m_PathRequestTicket;
+    // Where the path requested from the Scene leads, so it can be asked for again if the request gets lost
+    Vector m_PathRequestEnd;
+    // How many of the last points of the move path are coarse cluster entrances rather than a followable path. The path gets requested again before reaching them
+    int m_MovePathUnrefinedSize;
     // The minimum range to consider having reached a move target is considered
     float m_MoveProximityLimit;
     // Whether the AI is trying to progress to the right, left, or stand still
@@ -1542,6 +1558,27 @@ protected:
 
 private:
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ProcessNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prepares a freshly calculated move path for following and resets the
+//                  progress tracking towards it.
+// Arguments:       None.
+// Return value:    None.
+
+    void ProcessNewMovePath();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about the path this is waiting on, if any.
+// Arguments:       None.
+// Return value:    None.
+
+    void CancelMovePathRequest();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
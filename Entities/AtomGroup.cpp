@@ -1242,7 +1242,7 @@ namespace RTE {
 		totalVel.RadRotate(angularVel * travelTime);
 		totalVel += jointOffset * std::abs(angularVel);
 
-		Vector pushImpulse = PushTravel(m_LimbPos, totalVel, 100, didWrap, travelTime, false, false, false);
+		PushTravel(m_LimbPos, totalVel, 100, didWrap, travelTime, false, false, false);
 
 		Vector limbRange = m_LimbPos - jointPos;
 
@@ -1414,7 +1414,7 @@ namespace RTE {
 				if (tempMO->GetsHitByMOs()) {
 					// Make that MO draw itself again in the MOID layer so we can find its true edges
 					intersectedMO = tempMO;
-					intersectedMO->Draw(g_SceneMan.GetMOIDBitmap(), Vector(), g_DrawMOID, true);
+					g_SceneMan.DrawMOIDRepresentation(intersectedMO);
 					break;
 				}
 			}
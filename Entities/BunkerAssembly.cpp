@@ -260,7 +260,7 @@ int BunkerAssembly::ReadProperty(const std::string_view &propName, Reader &reade
 		} else {
 			// Do not allow to define assemblies prior to corresponding assembly scheme
 			char s[256];
-			std::snprintf(s, sizeof(s), "Required BunkerAssemblyScheme '%s%' not found when trying to load BunkerAssembly '%s'! BunkerAssemblySchemes MUST be defined before dependent BunkerAssmeblies.", parentScheme.c_str(), m_PresetName.c_str());
+			std::snprintf(s, sizeof(s), "Required BunkerAssemblyScheme '%s%' not found when trying to load BunkerAssembly '%s'! BunkerAssemblySchemes MUST be defined before dependent BunkerAssmeblies.", parentScheme.c_str(), GetPresetName().c_str());
 			RTEAbort(s);
 		}
 	} else
@@ -281,7 +281,7 @@ int BunkerAssembly::Save(Writer &writer) const
 	SceneObject::Save(writer);
 
     // Groups are essential for BunkerAssemblies so save them, because entity seem to ignore them
-	for (list<string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr)
+	for (list<string>::const_iterator itr = m_PresetData->Groups.begin(); itr != m_PresetData->Groups.end(); ++itr)
     {
 		if ((*itr) != m_ParentAssemblyScheme && (*itr) != m_ParentSchemeGroup)
 		{
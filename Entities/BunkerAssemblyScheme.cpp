@@ -189,7 +189,7 @@ int BunkerAssemblyScheme::ReadProperty(const std::string_view &propName, Reader
 		// Print scheme name
 		GUIFont *pSmallFont = g_FrameMan.GetSmallFont();
 		AllegroBitmap allegroBitmap(m_pPresentationBitmap);
-		pSmallFont->DrawAligned(&allegroBitmap, 4, 4, m_PresetName, GUIFont::Left);
+		pSmallFont->DrawAligned(&allegroBitmap, 4, 4, GetPresetName(), GUIFont::Left);
 
 		// Calculate bitmap offset
 		int width = m_pBitmap->w / 2;
@@ -1,6 +1,7 @@
 #ifndef _RTEGIB_
 #define _RTEGIB_
 
+#include "Serializable.h"
 #include "Vector.h"
 
 namespace RTE {
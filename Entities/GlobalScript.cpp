@@ -128,6 +128,7 @@ int GlobalScript::ReloadScripts()
 
 void GlobalScript::EnteredOrbit(Actor *orbitedActor) {
     if (orbitedActor && g_MovableMan.IsActor(orbitedActor)) {
+        LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
         g_LuaMan.RunScriptedFunction(m_LuaClassName + ".CraftEnteredOrbit", m_LuaClassName, {m_LuaClassName, m_LuaClassName + ".CraftEnteredOrbit"}, {orbitedActor});
     }
 }
@@ -136,6 +137,7 @@ void GlobalScript::EnteredOrbit(Actor *orbitedActor) {
 
 void GlobalScript::OnPieMenu(Actor *pieMenuActor) {
 	if (pieMenuActor && g_MovableMan.IsActor(pieMenuActor)) {
+        LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
         g_LuaMan.RunScriptedFunction(m_LuaClassName + ".OnPieMenu", m_LuaClassName, {m_LuaClassName, m_LuaClassName + ".OnPieMenu"}, {pieMenuActor});
 	}
 }
@@ -152,6 +154,7 @@ int GlobalScript::Start()
 {
 	int error = 0;
 	m_IsActive = false;
+    LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
 
     g_LuaMan.SetTempEntity(this);
     // Create the Lua variable which will hold the class representation that we'll add some definitions to
@@ -184,6 +187,7 @@ int GlobalScript::Start()
 
 void GlobalScript::Pause(bool pause)
 {
+    LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
     // Call the defined function, but only after first checking if it exists
     g_LuaMan.RunScriptString("if " + m_LuaClassName + ".PauseScript then " + m_LuaClassName + ":PauseScript(" + (pause ? "true" : "false") + "); end");
 }
@@ -196,6 +200,7 @@ void GlobalScript::Pause(bool pause)
 
 void GlobalScript::End()
 {
+    LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
     // Call the defined function, but only after first checking if it exists
     g_LuaMan.RunScriptString("if " + m_LuaClassName + ".EndScript then " + m_LuaClassName + ":EndScript(); end");
 }
@@ -209,6 +214,7 @@ void GlobalScript::End()
 
 void GlobalScript::Update()
 {
+    LuaMan::ScriptAccountingScope scriptAccountingScope(m_ScriptPath);
     // Call the defined function, but only after first checking if it exists
     int error = g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateScript then " + m_LuaClassName + ":UpdateScript(); end");
 	// Kill script on any error to avoid spamming the console with error messages
@@ -11,6 +11,7 @@ namespace RTE {
 	/// A movable object with mass that is graphically represented by a single pixel.
 	/// </summary>
 	class MOPixel : public MovableObject {
+		friend class PixelParticleStore;
 
 	public:
 
@@ -1570,7 +1570,7 @@ bool MOSRotating::DrawMOIDIfOverlapping(MovableObject *pOverlapMO)
         if (g_SceneMan.ShortestDistance(m_Pos, otherPos, g_SceneMan.SceneWrapsX()).GetMagnitude() < combinedRadii)
         {
             // They may be overlapping, so draw the MOID rep of this to the MOID layer
-            Draw(g_SceneMan.GetMOIDBitmap(), Vector(), g_DrawMOID, true);
+            g_SceneMan.DrawMOIDRepresentation(this);
             return true;
         }
     }
@@ -1776,8 +1776,44 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
     if (m_Recoiled)
         spritePos += m_RecoilOffset;
 
+    // Draw modes that only depend on the sprite and a fill color are served from the rotated sprite cache when possible, which skips all the intermediate bitmap work below
+    bool cacheable = true;
+    int cacheFillColor = -1;
+    switch (mode) {
+        case g_DrawColor:
+        case g_DrawTrans:
+            break;
+        case g_DrawMaterial:
+            cacheFillColor = m_SettleMaterialDisabled ? GetMaterial()->GetIndex() : GetMaterial()->GetSettleMaterial();
+            break;
+        case g_DrawAir:
+            cacheFillColor = g_MaterialAir;
+            break;
+        case g_DrawMask:
+            cacheFillColor = keyColor;
+            break;
+        case g_DrawWhite:
+            cacheFillColor = g_WhiteColor;
+            break;
+        case g_DrawMOID:
+            cacheFillColor = m_MOID;
+            break;
+        case g_DrawNoMOID:
+            cacheFillColor = g_NoMOID;
+            break;
+        case g_DrawDoor:
+            cacheFillColor = g_MaterialDoor;
+            break;
+        default:
+            cacheable = false;
+            break;
+    }
+    const RotatedSpriteCache::CachedSprite *cachedSprite = nullptr;
+    if (cacheable)
+        cachedSprite = g_FrameMan.GetRotatedSpriteCache().GetRotatedSprite(m_aSprite[m_Frame], cacheFillColor, bitmap_color_depth(pTempBitmap), static_cast<int>(-m_SpriteOffset.m_X), static_cast<int>(-m_SpriteOffset.m_Y), m_Rotation.GetAllegroAngle(), m_Scale, m_HFlipped && pFlipBitmap);
+
     // If we're drawing a material silhouette, then create an intermediate material bitmap as well
-    if (mode != g_DrawColor && mode != g_DrawTrans)
+    if (!cachedSprite && mode != g_DrawColor && mode != g_DrawTrans)
     {
         clear_to_color(pTempBitmap, keyColor);
 
@@ -1849,9 +1885,27 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
         }
     }
 
+    //////////////////
+    // CACHED
+    if (cachedSprite)
+    {
+        for (int i = 0; i < passes; ++i)
+        {
+            int cachedSpriteX = aDrawPos[i].GetFloorIntX() - cachedSprite->PivotOffset;
+            int cachedSpriteY = aDrawPos[i].GetFloorIntY() - cachedSprite->PivotOffset;
+            if (mode == g_DrawTrans)
+                draw_trans_sprite(pTargetBitmap, cachedSprite->Bitmap, cachedSpriteX, cachedSpriteY);
+            else
+                draw_sprite(pTargetBitmap, cachedSprite->Bitmap, cachedSpriteX, cachedSpriteY);
+
+            // Register potential MOID drawing
+            if (mode == g_DrawMOID)
+                g_SceneMan.RegisterMOIDDrawing(aDrawPos[i].GetFloored(), m_SpriteRadius + 2);
+        }
+    }
     //////////////////
     // FLIPPED
-    if (m_HFlipped && pFlipBitmap)
+    else if (m_HFlipped && pFlipBitmap)
     {
         // Don't size the intermediate bitmaps to the m_Scale, because the scaling happens after they are done
         clear_to_color(pFlipBitmap, keyColor);
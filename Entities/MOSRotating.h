@@ -301,7 +301,7 @@ ClassInfoGetters;
 // Arguments:       None.
 // Return value:    None.
 
-    bool IsRecoiled() { return m_Recoiled; }
+    bool IsRecoiled() const { return m_Recoiled; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -424,6 +424,12 @@ ClassInfoGetters;
 
 	void ApplyImpulses() override;
 
+    /// <summary>
+    /// Gets the Attachables directly attached to this MOSRotating, not including their own Attachables.
+    /// </summary>
+    /// <returns>The Attachables on this MOSRotating.</returns>
+    const std::list<Attachable *> & GetAttachables() const { return m_Attachables; }
+
     /// <summary>
     /// Adds the passed in Attachable the list of Attachables and sets its parent to this MOSRotating.
     /// </summary>
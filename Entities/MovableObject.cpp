@@ -17,6 +17,7 @@
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
 #include "LuaMan.h"
+#include "PerformanceMan.h"
 #include "Atom.h"
 #include "Actor.h"
 
@@ -74,10 +75,14 @@ void MovableObject::Clear()
     m_ToSettle = false;
     m_ToDelete = false;
     m_HUDVisible = true;
-    m_AllLoadedScripts.clear();
-    m_FunctionsAndScripts.clear();
+    // All unscripted MovableObjects can share the same LoadedScripts, so clearing doesn't have to allocate anything
+    static const std::shared_ptr<const LoadedScripts> noLoadedScripts = std::make_shared<LoadedScripts>();
+    m_LoadedScripts = noLoadedScripts;
     m_ScriptPresetName.clear();
     m_ScriptObjectName.clear();
+    m_ScriptObjectReference = LuaMan::c_NoReference;
+    m_ScriptFunctionReferences.clear();
+    m_ScriptUpdateDeferred = false;
     m_ScreenEffectFile.Reset();
     m_pScreenEffect = 0;
 	m_EffectRotAngle = 0;
@@ -217,8 +222,13 @@ int MovableObject::Create(const MovableObject &reference)
     m_HUDVisible = reference.m_HUDVisible;
 
     m_ScriptPresetName = reference.m_ScriptPresetName;
-    for (auto &[scriptPath, scriptEnabled] : reference.m_AllLoadedScripts) {
-        LoadScript(scriptPath, scriptEnabled);
+    if (!m_ScriptPresetName.empty()) {
+        // The reference's scripts have already been run into its preset table, so share its script configuration instead of running all the script files again
+        m_LoadedScripts = reference.m_LoadedScripts;
+    } else {
+        for (const auto &[scriptPath, scriptEnabled] : reference.m_LoadedScripts->AllLoadedScripts) {
+            LoadScript(scriptPath, scriptEnabled);
+        }
     }
 
     if (reference.m_pScreenEffect)
@@ -483,7 +493,9 @@ void MovableObject::Destroy(bool notInherited) {
         RunScriptedFunctionInAppropriateScripts("Destroy");
         g_LuaMan.RunScriptString(m_ScriptObjectName + " = nil;");
     }
+    ReleaseScriptReferences();
 	g_MovableMan.UnregisterObject(this);
+	g_SceneMan.UnregisterMOIDRepresentation(this);
     if (!notInherited) { SceneObject::Destroy(); }
     Clear();
 }
@@ -500,7 +512,19 @@ int MovableObject::InitializeObjectScripts() {
         return -2;
     }
 
-	if (!(*m_FunctionsAndScripts.find("Create")).second.empty() && RunScriptedFunctionInAppropriateScripts("Create", true, true) < 0) {
+    ReleaseScriptReferences();
+    m_ScriptObjectReference = g_LuaMan.CreateReference(m_ScriptObjectName);
+    if (m_ScriptObjectReference == LuaMan::c_NoReference) {
+        m_ScriptObjectName = "ERROR";
+        return -2;
+    }
+    // Hold on to the LoadedScripts being iterated, in case any scripts change them and they stop being shared
+    std::shared_ptr<const LoadedScripts> loadedScripts = m_LoadedScripts;
+    for (const auto &[scriptPath, scriptEnabled] : loadedScripts->AllLoadedScripts) {
+        ResolveScriptFunctionReferences(scriptPath);
+    }
+
+	if (!(*loadedScripts->FunctionsAndScripts.find("Create")).second.empty() && RunScriptedFunctionInAppropriateScripts("Create", true, true) < 0) {
 		m_ScriptObjectName = "ERROR";
 		return -3;
 	}
@@ -517,7 +541,7 @@ int MovableObject::LoadScript(const std::string &scriptPath, bool loadAsEnabledS
     } else if (HasScript(scriptPath)) {
         return -3;
     }
-    m_AllLoadedScripts.insert({scriptPath, loadAsEnabledScript});
+    GetWritableLoadedScripts().AllLoadedScripts.insert({scriptPath, loadAsEnabledScript});
 
     // Clear the temporary variable names that will hold the functions read in from the file
     for (const std::string &functionName : GetSupportedScriptFunctionNames()) {
@@ -544,16 +568,16 @@ int MovableObject::LoadScript(const std::string &scriptPath, bool loadAsEnabledS
             return -4;
         }
 
+        ReleaseScriptReferences();
         m_ScriptObjectName.clear();
     }
 
     // Assign the different functions read in from the script to their permanent locations in the preset's table
+    std::unordered_map<std::string, std::vector<std::string>> &functionsAndScripts = GetWritableLoadedScripts().FunctionsAndScripts;
     for (const std::string &functionName : GetSupportedScriptFunctionNames()) {
-        if (m_FunctionsAndScripts.find(functionName) == m_FunctionsAndScripts.end()) {
-            m_FunctionsAndScripts.insert({functionName, std::vector<std::string>()});
-        }
+        std::vector<std::string> &functionScripts = functionsAndScripts[functionName];
         if (g_LuaMan.GlobalIsDefined(functionName)) {
-            m_FunctionsAndScripts.find(functionName)->second.emplace_back(scriptPath);
+            functionScripts.emplace_back(scriptPath);
             int error = g_LuaMan.RunScriptString(
                 m_ScriptPresetName + "." + functionName + " = " + m_ScriptPresetName + "." + functionName + " or {}; " +
                 m_ScriptPresetName + "." + functionName + "[\"" + scriptPath + "\"] = " + functionName + ";"
@@ -570,7 +594,7 @@ int MovableObject::LoadScript(const std::string &scriptPath, bool loadAsEnabledS
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int MovableObject::ReloadScripts() {
-    if (m_AllLoadedScripts.empty()) {
+    if (!HasAnyScripts()) {
         return 0;
     }
 
@@ -578,9 +602,9 @@ int MovableObject::ReloadScripts() {
     /// Internal lambda function to clear a given object's script configurations, and then load them all again in order to reset them.
     /// </summary>
     auto clearScriptConfigurationAndLoadPreexistingScripts = [](MovableObject *object, bool isPresetObject) {
-        std::map<std::string, bool> loadedScriptsCopy = object->m_AllLoadedScripts;
-        object->m_AllLoadedScripts.clear();
-        object->m_FunctionsAndScripts.clear();
+        std::map<std::string, bool> loadedScriptsCopy = object->m_LoadedScripts->AllLoadedScripts;
+        object->m_LoadedScripts = std::make_shared<LoadedScripts>();
+        object->ReleaseScriptReferences();
         if (isPresetObject) {
             object->m_ScriptPresetName.clear();
         } else {
@@ -616,6 +640,7 @@ bool MovableObject::AddScript(const std::string &scriptPath) {
         case 0:
             // If we have a ScriptObjectName that means Create has already been run for pre-existing scripts. Run it right away for this one.
             if (ObjectScriptsInitialized()) {
+                ResolveScriptFunctionReferences(scriptPath);
                 RunScriptedFunction(scriptPath, "Create");
                 return false;
             }
@@ -645,16 +670,15 @@ bool MovableObject::AddScript(const std::string &scriptPath) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool MovableObject::EnableScript(const std::string &scriptPath) {
-    if (m_AllLoadedScripts.empty() || m_ScriptPresetName.empty()) {
+    if (!HasAnyScripts() || m_ScriptPresetName.empty()) {
         return false;
     }
 
-    std::map<std::string, bool>::iterator scriptEntryIterator = m_AllLoadedScripts.find(scriptPath);
-    if (scriptEntryIterator != m_AllLoadedScripts.end() && scriptEntryIterator->second == false) {
+    if (HasScript(scriptPath) && !ScriptEnabled(scriptPath)) {
         if (ObjectScriptsInitialized() && RunScriptedFunction(scriptPath, "OnScriptEnable") < 0) {
             return false;
         }
-        scriptEntryIterator->second = true;
+        GetWritableLoadedScripts().AllLoadedScripts.at(scriptPath) = true;
         return true;
     }
     return false;
@@ -663,16 +687,15 @@ bool MovableObject::EnableScript(const std::string &scriptPath) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool MovableObject::DisableScript(const std::string &scriptPath) {
-    if (m_AllLoadedScripts.empty() || m_ScriptPresetName.empty()) {
+    if (!HasAnyScripts() || m_ScriptPresetName.empty()) {
         return false;
     }
 
-    std::map<std::string, bool>::iterator scriptEntryIterator = m_AllLoadedScripts.find(scriptPath);
-    if (scriptEntryIterator != m_AllLoadedScripts.end() && scriptEntryIterator->second == true) {
+    if (ScriptEnabled(scriptPath)) {
         if (ObjectScriptsInitialized() && RunScriptedFunction(scriptPath, "OnScriptDisable") < 0) {
             return false;
         }
-        scriptEntryIterator->second = false;
+        GetWritableLoadedScripts().AllLoadedScripts.at(scriptPath) = false;
         return true;
     }
     return false;
@@ -681,7 +704,9 @@ bool MovableObject::DisableScript(const std::string &scriptPath) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void MovableObject::EnableOrDisableAllScripts(bool enableScripts) {
-    for (const auto &[scriptPath, scriptIsEnabled] : m_AllLoadedScripts) {
+    // Enabling or disabling scripts makes this stop sharing its LoadedScripts, so iterate over the ones it started with
+    std::shared_ptr<const LoadedScripts> loadedScripts = m_LoadedScripts;
+    for (const auto &[scriptPath, scriptIsEnabled] : loadedScripts->AllLoadedScripts) {
         if (enableScripts && !scriptIsEnabled) {
             EnableScript(scriptPath);
         } else if (!enableScripts && scriptIsEnabled) {
@@ -693,15 +718,24 @@ void MovableObject::EnableOrDisableAllScripts(bool enableScripts) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int MovableObject::RunScriptedFunction(const std::string &scriptPath, const std::string &functionName, const std::vector<Entity *> &functionEntityArguments, const std::vector<std::string> &functionLiteralArguments) const {
-    if (m_AllLoadedScripts.empty() || m_ScriptPresetName.empty() || !ObjectScriptsInitialized()) {
+    if (!HasAnyScripts() || m_ScriptPresetName.empty() || !ObjectScriptsInitialized()) {
         return -1;
     }
 
-    std::string presetAndFunctionName = m_ScriptPresetName + "." + functionName;
-    std::string fullFunctionName = presetAndFunctionName + "[\"" + scriptPath + "\"]";
+    // A missing reference means the script doesn't define this function, which is the same as the old safety check failing, so there's nothing to run.
+    std::unordered_map<std::string, std::unordered_map<std::string, int>>::const_iterator functionReferences = m_ScriptFunctionReferences.find(functionName);
+    if (functionReferences == m_ScriptFunctionReferences.end()) {
+        return 0;
+    }
+    std::unordered_map<std::string, int>::const_iterator functionReference = functionReferences->second.find(scriptPath);
+    if (functionReference == functionReferences->second.end()) {
+        return 0;
+    }
 
-    int status = g_LuaMan.RunScriptedFunction(fullFunctionName, m_ScriptObjectName, {presetAndFunctionName, m_ScriptObjectName, fullFunctionName}, functionEntityArguments, functionLiteralArguments);
-    if (status < 0 && m_AllLoadedScripts.size() > 1) {
+    PerformanceMan::ProfilingScope profilingScope(functionName, scriptPath);
+    LuaMan::ScriptAccountingScope scriptAccountingScope(scriptPath);
+    int status = g_LuaMan.RunFunctionReference(functionReference->second, m_ScriptObjectReference, functionEntityArguments, functionLiteralArguments);
+    if (status < 0 && m_LoadedScripts->AllLoadedScripts.size() > 1) {
         g_ConsoleMan.PrintString("ERROR: An error occured while trying to run the " + functionName + " function for script at path " + scriptPath);
         return -2;
     }
@@ -713,15 +747,17 @@ int MovableObject::RunScriptedFunction(const std::string &scriptPath, const std:
 
 int MovableObject::RunScriptedFunctionInAppropriateScripts(const std::string &functionName, bool runOnDisabledScripts, bool stopOnError, const std::vector<Entity *> &functionEntityArguments, const std::vector<std::string> &functionLiteralArguments) {
     int status = 0;
-    if (m_AllLoadedScripts.empty() || m_ScriptPresetName.empty() || m_FunctionsAndScripts.find(functionName) == m_FunctionsAndScripts.end()) {
+    // Hold on to the LoadedScripts being iterated, in case any scripts change them and they stop being shared
+    std::shared_ptr<const LoadedScripts> loadedScripts = m_LoadedScripts;
+    if (loadedScripts->AllLoadedScripts.empty() || m_ScriptPresetName.empty() || loadedScripts->FunctionsAndScripts.find(functionName) == loadedScripts->FunctionsAndScripts.end()) {
         status = -1;
     } else if (!ObjectScriptsInitialized()) {
         status = InitializeObjectScripts();
     }
 
     if (status >= 0) {
-        for (const std::string &scriptPath : m_FunctionsAndScripts.at(functionName)) {
-            if (runOnDisabledScripts || m_AllLoadedScripts.at(scriptPath) == true) {
+        for (const std::string &scriptPath : loadedScripts->FunctionsAndScripts.at(functionName)) {
+            if (runOnDisabledScripts || loadedScripts->AllLoadedScripts.at(scriptPath) == true) {
                 status = RunScriptedFunction(scriptPath, functionName, functionEntityArguments, functionLiteralArguments);
                 if (status < 0 && stopOnError) {
                     return status;
@@ -734,6 +770,53 @@ int MovableObject::RunScriptedFunctionInAppropriateScripts(const std::string &fu
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+bool MovableObject::ScriptPresetTableExists() const {
+    std::size_t separatorPos = m_ScriptPresetName.find('.');
+    return separatorPos != std::string::npos && g_LuaMan.TableEntryIsDefined(m_ScriptPresetName.substr(0, separatorPos), m_ScriptPresetName.substr(separatorPos + 1));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MovableObject::ResolveScriptFunctionReferences(const std::string &scriptPath) {
+    for (const auto &[functionName, scriptPaths] : m_LoadedScripts->FunctionsAndScripts) {
+        if (std::find(scriptPaths.begin(), scriptPaths.end(), scriptPath) == scriptPaths.end()) {
+            continue;
+        }
+        std::unordered_map<std::string, int> &functionReferences = m_ScriptFunctionReferences[functionName];
+        std::unordered_map<std::string, int>::iterator existingReference = functionReferences.find(scriptPath);
+        if (existingReference != functionReferences.end()) {
+            g_LuaMan.ReleaseReference(existingReference->second);
+            functionReferences.erase(existingReference);
+        }
+        std::string presetAndFunctionName = m_ScriptPresetName + "." + functionName;
+        int functionReference = g_LuaMan.CreateReference(presetAndFunctionName + " and " + presetAndFunctionName + "[\"" + scriptPath + "\"]");
+        if (functionReference != LuaMan::c_NoReference) { functionReferences.try_emplace(scriptPath, functionReference); }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MovableObject::ReleaseScriptReferences() {
+    g_LuaMan.ReleaseReference(m_ScriptObjectReference);
+    m_ScriptObjectReference = LuaMan::c_NoReference;
+    for (const auto &[functionName, functionReferences] : m_ScriptFunctionReferences) {
+        for (const auto &[scriptPath, functionReference] : functionReferences) {
+            g_LuaMan.ReleaseReference(functionReference);
+        }
+    }
+    m_ScriptFunctionReferences.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MovableObject::LoadedScripts & MovableObject::GetWritableLoadedScripts() {
+    if (m_LoadedScripts.use_count() > 1) { m_LoadedScripts = std::make_shared<LoadedScripts>(*m_LoadedScripts); }
+    // The LoadedScripts are only ever created by this, Clear or ReloadScripts, and are never const in themselves, so they're safe to change once this is their only user
+    return const_cast<LoadedScripts &>(*m_LoadedScripts);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /*
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     MovableObject
@@ -835,6 +918,10 @@ bool MovableObject::OnMOHit(MovableObject *pOtherMO) {
 void MovableObject::SetHitWhatTerrMaterial(unsigned char matID) {
     m_TerrainMatHit = matID;
     m_LastCollisionSimFrameNumber = g_MovableMan.GetSimUpdateFrameNumber();
+    if (MovableMan::IsDeferringTravelCommands()) {
+        if (HasAnyScripts()) { MovableMan::DeferTravelCommand([this, matID]() { RunScriptedFunctionInAppropriateScripts("OnCollideWithTerrain", false, false, {}, {std::to_string(matID)}); }); }
+        return;
+    }
     RunScriptedFunctionInAppropriateScripts("OnCollideWithTerrain", false, false, {}, {std::to_string(m_TerrainMatHit)});
 }
 
@@ -922,7 +1009,7 @@ void MovableObject::PreTravel()
 		if (g_SettingsMan.SimplifiedCollisionDetection()) {
 			m_IsTraveling = true;
 		} else {
-			Draw(g_SceneMan.GetMOIDBitmap(), Vector(), DrawMode::g_DrawNoMOID, true);
+			g_SceneMan.ClearMOIDRepresentation(this);
 		}
 	}
 
@@ -964,7 +1051,7 @@ void MovableObject::PostTravel()
 			if (g_SettingsMan.SimplifiedCollisionDetection()) {
 				m_IsTraveling = false;
 			} else {
-				Draw(g_SceneMan.GetMOIDBitmap(), Vector(), DrawMode::g_DrawMOID, true);
+				g_SceneMan.DrawMOIDRepresentation(this);
 			}
 		}
 		m_AlreadyHitBy.clear();
@@ -1007,11 +1094,11 @@ void MovableObject::Update()
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int MovableObject::UpdateScripts() {
-    if (m_AllLoadedScripts.empty() || m_ScriptPresetName.empty()) {
+    if (!HasAnyScripts() || m_ScriptPresetName.empty()) {
         return -1;
     }
 
-    int status = !g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false) ? ReloadScripts() : 0;
+    int status = !ScriptPresetTableExists() ? ReloadScripts() : 0;
     status = (status >= 0 && !ObjectScriptsInitialized()) ? InitializeObjectScripts() : status;
     status = (status >= 0) ? RunScriptedFunctionInAppropriateScripts("Update", false, true) : status;
 
@@ -1020,6 +1107,21 @@ int MovableObject::UpdateScripts() {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+int MovableObject::UpdateScriptsWithinBudget() {
+    std::unordered_map<std::string, std::vector<std::string>>::const_iterator updateScripts = m_LoadedScripts->FunctionsAndScripts.find("Update");
+    if (m_ScriptUpdateDeferred || updateScripts == m_LoadedScripts->FunctionsAndScripts.end() || !g_LuaMan.IsOverScriptUpdateBudget()) {
+        m_ScriptUpdateDeferred = false;
+        return UpdateScripts();
+    }
+    m_ScriptUpdateDeferred = true;
+    for (const std::string &scriptPath : updateScripts->second) {
+        if (m_LoadedScripts->AllLoadedScripts.at(scriptPath)) { g_LuaMan.RecordDeferredScriptUpdate(scriptPath); }
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 int MovableObject::OnPieMenu(Actor *pieMenuActor) {
     if (!pieMenuActor) {
         return -1;
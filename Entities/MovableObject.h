@@ -54,6 +54,7 @@ class MOSRotating;
 class MovableObject : public SceneObject {
 
 friend class Atom;
+friend class PixelParticleStore;
 friend struct EntityLuaBindings;
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -174,14 +175,14 @@ enum MOType
     /// Checks if this MO has any scripts on it.
     /// </summary>
     /// <returns>Whether or not this MO has any scripts on it.</returns>
-	bool HasAnyScripts() const { return !m_AllLoadedScripts.empty(); }
+	bool HasAnyScripts() const { return !m_LoadedScripts->AllLoadedScripts.empty(); }
 
     /// <summary>
     /// Checks if the script at the given path is one of the scripts on this MO.
     /// </summary>
     /// <param name="scriptPath">The path to the script to check.</param>
     /// <returns>Whether or not the script is on this MO.</returns>
-	bool HasScript(const std::string &scriptPath) const { return m_AllLoadedScripts.find(scriptPath) != m_AllLoadedScripts.end(); }
+	bool HasScript(const std::string &scriptPath) const { return m_LoadedScripts->AllLoadedScripts.find(scriptPath) != m_LoadedScripts->AllLoadedScripts.end(); }
 
     /// <summary>
     /// Adds the script at the given path as one of the scripts on this MO.
@@ -195,7 +196,7 @@ enum MOType
     /// </summary>
     /// <param name="scriptPath">The path to the script to check.</param>
     /// <returns>Whether or not the script is enabled on this MO.</returns>
-    bool ScriptEnabled(const std::string &scriptPath) const { std::map<std::string, bool>::const_iterator scriptPathIterator = m_AllLoadedScripts.find(scriptPath); return scriptPathIterator != m_AllLoadedScripts.end() && scriptPathIterator->second == true; }
+    bool ScriptEnabled(const std::string &scriptPath) const { std::map<std::string, bool>::const_iterator scriptPathIterator = m_LoadedScripts->AllLoadedScripts.find(scriptPath); return scriptPathIterator != m_LoadedScripts->AllLoadedScripts.end() && scriptPathIterator->second == true; }
 
     /// <summary>
     /// Enable the script at the given path on this MO.
@@ -1045,7 +1046,7 @@ enum MOType
 // Arguments:       The Preset name of the object to look for.
 // Return value:    Whetehr the object was found carried by this.
 
-    virtual bool HasObject(std::string objectName) const { return m_PresetName == objectName; }
+    virtual bool HasObject(std::string objectName) const { return GetPresetName() == objectName; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1057,7 +1058,7 @@ enum MOType
 // Arguments:       The name of the group to look for.
 // Return value:    Whetehr the object in the group was found carried by this.
 
-    virtual bool HasObjectInGroup(std::string groupName) const { return const_cast<MovableObject *>(this)->IsInGroup(groupName); }
+    virtual bool HasObjectInGroup(std::string groupName) const { return IsInGroup(groupName); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1549,6 +1550,13 @@ enum MOType
 
 	int UpdateScripts();
 
+    /// <summary>
+    /// Updates this MovableObject's Lua scripts like UpdateScripts, unless scripts have used up LuaMan's script update budget for this sim update, in which case the update is put off until the next one.
+    /// An update is never put off twice in a row, so every object's scripts still run at least every other sim update.
+    /// </summary>
+    /// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+    int UpdateScriptsWithinBudget();
+
     /// <summary>
     /// Executes the Lua-defined OnPieMenu event handler for this MO.
     /// </summary>
@@ -1632,7 +1640,7 @@ enum MOType
     /// Gets the preset name and unique ID of this MO, often useful for error messages.
     /// </summary>
     /// <returns>A string containing the unique ID and preset name of this MO.</returns>
-    std::string GetPresetNameAndUniqueID() const { return m_PresetName + ", UID: " + std::to_string(m_UniqueID); }
+    std::string GetPresetNameAndUniqueID() const { return GetPresetName() + ", UID: " + std::to_string(m_UniqueID); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1820,6 +1828,12 @@ protected:
     /// <returns>0 on success, -2 if it fails to setup the script object in Lua, and -3 if it fails to run any Create function.</returns>
     int InitializeObjectScripts();
 
+    /// <summary>
+    /// Gets whether this' preset table of scripted functions still exists in the Lua state. Looks the table up directly instead of evaluating its name as a Lua expression.
+    /// </summary>
+    /// <returns>Whether this' preset table of scripted functions exists in the Lua state.</returns>
+    bool ScriptPresetTableExists() const;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateChildMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1943,13 +1957,23 @@ protected:
 
 	bool m_IsTraveling; //!< Prevents self-intersection while traveling when simplified collision detection is used.
 
-    std::map<std::string, bool> m_AllLoadedScripts; //!< A map of script paths to the enabled state of the given script.
-    std::unordered_map<std::string, std::vector<std::string>> m_FunctionsAndScripts; //!< A map of function names to vectors of scripts paths. Used to maintain script execution order and avoid extraneous Lua calls.
+    /// <summary>
+    /// The script configuration of a MovableObject. It's shared between a preset and everything cloned from it, so clones don't have to load their scripts again, and only copied when one of them changes it.
+    /// </summary>
+    struct LoadedScripts {
+        std::map<std::string, bool> AllLoadedScripts; //!< A map of script paths to the enabled state of the given script.
+        std::unordered_map<std::string, std::vector<std::string>> FunctionsAndScripts; //!< A map of function names to vectors of scripts paths. Used to maintain script execution order and avoid extraneous Lua calls.
+    };
+
+    std::shared_ptr<const LoadedScripts> m_LoadedScripts; //!< The LoadedScripts of this, possibly shared with the preset this was cloned from and its other clones. Never nullptr.
 
     // The ID name unique to this' preset and its defined scripted functions in the lua state.
     std::string m_ScriptPresetName;
     // The ID name unique to this' object instance representation in the Lua state.
     std::string m_ScriptObjectName;
+    int m_ScriptObjectReference; //!< Lua registry reference to this' object instance representation in the Lua state, so scripted functions can be called without looking it up by name.
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> m_ScriptFunctionReferences; //!< Lua registry references to this' scripted functions, by function name and then script path. Resolved when object scripts are initialized, so calling them doesn't need any Lua parsing.
+    bool m_ScriptUpdateDeferred; //!< Whether this' last script update was put off because the script update budget was used up.
 
     // Special post processing flash effect file and Bitmap. Shuold be loaded from a 32bpp bitmap
     ContentFile m_ScreenEffectFile;
@@ -2022,6 +2046,23 @@ private:
 
     void Clear();
 
+    /// <summary>
+    /// Resolves the functions the given script defines for this' preset into Lua registry references, replacing any previous references for that script.
+    /// </summary>
+    /// <param name="scriptPath">The path to the script to resolve the functions of.</param>
+    void ResolveScriptFunctionReferences(const std::string &scriptPath);
+
+    /// <summary>
+    /// Frees all of this' Lua registry references to its object instance and scripted functions.
+    /// </summary>
+    void ReleaseScriptReferences();
+
+    /// <summary>
+    /// Gets the LoadedScripts of this for changing, first making a copy of them if they're shared with any other MovableObject.
+    /// </summary>
+    /// <returns>A reference to the LoadedScripts that only this MovableObject uses.</returns>
+    LoadedScripts & GetWritableLoadedScripts();
+
 	// Disallow the use of some implicit methods.
 	MovableObject(const MovableObject &reference) = delete;
 	MovableObject& operator=(const MovableObject& ref) = delete;
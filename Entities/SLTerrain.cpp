@@ -20,6 +20,7 @@
 #include "MOPixel.h"
 #include "MOSprite.h"
 #include "Atom.h"
+#include "ThreadMan.h"
 
 namespace RTE {
 
@@ -148,7 +149,9 @@ void SLTerrain::Clear()
     m_TerrainFrostings.clear();
     m_TerrainDebris.clear();
     m_TerrainObjects.clear();
-    m_UpdatedMateralAreas.clear();
+    m_DirtyTileColumns = 0;
+    m_DirtyTileRows = 0;
+    m_DirtyTiles.clear();
     m_DrawMaterial = false;
 	m_NeedToClearFrostings = false;
 	m_NeedToClearDebris = false;
@@ -271,6 +274,9 @@ int SLTerrain::LoadData()
     RTEAssert(m_pFGColor, "Terrain's foreground layer not instantiated before trying to load its data!");
     RTEAssert(m_pBGColor, "Terrain's background layer not instantiated before trying to load its data!");
 
+    // The whole material layer is new, so everything needs cleaning and pathing
+    ResetDirtyTiles();
+
     // Check if our color layers' BITMAP data is also to be loaded from disk, and not be generated from the material bitmap!
     if (m_pFGColor->IsFileData() && m_pBGColor->IsFileData())
     {
@@ -316,169 +322,157 @@ int SLTerrain::LoadData()
     ///////////////////////////////////////////////
     // Load and texturize the FG color bitmap, based on the materials defined in the recently loaded (main) material layer!
 
-    int xPos, yPos, matIndex, pixelColor;
-
-    // Temporary references for all the materials' textures and colors, since we'll access them a lot
-    BITMAP *apTexBitmaps[256];
-    int aColors[256];
-    // Null em out so we can tell which ones we've already got once so far
-    for (matIndex = 0; matIndex < 256; ++matIndex)
-    {
-        apTexBitmaps[matIndex] = 0;
-        aColors[matIndex] = 0;
-    }
-
     // Get the background texture
-    BITMAP *m_pBGTexture = m_BGTextureFile.GetAsBitmap();
+    BITMAP *pBGTexture = m_BGTextureFile.GetAsBitmap();
     // Get the material palette for quicker access
 	const std::array<Material *, c_PaletteEntriesNumber> &apMaterials = g_SceneMan.GetMaterialPalette();
     // Get the Material palette ID mappings local to the DataModule this SLTerrain is loaded from
 	const std::array<unsigned char, c_PaletteEntriesNumber> &materialMappings = g_PresetMan.GetDataModule(m_BitmapFile.GetDataModuleID())->GetAllMaterialMappings();
-    Material *pMaterial = 0;
+
+    // Resolve everything about each material ID as it appears in the loaded bitmap up front, so texturizing each pixel is just a few table lookups
+    std::array<unsigned char, c_PaletteEntriesNumber> aMappedMaterials;
+    std::array<BITMAP *, c_PaletteEntriesNumber> apTexBitmaps;
+    std::array<unsigned char, c_PaletteEntriesNumber> aColors;
+    std::vector<int> texturedMaterials;
+    for (int matIndex = 0; matIndex < c_PaletteEntriesNumber; ++matIndex)
+    {
+        // Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's
+        aMappedMaterials[matIndex] = materialMappings[matIndex] != 0 ? materialMappings[matIndex] : matIndex;
+        // Validate the material, or default to default material
+        const Material *pMaterial = apMaterials[aMappedMaterials[matIndex]] ? apMaterials[aMappedMaterials[matIndex]] : apMaterials[g_MaterialDefault];
+        // If no texture for the material, then use the material's solid color instead
+        apTexBitmaps[matIndex] = pMaterial->GetTexture();
+        aColors[matIndex] = pMaterial->GetColor().GetIndex();
+        if (apTexBitmaps[matIndex])
+            texturedMaterials.push_back(matIndex);
+    }
+
+    // Gather what each frosting needs. The thickness of each column is sampled here, in the same order as always, so the random numbers don't depend on how the work gets split between threads
+    struct FrostingPass
+    {
+        unsigned char TargetId;
+        unsigned char FrostingId;
+        BITMAP *pTexture;
+        unsigned char Color;
+        bool InAirOnly;
+        std::vector<int> ThicknessGoals;
+    };
+    std::vector<FrostingPass> frostingPasses;
+    for (TerrainFrosting &terrainFrosting : m_TerrainFrostings)
+    {
+        FrostingPass frostingPass = { static_cast<unsigned char>(terrainFrosting.GetTargetMaterial().GetIndex()), static_cast<unsigned char>(terrainFrosting.GetFrostingMaterial().GetIndex()), terrainFrosting.GetFrostingMaterial().GetTexture(), static_cast<unsigned char>(terrainFrosting.GetFrostingMaterial().GetColor().GetIndex()), terrainFrosting.InAirOnly(), std::vector<int>(m_pMainBitmap->w) };
+        for (int &thicknessGoal : frostingPass.ThicknessGoals)
+            thicknessGoal = terrainFrosting.GetThicknessSample();
+        frostingPasses.push_back(std::move(frostingPass));
+    }
 
     // Lock all involved bitmaps
     acquire_bitmap(m_pMainBitmap);
     acquire_bitmap(pFGBitmap);
     acquire_bitmap(pBGBitmap);
-    acquire_bitmap(m_pBGTexture);
-
-    // Go through each pixel on the main bitmap, which contains all the material pixels loaded from the bitmap
-    // Place texture pixels on the FG layer corresponding to the materials on the main material bitmap
-    for (xPos = 0; xPos < m_pMainBitmap->w; ++xPos)
+    acquire_bitmap(pBGTexture);
+    for (int matIndex : texturedMaterials)
+        acquire_bitmap(apTexBitmaps[matIndex]);
+    for (const FrostingPass &frostingPass : frostingPasses)
     {
-        for (yPos = 0; yPos < m_pMainBitmap->h; ++yPos)
-        {
-            // Read which material the current pixel represents
-            matIndex = _getpixel(m_pMainBitmap, xPos, yPos);
-            // Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's
-            if (materialMappings.at(matIndex) != 0)
-            {
-                // Assign the mapping and put it onto the material bitmap too
-                matIndex = materialMappings.at(matIndex);
-                _putpixel(m_pMainBitmap, xPos, yPos, matIndex);
-            }
-
-            // Validate the material, or default to default material
-            if (matIndex >= 0 && matIndex < c_PaletteEntriesNumber && apMaterials.at(matIndex))
-                pMaterial = apMaterials.at(matIndex);
-            else
-                pMaterial = apMaterials.at(g_MaterialDefault);
+        if (frostingPass.pTexture)
+            acquire_bitmap(frostingPass.pTexture);
+    }
 
-            // If haven't read a pixel of this material before, then get its texture so we can quickly access it
-            if (!apTexBitmaps[matIndex])
-            {
-                // Get, and acquire the texture bitmap if material has any
-                if (apTexBitmaps[matIndex] = pMaterial->GetTexture())
-                    acquire_bitmap(apTexBitmaps[matIndex]);
-            }
+    // Each column only ever depends on itself, so the terrain is split into strips of columns that are texturized and frosted on the worker threads. Within a strip everything goes row by row straight through the bitmap lines
+    int width = m_pMainBitmap->w;
+    int height = m_pMainBitmap->h;
+    g_ThreadMan.Wait(g_ThreadMan.ParallelFor(0, width, c_LoadDataStripWidth, [&](int stripLeft, int stripRight, int stripIndex) {
+        std::array<const unsigned char *, c_PaletteEntriesNumber> apTexRows;
 
-            // If actually no texture for the material, then use the material's solid color instead
-            if (!apTexBitmaps[matIndex])
-            {
-                // If the color hasn't been retrieved yet, then do so
-                if (!aColors[matIndex])
-                    aColors[matIndex] = pMaterial->GetColor().GetIndex();
-                // Use the color
-                pixelColor = aColors[matIndex];
-            }
-            // Use the texture's color
-            else
+        // Place texture pixels on the FG layer corresponding to the materials on the main material bitmap, and background texture pixels behind them
+        for (int yPos = 0; yPos < height; ++yPos)
+        {
+            unsigned char *pMaterialRow = m_pMainBitmap->line[yPos];
+            unsigned char *pFGRow = pFGBitmap->line[yPos];
+            unsigned char *pBGRow = pBGBitmap->line[yPos];
+            for (int matIndex : texturedMaterials)
+                apTexRows[matIndex] = apTexBitmaps[matIndex]->line[yPos % apTexBitmaps[matIndex]->h];
+            const unsigned char *pBGTexRow = pBGTexture ? pBGTexture->line[yPos % pBGTexture->h] : nullptr;
+
+            for (int xPos = stripLeft; xPos < stripRight; ++xPos)
             {
-//                acquire_bitmap(apTexBitmaps[matIndex]);
-                pixelColor = _getpixel(apTexBitmaps[matIndex], xPos % apTexBitmaps[matIndex]->w, yPos % apTexBitmaps[matIndex]->h);
-            }
-
-            // Draw the correct color pixel on the foreground
-            _putpixel(pFGBitmap, xPos, yPos, pixelColor);
+                unsigned char matIndex = pMaterialRow[xPos];
+                pMaterialRow[xPos] = aMappedMaterials[matIndex];
 
-            // Draw background texture on the background where this is stuff on the foreground
-            if (m_pBGTexture && pixelColor != g_MaskColor)
-            {
-                pixelColor = _getpixel(m_pBGTexture, xPos % m_pBGTexture->w, yPos % m_pBGTexture->h);
-                _putpixel(pBGBitmap, xPos, yPos, pixelColor);
+                unsigned char pixelColor = apTexBitmaps[matIndex] ? apTexRows[matIndex][xPos % apTexBitmaps[matIndex]->w] : aColors[matIndex];
+                pFGRow[xPos] = pixelColor;
+                // Draw background texture on the background where this is stuff on the foreground, put a keycolor pixel in the bg otherwise
+                pBGRow[xPos] = (pBGTexRow && pixelColor != g_MaskColor) ? pBGTexRow[xPos % pBGTexture->w] : g_MaskColor;
             }
-            // Put a keycolor pixel in the bg otherwise
-            else
-                _putpixel(pBGBitmap, xPos, yPos, g_MaskColor);
         }
-    }
 
-    ///////////////////////////////////////
-    // Material frostings application!
+        ///////////////////////////////////////
+        // Material frostings application!
 
-    bool targetFound = false, applyingFrosting = false;
-    int targetId, frostingId, thickness, thicknessGoal;
-    BITMAP *pFrostingTex = 0;
-    for (list<TerrainFrosting>::iterator tfItr = m_TerrainFrostings.begin(); tfItr != m_TerrainFrostings.end(); ++tfItr)
-    {
-        targetId = (*tfItr).GetTargetMaterial().GetIndex();
-        frostingId = (*tfItr).GetFrostingMaterial().GetIndex();
-        // Try to get the color texture of the frosting material. If fail, we'll use the color isntead
-        pFrostingTex = (*tfItr).GetFrostingMaterial().GetTexture();
-        if (pFrostingTex)
-            acquire_bitmap(pFrostingTex);
-
-        // Loop through all columns
-        for (xPos = 0; xPos < m_pMainBitmap->w; ++xPos)
+        int stripWidth = stripRight - stripLeft;
+        std::vector<unsigned char> targetFound(stripWidth);
+        std::vector<unsigned char> applyingFrosting(stripWidth);
+        std::vector<int> thickness(stripWidth);
+        for (const FrostingPass &frostingPass : frostingPasses)
         {
-            // Get the thickness for this column
-            thicknessGoal = (*tfItr).GetThicknessSample();
+            std::fill(targetFound.begin(), targetFound.end(), false);
+            std::fill(applyingFrosting.begin(), applyingFrosting.end(), false);
+            std::fill(thickness.begin(), thickness.end(), 0);
 
             // Work upward from the bottom of each column
-            for (yPos = m_pMainBitmap->h - 1; yPos >= 0; --yPos)
+            for (int yPos = height - 1; yPos >= 0; --yPos)
             {
-                // Read which material the current pixel represents
-                matIndex = _getpixel(m_pMainBitmap, xPos, yPos);
-
-                // We've encountered the target material! Prepare to apply frosting as soon as it ends!
-                if (!targetFound && matIndex == targetId)
-                {
-                    targetFound = true;
-                    thickness = 0;
-                }
-                // Target material has ended! See if we shuold start putting on the frosting
-                else if (targetFound && matIndex != targetId && thickness <= thicknessGoal)
-                {
-                    applyingFrosting = true;
-                    targetFound = false;
-                }
+                unsigned char *pMaterialRow = m_pMainBitmap->line[yPos];
+                unsigned char *pFGRow = pFGBitmap->line[yPos];
+                const unsigned char *pFrostingTexRow = frostingPass.pTexture ? frostingPass.pTexture->line[yPos % frostingPass.pTexture->h] : nullptr;
 
-                // If time to put down frosting pixels, then do so IF there is air, OR we're set to ignore what we're overwriting
-                if (applyingFrosting && (matIndex == g_MaterialAir || !(*tfItr).InAirOnly()) && thickness <= thicknessGoal)
+                for (int xPos = stripLeft; xPos < stripRight; ++xPos)
                 {
-                    // Get the color either from the frosting material's texture or the solid color
-                    if (pFrostingTex)
-                        pixelColor = _getpixel(pFrostingTex, xPos % pFrostingTex->w, yPos % pFrostingTex->h);
+                    int column = xPos - stripLeft;
+                    int thicknessGoal = frostingPass.ThicknessGoals[xPos];
+                    unsigned char matIndex = pMaterialRow[xPos];
+
+                    // We've encountered the target material! Prepare to apply frosting as soon as it ends!
+                    if (!targetFound[column] && matIndex == frostingPass.TargetId)
+                    {
+                        targetFound[column] = true;
+                        thickness[column] = 0;
+                    }
+                    // Target material has ended! See if we shuold start putting on the frosting
+                    else if (targetFound[column] && matIndex != frostingPass.TargetId && thickness[column] <= thicknessGoal)
+                    {
+                        applyingFrosting[column] = true;
+                        targetFound[column] = false;
+                    }
+
+                    // If time to put down frosting pixels, then do so IF there is air, OR we're set to ignore what we're overwriting
+                    if (applyingFrosting[column] && (matIndex == g_MaterialAir || !frostingPass.InAirOnly) && thickness[column] <= thicknessGoal)
+                    {
+                        // Put the frosting pixel color from the frosting material's texture or the solid color on the FG color layer, and the material ID pixel on the material layer
+                        pFGRow[xPos] = pFrostingTexRow ? pFrostingTexRow[xPos % frostingPass.pTexture->w] : frostingPass.Color;
+                        pMaterialRow[xPos] = frostingPass.FrostingId;
+                        // Keep track of the applied thickness
+                        thickness[column]++;
+                    }
                     else
-                        pixelColor = (*tfItr).GetFrostingMaterial().GetColor().GetIndex();
-
-                    // Put the frosting pixel color on the FG color layer
-                    _putpixel(pFGBitmap, xPos, yPos, pixelColor);
-                    // Put the material ID pixel on the material layer
-                    _putpixel(m_pMainBitmap, xPos, yPos, frostingId);
-
-                    // Keep track of the applied thickness
-                    thickness++;
+                        applyingFrosting[column] = false;
                 }
-                else
-                    applyingFrosting = false;
             }
         }
-
-        if (pFrostingTex)
-            release_bitmap(pFrostingTex);
-    }
+    }));
 
     // Release all involved bitmaps
     release_bitmap(m_pMainBitmap);
     release_bitmap(pFGBitmap);
     release_bitmap(pBGBitmap);
-    release_bitmap(m_pBGTexture);
-
-    for (matIndex = 0; matIndex < 256; ++matIndex)
+    release_bitmap(pBGTexture);
+    for (int matIndex : texturedMaterials)
+        release_bitmap(apTexBitmaps[matIndex]);
+    for (const FrostingPass &frostingPass : frostingPasses)
     {
-        if (apTexBitmaps[matIndex])
-            release_bitmap(apTexBitmaps[matIndex]);
+        if (frostingPass.pTexture)
+            release_bitmap(frostingPass.pTexture);
     }
 
     ///////////////////////////////////////////////
@@ -905,6 +899,8 @@ void SLTerrain::SetMaterialPixel(const int pixelX, const int pixelY, const unsig
        return;
 //    RTEAssert(m_pMainBitmap->m_LockCount > 0, "Trying to access unlocked terrain bitmap");
     _putpixel(m_pMainBitmap, posX, posY, material);
+    if (!m_DirtyTiles.empty())
+        m_DirtyTiles[(posY / c_DirtyTileSize) * m_DirtyTileColumns + (posX / c_DirtyTileSize)] = DirtyForAll;
 }
 
 
@@ -1044,9 +1040,8 @@ deque<MOPixel *> SLTerrain::EraseSilhouette(BITMAP *pSprite,
         }    
     }
 
-    // Add a box to the updated areas list to show there's been change to the materials layer
-// TODO: improve fit/tightness of box here
-    m_UpdatedMateralAreas.push_back(Box(pos - pivot, maxWidth, maxHeight));
+    // Mark the tiles under the test bitmap as changed, padded a pixel for the rounding of the terrain coordinates above
+    MarkDirtyTiles(static_cast<int>(pos.m_X) - halfWidth - 1, static_cast<int>(pos.m_Y) - halfHeight - 1, pTempBitmap->w + 2, pTempBitmap->h + 2);
 
     return MOPDeque;
 }
@@ -1090,6 +1085,12 @@ void SLTerrain::ApplyMovableObject(MovableObject *pMObject)
     if (!pMObject)
         return;
 
+    if (MovableMan::IsDeferringTravelCommands())
+    {
+        MovableMan::DeferTravelCommand([this, pMObject]() { ApplyMovableObject(pMObject); });
+        return;
+    }
+
     // Determine whether a sprite or just a pixel-based MO
     MOSprite *pMOSprite = dynamic_cast<MOSprite *>(pMObject);
 
@@ -1160,8 +1161,8 @@ void SLTerrain::ApplyMovableObject(MovableObject *pMObject)
         SceneLayer::Draw(pTempBitmap, notUsed, bitmapScroll);
         // Finally draw temporary bitmap to the Scene
         masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
-        // Add a box to the updated areas list to show there's been change to the materials layer
-        m_UpdatedMateralAreas.push_back(Box(bitmapScroll, pTempBitmap->w, pTempBitmap->h));
+        // Mark the tiles under the temp bitmap as changed, this takes care of the seams too
+        MarkDirtyTiles(static_cast<int>(bitmapScroll.m_X), static_cast<int>(bitmapScroll.m_Y), pTempBitmap->w, pTempBitmap->h);
 // TODO: centralize seam drawing!
         // Draw over seams
         if (g_SceneMan.SceneWrapsX())
@@ -1187,6 +1188,7 @@ void SLTerrain::ApplyMovableObject(MovableObject *pMObject)
 		g_SceneMan.RegisterTerrainChange(pMObject->GetPos().m_X, pMObject->GetPos().m_Y, 1, 1, g_DrawColor, false);
 
         pMObject->Draw(GetMaterialBitmap(), Vector(), g_DrawMaterial, true);
+        MarkDirtyTiles(pMObject->GetPos().GetFloorIntX(), pMObject->GetPos().GetFloorIntY(), 1, 1);
     }
 }
 
@@ -1250,8 +1252,8 @@ void SLTerrain::ApplyTerrainObject(TerrainObject *pTObject)
 	// Register terrain change
 	g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), g_MaskColor, false);
 
-    // Add a box to the updated areas list to show there's been change to the materials layer
-    m_UpdatedMateralAreas.push_back(Box(loc, pTObject->GetMaterialBitmap()->w, pTObject->GetMaterialBitmap()->h));
+    // Mark the tiles under the object as changed, this takes care of the seams too
+    MarkDirtyTiles(static_cast<int>(loc.m_X), static_cast<int>(loc.m_Y), pTObject->GetMaterialBitmap()->w, pTObject->GetMaterialBitmap()->h);
 
     // Apply all the child objects of the TO, and first reapply the team so all its children are guaranteed to be on the same team!
     pTObject->SetTeam(pTObject->GetTeam());
@@ -1266,6 +1268,125 @@ void SLTerrain::ApplyTerrainObject(TerrainObject *pTObject)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddUpdatedMaterialArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a notification that an area of the material terrain has been
+//                  updated.
+
+void SLTerrain::AddUpdatedMaterialArea(const Box &newArea)
+{
+    Box area = newArea;
+    area.Unflip();
+    int left = static_cast<int>(std::floor(area.m_Corner.m_X));
+    int top = static_cast<int>(std::floor(area.m_Corner.m_Y));
+    MarkDirtyTiles(left, top, static_cast<int>(std::ceil(area.m_Corner.m_X + area.m_Width)) - left, static_cast<int>(std::ceil(area.m_Corner.m_Y + area.m_Height)) - top);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the tiles overlapping an area of the material layer as changed,
+//                  so the next CleanAir() and pathfinding update process them.
+
+void SLTerrain::MarkDirtyTiles(int left, int top, int width, int height)
+{
+    if (m_DirtyTiles.empty() || width <= 0 || height <= 0)
+        return;
+
+    // Turns a span of pixels along one axis into at most two spans of tiles, split at the seam if the scene wraps and clipped to the scene otherwise
+    auto spanToTiles = [](int start, int length, int sceneLength, bool wraps, std::array<std::pair<int, int>, 2> &tileSpans) {
+        int spanCount = 0;
+        if (wraps)
+        {
+            if (length >= sceneLength)
+                tileSpans[spanCount++] = { 0, sceneLength - 1 };
+            else
+            {
+                int wrappedStart = ((start % sceneLength) + sceneLength) % sceneLength;
+                int wrappedEnd = wrappedStart + length - 1;
+                tileSpans[spanCount++] = { wrappedStart, std::min(wrappedEnd, sceneLength - 1) };
+                if (wrappedEnd >= sceneLength)
+                    tileSpans[spanCount++] = { 0, wrappedEnd - sceneLength };
+            }
+        }
+        else if (start < sceneLength && start + length > 0)
+            tileSpans[spanCount++] = { std::max(start, 0), std::min(start + length - 1, sceneLength - 1) };
+
+        for (int span = 0; span < spanCount; ++span)
+            tileSpans[span] = { tileSpans[span].first / c_DirtyTileSize, tileSpans[span].second / c_DirtyTileSize };
+        return spanCount;
+    };
+
+    std::array<std::pair<int, int>, 2> columnSpans;
+    std::array<std::pair<int, int>, 2> rowSpans;
+    int columnSpanCount = spanToTiles(left, width, m_pMainBitmap->w, m_WrapX, columnSpans);
+    int rowSpanCount = spanToTiles(top, height, m_pMainBitmap->h, m_WrapY, rowSpans);
+
+    for (int rowSpan = 0; rowSpan < rowSpanCount; ++rowSpan)
+    {
+        for (int row = rowSpans[rowSpan].first; row <= rowSpans[rowSpan].second; ++row)
+        {
+            for (int columnSpan = 0; columnSpan < columnSpanCount; ++columnSpan)
+            {
+                for (int column = columnSpans[columnSpan].first; column <= columnSpans[columnSpan].second; ++column)
+                    m_DirtyTiles[row * m_DirtyTileColumns + column] = DirtyForAll;
+            }
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetUpdatedMaterialAreas
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a list of boxes covering the tiles of the material layer that have
+//                  changed since last call to ClearUpdatedAreas().
+
+std::list<Box> SLTerrain::GetUpdatedMaterialAreas() const
+{
+    std::list<Box> updatedAreas;
+
+    for (int row = 0; row < m_DirtyTileRows; ++row)
+    {
+        int top = row * c_DirtyTileSize;
+        int bottom = std::min(top + c_DirtyTileSize, m_pMainBitmap->h);
+        int runStart = -1;
+
+        // Go one column past the end so a run reaching the last column gets closed too
+        for (int column = 0; column <= m_DirtyTileColumns; ++column)
+        {
+            bool dirty = column < m_DirtyTileColumns && (m_DirtyTiles[row * m_DirtyTileColumns + column] & DirtyForPathing);
+            if (dirty && runStart < 0)
+                runStart = column;
+            else if (!dirty && runStart >= 0)
+            {
+                int left = runStart * c_DirtyTileSize;
+                int right = std::min(column * c_DirtyTileSize, m_pMainBitmap->w);
+                updatedAreas.push_back(Box(Vector(left, top), right - left, bottom - top));
+                runStart = -1;
+            }
+        }
+    }
+    return updatedAreas;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sizes the dirty tile grid to the material layer and marks every tile
+//                  as changed.
+
+void SLTerrain::ResetDirtyTiles()
+{
+    m_DirtyTileColumns = (m_pMainBitmap->w + c_DirtyTileSize - 1) / c_DirtyTileSize;
+    m_DirtyTileRows = (m_pMainBitmap->h + c_DirtyTileSize - 1) / c_DirtyTileSize;
+    m_DirtyTiles.assign(m_DirtyTileColumns * m_DirtyTileRows, DirtyForAll);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsBoxBuried
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1350,26 +1471,26 @@ void SLTerrain::CleanAirBox(Box box, bool wrapsX, bool wrapsY)
 // Method:          CleanAir
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Removes any color pixel in the color layer of this SLTerrain wherever
-//                  there is an air material pixel in the material layer.
+//                  there is an air material pixel in the material layer. Only the tiles
+//                  that have changed since the last call are processed.
 
 void SLTerrain::CleanAir()
 {
+    RTEAssert(bitmap_color_depth(m_pMainBitmap) == 8 && bitmap_color_depth(m_pFGColor->GetBitmap()) == 8, "Terrain material and foreground layers have to be 8bpp to clean air out of them!");
+
     acquire_bitmap(m_pMainBitmap);
     acquire_bitmap(m_pFGColor->GetBitmap());
 
-    int width = m_pMainBitmap->w;
-    int height = m_pMainBitmap->h;
-    unsigned char matPixel;
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            matPixel = _getpixel(m_pMainBitmap, x, y);
-            if (matPixel == g_MaterialCavity) {
-                _putpixel(m_pMainBitmap, x, y, g_MaterialAir);
-                matPixel = g_MaterialAir;
+    for (int row = 0; row < m_DirtyTileRows; ++row)
+    {
+        for (int column = 0; column < m_DirtyTileColumns; ++column)
+        {
+            unsigned char &dirtyTile = m_DirtyTiles[row * m_DirtyTileColumns + column];
+            if (dirtyTile & DirtyForCleanAir)
+            {
+                CleanAirTile(column, row);
+                dirtyTile &= ~DirtyForCleanAir;
             }
-            if (matPixel == g_MaterialAir)
-                _putpixel(m_pFGColor->GetBitmap(), x, y, g_MaskColor);
         }
     }
 
@@ -1378,6 +1499,58 @@ void SLTerrain::CleanAir()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CleanAirTile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Does what CleanAir() does for a single tile. Reads the material layer
+//                  a word at a time so runs of all-air or all-solid pixels are handled
+//                  without looking at each one.
+
+void SLTerrain::CleanAirTile(int column, int row)
+{
+    // A byte is below 2 if subtracting 2 from it borrows into its high bit while that bit wasn't set already. Exact for a whole word being zero or not.
+    static_assert(g_MaterialAir == 0 && g_MaterialCavity == 1, "CleanAirTile's word-at-a-time test relies on air and cavity being the two lowest material indices!");
+    constexpr uint64_t lowBits = 0x0101010101010101;
+    constexpr uint64_t highBits = 0x8080808080808080;
+
+    BITMAP *pFGBitmap = m_pFGColor->GetBitmap();
+    int left = column * c_DirtyTileSize;
+    int top = row * c_DirtyTileSize;
+    int right = std::min(left + c_DirtyTileSize, m_pMainBitmap->w);
+    int bottom = std::min(top + c_DirtyTileSize, m_pMainBitmap->h);
+
+    for (int y = top; y < bottom; ++y)
+    {
+        unsigned char *pMaterialRow = m_pMainBitmap->line[y];
+        unsigned char *pFGRow = pFGBitmap->line[y];
+        auto cleanPixel = [pMaterialRow, pFGRow](int x) {
+            if (pMaterialRow[x] == g_MaterialCavity)
+                pMaterialRow[x] = g_MaterialAir;
+            if (pMaterialRow[x] == g_MaterialAir)
+                pFGRow[x] = g_MaskColor;
+        };
+
+        int x = left;
+        for (; x + static_cast<int>(sizeof(uint64_t)) <= right; x += sizeof(uint64_t))
+        {
+            uint64_t materialWord;
+            std::memcpy(&materialWord, pMaterialRow + x, sizeof(materialWord));
+            // All air, so the whole word of foreground gets masked
+            if (materialWord == g_MaterialAir * lowBits)
+                std::memset(pFGRow + x, g_MaskColor, sizeof(materialWord));
+            // Some air or cavity mixed in with other materials, so go pixel by pixel. Words with neither are left alone
+            else if (((materialWord - lowBits * 2) & ~materialWord & highBits) != 0)
+            {
+                for (int wordX = x; wordX < x + static_cast<int>(sizeof(materialWord)); ++wordX)
+                    cleanPixel(wordX);
+            }
+        }
+        for (; x < right; ++x)
+            cleanPixel(x);
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearAllMaterial
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1388,6 +1561,7 @@ void SLTerrain::ClearAllMaterial()
 {
     clear_to_color(m_pMainBitmap, g_MaskColor);
     clear_to_color(m_pFGColor->GetBitmap(), g_MaterialAir);
+    ResetDirtyTiles();
 }
 
 
@@ -578,19 +578,32 @@ ClassInfoGetters
 //                  and may be out of bounds of the scene.
 // Return value:    None.
 
-    void AddUpdatedMaterialArea(const Box &newArea) { m_UpdatedMateralAreas.push_back(newArea); }
+    void AddUpdatedMaterialArea(const Box &newArea);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the tiles overlapping an area of the material layer as changed,
+//                  so the next CleanAir() and pathfinding update process them. Should be
+//                  done every time the material layer is drawn to directly.
+// Arguments:       The coordinates and size of the changed area. Can be unwrapped and out
+//                  of bounds of the scene.
+// Return value:    None.
+
+    void MarkDirtyTiles(int left, int top, int width, int height);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetUpdatedMaterialAreas
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Gets a list of unwrapped boxes which show the areas where the material
-//                  layer has had objects applied to it since last call to ClearUpdatedAreas().
+// Description:     Gets a list of boxes covering the tiles of the material layer that have
+//                  changed since last call to ClearUpdatedAreas(). Tiles next to each other
+//                  in a row are merged into a single box.
 // Arguments:       None.
-// Return value:    Reference to the list that has been filled with Box:es which are
-//                  unwrapped and may be out of bounds of the scene!
+// Return value:    The list of Box:es, which are all within the bounds of the scene.
 
-    std::list<Box> & GetUpdatedMaterialAreas() { return m_UpdatedMateralAreas; }
+    std::list<Box> GetUpdatedMaterialAreas() const;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -611,7 +624,7 @@ ClassInfoGetters
 // Arguments:       None.
 // Return value:    None.
 
-    void ClearUpdatedAreas() { m_UpdatedMateralAreas.clear(); }
+    void ClearUpdatedAreas() { for (unsigned char &dirtyTile : m_DirtyTiles) { dirtyTile &= ~DirtyForPathing; } }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -628,7 +641,8 @@ ClassInfoGetters
 // Method:          CleanAir
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Removes any color pixel in the color layer of this SLTerrain wherever
-//                  there is an air material pixel in the material layer.
+//                  there is an air material pixel in the material layer. Only the tiles
+//                  that have changed since the last call are processed.
 // Arguments:       None.
 // Return value:    None.
 
@@ -701,9 +715,23 @@ protected:
     std::list<TerrainDebris *> m_TerrainDebris;
     std::list<TerrainObject *> m_TerrainObjects;
 
-    // List of areas of the material layer which have been affected by the updating of new objects copied to it
-    // These boxes are NOT wrapped, and can be out of bounds!
-    std::list<Box> m_UpdatedMateralAreas;
+    // Flags for which users of material layer changes haven't processed a tile since it last changed
+    enum DirtyTileFlags
+    {
+        DirtyForCleanAir = 1,
+        DirtyForPathing = 2,
+        DirtyForAll = DirtyForCleanAir | DirtyForPathing
+    };
+
+    // The width and height of the tiles the material layer is split into for tracking changes
+    static constexpr int c_DirtyTileSize = 64;
+    // The width of the strips of columns LoadData splits texturizing and frosting into, to spread over the worker threads
+    static constexpr int c_LoadDataStripWidth = 128;
+    // The number of tile columns and rows covering the material layer
+    int m_DirtyTileColumns;
+    int m_DirtyTileRows;
+    // The DirtyTileFlags of each tile, row by row
+    std::vector<unsigned char> m_DirtyTiles;
 
     // Draw the material layer instead of the color layer.
     bool m_DrawMaterial;
@@ -729,6 +757,29 @@ protected:
 
 private:
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sizes the dirty tile grid to the material layer and marks every tile
+//                  as changed. Should be done whenever the whole material layer changes.
+// Arguments:       None.
+// Return value:    None.
+
+    void ResetDirtyTiles();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CleanAirTile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Does what CleanAir() does for a single tile. Reads the material layer
+//                  a word at a time so runs of all-air or all-solid pixels are handled
+//                  without looking at each one.
+// Arguments:       The column and row of the tile to clean.
+// Return value:    None.
+
+    void CleanAirTile(int column, int row);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
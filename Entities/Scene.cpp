@@ -670,6 +670,10 @@ int Scene::LoadData(bool placeObjects, bool initPathfinding, bool placeUnits)
                     g_MovableMan.AddItem(dynamic_cast<MovableObject *>(pMO));
                 else
                     g_MovableMan.AddParticle(dynamic_cast<MovableObject *>(pMO));
+#ifdef DEBUG_BUILD
+				// Placed objects were registered when the Scene was cloned, before MovableMan got purged for loading it, so make sure they still count as valid.
+				RTEAssert(!pMO || g_MovableMan.ValidMO(pMO), "An object placed in the Scene isn't valid in MovableMan after being added!");
+#endif
             }
             else
             {
@@ -2937,6 +2941,86 @@ float Scene::CalculatePath(const Vector &start, const Vector &end, std::list<Vec
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SubmitPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up a path between two points to be calculated on the worker
+//                  threads. The result can be picked up with GetPathRequestResult on a
+//                  later update.
+
+int Scene::SubmitPathRequest(int team, const Vector &start, const Vector &end, float digStrength)
+{
+    RTEAssert(m_pPathFinder, "Tried to submit a path request to a Scene without a PathFinder!");
+    return m_pPathFinder->SubmitPathRequest(team, start, end, digStrength);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a submitted path request is still waiting to be solved.
+
+bool Scene::IsPathRequestPending(int ticket) const
+{
+    return m_pPathFinder && m_pPathFinder->IsPathRequestPending(ticket);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the result of a completed path request. Each result can only
+//                  be picked up once.
+
+bool Scene::GetPathRequestResult(int ticket, std::list<Vector> &pathResult, int &unrefinedWaypointCount)
+{
+    float notUsed;
+    return m_pPathFinder && m_pPathFinder->GetPathRequestResult(ticket, pathResult, notUsed, unrefinedWaypointCount);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path request that isn't needed anymore.
+
+void Scene::CancelPathRequest(int ticket)
+{
+    if (m_pPathFinder)
+        m_pPathFinder->CancelPathRequest(ticket);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdatePathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the path requests the worker threads have finished, and hands
+//                  them all the ones submitted since the last call.
+
+void Scene::UpdatePathRequests()
+{
+    if (!m_pPathFinder)
+        return;
+
+    m_pPathFinder->CollectPathRequests();
+
+    std::vector<int> teams;
+    m_pPathFinder->GetTeamsWithQueuedPathRequests(teams);
+    for (int team : teams)
+    {
+        // Remove the material representation of all doors of this team so its members can navigate through them (they'll open for them), then snapshot the costs with them gone
+        g_MovableMan.OverrideMaterialDoors(true, team);
+        UpdatePathFinding();
+        m_pPathFinder->DispatchPathRequests(team);
+        // Place back the material representation of all doors of this team so they are as we found them. The next team's update picks up the restored doors along with its own removed ones
+        g_MovableMan.OverrideMaterialDoors(false, team);
+    }
+    // Update the pathfinding once with all the doors back in place
+    if (!teams.empty())
+        UpdatePathFinding();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CalculateScenePath
 //////////////////////////////////////////////////////////////////////////////////////////
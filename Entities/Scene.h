@@ -1211,6 +1211,68 @@ const SceneObject * PickPlacedActorInRange(int whichSet, Vector &scenePoint, int
     int CalculateScenePath(const Vector start, const Vector end, bool movePathToGround, float digStrength = 1);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SubmitPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up a path between two points to be calculated on the worker
+//                  threads. The result can be picked up with GetPathRequestResult on a
+//                  later update.
+// Arguments:       The team the path is for. That team's doors won't block the path.
+//                  Start and end positions on the scene to find the path between.
+//                  The maximum material strength the path can dig through.
+// Return value:    The ticket to pick up the result with.
+
+    int SubmitPathRequest(int team, const Vector &start, const Vector &end, float digStrength = 1);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a submitted path request is still waiting to be solved.
+// Arguments:       The ticket of the path request.
+// Return value:    Whether the path request is still queued up or being solved.
+
+    bool IsPathRequestPending(int ticket) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the result of a completed path request. Each result can only
+//                  be picked up once.
+// Arguments:       The ticket of the path request.
+//                  A list which will be filled out with waypoints between the start and end.
+//                  An int which will be set to how many of the last waypoints are only
+//                  coarse points across far away parts of the scene, which should be
+//                  requested again once they get closer.
+// Return value:    Whether there was a result to pick up. False if the request is still
+//                  pending, or the ticket is unknown or was cancelled.
+
+    bool GetPathRequestResult(int ticket, std::list<Vector> &pathResult, int &unrefinedWaypointCount);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path request that isn't needed anymore.
+// Arguments:       The ticket of the path request.
+// Return value:    None.
+
+    void CancelPathRequest(int ticket);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdatePathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the path requests the worker threads have finished, and hands
+//                  them all the ones submitted since the last call. Supposed to be done
+//                  once every sim update, after the Actors have updated.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdatePathRequests();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetScenePathSize
 //////////////////////////////////////////////////////////////////////////////////////////
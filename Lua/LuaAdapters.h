@@ -87,6 +87,55 @@ namespace RTE {
 	/// <param name="whichButton">Which button to check for.</param>
 	/// <returns>Whether the mouse button is released or not.</returns>
 	static bool MouseButtonReleased(const UInputMan &uinputMan, int whichButton) { return uinputMan.MouseButtonReleased(Players::PlayerOne, whichButton); }
+
+	/// <summary>
+	/// Gets all Actors that are within a radius of a scene point, in a list of their own so Lua can make other actor queries while iterating over it.
+	/// </summary>
+	/// <param name="movableMan">A reference to MovableMan, provided by Lua.</param>
+	/// <param name="scenePoint">The Scene point to search around.</param>
+	/// <param name="radius">The radius around that scene point to search.</param>
+	/// <returns>The Actors within the radius.</returns>
+	static const std::vector<Actor *> & GetActorsInRadius(MovableMan &movableMan, const Vector &scenePoint, float radius) {
+		movableMan.GetActorsInRadius(scenePoint, radius);
+		return movableMan.KeepActorQueryResults();
+	}
+
+	/// <summary>
+	/// Gets all Actors of a team that are within a radius of a scene point, in a list of their own so Lua can make other actor queries while iterating over it.
+	/// </summary>
+	/// <param name="movableMan">A reference to MovableMan, provided by Lua.</param>
+	/// <param name="team">Which team to get Actors of.</param>
+	/// <param name="scenePoint">The Scene point to search around.</param>
+	/// <param name="radius">The radius around that scene point to search.</param>
+	/// <returns>The team's Actors within the radius.</returns>
+	static const std::vector<Actor *> & GetTeamActorsInRadius(MovableMan &movableMan, int team, const Vector &scenePoint, float radius) {
+		movableMan.GetTeamActorsInRadius(team, scenePoint, radius);
+		return movableMan.KeepActorQueryResults();
+	}
+
+	/// <summary>
+	/// Gets all Actors not of a team that are within a radius of a scene point, in a list of their own so Lua can make other actor queries while iterating over it.
+	/// </summary>
+	/// <param name="movableMan">A reference to MovableMan, provided by Lua.</param>
+	/// <param name="team">Which team to get enemy Actors of.</param>
+	/// <param name="scenePoint">The Scene point to search around.</param>
+	/// <param name="radius">The radius around that scene point to search.</param>
+	/// <returns>The enemy Actors within the radius.</returns>
+	static const std::vector<Actor *> & GetEnemyActorsInRadius(MovableMan &movableMan, int team, const Vector &scenePoint, float radius) {
+		movableMan.GetEnemyActorsInRadius(team, scenePoint, radius);
+		return movableMan.KeepActorQueryResults();
+	}
+
+	/// <summary>
+	/// Gets all Actors that are within a box, in a list of their own so Lua can make other actor queries while iterating over it.
+	/// </summary>
+	/// <param name="movableMan">A reference to MovableMan, provided by Lua.</param>
+	/// <param name="box">The Box to search in.</param>
+	/// <returns>The Actors within the box.</returns>
+	static const std::vector<Actor *> & GetActorsInBox(MovableMan &movableMan, const Box &box) {
+		movableMan.GetActorsInBox(box);
+		return movableMan.KeepActorQueryResults();
+	}
 #pragma endregion
 
 #pragma region Misc Lua Adapters
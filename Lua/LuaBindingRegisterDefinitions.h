@@ -17,6 +17,7 @@
 #include "FrameMan.h"
 #include "MetaMan.h"
 #include "MovableMan.h"
+#include "PerformanceMan.h"
 #include "PostProcessMan.h"
 #include "PresetMan.h"
 #include "PrimitiveMan.h"
@@ -111,6 +112,7 @@ namespace RTE {
 		LuaBindingRegisterFunctionDeclarationForType(FrameMan);
 		LuaBindingRegisterFunctionDeclarationForType(MetaMan);
 		LuaBindingRegisterFunctionDeclarationForType(MovableMan);
+		LuaBindingRegisterFunctionDeclarationForType(PerformanceMan);
 		LuaBindingRegisterFunctionDeclarationForType(PostProcessMan);
 		LuaBindingRegisterFunctionDeclarationForType(PresetMan);
 		LuaBindingRegisterFunctionDeclarationForType(PrimitiveMan);
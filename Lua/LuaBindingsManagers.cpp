@@ -126,6 +126,10 @@ namespace RTE {
 		.def("GetClosestEnemyActor", &MovableMan::GetClosestEnemyActor)
 		.def("GetFirstTeamActor", &MovableMan::GetFirstTeamActor)
 		.def("GetClosestActor", &MovableMan::GetClosestActor)
+		.def("GetActorsInRadius", &GetActorsInRadius, luabind::return_stl_iterator)
+		.def("GetTeamActorsInRadius", &GetTeamActorsInRadius, luabind::return_stl_iterator)
+		.def("GetEnemyActorsInRadius", &GetEnemyActorsInRadius, luabind::return_stl_iterator)
+		.def("GetActorsInBox", &GetActorsInBox, luabind::return_stl_iterator)
 		.def("GetClosestBrainActor", &MovableMan::GetClosestBrainActor)
 		.def("GetFirstBrainActor", &MovableMan::GetFirstBrainActor)
 		.def("GetClosestOtherBrainActor", &MovableMan::GetClosestOtherBrainActor)
@@ -151,6 +155,9 @@ namespace RTE {
 		.def("IsParticleSettlingEnabled", &MovableMan::IsParticleSettlingEnabled)
 		.def("EnableParticleSettling", &MovableMan::EnableParticleSettling)
 		.def("IsMOSubtractionEnabled", &MovableMan::IsMOSubtractionEnabled)
+		.def("IsPixelParticleStoreEnabled", &MovableMan::IsPixelParticleStoreEnabled)
+		.def("EnablePixelParticleStore", &MovableMan::EnablePixelParticleStore)
+		.def("PromotePixelParticles", &MovableMan::PromotePixelParticles)
 
 		.def("AddMO", &AddMO, luabind::adopt(_2))
 		.def("AddActor", &AddActor, luabind::adopt(_2))
@@ -158,6 +165,20 @@ namespace RTE {
 		.def("AddParticle", &AddParticle, luabind::adopt(_2));
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	LuaBindingRegisterFunctionDefinitionForType(ManagerLuaBindings, PerformanceMan) {
+		return luabind::class_<PerformanceMan>("PerformanceManager")
+
+		.property("CapturingTrace", &PerformanceMan::IsCapturingTrace)
+		.property("RotatedSpriteCacheHitRate", &PerformanceMan::GetRotatedSpriteCacheHitRate)
+
+		.def("CaptureTrace", &PerformanceMan::CaptureTrace)
+		.def("StartScope", &PerformanceMan::StartScope)
+		.def("EndScope", &PerformanceMan::EndScope)
+		.def("ResetRotatedSpriteCacheCounters", &PerformanceMan::ResetRotatedSpriteCacheCounters);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	LuaBindingRegisterFunctionDefinitionForType(ManagerLuaBindings, PostProcessMan) {
@@ -36,6 +36,7 @@
 #include "PerformanceMan.h"
 #include "MetaMan.h"
 #include "NetworkServer.h"
+#include "ThreadMan.h"
 
 extern "C" { FILE __iob_func[3] = { *stdin,*stdout,*stderr }; }
 
@@ -50,6 +51,7 @@ namespace RTE {
 	/// </summary>
 	void InitializeManagers() {
 		g_SettingsMan.Initialize();
+		g_ThreadMan.Initialize();
 
 		g_LuaMan.Initialize();
 		g_NetworkServer.Initialize();
@@ -80,8 +82,10 @@ namespace RTE {
 	/// Destroys all the managers and frees all loaded data before termination.
 	/// </summary>
 	void DestroyManagers() {
+		// The network threads have to be gone before the worker pool goes down
 		g_NetworkClient.Destroy();
 		g_NetworkServer.Destroy();
+		g_ThreadMan.Destroy();
 		g_MetaMan.Destroy();
 		g_MovableMan.Destroy();
 		g_SceneMan.Destroy();
@@ -108,13 +112,12 @@ namespace RTE {
 	/// </summary>
 	/// <param name="argCount">Argument count.</param>
 	/// <param name="argValue">Argument values.</param>
-	void HandleMainArgs(int argCount, char **argValue) {
+	/// <returns>Whether the arguments were valid. The game shouldn't start if they weren't.</returns>
+	bool HandleMainArgs(int argCount, char **argValue) {
 		// Discard the first argument because it's always the executable path/name
 		argCount--;
 		argValue++;
-		if (argCount == 0) {
-			return;
-		}
+
 		bool launchModeSet = false;
 		bool singleModuleSet = false;
 
@@ -134,16 +137,41 @@ namespace RTE {
 			if (!launchModeSet) {
 				if (currentArg == "-server") {
 					g_NetworkServer.EnableServerMode();
-					g_NetworkServer.SetServerPort(!lastArg ? argValue[++i] : "8000");
+					// The port is optional, so don't take the next argument as one if it's another switch, e.g. "-server -headless"
+					bool portArgGiven = !lastArg && argValue[i + 1][0] != '-';
+					g_NetworkServer.SetServerPort(portArgGiven ? argValue[++i] : "8000");
 					launchModeSet = true;
 				} else if (!lastArg && currentArg == "-editor") {
 					g_ActivityMan.SetEditorToLaunch(argValue[++i]);
 					launchModeSet = true;
+				} else if (currentArg == "-benchmark") {
+					// Missing arguments would otherwise have the switch silently ignored and the game launched normally.
+					if (i + 4 >= argCount) {
+						System::PrintToCLI("ERROR: -benchmark needs 4 arguments: <Activity> <Scene> <SimUpdates> <Seed>!");
+						return false;
+					}
+					int benchmarkSimUpdateCount = std::atoi(argValue[i + 3]);
+					// A benchmark without any sim updates would otherwise fall through to launching the game normally.
+					if (benchmarkSimUpdateCount <= 0) {
+						System::PrintToCLI("ERROR: The benchmark needs to run at least one sim update, got \"" + std::string(argValue[i + 3]) + "\"!");
+						return false;
+					}
+					g_ActivityMan.SetBenchmarkToLaunch(argValue[i + 1], argValue[i + 2]);
+					g_PerformanceMan.SetBenchmarkToRun(benchmarkSimUpdateCount, static_cast<unsigned int>(std::strtoul(argValue[i + 4], nullptr, 10)));
+					i += 4;
+					launchModeSet = true;
 				}
 			}
 			++i;
 		}
+		// A headless instance can't be used for anything but hosting or benchmarking, so it runs as a server, on the default port unless told otherwise.
+		if (System::IsHeadless() && !g_NetworkServer.IsServerModeEnabled() && !g_PerformanceMan.IsSetToRunBenchmark()) {
+			g_NetworkServer.EnableServerMode();
+			g_NetworkServer.SetServerPort("8000");
+			launchModeSet = true;
+		}
 		if (launchModeSet) { g_SettingsMan.SetSkipIntro(true); }
+		return true;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -174,12 +202,34 @@ namespace RTE {
 			}
 			g_ConsoleMan.Update();
 
-			g_MenuMan.Draw();
-			g_ConsoleMan.Draw(g_FrameMan.GetBackBuffer32());
-			g_FrameMan.FlipFrameBuffers();
+			// Nothing is ever shown locally when running headless.
+			if (!System::IsHeadless()) {
+				g_MenuMan.Draw();
+				g_ConsoleMan.Draw(g_FrameMan.GetBackBuffer32());
+				g_FrameMan.FlipFrameBuffers();
+			}
 		}
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Updates every manager that takes part in the simulation for one sim update and waits for the work they handed to the worker threads. Shared by the game and benchmark loops so both always simulate the same way.
+	/// </summary>
+	void UpdateSimulation() {
+		g_FrameMan.Update();
+		g_LuaMan.Update();
+		g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ActivityUpdate);
+		g_ActivityMan.Update();
+		g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ActivityUpdate);
+		g_MovableMan.Update();
+		g_AudioMan.Update();
+
+		g_ActivityMan.LateUpdateGlobalScripts();
+
+		g_ThreadMan.CompleteFrameJobs();
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	/// <summary>
@@ -218,15 +268,7 @@ namespace RTE {
 					g_NetworkServer.Update(true);
 					serverUpdated = true;
 				}
-				g_FrameMan.Update();
-				g_LuaMan.Update();
-				g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ActivityUpdate);
-				g_ActivityMan.Update();
-				g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ActivityUpdate);
-				g_MovableMan.Update();
-				g_AudioMan.Update();
-
-				g_ActivityMan.LateUpdateGlobalScripts();
+				UpdateSimulation();
 
 				g_ConsoleMan.Update();
 				g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::SimTotal);
@@ -274,6 +316,39 @@ namespace RTE {
 			g_FrameMan.FlipFrameBuffers();
 		}
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Benchmark loop. Runs the requested number of sim updates back to back without input, drawing or frame limiting, then writes the recorded performance data out.
+	/// </summary>
+	/// <returns>Whether the benchmark Activity started and the results were written.</returns>
+	bool RunBenchmarkLoop() {
+		if (!g_ActivityMan.Initialize()) {
+			return false;
+		}
+		// Seed right before the Activity starts so everything it and the Scene do from here on plays out the same every run.
+		SeedRNG(g_PerformanceMan.GetBenchmarkSeed());
+		if (!g_ActivityMan.RestartActivity()) {
+			return false;
+		}
+		g_TimerMan.PauseSim(false);
+
+		for (int simUpdate = 0; simUpdate < g_PerformanceMan.GetBenchmarkSimUpdateCount() && g_ActivityMan.IsInActivity() && !System::IsSetToQuit(); ++simUpdate) {
+			g_TimerMan.Update();
+			g_TimerMan.SetAccumulatorToOneSimUpdate();
+
+			g_PerformanceMan.NewPerformanceSample();
+			g_TimerMan.UpdateSim();
+
+			g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::SimTotal);
+			UpdateSimulation();
+			g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::SimTotal);
+
+			g_PerformanceMan.RecordBenchmarkSample();
+		}
+		return g_PerformanceMan.WriteBenchmarkResults(System::GetWorkingDirectory() + "BenchmarkResults.json");
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -282,8 +357,18 @@ namespace RTE {
 /// Implementation of the main function.
 /// </summary>
 int main(int argc, char **argv) {
+	// Headless mode decides which devices Allegro and the managers set up, so it has to be picked out of the arguments before anything is initialized.
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "-headless") { System::EnableHeadlessMode(); }
+	}
+
 	set_config_file("Base.rte/AllegroConfig.txt");
-	allegro_init();
+	if (System::IsHeadless()) {
+		install_allegro(SYSTEM_NONE, &errno, atexit);
+		System::EnableLoggingToCLI();
+	} else {
+		allegro_init();
+	}
 	loadpng_init();
 	set_close_button_callback(System::WindowCloseButtonHandler);
 
@@ -292,7 +377,10 @@ int main(int argc, char **argv) {
 
 	InitializeManagers();
 
-	HandleMainArgs(argc, argv);
+	if (!HandleMainArgs(argc, argv)) {
+		DestroyManagers();
+		return 1;
+	}
 
 	g_PresetMan.LoadAllDataModules();
 	// Load the different input device icons. This can't be done during UInputMan::Create() because the icon presets don't exist so we need to do this after modules are loaded.
@@ -308,11 +396,16 @@ int main(int argc, char **argv) {
 		if (std::filesystem::exists(System::GetWorkingDirectory() + "LogLoadingWarning.txt")) { std::remove("LogLoadingWarning.txt"); }
 	}
 
-	if (!g_ActivityMan.Initialize()) { RunMenuLoop(); }
-	RunGameLoop();
+	int exitCode = 0;
+	if (g_PerformanceMan.IsSetToRunBenchmark()) {
+		if (!RunBenchmarkLoop()) { exitCode = 1; }
+	} else {
+		if (!g_ActivityMan.Initialize()) { RunMenuLoop(); }
+		RunGameLoop();
+	}
 
 	DestroyManagers();
-	return 0;
+	return exitCode;
 }
 
 #ifdef _WIN32
@@ -38,6 +38,9 @@ namespace RTE {
 		m_LastMusicPos = 0.0F;
 		m_LaunchIntoActivity = false;
 		m_LaunchIntoEditor = false;
+		m_LaunchIntoBenchmark = false;
+		m_BenchmarkActivityToLaunch.clear();
+		m_BenchmarkSceneToLaunch.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +48,8 @@ namespace RTE {
 	bool ActivityMan::Initialize() {
 		if (g_NetworkServer.IsServerModeEnabled()) {
 			return SetStartMultiplayerServerOverview();
+		} else if (IsSetToLaunchIntoBenchmark()) {
+			return SetStartBenchmarkActivitySetToLaunchInto();
 		} else if (IsSetToLaunchIntoEditor()) {
 			// Evaluate LaunchIntoEditor before LaunchIntoActivity so it takes priority when both are set, otherwise it is ignored and editor is never launched.
 			return SetStartEditorActivitySetToLaunchInto();
@@ -117,6 +122,32 @@ namespace RTE {
 		}
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ActivityMan::SetStartBenchmarkActivitySetToLaunchInto() {
+		const Activity *activityPreset = nullptr;
+		std::list<Entity *> activityPresets;
+		g_PresetMan.GetAllOfType(activityPresets, "Activity");
+		for (const Entity *preset : activityPresets) {
+			if (preset->GetPresetName() == m_BenchmarkActivityToLaunch) {
+				activityPreset = dynamic_cast<const Activity *>(preset);
+				break;
+			}
+		}
+		if (!activityPreset) {
+			g_ConsoleMan.PrintString("ERROR: Couldn't find the Activity named \"" + m_BenchmarkActivityToLaunch + "\" passed into \"-benchmark\" argument!");
+		} else if (g_SceneMan.SetSceneToLoad(m_BenchmarkSceneToLaunch) < 0) {
+			g_ConsoleMan.PrintString("ERROR: Couldn't find the Scene named \"" + m_BenchmarkSceneToLaunch + "\" passed into \"-benchmark\" argument!");
+		} else {
+			if (g_MetaMan.GameInProgress()) { g_MetaMan.EndGame(); }
+			SetStartActivity(dynamic_cast<Activity *>(activityPreset->Clone()));
+			m_ActivityNeedsRestart = true;
+			return true;
+		}
+		m_LaunchIntoBenchmark = false;
+		return false;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool ActivityMan::SetStartMultiplayerActivity() {
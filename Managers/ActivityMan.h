@@ -138,6 +138,19 @@ namespace RTE {
 		/// </summary>
 		/// <param name="editorName"></param>
 		void SetEditorToLaunch(const std::string_view &editorName) { if (!editorName.empty()) { m_EditorToLaunch = editorName; m_LaunchIntoEditor = true; } }
+
+		/// <summary>
+		/// Gets whether the intro and main menu should be skipped on game start and launch directly into a benchmark Activity instead.
+		/// </summary>
+		/// <returns>Whether the game is set to launch directly into a benchmark Activity or not.</returns>
+		bool IsSetToLaunchIntoBenchmark() const { return m_LaunchIntoBenchmark; }
+
+		/// <summary>
+		/// Sets the Activity and Scene to launch directly into for a benchmark run.
+		/// </summary>
+		/// <param name="activityName">The PresetName of the Activity to launch.</param>
+		/// <param name="sceneName">The PresetName of the Scene to launch the Activity in.</param>
+		void SetBenchmarkToLaunch(const std::string &activityName, const std::string &sceneName) { if (!activityName.empty() && !sceneName.empty()) { m_BenchmarkActivityToLaunch = activityName; m_BenchmarkSceneToLaunch = sceneName; m_LaunchIntoBenchmark = true; } }
 #pragma endregion
 
 #pragma region Activity Start Handling
@@ -172,6 +185,12 @@ namespace RTE {
 		/// <returns>Whether a valid editor name was passed in and set to be launched next time ResetActivity is called.</returns>
 		bool SetStartEditorActivitySetToLaunchInto();
 
+		/// <summary>
+		/// Launch the benchmark Activity and Scene specified in command-line argument.
+		/// </summary>
+		/// <returns>Whether the Activity and Scene were found and set to be launched next time ResetActivity is called.</returns>
+		bool SetStartBenchmarkActivitySetToLaunchInto();
+
 		/// <summary>
 		/// Loads "Multiplayer Scene" and starts the MultiplayerGame Activity.
 		/// </summary>
@@ -252,6 +271,9 @@ namespace RTE {
 		bool m_LaunchIntoActivity; //!< Whether to skip the intro and main menu and launch directly into the set default Activity instead.
 		bool m_LaunchIntoEditor; //!< Whether to skip the intro and main menu and launch directly into the set editor Activity instead.
 		std::string_view m_EditorToLaunch; //!< The name of the editor Activity to launch directly into.
+		bool m_LaunchIntoBenchmark; //!< Whether to skip the intro and main menu and launch directly into the set benchmark Activity instead.
+		std::string m_BenchmarkActivityToLaunch; //!< The PresetName of the benchmark Activity to launch directly into.
+		std::string m_BenchmarkSceneToLaunch; //!< The PresetName of the Scene to launch the benchmark Activity in.
 
 	private:
 
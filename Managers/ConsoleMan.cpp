@@ -222,6 +222,7 @@ namespace RTE {
 		PrintString("F3 - Save console log");
 		PrintString("F4 - Save console user input log");
 		PrintString("F5 - Clear console log ");
+		PrintString("F6 - Capture a profiling trace of the next 60 sim updates");
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -55,8 +55,9 @@ namespace RTE {
 		m_PrimaryScreenResY = GetSystemMetrics(SM_CYSCREEN);
 #elif __unix__
 		m_NumScreens = 1;
-		m_MaxResX = m_PrimaryScreenResX = DisplayWidth(_xwin.display, _xwin.screen);
-		m_MaxResY = m_PrimaryScreenResY = DisplayHeight(_xwin.display, _xwin.screen);
+		// There is no X display to query when running headless, and the resolution doesn't get validated against it then anyway.
+		m_MaxResX = m_PrimaryScreenResX = System::IsHeadless() ? c_DefaultResX : DisplayWidth(_xwin.display, _xwin.screen);
+		m_MaxResY = m_PrimaryScreenResY = System::IsHeadless() ? c_DefaultResY : DisplayHeight(_xwin.display, _xwin.screen);
 #endif
 		m_ResX = c_DefaultResX;
 		m_ResY = c_DefaultResY;
@@ -263,26 +264,30 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int FrameMan::Initialize() {
-		ValidateResolution(m_ResX, m_ResY, m_ResMultiplier);
-		SetInitialGraphicsDriver();
 		set_color_depth(m_BPP);
 
-		if (set_gfx_mode(m_GfxDriver, m_ResX * m_ResMultiplier, m_ResY * m_ResMultiplier, 0, 0) != 0) {
-			// If a bad resolution somehow slipped past the validation, revert to defaults.
-			ShowMessageBox("Unable to set specified graphics mode because: " + std::string(allegro_error) + "!\n\nTrying to revert to defaults...");
-			if (set_gfx_mode(GFX_AUTODETECT_WINDOWED, c_DefaultResX, c_DefaultResY, 0, 0) != 0) {
-				RTEAbort("Unable to set any graphics mode because " + std::string(allegro_error) + "!");
-				return 1;
+		// Headless servers have no window to set up, everything gets drawn into the network back buffers at whatever resolution is set.
+		if (!System::IsHeadless()) {
+			ValidateResolution(m_ResX, m_ResY, m_ResMultiplier);
+			SetInitialGraphicsDriver();
+
+			if (set_gfx_mode(m_GfxDriver, m_ResX * m_ResMultiplier, m_ResY * m_ResMultiplier, 0, 0) != 0) {
+				// If a bad resolution somehow slipped past the validation, revert to defaults.
+				ShowMessageBox("Unable to set specified graphics mode because: " + std::string(allegro_error) + "!\n\nTrying to revert to defaults...");
+				if (set_gfx_mode(GFX_AUTODETECT_WINDOWED, c_DefaultResX, c_DefaultResY, 0, 0) != 0) {
+					RTEAbort("Unable to set any graphics mode because " + std::string(allegro_error) + "!");
+					return 1;
+				}
+				m_ResX = c_DefaultResX;
+				m_ResY = c_DefaultResY;
+				m_ResMultiplier = 1;
 			}
-			m_ResX = c_DefaultResX;
-			m_ResY = c_DefaultResY;
-			m_ResMultiplier = 1;
-		}
 
-		// Clear the screen buffer so it doesn't flash pink
-		clear_to_color(screen, 0);
+			// Clear the screen buffer so it doesn't flash pink
+			clear_to_color(screen, 0);
 
-		SetDisplaySwitchMode();
+			SetDisplaySwitchMode();
+		}
 
 		// Sets the allowed color conversions when loading bitmaps from files
 		set_color_conversion(COLORCONV_MOST);
@@ -313,11 +318,15 @@ namespace RTE {
 		m_BackBuffer8 = create_bitmap_ex(8, m_ResX, m_ResY);
 		ClearBackBuffer8();
 
+		// Nothing is ever shown locally when running headless, so the 32bpp buffers are only big enough for the GUI code that reads their color depth.
+		int backBuffer32Width = System::IsHeadless() ? 1 : m_ResX;
+		int backBuffer32Height = System::IsHeadless() ? 1 : m_ResY;
+
 		// Create the post-processing buffer, it'll be used for glow effects etc
-		m_BackBuffer32 = create_bitmap_ex(32, m_ResX, m_ResY);
+		m_BackBuffer32 = create_bitmap_ex(32, backBuffer32Width, backBuffer32Height);
 		ClearBackBuffer32();
 
-		m_OverlayBitmap32 = create_bitmap_ex(32, m_ResX, m_ResY);
+		m_OverlayBitmap32 = create_bitmap_ex(32, backBuffer32Width, backBuffer32Height);
 		clear_to_color(m_OverlayBitmap32, 0);
 
 		// Create all the network 8bpp back buffers
@@ -351,7 +360,8 @@ namespace RTE {
 			m_PlayerScreenHeight = m_PlayerScreen->h;
 		}
 
-		m_ScreenDumpBuffer = create_bitmap_ex(24, screen->w, screen->h);
+		// There's no screen to dump when running headless.
+		if (!System::IsHeadless()) { m_ScreenDumpBuffer = screen ? create_bitmap_ex(24, screen->w, screen->h) : create_bitmap_ex(24, m_ResX * m_ResMultiplier, m_ResY * m_ResMultiplier); }
 
 		return 0;
 	}
@@ -386,6 +396,7 @@ namespace RTE {
 		destroy_bitmap(m_ScreenDumpBuffer);
 		destroy_bitmap(m_WorldDumpBuffer);
 		destroy_bitmap(m_ScenePreviewDumpGradient);
+		m_RotatedSpriteCache.Destroy();
 
 		for (int i = 0; i < c_MaxScreenCount; i++) {
 			for (int f = 0; f < 2; f++) {
@@ -640,6 +651,9 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void FrameMan::FlipFrameBuffers() const {
+		if (System::IsHeadless()) {
+			return;
+		}
 		if (m_ResMultiplier > 1) {
 			stretch_blit(m_BackBuffer32, screen, 0, 0, m_BackBuffer32->w, m_BackBuffer32->h, 0, 0, SCREEN_W, SCREEN_H);
 		} else {
@@ -963,6 +977,9 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void FrameMan::Draw() {
+		// Drawing only happens on frames that get shown, so anything random in it must not come out of the simulation's randomness.
+		RandomStreamScope effectsStreamScope(RandomStreams::EffectsStream);
+
 		// Count how many split screens we'll need
 		int screenCount = (m_HSplit ? 2 : 1) * (m_VSplit ? 2 : 1);
 		RTEAssert(screenCount <= 1 || m_PlayerScreen, "Splitscreen surface not ready when needed!");
@@ -1081,10 +1098,13 @@ namespace RTE {
 
 		if (IsInMultiplayerMode()) { PrepareFrameForNetwork(); }
 
-		if (g_ActivityMan.IsInActivity()) { g_PostProcessMan.PostProcess(); }
+		// Nothing is ever shown locally when running headless, so the 32bpp back buffer and everything that goes into it is skipped.
+		if (!System::IsHeadless()) {
+			if (g_ActivityMan.IsInActivity()) { g_PostProcessMan.PostProcess(); }
 
-		// Draw the console on top of everything
-		g_ConsoleMan.Draw(m_BackBuffer32);
+			// Draw the console on top of everything
+			g_ConsoleMan.Draw(m_BackBuffer32);
+		}
 
 #ifdef DEBUG_BUILD
 		// Draw scene seam
@@ -1203,10 +1223,11 @@ namespace RTE {
 				effectPosX = postEffect.m_Pos.GetFloorIntX() - (effectBitmap->w / 2);
 				effectPosY = postEffect.m_Pos.GetFloorIntY() - (effectBitmap->h / 2);
 
-				if (postEffect.m_Angle == 0.0F) {
+				// There are no bitmaps to rotate effects in when running headless, so they're drawn unrotated.
+				BITMAP *targetBitmap = (postEffect.m_Angle == 0.0F) ? nullptr : g_PostProcessMan.GetTempEffectBitmap(effectBitmap);
+				if (!targetBitmap) {
 					draw_trans_sprite(m_WorldDumpBuffer, effectBitmap, effectPosX, effectPosY);
 				} else {
-					BITMAP *targetBitmap = g_PostProcessMan.GetTempEffectBitmap(effectBitmap);
 					clear_to_color(targetBitmap, 0);
 
 					Matrix newAngle(postEffect.m_Angle);
@@ -4,6 +4,7 @@
 #include "ContentFile.h"
 #include "Timer.h"
 #include "Box.h"
+#include "RotatedSpriteCache.h"
 
 #define g_FrameMan FrameMan::Instance()
 
@@ -95,6 +96,12 @@ namespace RTE {
 		/// </summary>
 		/// <returns>A pointer to the overlay BITMAP. OWNERSHIP IS NOT TRANSFERRED!</returns>
 		BITMAP * GetOverlayBitmap32() const { return m_OverlayBitmap32; }
+
+		/// <summary>
+		/// Gets the cache of pre-rotated sprite frames that rotated objects are drawn from.
+		/// </summary>
+		/// <returns>A reference to the RotatedSpriteCache.</returns>
+		RotatedSpriteCache & GetRotatedSpriteCache() { return m_RotatedSpriteCache; }
 #pragma endregion
 
 #pragma region Resolution Handling
@@ -580,6 +587,8 @@ namespace RTE {
 		BITMAP *m_WorldDumpBuffer; //!< Temporary buffer for making whole scene screencaps.
 		BITMAP *m_ScenePreviewDumpGradient; //!< BITMAP for the scene preview sky gradient (easier to load from a pre-made file because it's dithered).
 
+		RotatedSpriteCache m_RotatedSpriteCache; //!< The cache of pre-rotated sprite frames that rotated objects are drawn from.
+
 		BITMAP *m_NetworkBackBufferIntermediate8[2][c_MaxScreenCount]; //!< Per-player allocated frame buffer to draw upon during FrameMan draw.
 		BITMAP *m_NetworkBackBufferIntermediateGUI8[2][c_MaxScreenCount]; //!< Per-player allocated frame buffer to draw upon during FrameMan draw. Used to draw UI only.
 		BITMAP *m_NetworkBackBufferFinal8[2][c_MaxScreenCount]; //!< Per-player allocated frame buffer to copy Intermediate before sending.
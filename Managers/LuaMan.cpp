@@ -18,12 +18,25 @@ namespace RTE {
 		m_TempEntityVector.clear();
 
 		m_OpenedFiles.fill(nullptr);
+		m_CastFunctionReferences.clear();
+		m_ScriptUpdateBudget = 0;
+		m_ScriptTimeThisUpdate = 0;
+		m_ScriptProfilingEnabled = false;
+		m_ScriptIDs.clear();
+		m_ScriptProfiles.clear();
+		m_ProfiledScripts.clear();
+		m_ScriptAccountingStack.clear();
+		m_DefaultAllocator = nullptr;
+		m_DefaultAllocatorData = nullptr;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void LuaMan::Initialize() {
 		m_MasterState = luaL_newstate();
+		// Wrap the default allocator instead of replacing it, since LuaJIT can't use arbitrary allocators on all 64-bit targets.
+		m_DefaultAllocator = lua_getallocf(m_MasterState, &m_DefaultAllocatorData);
+		lua_setallocf(m_MasterState, &LuaMan::AccountingAllocator, this);
 		luabind::open(m_MasterState);
 
 		const luaL_Reg libsToLoad[] = {
@@ -63,7 +76,16 @@ namespace RTE {
 				.def("FileClose", &LuaMan::FileClose)
 				.def("FileReadLine", &LuaMan::FileReadLine)
 				.def("FileWriteLine", &LuaMan::FileWriteLine)
-				.def("FileEOF", &LuaMan::FileEOF),
+				.def("FileEOF", &LuaMan::FileEOF)
+				.property("ScriptUpdateBudget", &LuaMan::GetScriptUpdateBudget, &LuaMan::SetScriptUpdateBudget)
+				.property("ScriptProfilingEnabled", &LuaMan::IsScriptProfilingEnabled, &LuaMan::SetScriptProfilingEnabled)
+				.def_readonly("ProfiledScripts", &LuaMan::m_ProfiledScripts, luabind::return_stl_iterator)
+				.def("GetScriptTime", &LuaMan::GetScriptTime)
+				.def("GetScriptCallCount", &LuaMan::GetScriptCallCount)
+				.def("GetScriptAllocatedBytes", &LuaMan::GetScriptAllocatedBytes)
+				.def("GetScriptDeferredUpdateCount", &LuaMan::GetScriptDeferredUpdateCount)
+				.def("PrintScriptReport", &LuaMan::PrintScriptReport)
+				.def("ResetScriptProfiles", &LuaMan::ResetScriptProfiles),
 
 			luabind::def("DeleteEntity", &DeleteEntity, luabind::adopt(_1)), // NOT a member function, so adopting _1 instead of the _2 for the first param, since there's no "this" pointer!!
 			luabind::def("RangeRand", (double(*)(double, double)) &RandomNum),
@@ -135,6 +157,7 @@ namespace RTE {
 			RegisterLuaBindingsOfType(ManagerLuaBindings, FrameMan),
 			RegisterLuaBindingsOfType(ManagerLuaBindings, MetaMan),
 			RegisterLuaBindingsOfType(ManagerLuaBindings, MovableMan),
+			RegisterLuaBindingsOfType(ManagerLuaBindings, PerformanceMan),
 			RegisterLuaBindingsOfType(ManagerLuaBindings, PostProcessMan),
 			RegisterLuaBindingsOfType(ManagerLuaBindings, PresetMan),
 			RegisterLuaBindingsOfType(ManagerLuaBindings, PrimitiveMan),
@@ -165,6 +188,7 @@ namespace RTE {
 		luabind::globals(m_MasterState)["ConsoleMan"] = &g_ConsoleMan;
 		luabind::globals(m_MasterState)["LuaMan"] = &g_LuaMan;
 		luabind::globals(m_MasterState)["SettingsMan"] = &g_SettingsMan;
+		luabind::globals(m_MasterState)["PerformanceMan"] = &g_PerformanceMan;
 
 		luaL_dostring(m_MasterState,
 			// Override print() in the lua state to output to the console.
@@ -308,6 +332,243 @@ namespace RTE {
 		return error;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::CreateReference(const std::string &expression) {
+		static_assert(c_NoReference == LUA_NOREF, "LuaMan::c_NoReference needs to match LUA_NOREF!");
+		if (expression.empty()) {
+			return c_NoReference;
+		}
+		int reference = c_NoReference;
+
+		lua_pushcfunction(m_MasterState, &AddFileAndLineToError);
+		if (luaL_loadstring(m_MasterState, std::string("return " + expression + ";").c_str()) || lua_pcall(m_MasterState, 0, 1, -2)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			lua_pop(m_MasterState, 1);
+		} else if (lua_toboolean(m_MasterState, -1)) {
+			// luaL_ref pops the value it references, so only the error handler is left to clean up.
+			reference = luaL_ref(m_MasterState, LUA_REGISTRYINDEX);
+		} else {
+			lua_pop(m_MasterState, 1);
+		}
+		lua_pop(m_MasterState, 1);
+
+		return reference;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::ReleaseReference(int reference) {
+		if (reference != c_NoReference && m_MasterState) { luaL_unref(m_MasterState, LUA_REGISTRYINDEX, reference); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::RunFunctionReference(int functionReference, int selfObjectReference, const std::vector<Entity *> &functionEntityArguments, const std::vector<std::string> &functionLiteralArguments) {
+		if (functionReference == c_NoReference || selfObjectReference == c_NoReference) {
+			return -1;
+		}
+		int error = 0;
+
+		lua_pushcfunction(m_MasterState, &AddFileAndLineToError);
+		int errorHandlerIndex = lua_gettop(m_MasterState);
+
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, functionReference);
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, selfObjectReference);
+		for (Entity *functionEntityArgument : functionEntityArguments) {
+			PushEntityArgument(functionEntityArgument);
+		}
+		for (const std::string &functionLiteralArgument : functionLiteralArguments) {
+			PushLiteralArgument(functionLiteralArgument);
+		}
+		if (lua_pcall(m_MasterState, 1 + static_cast<int>(functionEntityArguments.size() + functionLiteralArguments.size()), 0, errorHandlerIndex)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			lua_pop(m_MasterState, 1);
+			g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+			ClearErrors();
+			error = -1;
+		}
+		// Pop the file and line error handler off the stack to clean it up
+		lua_pop(m_MasterState, 1);
+
+		return error;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::PushEntityArgument(Entity *entity) {
+		if (!entity) {
+			lua_pushnil(m_MasterState);
+			return;
+		}
+		const std::string &className = entity->GetClassName();
+		std::unordered_map<std::string, int>::const_iterator castFunctionEntry = m_CastFunctionReferences.find(className);
+		if (castFunctionEntry == m_CastFunctionReferences.end()) { castFunctionEntry = m_CastFunctionReferences.try_emplace(className, CreateReference("To" + className)).first; }
+
+		if (castFunctionEntry->second == c_NoReference) {
+			luabind::object(m_MasterState, entity).push(m_MasterState);
+			return;
+		}
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, castFunctionEntry->second);
+		luabind::object(m_MasterState, entity).push(m_MasterState);
+		// Casting can't really fail since the cast function matches the entity's own class, but if it somehow does, fall back to passing the entity as is like the script string version did.
+		if (lua_pcall(m_MasterState, 1, 1, 0)) {
+			lua_pop(m_MasterState, 1);
+			luabind::object(m_MasterState, entity).push(m_MasterState);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::PushLiteralArgument(const std::string &literalArgument) {
+		if (literalArgument == "nil") {
+			lua_pushnil(m_MasterState);
+		} else if (literalArgument == "true" || literalArgument == "false") {
+			lua_pushboolean(m_MasterState, literalArgument == "true");
+		} else if (literalArgument.size() >= 2 && literalArgument.front() == '"' && literalArgument.back() == '"' && literalArgument.find_first_of("\\\"", 1) == literalArgument.size() - 1) {
+			lua_pushlstring(m_MasterState, literalArgument.data() + 1, literalArgument.size() - 2);
+		} else {
+			char *numberEnd = nullptr;
+			double number = std::strtod(literalArgument.c_str(), &numberEnd);
+			if (!literalArgument.empty() && numberEnd == literalArgument.c_str() + literalArgument.size()) {
+				lua_pushnumber(m_MasterState, number);
+			} else if (luaL_loadstring(m_MasterState, std::string("return " + literalArgument + ";").c_str()) || lua_pcall(m_MasterState, 0, 1, 0)) {
+				// Not a plain value, so it had to go through the parser. Report the error and pass nil in its place so the stack stays balanced.
+				g_ConsoleMan.PrintString(std::string("ERROR: Could not evaluate Lua function argument ") + literalArgument + ": " + lua_tostring(m_MasterState, -1));
+				lua_pop(m_MasterState, 1);
+				lua_pushnil(m_MasterState);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::GetScriptID(const std::string &scriptPath) {
+		auto [scriptID, newlyAccounted] = m_ScriptIDs.try_emplace(scriptPath, static_cast<int>(m_ScriptProfiles.size()));
+		if (newlyAccounted) {
+			m_ScriptProfiles.emplace_back();
+			m_ProfiledScripts.emplace_back(scriptPath);
+		}
+		return scriptID->second;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::BeginScriptAccounting(int scriptID) {
+		long long currentTime = g_TimerMan.GetAbsoluteTime();
+		if (!m_ScriptAccountingStack.empty()) {
+			auto &[outerScriptID, outerStartTime] = m_ScriptAccountingStack.back();
+			m_ScriptProfiles[outerScriptID].Time += currentTime - outerStartTime;
+			m_ScriptTimeThisUpdate += currentTime - outerStartTime;
+		}
+		m_ScriptProfiles[scriptID].CallCount++;
+		m_ScriptAccountingStack.emplace_back(scriptID, currentTime);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::EndScriptAccounting() {
+		if (m_ScriptAccountingStack.empty()) {
+			return;
+		}
+		long long currentTime = g_TimerMan.GetAbsoluteTime();
+		const auto &[scriptID, startTime] = m_ScriptAccountingStack.back();
+		m_ScriptProfiles[scriptID].Time += currentTime - startTime;
+		m_ScriptTimeThisUpdate += currentTime - startTime;
+		m_ScriptAccountingStack.pop_back();
+
+		// The outer script picks up from here, so the time spent in the inner one isn't counted twice.
+		if (!m_ScriptAccountingStack.empty()) { m_ScriptAccountingStack.back().second = currentTime; }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	double LuaMan::GetScriptTime(const std::string &scriptPath) const {
+		const ScriptProfile *scriptProfile = FindScriptProfile(scriptPath);
+		return scriptProfile ? static_cast<double>(scriptProfile->Time) / 1000.0 : 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	double LuaMan::GetScriptCallCount(const std::string &scriptPath) const {
+		const ScriptProfile *scriptProfile = FindScriptProfile(scriptPath);
+		return scriptProfile ? static_cast<double>(scriptProfile->CallCount) : 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	double LuaMan::GetScriptAllocatedBytes(const std::string &scriptPath) const {
+		const ScriptProfile *scriptProfile = FindScriptProfile(scriptPath);
+		return scriptProfile ? static_cast<double>(scriptProfile->AllocatedBytes) : 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	double LuaMan::GetScriptDeferredUpdateCount(const std::string &scriptPath) const {
+		const ScriptProfile *scriptProfile = FindScriptProfile(scriptPath);
+		return scriptProfile ? static_cast<double>(scriptProfile->DeferredUpdateCount) : 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::PrintScriptReport(const std::string &sortBy) const {
+		std::function<long long(const ScriptProfile &)> sortValue;
+		if (sortBy == "Time") {
+			sortValue = [](const ScriptProfile &scriptProfile) { return scriptProfile.Time; };
+		} else if (sortBy == "Calls") {
+			sortValue = [](const ScriptProfile &scriptProfile) { return scriptProfile.CallCount; };
+		} else if (sortBy == "Memory") {
+			sortValue = [](const ScriptProfile &scriptProfile) { return scriptProfile.AllocatedBytes; };
+		} else if (sortBy == "Deferred") {
+			sortValue = [](const ScriptProfile &scriptProfile) { return scriptProfile.DeferredUpdateCount; };
+		} else {
+			g_ConsoleMan.PrintString("ERROR: Can't sort the script report by \"" + sortBy + "\"! Use \"Time\", \"Calls\", \"Memory\" or \"Deferred\".");
+			return;
+		}
+		if (!IsScriptAccountingEnabled()) { g_ConsoleMan.PrintString("WARNING: Script profiling is disabled, set LuaMan.ScriptProfilingEnabled = true to record script times and memory."); }
+
+		std::vector<int> sortedScriptIDs(m_ScriptProfiles.size());
+		std::iota(sortedScriptIDs.begin(), sortedScriptIDs.end(), 0);
+		std::sort(sortedScriptIDs.begin(), sortedScriptIDs.end(), [this, &sortValue](int scriptIDA, int scriptIDB) { return sortValue(m_ScriptProfiles[scriptIDA]) > sortValue(m_ScriptProfiles[scriptIDB]); });
+
+		g_ConsoleMan.PrintString("SYSTEM: Top " + std::to_string(std::min(static_cast<int>(sortedScriptIDs.size()), c_ScriptReportLength)) + " of " + std::to_string(sortedScriptIDs.size()) + " scripts by " + sortBy + ":");
+		for (int scriptIndex = 0; scriptIndex < std::min(static_cast<int>(sortedScriptIDs.size()), c_ScriptReportLength); ++scriptIndex) {
+			const std::string &scriptPath = m_ProfiledScripts.at(sortedScriptIDs.at(scriptIndex));
+			const ScriptProfile &scriptProfile = m_ScriptProfiles.at(sortedScriptIDs.at(scriptIndex));
+			char scriptReportLine[128];
+			std::snprintf(scriptReportLine, sizeof(scriptReportLine), "%9.2f ms %8lli calls %9.1f us/call %9.1f KB %6lli deferred  ",
+				static_cast<double>(scriptProfile.Time) / 1000.0, scriptProfile.CallCount, (scriptProfile.CallCount > 0) ? static_cast<double>(scriptProfile.Time) / static_cast<double>(scriptProfile.CallCount) : 0, static_cast<double>(scriptProfile.AllocatedBytes) / 1024.0, scriptProfile.DeferredUpdateCount);
+			g_ConsoleMan.PrintString(scriptReportLine + scriptPath);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::ResetScriptProfiles() {
+		// Scopes that are currently open keep referring to their script IDs, so the profiles are zeroed rather than removed.
+		for (ScriptProfile &scriptProfile : m_ScriptProfiles) {
+			scriptProfile = ScriptProfile();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const LuaMan::ScriptProfile * LuaMan::FindScriptProfile(const std::string &scriptPath) const {
+		std::unordered_map<std::string, int>::const_iterator scriptID = m_ScriptIDs.find(scriptPath);
+		return (scriptID != m_ScriptIDs.end()) ? &m_ScriptProfiles[scriptID->second] : nullptr;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void * LuaMan::AccountingAllocator(void *userData, void *pointer, size_t oldSize, size_t newSize) {
+		LuaMan *luaMan = static_cast<LuaMan *>(userData);
+		if (!luaMan->m_ScriptAccountingStack.empty()) {
+			size_t currentSize = pointer ? oldSize : 0;
+			if (newSize > currentSize) { luaMan->m_ScriptProfiles[luaMan->m_ScriptAccountingStack.back().first].AllocatedBytes += static_cast<long long>(newSize - currentSize); }
+		}
+		return luaMan->m_DefaultAllocator(luaMan->m_DefaultAllocatorData, pointer, oldSize, newSize);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool LuaMan::ExpressionIsTrue(const std::string &expression, bool consoleErrors) {
@@ -462,7 +723,8 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void LuaMan::Update() const {
+	void LuaMan::Update() {
+		m_ScriptTimeThisUpdate = 0;
 		lua_gc(m_MasterState, LUA_GCSTEP, 1);
 	}
 }
\ No newline at end of file
@@ -19,6 +19,34 @@ namespace RTE {
 
 	public:
 
+		/// <summary>
+		/// Attributes the Lua time and memory used while it's alive to a script file. Scopes can nest, time spent in an inner scope only counts towards the inner scope's script.
+		/// Scopes do nothing unless script accounting is enabled, so they can be left in hot paths.
+		/// </summary>
+		class ScriptAccountingScope {
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to start attributing Lua time and memory to a script file.
+			/// </summary>
+			/// <param name="scriptPath">The path of the script file to attribute to.</param>
+			explicit ScriptAccountingScope(const std::string &scriptPath) : m_Accounting(LuaMan::Instance().IsScriptAccountingEnabled()) { if (m_Accounting) { LuaMan::Instance().BeginScriptAccounting(LuaMan::Instance().GetScriptID(scriptPath)); } }
+
+			/// <summary>
+			/// Destructor method used to stop attributing Lua time and memory to this scope's script file.
+			/// </summary>
+			~ScriptAccountingScope() { if (m_Accounting) { LuaMan::Instance().EndScriptAccounting(); } }
+
+		private:
+
+			bool m_Accounting; //!< Whether this scope started attributing to its script, so it stops again even if script accounting was disabled in the meantime.
+
+			// Disallow the use of some implicit methods.
+			ScriptAccountingScope(const ScriptAccountingScope &reference) = delete;
+			ScriptAccountingScope & operator=(const ScriptAccountingScope &rhs) = delete;
+		};
+
 #pragma region Creation
 		/// <summary>
 		/// Constructor method used to instantiate a LuaMan object in system memory. Initialize() should be called before using the object.
@@ -110,6 +138,33 @@ namespace RTE {
 		int RunScriptFile(const std::string &filePath, bool consoleErrors = true);
 #pragma endregion
 
+#pragma region Registry References
+		/// <summary>
+		/// Evaluates a Lua expression once and stores its result in the Lua registry, so it can be pushed again later without looking it up by name or parsing anything.
+		/// Meant for resolving script functions and self objects ahead of time, so per-frame callbacks don't have to go through RunScriptString.
+		/// </summary>
+		/// <param name="expression">The Lua expression to evaluate, e.g. the name of a global function.</param>
+		/// <returns>A registry reference to the result, or c_NoReference if the expression had errors or evaluated to nil or false.</returns>
+		int CreateReference(const std::string &expression);
+
+		/// <summary>
+		/// Frees a registry reference made with CreateReference, so the referenced value can be garbage collected.
+		/// </summary>
+		/// <param name="reference">The reference to free. c_NoReference is ignored.</param>
+		void ReleaseReference(int reference);
+
+		/// <summary>
+		/// Calls a function stored in the registry with optional arguments. The first argument to the function will always be the self object.
+		/// If either argument list has entries, they will be pushed onto the Lua stack directly and passed into the function in order, with entity arguments first.
+		/// </summary>
+		/// <param name="functionReference">The registry reference to the function to call.</param>
+		/// <param name="selfObjectReference">The registry reference to the self object.</param>
+		/// <param name="functionEntityArguments">Optional vector of entity pointers that should be passed into the Lua function, cast to their most derived type. Their internal Lua states will not be accessible. Defaults to empty.</param>
+		/// <param name="functionLiteralArguments">Optional vector of strings that should be passed into the Lua function. Numbers, booleans, nil and strings surrounded with escaped quotes (i.e.`\"`) are pushed as their Lua types, anything else is evaluated as an expression. Defaults to empty.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int RunFunctionReference(int functionReference, int selfObjectReference, const std::vector<Entity *> &functionEntityArguments = std::vector<Entity *>(), const std::vector<std::string> &functionLiteralArguments = std::vector<std::string>());
+#pragma endregion
+
 #pragma region
 		/// <summary>
 		/// Gets whether the given Lua expression evaluates to true or false.
@@ -142,6 +197,107 @@ namespace RTE {
 		bool TableEntryIsDefined(const std::string &tableName, const std::string &indexName);
 #pragma endregion
 
+#pragma region Script Accounting
+		/// <summary>
+		/// Gets how much time scripts can take per sim update before deferrable script updates are put off until the next one.
+		/// </summary>
+		/// <returns>The script update budget, in milliseconds. 0 means there is no budget.</returns>
+		float GetScriptUpdateBudget() const { return m_ScriptUpdateBudget; }
+
+		/// <summary>
+		/// Sets how much time scripts can take per sim update before deferrable script updates are put off until the next one.
+		/// </summary>
+		/// <param name="newBudget">The new script update budget, in milliseconds. 0 or less disables the budget.</param>
+		void SetScriptUpdateBudget(float newBudget) { m_ScriptUpdateBudget = std::max(newBudget, 0.0F); }
+
+		/// <summary>
+		/// Gets whether scripts have taken more time this sim update than the script update budget allows.
+		/// </summary>
+		/// <returns>Whether the script update budget has been used up for this sim update.</returns>
+		bool IsOverScriptUpdateBudget() const { return m_ScriptUpdateBudget > 0 && static_cast<float>(m_ScriptTimeThisUpdate) > m_ScriptUpdateBudget * 1000.0F; }
+
+		/// <summary>
+		/// Gets whether the time and memory of every script file are being profiled.
+		/// </summary>
+		/// <returns>Whether script profiling is enabled.</returns>
+		bool IsScriptProfilingEnabled() const { return m_ScriptProfilingEnabled; }
+
+		/// <summary>
+		/// Sets whether the time and memory of every script file should be profiled. Script time is also measured while there is a script update budget, since the budget needs it.
+		/// </summary>
+		/// <param name="enable">Whether to enable script profiling.</param>
+		void SetScriptProfilingEnabled(bool enable) { m_ScriptProfilingEnabled = enable; }
+
+		/// <summary>
+		/// Gets whether scripted calls are being attributed to their script files, either for profiling or for the script update budget.
+		/// </summary>
+		/// <returns>Whether script accounting is enabled.</returns>
+		bool IsScriptAccountingEnabled() const { return m_ScriptProfilingEnabled || m_ScriptUpdateBudget > 0; }
+
+		/// <summary>
+		/// Gets the ID of a script file, giving it one if it doesn't have one yet. Script profiles are stored by these IDs.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The ID of the script file.</returns>
+		int GetScriptID(const std::string &scriptPath);
+
+		/// <summary>
+		/// Starts attributing Lua time and memory to a script file. Use ScriptAccountingScope instead of calling this directly where possible.
+		/// </summary>
+		/// <param name="scriptID">The ID of the script file to attribute to, as given by GetScriptID.</param>
+		void BeginScriptAccounting(int scriptID);
+
+		/// <summary>
+		/// Stops attributing Lua time and memory to the script file of the last BeginScriptAccounting call, and goes back to the one before it, if any.
+		/// </summary>
+		void EndScriptAccounting();
+
+		/// <summary>
+		/// Records that a script's update was put off because the script update budget was used up.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file whose update was put off.</param>
+		void RecordDeferredScriptUpdate(const std::string &scriptPath) { m_ScriptProfiles.at(GetScriptID(scriptPath)).DeferredUpdateCount++; }
+
+		/// <summary>
+		/// Gets the total time spent running a script file's functions since the script profiles were last reset.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The total time spent in the script, in milliseconds. 0 if the script hasn't run.</returns>
+		double GetScriptTime(const std::string &scriptPath) const;
+
+		/// <summary>
+		/// Gets how many times a script file's functions have been called since the script profiles were last reset.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The number of calls into the script.</returns>
+		double GetScriptCallCount(const std::string &scriptPath) const;
+
+		/// <summary>
+		/// Gets how much memory Lua allocated while running a script file's functions since the script profiles were last reset. Memory freed again is not subtracted.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The number of bytes allocated by the script.</returns>
+		double GetScriptAllocatedBytes(const std::string &scriptPath) const;
+
+		/// <summary>
+		/// Gets how many times a script file's updates were put off because the script update budget was used up, since the script profiles were last reset.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The number of deferred updates of the script.</returns>
+		double GetScriptDeferredUpdateCount(const std::string &scriptPath) const;
+
+		/// <summary>
+		/// Prints the most expensive scripts to the console.
+		/// </summary>
+		/// <param name="sortBy">What to sort the scripts by. Can be "Time", "Calls", "Memory" or "Deferred".</param>
+		void PrintScriptReport(const std::string &sortBy) const;
+
+		/// <summary>
+		/// Clears the times, call counts, allocations and deferred updates recorded for every script.
+		/// </summary>
+		void ResetScriptProfiles();
+#pragma endregion
+
 #pragma region Error Handling
 		/// <summary>
 		/// Tells whether there are any errors reported waiting to be read.
@@ -207,11 +363,26 @@ namespace RTE {
 		/// <summary>
 		/// Updates the state of this LuaMan.
 		/// </summary>
-		void Update() const;
+		void Update();
 #pragma endregion
 
+		static constexpr int c_NoReference = -2; //!< The value of an invalid registry reference. Matches LUA_NOREF, so the Lua headers don't need to be included everywhere.
+
 	private:
 
+		/// <summary>
+		/// The Lua time and memory attributed to a single script file.
+		/// </summary>
+		struct ScriptProfile {
+			long long Time = 0; //!< The total time spent running the script's functions, in microseconds, not counting time spent in nested scopes of other scripts.
+			long long CallCount = 0; //!< The number of calls into the script.
+			long long AllocatedBytes = 0; //!< The number of bytes Lua allocated while running the script.
+			long long DeferredUpdateCount = 0; //!< The number of updates of the script that were put off because the script update budget was used up.
+		};
+
+		using LuaAllocator = void * (*)(void *userData, void *pointer, size_t oldSize, size_t newSize); //!< Convenience for the lua_Alloc function type, so the Lua headers don't need to be included everywhere.
+
+		static constexpr int c_ScriptReportLength = 20; //!< The maximum number of scripts PrintScriptReport lists.
 		static constexpr int c_MaxOpenFiles = 10; //!< The maximum number of files that can be opened with FileOpen at runtime.
 
 		lua_State *m_MasterState; //!< The master parent script state.
@@ -227,6 +398,47 @@ namespace RTE {
 
 		std::array<FILE *, c_MaxOpenFiles> m_OpenedFiles; //!< Internal list of opened files used by File functions.
 
+		std::unordered_map<std::string, int> m_CastFunctionReferences; //!< Registry references to the To<ClassName> cast functions by class name, used to pass entity arguments as their most derived type. Classes without a cast function map to c_NoReference.
+
+		float m_ScriptUpdateBudget; //!< How much time scripts can take per sim update before deferrable script updates are put off, in milliseconds. 0 means there is no budget.
+		long long m_ScriptTimeThisUpdate; //!< The time spent running scripts this sim update, in microseconds.
+		bool m_ScriptProfilingEnabled; //!< Whether the time and memory of every script file are being profiled.
+		std::unordered_map<std::string, int> m_ScriptIDs; //!< The ID of every script file that was accounted for, by script path.
+		std::vector<ScriptProfile> m_ScriptProfiles; //!< The Lua time and memory attributed to each script file, by script ID.
+		std::vector<std::string> m_ProfiledScripts; //!< The path of each script file in m_ScriptProfiles, by script ID, which is the order they first ran in. Exposed to Lua so scripts can iterate over them.
+		std::vector<std::pair<int, long long>> m_ScriptAccountingStack; //!< The IDs of the script files currently being attributed to, innermost last, and the time each started or resumed being attributed to.
+		LuaAllocator m_DefaultAllocator; //!< The allocator the master state was created with, which the accounting allocator forwards to.
+		void *m_DefaultAllocatorData; //!< The user data of the allocator the master state was created with.
+
+		/// <summary>
+		/// Gets the profile of a script file, if it has been accounted for.
+		/// </summary>
+		/// <param name="scriptPath">The path of the script file.</param>
+		/// <returns>The profile of the script file, or nullptr if it hasn't been accounted for.</returns>
+		const ScriptProfile * FindScriptProfile(const std::string &scriptPath) const;
+
+		/// <summary>
+		/// Lua allocator that forwards to the master state's default allocator and attributes any growth to the script file currently being accounted for, if any.
+		/// </summary>
+		/// <param name="userData">The LuaMan instance.</param>
+		/// <param name="pointer">The block to reallocate or free, or nullptr to allocate a new one.</param>
+		/// <param name="oldSize">The current size of the block.</param>
+		/// <param name="newSize">The requested size of the block. 0 frees it.</param>
+		/// <returns>The reallocated block, or nullptr if it was freed or allocation failed.</returns>
+		static void * AccountingAllocator(void *userData, void *pointer, size_t oldSize, size_t newSize);
+
+		/// <summary>
+		/// Pushes an entity onto the Lua stack as its most derived type, using the cast function for its class if there is one.
+		/// </summary>
+		/// <param name="entity">The entity to push. Ownership is NOT transferred!</param>
+		void PushEntityArgument(Entity *entity);
+
+		/// <summary>
+		/// Pushes a literal argument onto the Lua stack as the Lua type it represents. Anything that isn't a plain number, boolean, nil or quoted string is evaluated as an expression.
+		/// </summary>
+		/// <param name="literalArgument">The literal argument to push.</param>
+		void PushLiteralArgument(const std::string &literalArgument);
+
 		/// <summary>
 		/// Clears all the member variables of this LuaMan, effectively resetting the members of this abstraction level only.
 		/// </summary>
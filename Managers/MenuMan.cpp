@@ -90,6 +90,7 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool MenuMan::Update() {
+		RandomStreamScope interfaceStreamScope(RandomStreams::InterfaceStream);
 		m_TitleScreen->Update();
 		SetActiveMenu();
 
@@ -197,6 +198,7 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void MenuMan::Draw() const {
+		RandomStreamScope interfaceStreamScope(RandomStreams::InterfaceStream);
 		g_FrameMan.ClearBackBuffer32();
 
 		// Early return when changing resolution so screen remains black while everything is being recreated instead of being stuck showing a badly aligned title screen.
@@ -14,21 +14,28 @@
 #include "MovableMan.h"
 #include "PostProcessMan.h"
 #include "PerformanceMan.h"
+#include "SettingsMan.h"
 #include "PresetMan.h"
 #include "AHuman.h"
 #include "MOPixel.h"
 #include "HeldDevice.h"
 #include "SLTerrain.h"
+#include "Scene.h"
 #include "Controller.h"
 #include "AtomGroup.h"
 #include "Actor.h"
 #include "ADoor.h"
 #include "Atom.h"
+#include "MOSParticle.h"
+#include "ThreadMan.h"
+#include "NetworkServer.h"
 
 namespace RTE {
 
 const string MovableMan::c_ClassName = "MovableMan";
 
+thread_local std::vector<std::function<void()>> *MovableMan::s_DeferredTravelCommands = nullptr;
+
 
 // Comparison functor for sorting movable objects by their X position using STL's sort
 struct MOXPosComparison {
@@ -58,10 +65,15 @@ void MovableMan::Clear()
     m_SortTeamRoster[Activity::TeamTwo] = false;
     m_SortTeamRoster[Activity::TeamThree] = false;
     m_SortTeamRoster[Activity::TeamFour] = false;
-    m_ValiditySearchResults.clear();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
+    m_ActorGrid.Reset();
+    m_ActorGridDirty = true;
+    m_ActorGridQueryResults.clear();
+    m_ActorQueryResults.clear();
+    m_KeptActorQueryResults.clear();
+    m_KeptActorQueryResultCount = 0;
     m_SplashRatio = 0.75;
     m_MaxDroppedItems = 25;
     m_SloMoTimer.Reset();
@@ -69,6 +81,10 @@ void MovableMan::Clear()
     m_SloMoDuration = 1000;
     m_SettlingEnabled = true;
     m_MOSubtractionEnabled = true;
+    m_ParallelParticleTravel = false;
+    m_PixelParticleStoreEnabled = false;
+    m_PixelParticles.Reset();
+    m_PixelParticlePromotionPending = false;
 }
 
 
@@ -179,8 +195,43 @@ MovableObject * MovableMan::GetMOFromID(MOID whichID) {
 
 void MovableMan::RegisterObject(MovableObject * mo) 
 { 
-	if (mo) 
-		m_KnownObjects[mo->GetUniqueID()] = mo; 
+	if (!mo)
+		return;
+
+	m_KnownObjects[mo->GetUniqueID()] = mo;
+
+	// Objects that get created again keep their slot, only their unique ID changes
+	auto slotIndex = m_KnownObjectSlotIndices.find(mo);
+	if (slotIndex != m_KnownObjectSlotIndices.end())
+	{
+		KnownObjectSlot &slot = m_KnownObjectSlots[slotIndex->second];
+		if (slot.UniqueID != mo->GetUniqueID())
+		{
+			auto staleEntry = m_KnownObjects.find(slot.UniqueID);
+			if (staleEntry != m_KnownObjects.end() && staleEntry->second == mo)
+				m_KnownObjects.erase(staleEntry);
+			slot.UniqueID = mo->GetUniqueID();
+		}
+		return;
+	}
+
+	unsigned int slotIndexToUse;
+	if (!m_FreeKnownObjectSlots.empty())
+	{
+		slotIndexToUse = m_FreeKnownObjectSlots.back();
+		m_FreeKnownObjectSlots.pop_back();
+	}
+	else
+	{
+		slotIndexToUse = m_KnownObjectSlots.size();
+		// Generations start at 1 so a default constructed MOHandle never resolves
+		m_KnownObjectSlots.push_back({ nullptr, 0, 1, NotInSimulation });
+	}
+	KnownObjectSlot &slot = m_KnownObjectSlots[slotIndexToUse];
+	slot.Object = mo;
+	slot.UniqueID = mo->GetUniqueID();
+	slot.List = NotInSimulation;
+	m_KnownObjectSlotIndices[mo] = slotIndexToUse;
 }
 
 
@@ -197,7 +248,100 @@ void MovableMan::UnregisterObject(MovableObject * mo)
 	{
 		m_KnownObjects.erase(mo->GetUniqueID());
 		//g_ConsoleMan.PrintString(std::to_string(mo->GetUniqueID()));
+
+		auto slotIndex = m_KnownObjectSlotIndices.find(mo);
+		if (slotIndex != m_KnownObjectSlotIndices.end())
+		{
+			KnownObjectSlot &slot = m_KnownObjectSlots[slotIndex->second];
+			// Bumping the generation invalidates every handle to this slot's previous occupant
+			slot.Object = nullptr;
+			slot.UniqueID = 0;
+			++slot.Generation;
+			slot.List = NotInSimulation;
+			m_FreeKnownObjectSlots.push_back(slotIndex->second);
+			m_KnownObjectSlotIndices.erase(slotIndex);
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a generation-tagged handle to a registered object.
+
+MovableMan::MOHandle MovableMan::GetMOHandle(const MovableObject *mo) const
+{
+	MOHandle handle;
+	auto slotIndex = m_KnownObjectSlotIndices.find(mo);
+	if (slotIndex != m_KnownObjectSlotIndices.end())
+	{
+		handle.Slot = slotIndex->second;
+		handle.Generation = m_KnownObjectSlots[slotIndex->second].Generation;
 	}
+	return handle;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetMOList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records which MO list a registered object was just put in or taken out
+//                  of.
+
+void MovableMan::SetMOList(MovableObject *mo, MOListType list)
+{
+	auto slotIndex = m_KnownObjectSlotIndices.find(mo);
+	if (slotIndex == m_KnownObjectSlotIndices.end())
+	{
+		if (list == NotInSimulation)
+			return;
+		// Anything in a list needs a slot or it won't count as valid, so give one to objects that somehow lost theirs instead of leaving them untracked
+		RegisterObject(mo);
+		slotIndex = m_KnownObjectSlotIndices.find(mo);
+	}
+	m_KnownObjectSlots[slotIndex->second].List = list;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets which MO list an object is kept in, in constant time.
+
+MovableMan::MOListType MovableMan::GetMOList(const MovableObject *mo) const
+{
+	if (!mo)
+		return NotInSimulation;
+
+	auto slotIndex = m_KnownObjectSlotIndices.find(mo);
+	if (slotIndex == m_KnownObjectSlotIndices.end())
+		return NotInSimulation;
+
+	MOListType list = m_KnownObjectSlots[slotIndex->second].List;
+#ifdef DEBUG_BUILD
+	// Only registered objects are cross-checked, since deleted ones can still sit in a list until the end of the delete pass.
+	RTEAssert(list == FindMOListLinear(mo), "MovableMan's known object registry is out of sync with its MO lists!");
+#endif
+	return list;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindMOListLinear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds which MO list an object is kept in by searching through all of
+//                  them.
+
+MovableMan::MOListType MovableMan::FindMOListLinear(const MovableObject *mo) const
+{
+	if (std::find(m_Actors.begin(), m_Actors.end(), mo) != m_Actors.end() || std::find(m_AddedActors.begin(), m_AddedActors.end(), mo) != m_AddedActors.end())
+		return ActorList;
+	if (std::find(m_Items.begin(), m_Items.end(), mo) != m_Items.end() || std::find(m_AddedItems.begin(), m_AddedItems.end(), mo) != m_AddedItems.end())
+		return ItemList;
+	if (std::find(m_Particles.begin(), m_Particles.end(), mo) != m_Particles.end() || std::find(m_AddedParticles.begin(), m_AddedParticles.end(), mo) != m_AddedParticles.end())
+		return ParticleList;
+	return NotInSimulation;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -221,6 +365,8 @@ void MovableMan::PurgeAllMOs()
     m_AddedActors.clear();
     m_AddedItems.clear();
     m_AddedParticles.clear();
+    m_PixelParticles.Reset();
+    m_PixelParticlePromotionPending = false;
     m_ActorRoster[Activity::TeamOne].clear();
     m_ActorRoster[Activity::TeamTwo].clear();
     m_ActorRoster[Activity::TeamThree].clear();
@@ -229,16 +375,20 @@ void MovableMan::PurgeAllMOs()
     m_SortTeamRoster[Activity::TeamTwo] = false;
     m_SortTeamRoster[Activity::TeamThree] = false;
     m_SortTeamRoster[Activity::TeamFour] = false;
-    m_ValiditySearchResults.clear();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
+    m_ActorGrid.ClearObjects();
+    m_ActorGridDirty = true;
 
     // Set the time limit to 0 so it will report as being past it from the start of simulation
     m_SloMoTimer.SetRealTimeLimitMS(0);
     m_SloMoTimer.SetSimTimeLimitMS(0);
 
-	m_KnownObjects.clear();
+	// Deleting the objects above unregistered them, so whatever is still registered is alive but not in any list anymore, like the objects placed in a Scene that's being loaded.
+	// Those keep their slots so they're still valid once they get added again.
+	for (KnownObjectSlot &slot : m_KnownObjectSlots)
+		slot.List = NotInSimulation;
 }
 
 
@@ -542,6 +692,41 @@ Actor * MovableMan::GetClosestTeamActor(int team, int player, const Vector &scen
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
 
+    if (UseActorGrid())
+    {
+        // The grid only has the main actor list, while the team rosters also have this frame's added actors, so check those separately
+        if (team != Activity::NoTeam)
+        {
+            for (deque<Actor *>::iterator aIt = m_AddedActors.begin(); aIt != m_AddedActors.end(); ++aIt)
+            {
+                if ((*aIt) == pExcludeThis || (*aIt)->GetTeam() != team || (player != NoPlayer && ((*aIt)->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(*aIt, player)))))
+                    continue;
+
+                distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
+                distance = distanceVec.GetMagnitude();
+                if (distance < shortestDistance)
+                {
+                    shortestDistance = distance;
+                    pClosestActor = *aIt;
+                    getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
+                }
+            }
+        }
+        auto teamActorFilter = [team, player, pActivity, pExcludeThis](const MovableObject *candidate) {
+            if (candidate == pExcludeThis || candidate->GetTeam() != team)
+                return false;
+            Actor *candidateActor = const_cast<Actor *>(static_cast<const Actor *>(candidate));
+            return team == Activity::NoTeam || player == NoPlayer || !(candidateActor->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(candidateActor, player)));
+        };
+        if (Actor *pGridActor = static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, shortestDistance, teamActorFilter, distanceVec)))
+        {
+            pClosestActor = pGridActor;
+            if (team != Activity::NoTeam)
+                getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
+        }
+        return pClosestActor;
+    }
+
     // If we're looking for a noteam actor, then go through the entire actor list instead
     if (team == Activity::NoTeam)
     {
@@ -603,6 +788,9 @@ Actor * MovableMan::GetClosestEnemyActor(int team, const Vector &scenePoint, int
     float distance;
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
+
+    if (UseActorGrid())
+        return static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, shortestDistance, [team](const MovableObject *candidate) { return candidate->GetTeam() != team; }, getDistance));
     
     for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
     {
@@ -643,6 +831,9 @@ Actor * MovableMan::GetClosestActor(const Vector &scenePoint, int maxRadius, Vec
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
 
+    if (UseActorGrid())
+        return static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, shortestDistance, [pExcludeThis](const MovableObject *candidate) { return candidate != pExcludeThis; }, getDistance));
+
     for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
     {
         if ((*aIt) == pExcludeThis)
@@ -664,6 +855,118 @@ Actor * MovableMan::GetClosestActor(const Vector &scenePoint, int maxRadius, Vec
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are within a radius of
+//                  a scene point, optionally filtered by team.
+
+const std::vector<Actor *> & MovableMan::GetActorsInRadius(int team, bool getEnemies, const Vector &scenePoint, float radius)
+{
+    m_ActorQueryResults.clear();
+
+    auto teamFilter = [team, getEnemies](const MovableObject *candidate) { return team == Activity::NoTeam || ((candidate->GetTeam() == team) != getEnemies); };
+
+    if (UseActorGrid())
+    {
+        m_ActorGridQueryResults.clear();
+        m_ActorGrid.GetObjectsInRadius(scenePoint, radius, teamFilter, m_ActorGridQueryResults);
+        for (MovableObject *pFoundActor : m_ActorGridQueryResults)
+            m_ActorQueryResults.push_back(static_cast<Actor *>(pFoundActor));
+        return m_ActorQueryResults;
+    }
+
+    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+    {
+        if (teamFilter(*aIt) && g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint).GetMagnitude() <= radius)
+            m_ActorQueryResults.push_back(*aIt);
+    }
+    return m_ActorQueryResults;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are within a box,
+//                  taking scene wrapping into account.
+
+const std::vector<Actor *> & MovableMan::GetActorsInBox(const Box &box)
+{
+    m_ActorQueryResults.clear();
+
+    if (UseActorGrid())
+    {
+        m_ActorGridQueryResults.clear();
+        m_ActorGrid.GetObjectsInBox(box, nullptr, m_ActorGridQueryResults);
+        for (MovableObject *pFoundActor : m_ActorGridQueryResults)
+            m_ActorQueryResults.push_back(static_cast<Actor *>(pFoundActor));
+        return m_ActorQueryResults;
+    }
+
+    list<Box> wrappedBoxes;
+    g_SceneMan.WrapBox(box, wrappedBoxes);
+    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+    {
+        for (const Box &wrappedBox : wrappedBoxes)
+        {
+            if (wrappedBox.IsWithinBox((*aIt)->GetPos()))
+            {
+                m_ActorQueryResults.push_back(*aIt);
+                break;
+            }
+        }
+    }
+    return m_ActorQueryResults;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          KeepActorQueryResults
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies the results of the last actor query into a list of their own
+//                  that stays valid until the next MovableMan update.
+
+const std::vector<Actor *> & MovableMan::KeepActorQueryResults()
+{
+    if (m_KeptActorQueryResultCount == m_KeptActorQueryResults.size())
+        m_KeptActorQueryResults.emplace_back();
+
+    std::vector<Actor *> &keptResults = m_KeptActorQueryResults[m_KeptActorQueryResultCount++];
+    keptResults.assign(m_ActorQueryResults.begin(), m_ActorQueryResults.end());
+    return keptResults;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UseActorGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets whether actor queries should be answered from m_ActorGrid, and
+//                  rebuilds it first if it's out of date.
+
+bool MovableMan::UseActorGrid()
+{
+    const Scene *pScene = g_SceneMan.GetScene();
+    if (!pScene || static_cast<int>(m_Actors.size()) < c_ActorGridMinActorCount)
+        return false;
+
+    if (m_ActorGridDirty)
+    {
+        int sceneWidth = g_SceneMan.GetSceneWidth();
+        int sceneHeight = g_SceneMan.GetSceneHeight();
+        if (!m_ActorGrid.MatchesDimensions(sceneWidth, sceneHeight, g_SceneMan.SceneWrapsX(), g_SceneMan.SceneWrapsY()))
+            m_ActorGrid.Create(sceneWidth, sceneHeight, c_ActorGridCellSize, g_SceneMan.SceneWrapsX(), g_SceneMan.SceneWrapsY());
+        else
+            m_ActorGrid.ClearObjects();
+
+        for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+            m_ActorGrid.Add(*aIt);
+        m_ActorGridDirty = false;
+    }
+    return true;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetClosestBrainActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -838,6 +1141,7 @@ void MovableMan::AddActor(Actor *pActorToAdd)
             pActorToAdd->SetAge(0);
         }
         m_AddedActors.push_back(pActorToAdd);
+        SetMOList(pActorToAdd, ActorList);
 
 		AddActorToTeamRoster(pActorToAdd);
     }
@@ -877,6 +1181,7 @@ void MovableMan::AddItem(MovableObject *pItemToAdd)
             pItemToAdd->SetAge(0);
         }
         m_AddedItems.push_back(pItemToAdd);
+        SetMOList(pItemToAdd, ItemList);
     }
 }
 
@@ -890,6 +1195,11 @@ void MovableMan::AddItem(MovableObject *pItemToAdd)
 
 void MovableMan::AddParticle(MovableObject *pMOToAdd)
 {
+    if (pMOToAdd && IsDeferringTravelCommands())
+    {
+        DeferTravelCommand([this, pMOToAdd]() { AddParticle(pMOToAdd); });
+        return;
+    }
     if (pMOToAdd)
     {
 //        pMOToAdd->SetPrevPos(pMOToAdd->GetPos());
@@ -912,13 +1222,44 @@ void MovableMan::AddParticle(MovableObject *pMOToAdd)
             pMOToAdd->SetAge(0);
         }
         if (pMOToAdd->IsDevice())
+        {
             m_AddedItems.push_back(pMOToAdd);
+            SetMOList(pMOToAdd, ItemList);
+        }
         else
+        {
             m_AddedParticles.push_back(pMOToAdd);
+            SetMOList(pMOToAdd, ParticleList);
+        }
     }
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnablePixelParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether simple MOPixels are moved into the pixel particle store.
+
+void MovableMan::EnablePixelParticleStore(bool enable)
+{
+    m_PixelParticleStoreEnabled = enable;
+    if (!m_PixelParticleStoreEnabled)
+        PromotePixelParticles();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PromotePixelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Turns every pixel in the pixel particle store back into a full MOPixel
+//                  and adds it to the particle list.
+
+void MovableMan::PromotePixelParticles()
+{
+    m_PixelParticlePromotionPending = true;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RemoveActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -937,6 +1278,7 @@ bool MovableMan::RemoveActor(MovableObject *pActorToRem)
             if (*itr == pActorToRem)
             {
                 m_Actors.erase(itr);
+                m_ActorGridDirty = true;
                 removed = true;
                 break;
             }
@@ -955,6 +1297,8 @@ bool MovableMan::RemoveActor(MovableObject *pActorToRem)
             }
         }
 		RemoveActorFromTeamRoster(dynamic_cast<Actor *>(pActorToRem));
+        if (removed)
+            SetMOList(pActorToRem, NotInSimulation);
     }
     return removed;
 }
@@ -995,6 +1339,8 @@ bool MovableMan::RemoveItem(MovableObject *pItemToRem)
                 }
             }
         }
+        if (removed)
+            SetMOList(pItemToRem, NotInSimulation);
     }
     return removed;
 }
@@ -1097,6 +1443,8 @@ bool MovableMan::RemoveParticle(MovableObject *pMOToRem)
                 }
             }
         }
+        if (removed)
+            SetMOList(pMOToRem, NotInSimulation);
     }
     return removed;
 }
@@ -1128,36 +1476,11 @@ bool MovableMan::ValidateMOIDs()
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Indicates whether the passed in MovableObject pointer points to an
 //                  MO that's currently active in the simulation, and kept by this
-//                  MovableMan. Internal optimization is made so that the same MO can
-//                  efficiently be checked many times during the same frame.
+//                  MovableMan.
 
 bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
 {
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-
-        // See if this MO has been found earlier this frame
-        for (deque<pair <const MovableObject *, bool> >::iterator itr = m_ValiditySearchResults.begin(); !found && itr != m_ValiditySearchResults.end(); ++itr)
-        {
-            // If the MO is found to have been searched for earlier this frame, then just return the search results
-            if (itr->first == pMOToCheck)
-                return itr->second;
-        }
-
-        // Check actors
-        found = found ? true : IsActor(pMOToCheck);
-        // Check Items
-        found = found ? true : IsDevice(pMOToCheck);
-        // Check particles
-        found = found ? true : IsParticle(pMOToCheck);
-
-        // Save search result for future requests this frame
-        m_ValiditySearchResults.push_back(pair<const MovableObject *, bool>(pMOToCheck, found));
-    }
-
-    return found;
+    return GetMOList(pMOToCheck) != NotInSimulation;
 }
 
 
@@ -1169,32 +1492,7 @@ bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsActor(const MovableObject *pMOToCheck)
 {
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<Actor *>::iterator itr = m_Actors.begin(); !found && itr != m_Actors.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the actors just added this frame
-        if (!found)
-        {
-            for (deque<Actor *>::iterator itr = m_AddedActors.begin(); !found && itr != m_AddedActors.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    return GetMOList(pMOToCheck) == ActorList;
 }
 
 
@@ -1206,32 +1504,7 @@ bool MovableMan::IsActor(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsDevice(const MovableObject *pMOToCheck)
 {
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Items.begin(); !found && itr != m_Items.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedItems.begin(); !found && itr != m_AddedItems.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    return GetMOList(pMOToCheck) == ItemList;
 }
 
 
@@ -1243,32 +1516,7 @@ bool MovableMan::IsDevice(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsParticle(const MovableObject *pMOToCheck)
 {
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Particles.begin(); !found && itr != m_Particles.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedParticles.begin(); !found && itr != m_AddedParticles.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    return GetMOList(pMOToCheck) == ParticleList;
 }
 
 
@@ -1418,6 +1666,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         if ((onlyTeam == Activity::NoTeam || (*aIt)->GetTeam() == onlyTeam) && (!noBrains || !(*aIt)->HasObjectInGroup("Brains")))
         {
             actorList.push_back((*aIt));
+            SetMOList(*aIt, NotInSimulation);
             addedCount++;
         }
         else
@@ -1425,6 +1674,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
     }
     // Clear the internal Actor list; we transferred the ownership of them
     m_Actors.clear();
+    m_ActorGridDirty = true;
 
     // Add all Actors added this frame
     for (deque<Actor *>::iterator aIt = m_AddedActors.begin(); aIt != m_AddedActors.end(); ++aIt)
@@ -1433,6 +1683,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         if ((onlyTeam == Activity::NoTeam || (*aIt)->GetTeam() == onlyTeam) && (!noBrains || !(*aIt)->HasObjectInGroup("Brains")))
         {
             actorList.push_back((*aIt));
+            SetMOList(*aIt, NotInSimulation);
             addedCount++;
         }
         else
@@ -1463,6 +1714,7 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        SetMOList(*iIt, NotInSimulation);
         addedCount++;
     }
     // Clear the internal Actor list; we transferred the ownership of them
@@ -1472,6 +1724,7 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_AddedItems.begin(); iIt != m_AddedItems.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        SetMOList(*iIt, NotInSimulation);
         addedCount++;
     }
     // Clear the internal Item list; we transferred the ownership of them
@@ -1617,6 +1870,112 @@ void MovableMan::OnPieMenu(Actor * pActor)
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CanTravelInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a particle's travel only touches state that can be
+//                  deferred, so it can be traveled on a worker thread.
+
+bool MovableMan::CanTravelInParallel(const MovableObject *particle) const
+{
+    if (particle->HitsMOs() || particle->GetsHitByMOs())
+        return false;
+
+    return dynamic_cast<const MOPixel *>(particle) || dynamic_cast<const MOSParticle *>(particle);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Travels all the particles for this sim update, in parallel where
+//                  possible.
+
+void MovableMan::TravelParticles()
+{
+    std::vector<MovableObject *> parallelParticles;
+    std::vector<MovableObject *> serialParticles;
+
+    if (m_ParallelParticleTravel)
+    {
+        parallelParticles.reserve(m_Particles.size());
+        for (MovableObject *particle : m_Particles)
+        {
+            if (!particle->IsUpdated())
+            {
+                if (CanTravelInParallel(particle))
+                    parallelParticles.push_back(particle);
+                else
+                    serialParticles.push_back(particle);
+            }
+        }
+    }
+    else
+    {
+        serialParticles.reserve(m_Particles.size());
+        for (MovableObject *particle : m_Particles)
+        {
+            if (!particle->IsUpdated())
+                serialParticles.push_back(particle);
+        }
+    }
+
+    // The parallel set travels and has its side effects merged before any serial particle moves, so turning this on changes the update order, not just the threading.
+    if (!parallelParticles.empty())
+    {
+        TravelInParallel(static_cast<int>(parallelParticles.size()), [&parallelParticles](int chunkStart, int chunkEnd) {
+            for (int particleIndex = chunkStart; particleIndex < chunkEnd; ++particleIndex)
+            {
+                MovableObject *particle = parallelParticles[particleIndex];
+                particle->ApplyForces();
+                particle->PreTravel();
+                particle->Travel();
+                particle->PostTravel();
+            }
+        });
+    }
+
+    for (MovableObject *particle : serialParticles)
+    {
+        particle->ApplyForces();
+        particle->PreTravel();
+        particle->Travel();
+        particle->PostTravel();
+    }
+
+    for (MovableObject *particle : m_Particles)
+        particle->NewFrame();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Splits a range of things to travel into fixed size chunks on the
+//                  ThreadMan workers and merges their deferred commands in chunk order.
+
+void MovableMan::TravelInParallel(int count, const std::function<void(int chunkStart, int chunkEnd)> &travelChunk)
+{
+    std::vector<std::vector<std::function<void()>>> chunkCommands(g_ThreadMan.GetParallelForChunkCount(0, count, c_ParallelTravelChunkSize));
+    // Each chunk is its own Job with its own random stream picked by its index, so the results only depend on the travel order and not on which thread ran what, or how many threads there are.
+    // Without workers the chunks just run one after another on this thread while it waits, which keeps the results the same as with them.
+    g_ThreadMan.Wait(g_ThreadMan.ParallelFor(0, count, c_ParallelTravelChunkSize, [&travelChunk, &chunkCommands](int chunkStart, int chunkEnd, int chunkIndex) {
+        s_DeferredTravelCommands = &chunkCommands[chunkIndex];
+
+        travelChunk(chunkStart, chunkEnd);
+
+        s_DeferredTravelCommands = nullptr;
+    }));
+
+    // Chunks are contiguous ranges, so applying them in chunk order makes the merge order depend only on the travel order.
+    for (std::vector<std::function<void()>> &commands : chunkCommands)
+    {
+        for (const std::function<void()> &command : commands)
+            command();
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1624,6 +1983,9 @@ void MovableMan::OnPieMenu(Actor * pActor)
 
 void MovableMan::Update()
 {
+    // Lua is done with whatever actor query results it was given last update
+    m_KeptActorQueryResultCount = 0;
+
     // Don't update if paused
     if (g_ActivityMan.GetActivity() && g_ActivityMan.ActivityPaused())
         return;
@@ -1643,8 +2005,6 @@ void MovableMan::Update()
     m_SortTeamRoster[Activity::TeamTwo] = false;
     m_SortTeamRoster[Activity::TeamThree] = false;
     m_SortTeamRoster[Activity::TeamFour] = false;
-    // Clear out MO finding optimization buffer - will be added to each frame as thigns are searched for as curently exisitng in the manager
-    m_ValiditySearchResults.clear();
 
     // Move all last frame's alarm events into the proper buffer, and clear out the new one to fill up with this frame's
     m_AlarmEvents.clear();
@@ -1709,17 +2069,31 @@ void MovableMan::Update()
 
         // Travel particles
 		g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ParticlesTravel);
+        TravelParticles();
+
+        // Travel the pixel particle store, which also does its rest detection since its pixels have nothing else to update
+        if (m_PixelParticles.GetCount() > 0)
         {
-            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
+            if (m_ParallelParticleTravel)
             {
-                if (!((*parIt)->IsUpdated()))
-                {
-                    (*parIt)->ApplyForces();
-                    (*parIt)->PreTravel();
-                    (*parIt)->Travel();
-                    (*parIt)->PostTravel();
-                }
-                (*parIt)->NewFrame();
+                // The MOID broadphase draws MO footprints the first time they're queried, which isn't thread safe, so with it on the pixels that hit MOs travel on this thread afterwards
+                bool serialMOHitters = g_SettingsMan.UseMOIDBroadphase();
+                PixelParticleStore::TravelSet parallelSet = serialMOHitters ? PixelParticleStore::TravelSet::NotHittingMOs : PixelParticleStore::TravelSet::All;
+                TravelInParallel(m_PixelParticles.GetCount(), [this, parallelSet](int chunkStart, int chunkEnd) { m_PixelParticles.Travel(chunkStart, chunkEnd, parallelSet); });
+                if (serialMOHitters)
+                    m_PixelParticles.Travel(0, m_PixelParticles.GetCount(), PixelParticleStore::TravelSet::HittingMOs);
+            }
+            else
+                m_PixelParticles.Travel(0, m_PixelParticles.GetCount());
+
+            // Pixels that ran into an MO become full MOPixels again so they can collide with it on their next travel
+            std::vector<MOPixel *> promotedPixels;
+            m_PixelParticles.PromoteMOHits(promotedPixels);
+            for (MOPixel *pixel : promotedPixels)
+            {
+                pixel->SetAsAddedToMovableMan();
+                m_Particles.push_back(pixel);
+                SetMOList(pixel, ParticleList);
             }
         }
 		g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ParticlesTravel);
@@ -1733,6 +2107,9 @@ void MovableMan::Update()
     {
         g_SceneMan.LockScene();
 
+        // Everything has moved, so the actor grid gets rebuilt on the first query of the update pass
+        m_ActorGridDirty = true;
+
         // Actors
 		g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ActorsUpdate);
         {
@@ -1745,6 +2122,10 @@ void MovableMan::Update()
         }
 		g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ActorsUpdate);
 
+        // Hand the paths the Actors asked for this update over to the pathfinding workers, and pick up the ones they finished since last update
+        if (g_SceneMan.GetScene())
+            g_SceneMan.GetScene()->UpdatePathRequests();
+
         // Items
         {
             int count = 0;
@@ -1752,7 +2133,7 @@ void MovableMan::Update()
             for (iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt, ++count)
             {
                 (*iIt)->Update();
-                (*iIt)->UpdateScripts();
+                (*iIt)->UpdateScriptsWithinBudget();
                 (*iIt)->ApplyImpulses();
                 if (count <= itemLimit)
                 {
@@ -1767,7 +2148,7 @@ void MovableMan::Update()
             for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
             {
                 (*parIt)->Update();
-                (*parIt)->UpdateScripts();
+                (*parIt)->UpdateScriptsWithinBudget();
                 (*parIt)->ApplyImpulses();
                 (*parIt)->RestDetection();
                 // Copy particles that are at rest to the terrain and mark them for deletion.
@@ -1807,7 +2188,10 @@ void MovableMan::Update()
         {
             // Delete instead if it's marked for it
             if (!(*aIt)->IsSetToDelete())
+            {
                 m_Actors.push_back(*aIt);
+                m_ActorGridDirty = true;
+            }
             else
 			{
 				// Also remove actor from the roster
@@ -1834,12 +2218,34 @@ void MovableMan::Update()
         for (parIt = m_AddedParticles.begin(); parIt != m_AddedParticles.end(); ++parIt)
         {
             // Delete instead if it's marked for it
-            if (!(*parIt)->IsSetToDelete())
-                m_Particles.push_back(*parIt);
-            else
+            if ((*parIt)->IsSetToDelete())
                 delete (*parIt);
+            // Simple pixels are copied into the pixel particle store and the full object is dropped
+            else if (m_PixelParticleStoreEnabled && PixelParticleStore::IsEligible(*parIt))
+            {
+                m_PixelParticles.Add(*static_cast<MOPixel *>(*parIt));
+                delete (*parIt);
+            }
+            else
+                m_Particles.push_back(*parIt);
         }
         m_AddedParticles.clear();
+
+        // Pixels are only promoted here, because being asked to from a script can happen while the particle list is being iterated over
+        if (m_PixelParticlePromotionPending)
+        {
+            std::vector<MOPixel *> promotedPixels;
+            m_PixelParticles.PromoteAll(promotedPixels);
+
+            // Straight into the particle list rather than through AddParticle, which would reset their age and rest timers.
+            for (MOPixel *pixel : promotedPixels)
+            {
+                pixel->SetAsAddedToMovableMan();
+                m_Particles.push_back(pixel);
+                SetMOList(pixel, ParticleList);
+            }
+            m_PixelParticlePromotionPending = false;
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -1864,6 +2270,7 @@ void MovableMan::Update()
 
                 // Add to the particles list
                 m_Particles.push_back(*aIt);
+                SetMOList(*aIt, ParticleList);
                 // Remove from the team roster
 
                 if ((*aIt)->GetTeam() >= 0)
@@ -1874,6 +2281,7 @@ void MovableMan::Update()
             // Try to set the existing iterator to a safer value, erase can crash in debug mode otherwise?
             aIt = m_Actors.begin();
             m_Actors.erase(amidIt, m_Actors.end());
+            m_ActorGridDirty = true;
         }
 
         // ITEM SETTLE //////////////////////////////////////////////////////////
@@ -1890,6 +2298,7 @@ void MovableMan::Update()
 				// Disable TDExplosive's immunity to settling
 				if ((*iIt)->GetRestThreshold()< 0)
 					(*iIt)->SetRestThreshold(500);
+                SetMOList(*iIt, ParticleList);
                 m_Particles.push_back(*(iIt++));
             }
             m_Items.erase(imidIt, m_Items.end());
@@ -1924,6 +2333,8 @@ void MovableMan::Update()
         }
         // Try to set the existing iterator to a safer value, erase can crash in debug mode otherwise?
         aIt = m_Actors.begin();
+        if (amidIt != m_Actors.end())
+            m_ActorGridDirty = true;
         m_Actors.erase(amidIt, m_Actors.end());
 
         // Items
@@ -1969,6 +2380,7 @@ void MovableMan::Update()
 		}
 		m_Particles.erase(midIt, m_Particles.end());
 	}
+    m_PixelParticles.SettleAndRemoveDead(m_SettlingEnabled);
 
     release_bitmap(g_SceneMan.GetTerrain()->GetMaterialBitmap());
 
@@ -2033,6 +2445,8 @@ void MovableMan::DrawMatter(BITMAP *pTargetBitmap, Vector &targetPos)
 
     for (deque<MovableObject *>::iterator parIt = --m_Particles.end(); parIt != --m_Particles.begin(); --parIt)
         (*parIt)->Draw(pTargetBitmap, targetPos, g_DrawMaterial);
+
+    m_PixelParticles.Draw(pTargetBitmap, targetPos, true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2091,13 +2505,18 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
 
     MOID currentMOID = 1;
     int i = 0;
+    // With the broadphase the MOs are only registered here, and drawn later if anything actually checks for them
+    bool useMOIDBroadphase = g_SettingsMan.UseMOIDBroadphase();
 
     for (i = 0; i < aCount; ++i) {
 		if (m_Actors[i]->GetsHitByMOs() && !m_Actors[i]->IsSetToDelete())
         {
 			Vector notUsed;
             m_Actors[i]->UpdateMOID(m_MOIDIndex);
-            m_Actors[i]->Draw(pTargetBitmap, notUsed, g_DrawMOID, true);
+            if (useMOIDBroadphase)
+                g_SceneMan.DrawMOIDRepresentation(m_Actors[i]);
+            else
+                m_Actors[i]->Draw(pTargetBitmap, notUsed, g_DrawMOID, true);
             currentMOID = m_MOIDIndex.size();
         }
         else
@@ -2108,7 +2527,10 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
         if (m_Items[i]->GetsHitByMOs() && !m_Items[i]->IsSetToDelete())
         {
             m_Items[i]->UpdateMOID(m_MOIDIndex);
-            m_Items[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
+            if (useMOIDBroadphase)
+                g_SceneMan.DrawMOIDRepresentation(m_Items[i]);
+            else
+                m_Items[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
             currentMOID = m_MOIDIndex.size();
         }
         else
@@ -2119,7 +2541,10 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
         if (m_Particles[i]->GetsHitByMOs() && !m_Particles[i]->IsSetToDelete())
         {
             m_Particles[i]->UpdateMOID(m_MOIDIndex);
-            m_Particles[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
+            if (useMOIDBroadphase)
+                g_SceneMan.DrawMOIDRepresentation(m_Particles[i]);
+            else
+                m_Particles[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
             currentMOID = m_MOIDIndex.size();
         }
         else
@@ -2136,15 +2561,31 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
 
 void MovableMan::Draw(BITMAP *pTargetBitmap, const Vector &targetPos)
 {
+    // When replicating entities to network clients, the MOs they can draw themselves are captured instead of drawn into the MO color layer the frames are made from
+    bool replicateEntities = g_NetworkServer.IsServerModeEnabled() && g_NetworkServer.UsesEntityReplication() && pTargetBitmap == g_SceneMan.GetMOColorBitmap();
+    if (replicateEntities)
+        g_NetworkServer.BeginEntitySnapshot();
+
     // Draw objects to accumulation bitmap, in reverse order so actors appear on top.
+    m_PixelParticles.Draw(pTargetBitmap, targetPos);
+
     for (deque<MovableObject *>::iterator parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
-        (*parIt)->Draw(pTargetBitmap, targetPos);
+    {
+        if (!replicateEntities || !g_NetworkServer.AddReplicatedEntity(*parIt))
+            (*parIt)->Draw(pTargetBitmap, targetPos);
+    }
 
 	for (deque<MovableObject *>::reverse_iterator itmIt = m_Items.rbegin(); itmIt != m_Items.rend(); ++itmIt)
-        (*itmIt)->Draw(pTargetBitmap, targetPos);
+    {
+        if (!replicateEntities || !g_NetworkServer.AddReplicatedEntity(*itmIt))
+            (*itmIt)->Draw(pTargetBitmap, targetPos);
+    }
 
     for (deque<Actor *>::reverse_iterator aIt = m_Actors.rbegin(); aIt != m_Actors.rend(); ++aIt)
         (*aIt)->Draw(pTargetBitmap, targetPos);
+
+    if (replicateEntities)
+        g_NetworkServer.EndEntitySnapshot();
 }
 
 
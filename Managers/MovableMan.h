@@ -20,6 +20,8 @@
 #include "SceneMan.h"
 #include "LuaMan.h"
 #include "Singleton.h"
+#include "PixelParticleStore.h"
+#include "SpatialPartitionGrid.h"
 
 #define g_MovableMan MovableMan::Instance()
 
@@ -71,6 +73,14 @@ class MovableMan : public Singleton<MovableMan>, public Serializable {
 
 public:
 
+    // Generation-tagged reference to a registered MO. Resolves to nothing once the MO is destroyed, even if its address gets reused.
+    struct MOHandle
+    {
+        unsigned int Slot = 0;
+        unsigned int Generation = 0;
+    };
+
+
 	SerializableClassNameGetter;
 	SerializableOverrideMethods;
 
@@ -306,6 +316,72 @@ public:
     Actor * GetClosestActor(const Vector &scenePoint, int maxRadius, Vector &getDistance, const Actor *pExcludeThis = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are within a radius of
+//                  a scene point, taking scene wrapping into account.
+// Arguments:       The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The Actors within the radius. The list is reused by the next actor
+//                  query, so copy it if it needs to be kept. OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<Actor *> & GetActorsInRadius(const Vector &scenePoint, float radius) { return GetActorsInRadius(Activity::NoTeam, false, scenePoint, radius); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetTeamActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list of a specific team that are
+//                  within a radius of a scene point, taking scene wrapping into account.
+// Arguments:       Which team to get Actors of.
+//                  The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The team's Actors within the radius. The list is reused by the next
+//                  actor query. OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<Actor *> & GetTeamActorsInRadius(int team, const Vector &scenePoint, float radius) { return GetActorsInRadius(team, false, scenePoint, radius); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetEnemyActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are not of a specific
+//                  team and are within a radius of a scene point, taking scene wrapping
+//                  into account.
+// Arguments:       Which team to get enemy Actors of.
+//                  The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The enemy Actors within the radius. The list is reused by the next
+//                  actor query. OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<Actor *> & GetEnemyActorsInRadius(int team, const Vector &scenePoint, float radius) { return GetActorsInRadius(team, true, scenePoint, radius); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are within a box,
+//                  taking scene wrapping into account.
+// Arguments:       The Box to search in.
+// Return value:    The Actors within the box. The list is reused by the next actor query,
+//                  so copy it if it needs to be kept. OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<Actor *> & GetActorsInBox(const Box &box);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          KeepActorQueryResults
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies the results of the last actor query into a list of their own
+//                  that stays valid until the next MovableMan update, so Lua can iterate
+//                  over them while making other actor queries.
+// Arguments:       None.
+// Return value:    The copied Actors. OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<Actor *> & KeepActorQueryResults();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetClosestBrainActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -372,11 +448,32 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetParticleCount
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Gets the number of particles (MOPixel:s) currently held.
+// Description:     Gets the number of particles (MOPixel:s) currently held, including
+//                  the ones in the pixel particle store.
 // Arguments:       None.
 // Return value:    The number of particles.
 
-    long GetParticleCount() const { return m_Particles.size(); }
+    long GetParticleCount() const { return m_Particles.size() + m_PixelParticles.GetCount(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of Actors currently held.
+// Arguments:       None.
+// Return value:    The number of Actors.
+
+    long GetActorCount() const { return m_Actors.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of Items (loose devices and the like) currently held.
+// Arguments:       None.
+// Return value:    The number of Items.
+
+    long GetItemCount() const { return m_Items.size(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -558,8 +655,7 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Indicates whether the passed in MovableObject pointer points to an
 //                  MO that's currently active in the simulation, and kept by this
-//                  MovableMan. Internal optimization is made so that the same MO can
-//                  efficiently be checked many times during the same frame.
+//                  MovableMan. Constant time, answered from the known object registry.
 // Arguments:       A pointer to the MovableObject to check for being actively kept by
 //                  this MovableMan.
 // Return value:    Whether the MO instance was found in the active list or not.
@@ -775,6 +871,92 @@ public:
     bool IsMOSubtractionEnabled() { return m_MOSubtractionEnabled; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsParallelParticleTravelEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether particles that are safe to do so are traveled on the
+//                  ThreadMan worker threads, with their side effects deferred.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsParallelParticleTravelEnabled() const { return m_ParallelParticleTravel; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableParallelParticleTravel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether particles that are safe to do so are traveled on the
+//                  ThreadMan worker threads. Switch off to compare against the serial path.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableParallelParticleTravel(bool enable = true) { m_ParallelParticleTravel = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPixelParticleStoreEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether simple MOPixels are moved into the structure-of-arrays
+//                  pixel particle store instead of being kept as full MovableObjects.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsPixelParticleStoreEnabled() const { return m_PixelParticleStoreEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnablePixelParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether simple MOPixels are moved into the pixel particle store.
+//                  Disabling it promotes every pixel in the store back to a full MOPixel
+//                  when added objects are next merged in during Update, so they become
+//                  visible to Lua and everything else again.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnablePixelParticleStore(bool enable = true);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PromotePixelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Turns every pixel in the pixel particle store back into a full MOPixel
+//                  and adds it to the particle list, for when something needs to see or
+//                  script all the particles. This is done when added objects are next
+//                  merged in during Update, since the particle list can be iterated over
+//                  while this is called from scripts.
+// Arguments:       None.
+// Return value:    None.
+
+    void PromotePixelParticles();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   IsDeferringTravelCommands
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the calling thread is traveling particles in parallel.
+//                  While this is true, nothing that touches shared state (terrain, the MO
+//                  lists, Lua) may be done directly, it has to go through
+//                  DeferTravelCommand instead.
+// Arguments:       None.
+// Return value:    Whether travel side effects on this thread need to be deferred.
+
+    static bool IsDeferringTravelCommands() { return s_DeferredTravelCommands != nullptr; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   DeferTravelCommand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records a side effect of a parallel particle travel into the calling
+//                  thread's command buffer. All buffers are applied serially, in particle
+//                  order, once the parallel travel is done. Only valid while
+//                  IsDeferringTravelCommands() is true.
+// Arguments:       The command to apply during the serial merge.
+// Return value:    None.
+
+    static void DeferTravelCommand(std::function<void()> command) { s_DeferredTravelCommands->emplace_back(std::move(command)); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RedrawOverlappingMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -859,7 +1041,9 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RegisterObject
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Registers an object in a global Map collection so it could be found later with FindObjectByUniqueId
+// Description:     Registers an object in the known object registry so it could be found
+//                  later with FindObjectByUniqueId, and gives it a slot in the registry's
+//                  slot map so its validity can be checked in constant time.
 // Arguments:       MO to register.
 // Return value:    None.
 
@@ -869,7 +1053,8 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          UnregisterObject
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Removes an object from the global lookup collection
+// Description:     Removes an object from the known object registry and frees its slot,
+//                  invalidating any MOHandles to it.
 // Arguments:       MO to remove.
 // Return value:    None.
 
@@ -883,7 +1068,29 @@ public:
 // Arguments:       Unique Id to look for.
 // Return value:    Object found or 0 if not found any.
 
-	MovableObject * FindObjectByUniqueID(long int id) { if (m_KnownObjects.count(id) > 0) return m_KnownObjects[id]; else return 0; }
+	MovableObject * FindObjectByUniqueID(long int id) const { auto knownObject = m_KnownObjects.find(id); return knownObject != m_KnownObjects.end() ? knownObject->second : nullptr; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a generation-tagged handle to a registered object. Unlike a raw
+//                  pointer, a handle can never resolve to a different object that later
+//                  got allocated at the same address.
+// Arguments:       The MO to get a handle to.
+// Return value:    A handle to the MO, or an invalid handle if it isn't registered.
+
+	MOHandle GetMOHandle(const MovableObject *mo) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOFromHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resolves a handle from GetMOHandle back to its object, in constant time.
+// Arguments:       The handle to resolve.
+// Return value:    The MO the handle refers to, or 0 if it has since been destroyed.
+
+	MovableObject * GetMOFromHandle(const MOHandle &handle) const { return (handle.Slot < m_KnownObjectSlots.size() && m_KnownObjectSlots[handle.Slot].Generation == handle.Generation) ? m_KnownObjectSlots[handle.Slot].Object : nullptr; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -913,6 +1120,24 @@ public:
 
 protected:
 
+    // Which of the MO lists a registered object is kept in, added ones included
+    enum MOListType
+    {
+        NotInSimulation = 0,
+        ActorList,
+        ItemList,
+        ParticleList
+    };
+
+    // A registered object's entry in the known object slot map
+    struct KnownObjectSlot
+    {
+        MovableObject *Object;
+        unsigned long int UniqueID;
+        unsigned int Generation;
+        MOListType List;
+    };
+
     // All actors in the scene
     std::deque<Actor *> m_Actors;
     // List of items that are pickup-able by actors
@@ -932,10 +1157,6 @@ protected:
 	// Every team's MO footprint
 	int m_TeamMOIDCount[Activity::MaxTeamCount];
 
-    // Optimization implementation
-    // MO's that have already been asked whether they exist in the manager this frame, and the search result.
-    // Gets cleaned out each frame. Does NOT own any instances.
-    std::deque<std::pair<const MovableObject *, bool> > m_ValiditySearchResults;
 
     // The alarm events on the scene where something alarming happened, for use with AI firings awareness os they react to shots fired etc.
     // This is the last frame's events, is the one for Actors to poll for events, should be cleaned out and refilled each frame.
@@ -963,11 +1184,40 @@ protected:
     bool m_SettlingEnabled;
     // Whtehr MO's vcanng et subtracted form the terrain at all
     bool m_MOSubtractionEnabled;
+    // Whether particles that are safe to do so are traveled in parallel on the ThreadMan workers
+    bool m_ParallelParticleTravel;
+    // Whether simple MOPixels are moved into m_PixelParticles when they're added
+    bool m_PixelParticleStoreEnabled;
+    // Structure-of-arrays store of simple MOPixels that only interact with the terrain
+    PixelParticleStore m_PixelParticles;
+    // Whether every pixel in m_PixelParticles should be promoted back to a full MOPixel when added objects are next merged in
+    bool m_PixelParticlePromotionPending;
+
+    // Uniform grid of the Actors in m_Actors, used to answer proximity queries without checking every Actor
+    SpatialPartitionGrid m_ActorGrid;
+    // Whether m_ActorGrid is out of date and needs to be rebuilt before the next query
+    bool m_ActorGridDirty;
+    // Scratch buffers for actor queries, so they don't allocate every call
+    std::vector<MovableObject *> m_ActorGridQueryResults;
+    std::vector<Actor *> m_ActorQueryResults;
+    // Copies of actor query results handed to Lua this update. A deque so handing out another doesn't move the ones still being iterated over
+    std::deque<std::vector<Actor *>> m_KeptActorQueryResults;
+    // How many of m_KeptActorQueryResults are in use this update, the rest are kept around to be reused
+    size_t m_KeptActorQueryResultCount;
+
+    // The command buffer side effects of parallel particle travel are recorded to on the calling thread, or nullptr when not traveling in parallel
+    static thread_local std::vector<std::function<void()>> *s_DeferredTravelCommands;
 
 	unsigned int m_SimUpdateFrameNumber;
 
 	// Global map which stores all objects so they could be foud by their unique ID
-	std::map<long int, MovableObject *> m_KnownObjects;
+	std::unordered_map<long int, MovableObject *> m_KnownObjects;
+	// Slot map of all registered objects, tracking which MO list each one is in so validity checks don't need to search the lists
+	std::vector<KnownObjectSlot> m_KnownObjectSlots;
+	// Slots in m_KnownObjectSlots that were freed by unregistered objects and can be reused
+	std::vector<unsigned int> m_FreeKnownObjectSlots;
+	// The slot of each registered object, by address
+	std::unordered_map<const MovableObject *, unsigned int> m_KnownObjectSlotIndices;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -977,6 +1227,110 @@ private:
 
 	static const std::string c_ClassName; //!< A string with the friendly-formatted type name of this object.
 
+	static constexpr int c_ParallelTravelChunkSize = 256; //!< How many particles each parallel travel Job handles. Fixed so the chunking, and with it the per-chunk random streams, doesn't depend on the number of threads.
+	static constexpr int c_ActorGridCellSize = 128; //!< The preferred size of each m_ActorGrid cell, in pixels. Roughly the size of a large Actor, so most short range queries only touch a handful of cells.
+	static constexpr int c_ActorGridMinActorCount = 128; //!< Below this many Actors a linear scan is faster than rebuilding and querying the grid, so actor queries don't use it. Measured on a 4096x2048 Scene with 100 and 300 pixel radius queries, where the grid only started winning at 100-250 Actors.
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UseActorGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets whether actor queries should be answered from m_ActorGrid, and
+//                  rebuilds it first if it's out of date.
+// Arguments:       None.
+// Return value:    Whether m_ActorGrid is up to date and worth using. If not, queries
+//                  should fall back to scanning m_Actors.
+
+    bool UseActorGrid();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all Actors in the internal Actor list that are within a radius of
+//                  a scene point, optionally filtered by team.
+// Arguments:       Which team to filter by. NoTeam means all Actors.
+//                  Whether to get Actors NOT of the team instead of the ones of it.
+//                  The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The Actors within the radius, in m_ActorQueryResults.
+
+    const std::vector<Actor *> & GetActorsInRadius(int team, bool getEnemies, const Vector &scenePoint, float radius);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetMOList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records which MO list a registered object was just put in or taken out
+//                  of. Needs to be called whenever an MO moves between the lists. Objects
+//                  without a slot get registered when they're put into a list.
+// Arguments:       The MO that moved.
+//                  The list it's in now.
+// Return value:    None.
+
+    void SetMOList(MovableObject *mo, MOListType list);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets which MO list an object is kept in, in constant time. Debug builds
+//                  cross-check the answer against FindMOListLinear.
+// Arguments:       The MO to look up. Doesn't get dereferenced, so may be dangling.
+// Return value:    The list the MO is in, or NotInSimulation.
+
+    MOListType GetMOList(const MovableObject *mo) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindMOListLinear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds which MO list an object is kept in by searching through all of
+//                  them. This is the slow reference the registry is checked against.
+// Arguments:       The MO to look for. Doesn't get dereferenced, so may be dangling.
+// Return value:    The list the MO was found in, or NotInSimulation.
+
+    MOListType FindMOListLinear(const MovableObject *mo) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CanTravelInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a particle's travel only touches state that can be
+//                  deferred, so it can be traveled on a worker thread. MO collisions
+//                  read and write other MOs directly, so anything involved in them stays
+//                  on the serial path.
+// Arguments:       The particle to check.
+// Return value:    Whether the particle can be traveled in parallel.
+
+    bool CanTravelInParallel(const MovableObject *particle) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Travels all the particles for this sim update. Particles that can be
+//                  traveled in parallel are split into chunks on the ThreadMan workers,
+//                  their deferred commands are merged serially in particle order, and
+//                  the remaining particles are then traveled serially.
+// Arguments:       None.
+// Return value:    None.
+
+    void TravelParticles();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Splits a range of things to travel into fixed size chunks on the
+//                  ThreadMan workers. Each chunk gets its own random stream and command
+//                  buffer, and the buffers are applied serially in chunk order afterwards.
+// Arguments:       The number of things to travel.
+//                  The function that travels one chunk, given its start and end indices.
+// Return value:    None.
+
+    void TravelInParallel(int count, const std::function<void(int chunkStart, int chunkEnd)> &travelChunk);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
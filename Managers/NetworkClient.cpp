@@ -5,10 +5,13 @@
 #include "SettingsMan.h"
 #include "PerformanceMan.h"
 #include "UInputMan.h"
+#include "PresetMan.h"
+#include "MOSprite.h"
 
 #include "RakSleep.h"
 
 #include "NetworkClient.h"
+#include "NetworkServer.h"
 #include <lz4.h>
 
 namespace RTE {
@@ -34,8 +37,14 @@ namespace RTE {
 		m_ClientInputFps = 120;
 		m_SceneBackgroundBitmap = 0;
 		m_SceneForegroundBitmap = 0;
+		m_SceneTileSize = 0;
+		m_MissingSceneTiles.clear();
 		m_CurrentSceneLayerReceived = -1;
 		m_CurrentFrame = 0;
+		ClearFrameBoxSequences();
+		m_UseEntityReplication = false;
+		m_EntityPresets.clear();
+		m_EntitySnapshots.clear();
 		m_UseNATPunchThroughService = false;
 		m_ServerGUID = RakNet::UNASSIGNED_RAKNET_GUID;
 		m_NATServiceServerID = RakNet::UNASSIGNED_SYSTEM_ADDRESS;
@@ -106,6 +115,7 @@ namespace RTE {
 
 		m_IsRegistered = false;
 		m_IsConnected = false;
+		ClearFrameBoxSequences();
 		RakSleep(250);
 		RakNet::AddressOrGUID addr = m_Client->GetSystemAddressFromIndex(0);
 		m_Client->CloseConnection(addr, true);
@@ -283,6 +293,11 @@ namespace RTE {
 			return;
 		}
 
+		// Frames arrive in order, so every box of the previous frame has either arrived or got lost by now
+		if (m_FrameBoxSequence != 0) { SendFrameBoxAckMsg(); }
+		m_FrameBoxSequence = frameData->FrameSequence;
+		m_FrameBoxesReceived = 0;
+
 		if (!g_SettingsMan.UseExperimentalMultiplayerSpeedBoosts()) { DrawFrame(); }
 
 		m_PostEffects[m_CurrentFrame].clear();
@@ -290,6 +305,7 @@ namespace RTE {
 
 		m_TargetPos[m_CurrentFrame].m_X = frameData->TargetPosX;
 		m_TargetPos[m_CurrentFrame].m_Y = frameData->TargetPosY;
+		m_UseEntityReplication = frameData->EntityReplication;
 
 		for (int i = 0; i < c_MaxLayersStoredForNetwork; i++) {
 			m_BackgroundLayers[m_CurrentFrame][i].OffsetX = frameData->OffsetX[i];
@@ -365,6 +381,15 @@ namespace RTE {
 		m_CompressedData += frameData->UncompressedSize;
 
 		if (bpx + maxWidth - 1 < bmp->w && bpy + maxHeight - 1 < bmp->h && bpx >= 0 && bpy >= 0) {
+			unsigned int &boxSequence = m_FrameBoxSequences[frameData->Layer][(static_cast<unsigned int>(bpy) << 16) | static_cast<unsigned int>(bpx)];
+			// Don't overwrite a box with an older version of it, and a delta against anything but what's in the box now would garble it. The server finds out about the dropped box through the acknowledgement and sends it whole
+			if (frameData->FrameSequence <= boxSequence || (frameData->ReferenceSequence != 0 && frameData->ReferenceSequence != boxSequence)) {
+				release_bitmap(bmp);
+				return;
+			}
+			boxSequence = frameData->FrameSequence;
+			if (frameData->FrameSequence == m_FrameBoxSequence) { m_FrameBoxesReceived++; }
+
 			// Unpack box
 			if (frameData->DataSize == 0) {
 				//memset(bmp->line[lineNumber], g_MaskColor, bmp->w);
@@ -383,14 +408,25 @@ namespace RTE {
 				}
 				// Copy box to bitmap line by line
 				const unsigned char *lineAddr = m_PixelLineBuffer;
-				for (int y = 0; y < maxHeight; y++) {
+				if (frameData->ReferenceSequence != 0) {
+					// The box is XORed against the content it had when the server last sent it, which is what's still in the bitmap
+					for (int y = 0; y < maxHeight; y++) {
+						unsigned char *boxLine = bmp->line[bpy + y] + bpx;
+						for (int x = 0; x < maxWidth; x++) {
+							boxLine[x] ^= lineAddr[x];
+						}
+						lineAddr += maxWidth;
+					}
+				} else {
+					for (int y = 0; y < maxHeight; y++) {
 #ifdef _WIN32
-					memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
+						memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
 #else
-					memcpy(bmp->line[bpy + y] + bpx, lineAddr, maxWidth);
+						memcpy(bmp->line[bpy + y] + bpx, lineAddr, maxWidth);
 #endif
 
-					lineAddr += maxWidth;
+						lineAddr += maxWidth;
+					}
 				}
 
 #ifndef RELEASE_BUILD
@@ -401,6 +437,26 @@ namespace RTE {
 		release_bitmap(bmp);
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::SendFrameBoxAckMsg() {
+		MsgFrameBoxAck msg;
+		msg.Id = ID_CLT_FRAME_BOX_ACK;
+		msg.FrameSequence = m_FrameBoxSequence;
+		msg.BoxCount = m_FrameBoxesReceived;
+		m_Client->Send((const char *)&msg, sizeof(msg), MEDIUM_PRIORITY, RELIABLE_ORDERED, 0, m_ServerID, false);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ClearFrameBoxSequences() {
+		m_FrameBoxSequence = 0;
+		m_FrameBoxesReceived = 0;
+		for (std::unordered_map<unsigned int, unsigned int> &frameBoxSequences : m_FrameBoxSequences) {
+			frameBoxSequences.clear();
+		}
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::SendSceneAcceptedMsg() {
@@ -410,58 +466,239 @@ namespace RTE {
 		g_ConsoleMan.PrintString("CLIENT: Scene ACK Sent");
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ReceiveSceneTileManifestMsg(RakNet::Packet *packet) {
+		const MsgSceneTileManifest *manifest = reinterpret_cast<const MsgSceneTileManifest *>(packet->data);
+		if (packet->length < sizeof(MsgSceneTileManifest) || manifest->SceneId != m_SceneID || manifest->TileSize == 0 || manifest->TileSize * manifest->TileSize > c_MaxPixelLineBufferSize || !m_SceneBackgroundBitmap || !m_SceneForegroundBitmap) {
+			return;
+		}
+		int layerTileCount = ((m_SceneWidth + manifest->TileSize - 1) / manifest->TileSize) * ((m_SceneHeight + manifest->TileSize - 1) / manifest->TileSize);
+		if (manifest->TileCount != static_cast<unsigned int>(layerTileCount * 2) || packet->length - sizeof(MsgSceneTileManifest) < static_cast<size_t>(manifest->TileCount) * sizeof(unsigned long long)) {
+			return;
+		}
+		m_SceneTileSize = manifest->TileSize;
+		m_MissingSceneTiles.clear();
+
+		const unsigned char *tileHashes = packet->data + sizeof(MsgSceneTileManifest);
+		for (int tileIndex = 0; tileIndex < static_cast<int>(manifest->TileCount); ++tileIndex) {
+			unsigned long long hash;
+			memcpy(&hash, tileHashes + tileIndex * sizeof(unsigned long long), sizeof(unsigned long long));
+			m_MissingSceneTiles[hash].emplace_back(tileIndex);
+		}
+
+		int cachedTileCount = 0;
+		for (std::unordered_map<unsigned long long, std::vector<int>>::iterator missingSceneTile = m_MissingSceneTiles.begin(); missingSceneTile != m_MissingSceneTiles.end();) {
+			int tileX;
+			int tileY;
+			int tileWidth;
+			int tileHeight;
+			GetSceneTileBounds(missingSceneTile->second.front(), tileX, tileY, tileWidth, tileHeight);
+			if (LoadCachedSceneTile(missingSceneTile->first, tileWidth * tileHeight, m_PixelLineBuffer)) {
+				for (int tileIndex : missingSceneTile->second) {
+					DrawSceneTile(tileIndex, m_PixelLineBuffer);
+				}
+				cachedTileCount++;
+				missingSceneTile = m_MissingSceneTiles.erase(missingSceneTile);
+			} else {
+				++missingSceneTile;
+			}
+		}
+		m_CurrentSceneLayerReceived = 1;
+
+		g_ConsoleMan.PrintString("CLIENT: Scene tiles found in cache: " + std::to_string(cachedTileCount) + ", requested: " + std::to_string(m_MissingSceneTiles.size()));
+		SendSceneTileRequestMsg();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::SendSceneTileRequestMsg() {
+		std::vector<unsigned char> requestMessage(sizeof(MsgSceneTileRequest) + m_MissingSceneTiles.size() * sizeof(unsigned long long));
+		MsgSceneTileRequest *request = reinterpret_cast<MsgSceneTileRequest *>(requestMessage.data());
+		request->Id = ID_CLT_SCENE_TILE_REQUEST;
+		request->SceneId = m_SceneID;
+		request->HashCount = static_cast<unsigned int>(m_MissingSceneTiles.size());
+
+		unsigned char *requestedHashes = requestMessage.data() + sizeof(MsgSceneTileRequest);
+		for (const auto &[hash, tileIndices] : m_MissingSceneTiles) {
+			memcpy(requestedHashes, &hash, sizeof(unsigned long long));
+			requestedHashes += sizeof(unsigned long long);
+		}
+		m_Client->Send(reinterpret_cast<const char *>(requestMessage.data()), static_cast<int>(requestMessage.size()), HIGH_PRIORITY, RELIABLE_ORDERED, 0, m_ServerID, false);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::ReceiveSceneMsg(RakNet::Packet *packet) {
-		const MsgSceneLine *frameData = (MsgSceneLine *)packet->data;
-		if (frameData->SceneId != m_SceneID) {
+		const MsgSceneTile *tileData = reinterpret_cast<const MsgSceneTile *>(packet->data);
+		if (packet->length < sizeof(MsgSceneTile) || tileData->SceneId != m_SceneID || packet->length < sizeof(MsgSceneTile) + tileData->DataSize) {
+			return;
+		}
+		std::unordered_map<unsigned long long, std::vector<int>>::iterator missingSceneTile = m_MissingSceneTiles.find(tileData->Hash);
+		if (missingSceneTile == m_MissingSceneTiles.end()) {
 			return;
 		}
+		int tileX;
+		int tileY;
+		int tileWidth;
+		int tileHeight;
+		GetSceneTileBounds(missingSceneTile->second.front(), tileX, tileY, tileWidth, tileHeight);
+		const unsigned char *payload = packet->data + sizeof(MsgSceneTile);
+		int size = tileWidth * tileHeight;
+
+		if (tileData->UncompressedSize != size) {
+			return;
+		} else if (tileData->DataSize == tileData->UncompressedSize) {
+			memcpy(m_PixelLineBuffer, payload, size);
+		} else if (LZ4_decompress_safe(reinterpret_cast<const char *>(payload), reinterpret_cast<char *>(m_PixelLineBuffer), tileData->DataSize, size) != size) {
+			return;
+		}
+		// The tile ends up in the cache under its hash and gets reused for every Scene with a tile of the same hash, so a tile that doesn't match its hash must never be drawn or stored
+		if (NetworkServer::HashFrameBox(m_PixelLineBuffer, size) != tileData->Hash) {
+			g_ConsoleMan.PrintString("CLIENT: Refused a scene tile that doesn't match its hash!");
+			return;
+		}
+		for (int tileIndex : missingSceneTile->second) {
+			DrawSceneTile(tileIndex, m_PixelLineBuffer);
+		}
+		m_MissingSceneTiles.erase(missingSceneTile);
 
-		int linex = frameData->X;
-		int liney = frameData->Y;
+		StoreCachedSceneTile(tileData->Hash, payload, tileData->DataSize);
+	}
 
-		const BITMAP *bmp = 0;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		if (frameData->Layer == 0) {
-			bmp = m_SceneBackgroundBitmap;
-		} else if (frameData->Layer == 1) {
-			bmp = m_SceneForegroundBitmap;
+	BITMAP * NetworkClient::GetSceneTileBounds(int tileIndex, int &tileX, int &tileY, int &tileWidth, int &tileHeight) const {
+		int columns = (m_SceneWidth + m_SceneTileSize - 1) / m_SceneTileSize;
+		int layerTileCount = columns * ((m_SceneHeight + m_SceneTileSize - 1) / m_SceneTileSize);
+		tileX = ((tileIndex % layerTileCount) % columns) * m_SceneTileSize;
+		tileY = ((tileIndex % layerTileCount) / columns) * m_SceneTileSize;
+		tileWidth = std::min(m_SceneTileSize, m_SceneWidth - tileX);
+		tileHeight = std::min(m_SceneTileSize, m_SceneHeight - tileY);
+		return (tileIndex < layerTileCount) ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::DrawSceneTile(int tileIndex, const unsigned char *tilePixels) {
+		int tileX;
+		int tileY;
+		int tileWidth;
+		int tileHeight;
+		BITMAP *bmp = GetSceneTileBounds(tileIndex, tileX, tileY, tileWidth, tileHeight);
+		for (int line = 0; line < tileHeight; ++line) {
+			memcpy(bmp->line[tileY + line] + tileX, tilePixels + line * tileWidth, tileWidth);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkClient::LoadCachedSceneTile(unsigned long long hash, int size, unsigned char *tilePixels) const {
+		std::string cachePath = GetSceneTileCachePath(hash);
+		std::ifstream cacheFile(cachePath, std::ios::binary | std::ios::ate);
+		if (!cacheFile.is_open()) {
+			return false;
 		}
+		int dataSize = static_cast<int>(cacheFile.tellg());
+		if (dataSize <= 0 || dataSize > size) {
+			return false;
+		}
+		cacheFile.seekg(0);
+		if (dataSize == size) {
+			if (!cacheFile.read(reinterpret_cast<char *>(tilePixels), size)) {
+				return false;
+			}
+		} else {
+			std::vector<char> tileData(dataSize);
+			if (!cacheFile.read(tileData.data(), dataSize) || LZ4_decompress_safe(tileData.data(), reinterpret_cast<char *>(tilePixels), dataSize, size) != size) {
+				return false;
+			}
+		}
+		cacheFile.close();
+		// A cache file that doesn't decode to exactly one tile with the right hash is damaged, so the tile just gets requested again and the file overwritten
+		if (NetworkServer::HashFrameBox(tilePixels, size) != hash) {
+			return false;
+		}
+		// The modification time doubles as the last time the tile was used, so trimming the cache drops the tiles that haven't been needed for the longest
+		std::error_code touchError;
+		std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), touchError);
+		return true;
+	}
 
-		int width = frameData->UncompressedSize;
-		int pixels = bmp ? std::min(bmp->w, width) : 0;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		m_CurrentSceneLayerReceived = frameData->Layer;
+	void NetworkClient::StoreCachedSceneTile(unsigned long long hash, const unsigned char *tileData, int dataSize) const {
+		std::string cacheDirectory = System::GetWorkingDirectory() + System::GetSceneTileCacheDirectory();
+		if (!std::filesystem::exists(cacheDirectory)) { System::MakeDirectory(cacheDirectory); }
 
-		if (bmp && liney < bmp->h) {
-			if (frameData->DataSize == 0) {
-				memset(bmp->line[liney] + linex, g_MaskColor, width);
-			} else {
-				if (frameData->DataSize == frameData->UncompressedSize) {
-#ifdef _WIN32
-					memcpy_s(bmp->line[liney] + linex, width, packet->data + sizeof(MsgSceneLine), pixels);
-#else
-					memcpy(bmp->line[liney] + linex, packet->data + sizeof(MsgSceneLine), pixels);
-#endif
-				} else {
-					LZ4_decompress_safe((char *)(packet->data + sizeof(MsgSceneLine)), (char *)(bmp->line[liney] + linex), frameData->DataSize, width);
-				}
+		// Write to a temporary file first so a tile that was only partially written never ends up in the cache
+		std::string cachePath = GetSceneTileCachePath(hash);
+		std::string temporaryPath = cachePath + ".tmp";
+		std::ofstream cacheFile(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!cacheFile.write(reinterpret_cast<const char *>(tileData), dataSize)) {
+			return;
+		}
+		cacheFile.close();
+		std::error_code renameError;
+		std::filesystem::rename(temporaryPath, cachePath, renameError);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::TrimSceneTileCache() const {
+		std::string cacheDirectory = System::GetWorkingDirectory() + System::GetSceneTileCacheDirectory();
+		std::error_code directoryError;
+		if (!std::filesystem::is_directory(cacheDirectory, directoryError)) {
+			return;
+		}
+		std::vector<std::tuple<std::filesystem::file_time_type, uintmax_t, std::filesystem::path>> cacheFiles;
+		uintmax_t cacheSize = 0;
+		for (const std::filesystem::directory_entry &cacheEntry : std::filesystem::directory_iterator(cacheDirectory, directoryError)) {
+			std::error_code entryError;
+			if (!cacheEntry.is_regular_file(entryError)) {
+				continue;
+			}
+			uintmax_t fileSize = cacheEntry.file_size(entryError);
+			std::filesystem::file_time_type lastUseTime = cacheEntry.last_write_time(entryError);
+			if (!entryError) {
+				cacheFiles.emplace_back(lastUseTime, fileSize, cacheEntry.path());
+				cacheSize += fileSize;
+			}
+		}
+		if (cacheSize <= c_MaxSceneTileCacheSize) {
+			return;
+		}
+		std::sort(cacheFiles.begin(), cacheFiles.end());
+		for (const auto &[lastUseTime, fileSize, filePath] : cacheFiles) {
+			if (cacheSize <= c_MaxSceneTileCacheSize) {
+				break;
 			}
+			std::error_code removeError;
+			if (std::filesystem::remove(filePath, removeError)) { cacheSize -= fileSize; }
 		}
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string NetworkClient::GetSceneTileCachePath(unsigned long long hash) {
+		char fileName[32];
+		std::snprintf(fileName, sizeof(fileName), "/%016llx.tile", hash);
+		return System::GetWorkingDirectory() + System::GetSceneTileCacheDirectory() + fileName;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::ReceiveSceneEndMsg() {
 		g_ConsoleMan.PrintString("CLIENT: Scene received.");
 		SendSceneAcceptedMsg();
+		TrimSceneTileCache();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::ReceiveSceneSetupMsg(RakNet::Packet *packet) {
 		clear_to_color(g_FrameMan.GetNetworkBackBufferIntermediateGUI8Ready(0), g_MaskColor);
+		ClearFrameBoxSequences();
 		clear_to_color(g_FrameMan.GetNetworkBackBufferGUI8Ready(0), g_MaskColor);
 
 		const MsgSceneSetup *frameData = (MsgSceneSetup *)packet->data;
@@ -475,7 +712,9 @@ namespace RTE {
 		m_SceneForegroundBitmap = create_bitmap_ex(8, frameData->Width, frameData->Height);
 
 		// This is purely for aesthetic reasons to draw bitmap during level loading
+		clear_to_color(m_SceneBackgroundBitmap, g_MaskColor);
 		clear_to_color(m_SceneForegroundBitmap, g_MaskColor);
+		m_MissingSceneTiles.clear();
 
 		m_SceneWrapsX = frameData->SceneWrapsX;
 		m_SceneWidth = frameData->Width;
@@ -538,32 +777,27 @@ namespace RTE {
 		if (frameData->SceneId != m_SceneID) {
 			return;
 		}
+		BITMAP *bmp = frameData->Back ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+		int maskSize = (frameData->W * frameData->H + 7) / 8;
+		int size = frameData->UncompressedSize;
+		if (!bmp || frameData->X + frameData->W > bmp->w || frameData->Y + frameData->H > bmp->h || size < maskSize || size > c_MaxPixelLineBufferSize) {
+			return;
+		}
 
-		if (frameData->W == 1 && frameData->H == 1) {
-			BITMAP *bmp = 0;
-			bmp = frameData->Back ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
-			putpixel(bmp, frameData->X, frameData->Y, frameData->Color);
-		} else {
-			int size = frameData->UncompressedSize;
-
-			if (frameData->DataSize == frameData->UncompressedSize) {
-#ifdef _WIN32
-				memcpy_s(m_PixelLineBuffer, size, packet->data + sizeof(MsgTerrainChange), size);
-#else
-				memcpy(m_PixelLineBuffer, packet->data + sizeof(MsgTerrainChange), size);
-#endif
-			} else {
-				LZ4_decompress_safe((char *)(packet->data + sizeof(MsgTerrainChange)), (char *)m_PixelLineBuffer, frameData->DataSize, size);
-			}
-
-			// Copy bitmap data to scene bitmap
-			const BITMAP *bmp = 0;
-			bmp = (frameData->Back) ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+		if (frameData->DataSize == frameData->UncompressedSize) {
+			memcpy(m_PixelLineBuffer, packet->data + sizeof(MsgTerrainChange), size);
+		} else if (LZ4_decompress_safe((char *)(packet->data + sizeof(MsgTerrainChange)), (char *)m_PixelLineBuffer, frameData->DataSize, size) != size) {
+			return;
+		}
 
-			const unsigned char *src = m_PixelLineBuffer;
-			for (int y = 0; y < frameData->H && frameData->Y + y < bmp->h; y++) {
-				memcpy(bmp->line[frameData->Y + y] + frameData->X, src, frameData->W);
-				src += frameData->W;
+		// Set every pixel whose bit is set in the mask to the next of the changed colors that follow it
+		const unsigned char *changedColor = m_PixelLineBuffer + maskSize;
+		const unsigned char *changedColorsEnd = m_PixelLineBuffer + size;
+		for (int y = 0; y < frameData->H; y++) {
+			unsigned char *dest = bmp->line[frameData->Y + y] + frameData->X;
+			for (int x = 0; x < frameData->W && changedColor != changedColorsEnd; x++) {
+				int maskBit = y * frameData->W + x;
+				if (m_PixelLineBuffer[maskBit / 8] & (1 << (maskBit % 8))) { dest[x] = *changedColor++; }
 			}
 		}
 	}
@@ -692,6 +926,92 @@ namespace RTE {
 		}
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ReceiveEntityPresetsMsg(RakNet::Packet *packet) {
+		if (packet->length < sizeof(MsgEntityPresets)) {
+			return;
+		}
+		const MsgEntityPresets *msg = (MsgEntityPresets *)packet->data;
+		const unsigned char *entryData = packet->data + sizeof(MsgEntityPresets);
+		const unsigned char *dataEnd = packet->data + packet->length;
+
+		for (int i = 0; i < msg->PresetCount; i++) {
+			unsigned short presetIndex = 0;
+			if (entryData + sizeof(unsigned short) > dataEnd) {
+				return;
+			}
+			memcpy(&presetIndex, entryData, sizeof(unsigned short));
+			entryData += sizeof(unsigned short);
+
+			// The class name, then the module and preset name
+			std::string presetStrings[2];
+			for (std::string &presetString : presetStrings) {
+				if (entryData >= dataEnd || entryData + 1 + *entryData > dataEnd) {
+					return;
+				}
+				presetString.assign(reinterpret_cast<const char *>(entryData + 1), *entryData);
+				entryData += 1 + presetString.size();
+			}
+			if (presetIndex >= m_EntityPresets.size()) { m_EntityPresets.resize(presetIndex + 1, nullptr); }
+			m_EntityPresets[presetIndex] = dynamic_cast<const MOSprite *>(g_PresetMan.GetEntityPreset(presetStrings[0], presetStrings[1]));
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ReceiveEntitySnapshotMsg(RakNet::Packet *packet) {
+		if (packet->length < sizeof(MsgEntitySnapshot)) {
+			return;
+		}
+		const MsgEntitySnapshot *msg = (MsgEntitySnapshot *)packet->data;
+		// Every entity takes at least its ID and the mask of its encoded fields, so a count the data can't hold is bogus and mustn't get as far as Decode reserving room for it
+		size_t minDataSize = static_cast<size_t>(msg->EntityCount) * (sizeof(unsigned int) + 1);
+		size_t maxDataSize = static_cast<size_t>(msg->EntityCount) * (sizeof(unsigned int) + 1 + sizeof(EntitySnapshot::EntityState));
+		if (packet->length < sizeof(MsgEntitySnapshot) + msg->DataSize || msg->UncompressedSize < minDataSize || msg->UncompressedSize > maxDataSize) {
+			return;
+		}
+		// Snapshots arrive sequenced, but don't take any chances with stale ones replacing newer ones
+		if (!m_EntitySnapshots.empty() && msg->Sequence <= m_EntitySnapshots.back().GetSequence()) {
+			return;
+		}
+		const EntitySnapshot *baseline = nullptr;
+		if (msg->BaselineSequence != 0) {
+			for (const EntitySnapshot &entitySnapshot : m_EntitySnapshots) {
+				if (entitySnapshot.GetSequence() == msg->BaselineSequence) {
+					baseline = &entitySnapshot;
+					break;
+				}
+			}
+			// Without the baseline there's nothing to apply the deltas to. The server falls back to whole snapshots once the baseline grows too old
+			if (!baseline) {
+				return;
+			}
+		}
+		const unsigned char *snapshotData = packet->data + sizeof(MsgEntitySnapshot);
+		if (msg->DataSize != msg->UncompressedSize) {
+			m_EntitySnapshotData.resize(msg->UncompressedSize);
+			if (LZ4_decompress_safe(reinterpret_cast<const char *>(snapshotData), reinterpret_cast<char *>(m_EntitySnapshotData.data()), msg->DataSize, msg->UncompressedSize) != static_cast<int>(msg->UncompressedSize)) {
+				return;
+			}
+			snapshotData = m_EntitySnapshotData.data();
+		}
+		EntitySnapshot entitySnapshot;
+		if (!entitySnapshot.Decode(baseline, snapshotData, msg->UncompressedSize, msg->EntityCount)) {
+			return;
+		}
+		entitySnapshot.SetSequence(msg->Sequence);
+		m_EntitySnapshots.emplace_back(std::move(entitySnapshot));
+		while (m_EntitySnapshots.size() > c_MaxEntitySnapshots) {
+			m_EntitySnapshots.pop_front();
+		}
+
+		MsgEntitySnapshotAck ackMsg;
+		ackMsg.Id = ID_CLT_ENTITY_SNAPSHOT_ACK;
+		ackMsg.Sequence = msg->Sequence;
+		m_Client->Send((const char *)&ackMsg, sizeof(ackMsg), MEDIUM_PRIORITY, UNRELIABLE, 0, m_ServerID, false);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::DrawBackgrounds(BITMAP *targetBitmap) {
@@ -879,6 +1199,61 @@ namespace RTE {
 
 	void NetworkClient::DrawPostEffects(int frame) { g_PostProcessMan.SetNetworkPostEffectsList(0, m_PostEffects[frame]); }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::DrawEntities(BITMAP *targetBitmap, const Vector &targetPos) {
+		if (m_EntitySnapshots.empty()) {
+			return;
+		}
+		// Entities near the seam of a wrapping Scene have to be drawn on the other side of it too if the view straddles it
+		int wrapOffsets[3] = { 0, 0, 0 };
+		int passes = 1;
+		if (m_SceneWrapsX) {
+			if (targetPos.m_X < 0) { wrapOffsets[passes++] = -m_SceneWidth; }
+			if (targetPos.m_X + targetBitmap->w > m_SceneWidth) { wrapOffsets[passes++] = m_SceneWidth; }
+		}
+		int targetX = targetPos.GetFloorIntX();
+		int targetY = targetPos.GetFloorIntY();
+
+		for (const EntitySnapshot::EntityState &entityState : m_EntitySnapshots.back().GetEntities()) {
+			const MOSprite *entityPreset = (entityState.PresetIndex < m_EntityPresets.size()) ? m_EntityPresets[entityState.PresetIndex] : nullptr;
+			BITMAP *sprite = entityPreset ? entityPreset->GetSpriteFrame(entityState.Frame) : nullptr;
+			if (!sprite) {
+				continue;
+			}
+			int spriteX = entityState.PosX - targetX;
+			int spriteY = entityState.PosY - targetY;
+
+			if (entityState.Flags & EntitySnapshot::Unrotated) {
+				for (int pass = 0; pass < passes; ++pass) {
+					draw_sprite(targetBitmap, sprite, spriteX + wrapOffsets[pass], spriteY);
+				}
+				continue;
+			}
+			Vector spriteOffset = entityPreset->GetSpriteOffset();
+			bool hFlipped = entityState.Flags & EntitySnapshot::HFlipped;
+			const RotatedSpriteCache::CachedSprite *cachedSprite = g_FrameMan.GetRotatedSpriteCache().GetRotatedSprite(sprite, -1, bitmap_color_depth(targetBitmap), static_cast<int>(-spriteOffset.m_X), static_cast<int>(-spriteOffset.m_Y), entityState.GetAllegroAngle(), entityState.GetScale(), hFlipped);
+			if (cachedSprite) {
+				for (int pass = 0; pass < passes; ++pass) {
+					draw_sprite(targetBitmap, cachedSprite->Bitmap, spriteX + wrapOffsets[pass] - cachedSprite->PivotOffset, spriteY - cachedSprite->PivotOffset);
+				}
+				continue;
+			}
+			// The cache is over its memory budget, so rotate the sprite directly like MOSRotating does, flipping it on a temporary bitmap first if need be
+			BITMAP *flippedSprite = nullptr;
+			if (hFlipped) {
+				flippedSprite = create_bitmap_ex(bitmap_color_depth(sprite), sprite->w, sprite->h);
+				clear_to_color(flippedSprite, g_MaskColor);
+				draw_sprite_h_flip(flippedSprite, sprite, 0, 0);
+			}
+			int pivotX = hFlipped ? sprite->w + static_cast<int>(spriteOffset.m_X) : static_cast<int>(-spriteOffset.m_X);
+			for (int pass = 0; pass < passes; ++pass) {
+				pivot_scaled_sprite(targetBitmap, hFlipped ? flippedSprite : sprite, spriteX + wrapOffsets[pass], spriteY, pivotX, static_cast<int>(-spriteOffset.m_Y), ftofix(entityState.GetAllegroAngle()), ftofix(entityState.GetScale()));
+			}
+			if (flippedSprite) { destroy_bitmap(flippedSprite); }
+		}
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::DrawFrame() {
@@ -915,6 +1290,7 @@ namespace RTE {
 		}
 
 		//draw_sprite(src_bmp, dst_bmp, 0, 0);
+		if (m_UseEntityReplication) { DrawEntities(dst_bmp, m_TargetPos[m_CurrentFrame]); }
 		masked_blit(src_bmp, dst_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h);
 		masked_blit(src_gui_bmp, dst_gui_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h);
 		masked_blit(m_SceneForegroundBitmap, dst_bmp, sourceX, sourceY, destX, destY, src_bmp->w, src_bmp->h);
@@ -1115,6 +1491,9 @@ namespace RTE {
 				case ID_SRV_SCENE_SETUP:
 					ReceiveSceneSetupMsg(packet);
 					break;
+				case ID_SRV_SCENE_TILE_MANIFEST:
+					ReceiveSceneTileManifestMsg(packet);
+					break;
 				case ID_SRV_SCENE:
 					ReceiveSceneMsg(packet);
 					break;
@@ -1143,6 +1522,12 @@ namespace RTE {
 				case ID_SRV_MUSIC_EVENTS:
 					ReceiveMusicEventsMsg(packet);
 					break;
+				case ID_SRV_ENTITY_PRESETS:
+					ReceiveEntityPresetsMsg(packet);
+					break;
+				case ID_SRV_ENTITY_SNAPSHOT:
+					ReceiveEntitySnapshotMsg(packet);
+					break;
 				case ID_NAT_TARGET_NOT_CONNECTED:
 					g_ConsoleMan.PrintString("Failed: ID_NAT_TARGET_NOT_CONNECTED");
 					m_IsConnected = false;
@@ -5,6 +5,7 @@
 #include "SoundContainer.h"
 
 #include "NetworkMessages.h"
+#include "EntitySnapshot.h"
 
 // TODO: Figure out how to deal with anything that is defined by these and include them in implementation only to remove Windows.h macro pollution from our headers.
 #include "RakPeerInterface.h"
@@ -22,6 +23,7 @@
 namespace RTE {
 
 	struct PostEffect;
+	class MOSprite;
 
 	/// <summary>
 	/// The centralized singleton manager of the network multiplayer client.
@@ -140,6 +142,8 @@ namespace RTE {
 	protected:
 
 		static constexpr unsigned short c_PlayerNameCharLimit = 15; //!< Maximum length of the player name.
+		static constexpr uintmax_t c_MaxSceneTileCacheSize = 128 * 1024 * 1024; //!< How many bytes the scene tile cache may take up on disk before the tiles that weren't used for the longest are removed.
+		static constexpr int c_MaxEntitySnapshots = 32; //!< How many entity snapshots are kept for the server to delta encode against. Has to be more than the server keeps around waiting for acknowledgements.
 		std::string m_PlayerName; //!< The player name the will be used by the client in network games.
 
 		RakNet::RakPeerInterface *m_Client; //!< The client RakPeerInterface.
@@ -167,6 +171,15 @@ namespace RTE {
 
 		int m_CurrentFrame; //!<
 
+		unsigned int m_FrameBoxSequence; //!< The sequence number of the frame whose boxes are currently being received, or 0 if none.
+		unsigned short m_FrameBoxesReceived; //!< How many boxes of the current frame were received and could be decoded.
+		std::unordered_map<unsigned int, unsigned int> m_FrameBoxSequences[2]; //!< The sequence number of the frame each box on each layer was last received in, keyed by the box's position. Boxes sent as deltas can only be decoded against the content they were made from.
+
+		bool m_UseEntityReplication; //!< Whether the server leaves replicable MovableObjects out of the frames and sends them as entity snapshots to draw instead.
+		std::vector<const MOSprite *> m_EntityPresets; //!< The Presets entities in entity snapshots refer to, by their index in the server's table. Null where the Preset wasn't received or couldn't be found.
+		std::deque<EntitySnapshot> m_EntitySnapshots; //!< The latest entity snapshots received, oldest first. The newest is the one drawn.
+		std::vector<unsigned char> m_EntitySnapshotData; //!< Scratch space entity snapshots are decompressed into.
+
 		Vector m_TargetPos[c_FramesToRemember]; //!<
 		std::list<PostEffect> m_PostEffects[c_FramesToRemember]; //!< List of post-effects received from server.
 
@@ -178,6 +191,9 @@ namespace RTE {
 		BITMAP *m_SceneBackgroundBitmap; //!<
 		BITMAP *m_SceneForegroundBitmap; //!<
 
+		int m_SceneTileSize; //!< The width and height of the tiles the server splits the Scene's terrain into.
+		std::unordered_map<unsigned long long, std::vector<int>> m_MissingSceneTiles; //!< The tiles of the current Scene that weren't cached and still have to be received, by hash. Identical tiles share a hash and are all filled by one message.
+
 		BITMAP *m_BackgroundBitmaps[c_MaxLayersStoredForNetwork]; //!<
 		LightweightSceneLayer m_BackgroundLayers[c_FramesToRemember][c_MaxLayersStoredForNetwork]; //!<
 		int m_ActiveBackgroundLayers; //!<
@@ -258,17 +274,85 @@ namespace RTE {
 		/// <param name="packet"></param>
 		void ReceiveFrameBoxMsg(RakNet::Packet *packet);
 
+		/// <summary>
+		/// Tells the server how many boxes of the current frame were received, so it can resend any it had sent as deltas against boxes that got lost.
+		/// </summary>
+		void SendFrameBoxAckMsg();
+
+		/// <summary>
+		/// Forgets which frame each box was last received in, so only whole boxes are accepted until every box has been received again. Done whenever the frame buffers get cleared.
+		/// </summary>
+		void ClearFrameBoxSequences();
+
 		/// <summary>
 		/// 
 		/// </summary>
 		void SendSceneAcceptedMsg();
 
 		/// <summary>
-		/// 
+		/// Receives the manifest of the Scene's terrain tiles, fills every tile found in the scene tile cache and requests the rest from the server.
 		/// </summary>
-		/// <param name="packet"></param>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveSceneTileManifestMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Asks the server for the content of the scene tiles that weren't cached.
+		/// </summary>
+		void SendSceneTileRequestMsg();
+
+		/// <summary>
+		/// Receives the content of a scene tile, fills every tile with its hash and stores it in the scene tile cache. Tiles whose content doesn't match their hash are refused.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
 		void ReceiveSceneMsg(RakNet::Packet *packet);
 
+		/// <summary>
+		/// Gets the terrain layer bitmap and area a scene tile covers.
+		/// </summary>
+		/// <param name="tileIndex">The index of the tile in the manifest.</param>
+		/// <param name="tileX">Set to the X position of the tile in the layer.</param>
+		/// <param name="tileY">Set to the Y position of the tile in the layer.</param>
+		/// <param name="tileWidth">Set to the width of the tile, smaller than the tile size at the right edge of the Scene.</param>
+		/// <param name="tileHeight">Set to the height of the tile, smaller than the tile size at the bottom edge of the Scene.</param>
+		/// <returns>The layer bitmap the tile is on.</returns>
+		BITMAP * GetSceneTileBounds(int tileIndex, int &tileX, int &tileY, int &tileWidth, int &tileHeight) const;
+
+		/// <summary>
+		/// Copies the content of a scene tile into the terrain layer bitmap it's on.
+		/// </summary>
+		/// <param name="tileIndex">The index of the tile in the manifest.</param>
+		/// <param name="tilePixels">The content of the tile, row by row without padding.</param>
+		void DrawSceneTile(int tileIndex, const unsigned char *tilePixels);
+
+		/// <summary>
+		/// Loads the content of a scene tile from the scene tile cache, and marks the tile as used so it's kept when the cache is trimmed.
+		/// </summary>
+		/// <param name="hash">The hash of the tile.</param>
+		/// <param name="size">The size of the tile content, in bytes. Cache files that don't decode to exactly this size are ignored.</param>
+		/// <param name="tilePixels">The buffer to load the tile content into. Has to hold at least size bytes.</param>
+		/// <returns>Whether the tile was found in the cache and matches its hash.</returns>
+		bool LoadCachedSceneTile(unsigned long long hash, int size, unsigned char *tilePixels) const;
+
+		/// <summary>
+		/// Stores a scene tile in the scene tile cache, as it was received from the server.
+		/// </summary>
+		/// <param name="hash">The hash of the tile.</param>
+		/// <param name="tileData">The tile data, LZ4 compressed unless it's as big as the tile itself.</param>
+		/// <param name="dataSize">The size of the tile data, in bytes.</param>
+		void StoreCachedSceneTile(unsigned long long hash, const unsigned char *tileData, int dataSize) const;
+
+		/// <summary>
+		/// Removes the tiles that weren't used for the longest from the scene tile cache until it's no bigger than c_MaxSceneTileCacheSize. Done once every Scene is received.
+		/// </summary>
+		void TrimSceneTileCache() const;
+
+		/// <summary>
+		/// Gets the path of the scene tile cache file for a hash.
+		/// </summary>
+		/// <param name="hash">The hash of the tile.</param>
+		/// <returns>The path of the cache file.</returns>
+		static std::string GetSceneTileCachePath(unsigned long long hash);
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -308,6 +392,18 @@ namespace RTE {
 		/// </summary>
 		/// <param name="packet">The packet to handle.</param>
 		void ReceiveMusicEventsMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Receives entity Presets and looks them up, so entities in entity snapshots that refer to them can be drawn.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveEntityPresetsMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Receives an entity snapshot, decodes it against the snapshot it was delta encoded against and acknowledges it to the server.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveEntitySnapshotMsg(RakNet::Packet *packet);
 #pragma endregion
 
 #pragma region Drawing
@@ -323,6 +419,13 @@ namespace RTE {
 		/// <param name="frame"></param>
 		void DrawPostEffects(int frame);
 
+		/// <summary>
+		/// Draws the entities of the latest entity snapshot from their Presets, the way the server would have drawn them into the frame.
+		/// </summary>
+		/// <param name="targetBitmap">The bitmap to draw on.</param>
+		/// <param name="targetPos">The position of the upper left corner of the target bitmap in the Scene.</param>
+		void DrawEntities(BITMAP *targetBitmap, const Vector &targetPos);
+
 		/// <summary>
 		/// 
 		/// </summary>
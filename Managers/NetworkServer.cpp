@@ -7,25 +7,37 @@
 #include "Scene.h"
 #include "SLTerrain.h"
 #include "GameActivity.h"
+#include "MOSprite.h"
 
 #include "SettingsMan.h"
+#include "PresetMan.h"
 #include "ConsoleMan.h"
 #include "UInputMan.h"
 #include "TimerMan.h"
 #include "AudioMan.h"
 
+#include "ThreadMan.h"
+
 #include "RakNetStatistics.h"
 #include "RakSleep.h"
 
 #include <lz4.h>
 #include <lz4hc.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
 namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::BackgroundSendThreadFunction(NetworkServer *server, short player) {
 		const int sleepTime = 1000000 / server->m_EncodingFps;
+		// The send thread runs alongside the sim, so anything it does that draws random numbers needs a stream of its own to not race the sim on the shared ones
+		RandomStream sendThreadStream(static_cast<uint64_t>(std::random_device()()), static_cast<uint64_t>(player));
+		g_ThreadRandomStream = &sendThreadStream;
+
 		while (server->IsServerModeEnabled() && server->IsPlayerConnected(player)) {
 			if (server->NeedToSendSceneSetupData(player) && server->IsSceneAvailable(player)) {
 				server->SendSceneSetupData(player);
@@ -34,14 +46,17 @@ namespace RTE {
 				server->ClearTerrainChangeQueue(player);
 				server->SendSceneData(player);
 			}
+			if (server->NeedToSendSceneTiles(player) && server->IsSceneAvailable(player)) {
+				server->SendSceneTiles(player);
+			}
 			if (server->SendFrameData(player)) {
 				server->SendFrame(player);
 				std::this_thread::sleep_for(std::chrono::microseconds(sleepTime));
 			}
 			server->UpdateStats(player);
 		}
+		g_ThreadRandomStream = nullptr;
 		server->SetThreadExitReason(player, NetworkServer::THREAD_FINISH);
-
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +95,7 @@ namespace RTE {
 			// Set to send scene setup data by default
 			m_SendSceneSetupData[i] = false;
 			m_SendSceneData[i] = false;
+			m_SendSceneTiles[i] = false;
 			m_SceneAvailable[i] = false;
 			m_SendFrameData[i] = false;
 
@@ -87,6 +103,29 @@ namespace RTE {
 			m_RestartActivityVotes[i] = false;
 
 			m_FrameNumbers[i] = 0;
+			m_FrameSequences[i] = 0;
+			m_FrameBoxColumns[i] = 0;
+			for (FrameBoxHistory &frameBoxHistory : m_FrameBoxHistory[i]) {
+				frameBoxHistory = FrameBoxHistory();
+			}
+			m_UnacknowledgedFrames[i].clear();
+			m_PendingFrameBoxAcks[i] = std::queue<MsgFrameBoxAck>();
+			m_FrameBoxJobs[i].clear();
+			m_FrameBoxMessages[i].clear();
+			m_FrameBoxEncoders[i].clear();
+			m_SceneTileSnapshots[i] = SceneTileSnapshot();
+			m_SceneTileMessages[i].clear();
+			m_PendingTerrainDeltas[i].clear();
+			m_EntityPresetsSent[i].clear();
+			m_PendingEntitySnapshots[i].Reset();
+			m_PendingEntityPresets[i].clear();
+			m_EntitySnapshotPending[i] = false;
+			m_OutgoingEntitySnapshots[i].Reset();
+			m_OutgoingEntityPresets[i].clear();
+			m_EntitySnapshotSequences[i] = 0;
+			m_AcknowledgedEntitySnapshots[i] = 0;
+			m_SentEntitySnapshots[i].clear();
+			m_PendingEntitySnapshotAcks[i] = std::queue<unsigned int>();
 
 			m_Ping[i] = 0;
 			m_PingTimer[i].Reset();
@@ -121,12 +160,29 @@ namespace RTE {
 
 			m_EmptyBlocks[i] = 0;
 			m_FullBlocks[i] = 0;
+			m_UnchangedBlocks[i] = 0;
 		}
 
 		m_UseHighCompression = true;
 		m_UseFastCompression = false;
 		m_HighCompressionLevel = LZ4HC_CLEVEL_OPT_MIN;
 		m_FastAccelerationFactor = 10;
+		m_SceneCompressionLevel = LZ4HC_CLEVEL_DEFAULT;
+		for (std::vector<unsigned char> &terrainShadowLayer : m_TerrainShadow) {
+			terrainShadowLayer.clear();
+		}
+		m_TerrainShadowWidth = 0;
+		m_TerrainShadowHeight = 0;
+		m_TerrainDeltaColumns = 0;
+		m_TerrainDeltaRows = 0;
+		m_DirtyTerrainTiles.clear();
+		m_DirtyTerrainTileIndices.clear();
+		m_UseEntityReplication = false;
+		m_EntityPresetIndices.clear();
+		m_EntityPresets.clear();
+		m_ReplicatedEntities.clear();
+		m_CapturedEntityStates.clear();
+		m_CapturingEntitySnapshot = false;
 		m_UseInterlacing = false;
 		m_EncodingFps = 60;
 		m_ShowInput = false;
@@ -134,6 +190,7 @@ namespace RTE {
 		m_TransmitAsBoxes = true;
 		m_BoxWidth = 64;
 		m_BoxHeight = 88;
+		m_UseDeltaCompression = true;
 		m_UseNATService = false;
 		m_NatServerConnected = false;
 		m_LastPackedReceived.Reset();
@@ -166,6 +223,7 @@ namespace RTE {
 		m_IsInServerMode = false;
 		// Wait for thread to shut down
 		RakSleep(250);
+		m_EncoderPool.Stop();
 		m_Server->Shutdown(300);
 		// We're done with the network
 		RakNet::RakPeerInterface::DestroyInstance(m_Server);
@@ -178,7 +236,21 @@ namespace RTE {
 
 			if (m_LZ4FastCompressionState[i]) { free(m_LZ4FastCompressionState[i]); }		
 			m_LZ4FastCompressionState[i] = 0;
+
+			for (const FrameBoxEncoder &frameBoxEncoder : m_FrameBoxEncoders[i]) {
+				free(frameBoxEncoder.LZ4State);
+			}
+			m_FrameBoxEncoders[i].clear();
+
+			for (void *sceneTileLZ4State : m_SceneTileLZ4States[i]) {
+				free(sceneTileLZ4State);
+			}
+			m_SceneTileLZ4States[i].clear();
+		}
+		for (void *terrainDeltaLZ4State : m_TerrainDeltaLZ4States) {
+			free(terrainDeltaLZ4State);
 		}
+		m_TerrainDeltaLZ4States.clear();
 		Clear();
 	}
 
@@ -226,6 +298,8 @@ namespace RTE {
 			m_Server->SetMaximumIncomingConnections(4);
 			g_ConsoleMan.PrintString("SERVER: STARTED!");
 		}
+		// The send threads encode on the encoder pool as well while they wait on it, so a quarter of the hardware threads is plenty and leaves the rest to the sim
+		if (m_EncoderPool.GetWorkerCount() == 0) { m_EncoderPool.Start(std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 4, 1, c_MaxEncoderThreads)); }
 
 		if (m_UseNATService) {
 			g_ConsoleMan.PrintString("SERVER: Connecting to NAT service");
@@ -273,10 +347,12 @@ namespace RTE {
 
 	void NetworkServer::ResetScene() {
 		m_SceneID++;
+		ResetTerrainShadow();
 		for (int i = 0; i < c_MaxClients; i++) {
 			m_SendSceneSetupData[i] = true;
 			m_SceneAvailable[i] = true;
 			m_SendSceneData[i] = false;
+			m_SendSceneTiles[i] = false;
 			m_SendFrameData[i] = false;
 		}
 	}
@@ -284,14 +360,96 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::RegisterTerrainChange(SceneMan::TerrainChange terrainChange) {
-		if (m_IsInServerMode) {
-			for (short player = 0; player < c_MaxClients; player++) {
-				if (IsPlayerConnected(player)) {
-					m_Mutex[player].lock();
-					m_PendingTerrainChanges[player].push(terrainChange);
-					m_Mutex[player].unlock();
+		if (!m_IsInServerMode || m_DirtyTerrainTiles.empty()) {
+			return;
+		}
+		int layerOffset = terrainChange.back ? 0 : m_TerrainDeltaColumns * m_TerrainDeltaRows;
+		int firstColumn = std::clamp(terrainChange.x / c_TerrainDeltaTileSize, 0, m_TerrainDeltaColumns - 1);
+		int lastColumn = std::clamp((terrainChange.x + terrainChange.w - 1) / c_TerrainDeltaTileSize, 0, m_TerrainDeltaColumns - 1);
+		int firstRow = std::clamp(terrainChange.y / c_TerrainDeltaTileSize, 0, m_TerrainDeltaRows - 1);
+		int lastRow = std::clamp((terrainChange.y + terrainChange.h - 1) / c_TerrainDeltaTileSize, 0, m_TerrainDeltaRows - 1);
+		for (int row = firstRow; row <= lastRow; ++row) {
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				int tileIndex = layerOffset + row * m_TerrainDeltaColumns + column;
+				if (!m_DirtyTerrainTiles[tileIndex]) {
+					m_DirtyTerrainTiles[tileIndex] = 1;
+					m_DirtyTerrainTileIndices.emplace_back(tileIndex);
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::BeginEntitySnapshot() {
+		m_ReplicatedEntities.clear();
+		m_CapturedEntityStates.clear();
+		m_CapturingEntitySnapshot = m_IsInServerMode && m_UseEntityReplication;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkServer::AddReplicatedEntity(const MovableObject *movableObject) {
+		if (!m_CapturingEntitySnapshot || !EntitySnapshot::IsReplicable(movableObject)) {
+			return false;
+		}
+		m_CapturedEntityParts.clear();
+		EntitySnapshot::GetDrawnParts(movableObject, m_CapturedEntityParts);
+
+		int firstState = static_cast<int>(m_CapturedEntityStates.size());
+		for (const MOSprite *part : m_CapturedEntityParts) {
+			unsigned short presetIndex = 0;
+			if (!GetEntityPresetIndex(part, presetIndex)) {
+				// The client couldn't draw this part, so the whole thing has to go out as pixels instead
+				m_CapturedEntityStates.resize(firstState);
+				return false;
+			}
+			m_CapturedEntityStates.emplace_back(EntitySnapshot::CaptureState(part, presetIndex));
+		}
+		m_ReplicatedEntities.push_back({ movableObject->GetPos(), movableObject->GetRadius(), firstState, static_cast<int>(m_CapturedEntityStates.size()) });
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::EndEntitySnapshot() {
+		if (!m_CapturingEntitySnapshot) {
+			return;
+		}
+		m_CapturingEntitySnapshot = false;
+
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (!IsPlayerConnected(player) || !SendFrameData(player)) {
+				continue;
+			}
+			Vector viewHalfSize(static_cast<float>(g_FrameMan.GetPlayerFrameBufferWidth(player)) / 2.0F, static_cast<float>(g_FrameMan.GetPlayerFrameBufferHeight(player)) / 2.0F);
+			Vector viewCenter = g_FrameMan.GetTargetPos(player) + viewHalfSize;
+
+			EntitySnapshot entitySnapshot;
+			std::vector<const EntityPresetDefinition *> newEntityPresets;
+			std::vector<bool> &entityPresetsSent = m_EntityPresetsSent[player];
+			entityPresetsSent.resize(m_EntityPresets.size(), false);
+			for (const ReplicatedEntity &replicatedEntity : m_ReplicatedEntities) {
+				Vector distanceFromView = g_SceneMan.ShortestDistance(viewCenter, replicatedEntity.Pos, true);
+				float interestMargin = replicatedEntity.Radius + c_EntityInterestMargin;
+				if (std::abs(distanceFromView.m_X) > viewHalfSize.m_X + interestMargin || std::abs(distanceFromView.m_Y) > viewHalfSize.m_Y + interestMargin) {
+					continue;
+				}
+				for (int stateIndex = replicatedEntity.FirstState; stateIndex < replicatedEntity.EndState; ++stateIndex) {
+					const EntitySnapshot::EntityState &entityState = m_CapturedEntityStates[stateIndex];
+					if (!entityPresetsSent[entityState.PresetIndex]) {
+						entityPresetsSent[entityState.PresetIndex] = true;
+						newEntityPresets.emplace_back(&m_EntityPresets[entityState.PresetIndex]);
+					}
+					entitySnapshot.AddEntity(entityState);
 				}
 			}
+			// If the send thread didn't get to the previous snapshot yet it gets replaced, but the Presets that came with it still have to be sent
+			m_Mutex[player].lock();
+			std::swap(m_PendingEntitySnapshots[player], entitySnapshot);
+			m_PendingEntityPresets[player].insert(m_PendingEntityPresets[player].end(), newEntityPresets.begin(), newEntityPresets.end());
+			m_EntitySnapshotPending[player] = true;
+			m_Mutex[player].unlock();
 		}
 	}
 
@@ -381,6 +539,7 @@ namespace RTE {
 
 				m_SendSceneSetupData[index] = true;
 				m_SendSceneData[index] = false;
+				m_SendSceneTiles[index] = false;
 				m_SendFrameData[index] = false;
 			}
 		}
@@ -409,11 +568,19 @@ namespace RTE {
 
 				m_Server->SetTimeoutTime(5000, m_ClientConnections[index].ClientId);
 
+				// The client starts out without any entity Presets, so they all have to be sent again
+				m_EntityPresetsSent[index].clear();
+				m_Mutex[index].lock();
+				m_PendingEntityPresets[index].clear();
+				m_EntitySnapshotPending[index] = false;
+				m_Mutex[index].unlock();
+
 				m_ClientConnections[index].SendThread = new std::thread(BackgroundSendThreadFunction, this, index);
 				SendAcceptedMsg(index);
 
 				m_SendSceneSetupData[index] = true;
 				m_SendSceneData[index] = false;
+				m_SendSceneTiles[index] = false;
 				m_SendFrameData[index] = false;
 			}
 		}
@@ -669,6 +836,10 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::SendSceneSetupData(short player) {
+		// The client clears its frame buffers when it gets the new scene, so it won't have anything to skip or delta boxes against
+		ResetFrameBoxHistory(player);
+		ResetEntitySnapshotHistory(player);
+
 		MsgSceneSetup msgSceneSetup;
 		msgSceneSetup.Id = ID_SRV_SCENE_SETUP;
 		msgSceneSetup.SceneId = m_SceneID;
@@ -758,114 +929,179 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::SendSceneData(short player) {
-		// Check for congestion
-		RakNet::RakNetStatistics rns;
-
-		MsgSceneLine *sceneData = (MsgSceneLine *)m_PixelLineBuffer[player];
-
-		// Save message ID
-		sceneData->Id = ID_SRV_SCENE;
-
-		int lineX = 0;
-		int lineY = 0;
-		int lineWidth = 1280;
-
 		Scene *scene = g_SceneMan.GetScene();
-		SLTerrain *terrain = 0;
-
-		if (scene) {
-			terrain = scene->GetTerrain();
-			if (!terrain) {
-				return;
-			}
-		} else {
+		SLTerrain *terrain = scene ? scene->GetTerrain() : nullptr;
+		if (!terrain) {
 			return;
 		}
-
-		// Lock the scene until current bitmap is fully transfered
+		SceneTileSnapshot &sceneTileSnapshot = m_SceneTileSnapshots[player];
+		const BITMAP *layerBitmaps[2] = { terrain->GetBGColorBitmap(), terrain->GetFGColorBitmap() };
+		int sceneWidth = layerBitmaps[0]->w;
+		int sceneHeight = layerBitmaps[0]->h;
+		sceneTileSnapshot.Width = sceneWidth;
+		sceneTileSnapshot.Height = sceneHeight;
+		sceneTileSnapshot.Columns = (sceneWidth + c_SceneTileSize - 1) / c_SceneTileSize;
+		sceneTileSnapshot.Rows = (sceneHeight + c_SceneTileSize - 1) / c_SceneTileSize;
+		int layerTileCount = sceneTileSnapshot.Columns * sceneTileSnapshot.Rows;
+		int tileCount = layerTileCount * 2;
+		sceneTileSnapshot.Pixels.resize(static_cast<size_t>(tileCount) * c_SceneTileSize * c_SceneTileSize);
+		sceneTileSnapshot.Hashes.resize(tileCount);
+		sceneTileSnapshot.TileIndices.clear();
+
+		// Lock the scene until the terrain is copied, the tiles the client requests later are sent from the copy. Every tile is copied and hashed independently, so they're spread over the encoder pool
 		m_SceneLock[player].lock();
-
-		for (int layer = 0; layer < 2; layer++) {
-			BITMAP *bmp = 0;
-			if (layer == 0) {
-				bmp = terrain->GetBGColorBitmap();
-			} else if (layer == 1) {
-				bmp = terrain->GetFGColorBitmap();
+		int grainSize = std::max((tileCount + m_EncoderPool.GetConcurrency() - 1) / m_EncoderPool.GetConcurrency(), 1);
+		m_EncoderPool.Wait(m_EncoderPool.ParallelFor(0, tileCount, grainSize, [&sceneTileSnapshot, &layerBitmaps, layerTileCount, sceneWidth, sceneHeight](int chunkStart, int chunkEnd, int chunkIndex) {
+			for (int tileIndex = chunkStart; tileIndex < chunkEnd; ++tileIndex) {
+				const BITMAP *layerBitmap = layerBitmaps[tileIndex / layerTileCount];
+				int tileX = ((tileIndex % layerTileCount) % sceneTileSnapshot.Columns) * c_SceneTileSize;
+				int tileY = ((tileIndex % layerTileCount) / sceneTileSnapshot.Columns) * c_SceneTileSize;
+				int tileWidth = std::min(c_SceneTileSize, sceneWidth - tileX);
+				int tileHeight = std::min(c_SceneTileSize, sceneHeight - tileY);
+
+				unsigned char *tilePixels = &sceneTileSnapshot.Pixels[static_cast<size_t>(tileIndex) * c_SceneTileSize * c_SceneTileSize];
+				for (int line = 0; line < tileHeight; ++line) {
+					memcpy(tilePixels + line * tileWidth, layerBitmap->line[tileY + line] + tileX, tileWidth);
+				}
+				sceneTileSnapshot.Hashes[tileIndex] = HashFrameBox(tilePixels, tileWidth * tileHeight);
 			}
+		}));
+		m_SceneLock[player].unlock();
 
-			lock_bitmap(bmp);
+		for (int tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+			sceneTileSnapshot.TileIndices.try_emplace(sceneTileSnapshot.Hashes[tileIndex], tileIndex);
+		}
 
-			for (lineX = 0; ; lineX += lineWidth) {
-				int width = lineWidth;
-				if (lineX + width >= g_SceneMan.GetSceneWidth()) { width = g_SceneMan.GetSceneWidth() - lineX; }
+		std::vector<unsigned char> manifestMessage(sizeof(MsgSceneTileManifest) + sceneTileSnapshot.Hashes.size() * sizeof(unsigned long long));
+		MsgSceneTileManifest *manifest = reinterpret_cast<MsgSceneTileManifest *>(manifestMessage.data());
+		manifest->Id = ID_SRV_SCENE_TILE_MANIFEST;
+		manifest->SceneId = m_SceneID;
+		manifest->TileSize = c_SceneTileSize;
+		manifest->TileCount = static_cast<unsigned int>(tileCount);
+		memcpy(manifestMessage.data() + sizeof(MsgSceneTileManifest), sceneTileSnapshot.Hashes.data(), sceneTileSnapshot.Hashes.size() * sizeof(unsigned long long));
 
-				for (lineY = 0; lineY < g_SceneMan.GetSceneHeight(); lineY++) {
-					// Save scene fragment data
-					sceneData->DataSize = width;
-					sceneData->UncompressedSize = width;
-					sceneData->Layer = layer;
-					sceneData->X = lineX;
-					sceneData->Y = lineY;
-					sceneData->SceneId = m_SceneID;
+		int payloadSize = static_cast<int>(manifestMessage.size());
+		m_Server->Send(reinterpret_cast<const char *>(manifestMessage.data()), payloadSize, HIGH_PRIORITY, RELIABLE_ORDERED, 0, m_ClientConnections[player].ClientId, false);
 
-					// Compression section
-					int result = 0;
-					//bool lineIsEmpty = false;
+		m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataSentTotal[player] += payloadSize;
 
-					result = LZ4_compress_HC_extStateHC(m_LZ4CompressionState[player], (char *)bmp->line[lineY] + lineX, (char *)(m_PixelLineBuffer[player] + sizeof(MsgSceneLine)), width, width, LZ4HC_CLEVEL_MAX);
+		m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_TerrainDataSentTotal[player] += payloadSize;
 
-					// Compression failed or ineffective, send as is
-					if (result == 0 || result == width) {
-#ifdef _WIN32
-						memcpy_s(m_PixelLineBuffer[player] + sizeof(MsgSceneLine), c_MaxPixelLineBufferSize, bmp->line[lineY] + lineX, width);
-#else
-						memcpy(m_PixelLineBuffer[player] + sizeof(MsgSceneLine), bmp->line[lineY] + lineX, width);
-#endif
-					} else {
-						sceneData->DataSize = result;
-					}
-
-					int payloadSize = sceneData->DataSize + sizeof(MsgSceneLine);
+		m_DataUncompressedCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataUncompressedTotal[player] += payloadSize;
 
-					m_Server->Send((const char *)sceneData, payloadSize, HIGH_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
+		m_SendSceneSetupData[player] = false;
+		m_SendSceneData[player] = false;
+		m_SendFrameData[player] = false;
+	}
 
-					m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-					m_DataSentTotal[player] += payloadSize;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-					m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-					m_TerrainDataSentTotal[player] += payloadSize;
+	void NetworkServer::ReceiveSceneTileRequestMsg(RakNet::Packet *packet) {
+		const MsgSceneTileRequest *msg = reinterpret_cast<const MsgSceneTileRequest *>(packet->data);
+		if (packet->length < sizeof(MsgSceneTileRequest) || msg->SceneId != m_SceneID || packet->length < sizeof(MsgSceneTileRequest) + static_cast<size_t>(msg->HashCount) * sizeof(unsigned long long)) {
+			return;
+		}
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (m_ClientConnections[player].ClientId == packet->systemAddress) {
+				m_Mutex[player].lock();
+				std::vector<unsigned long long> &requestedHashes = m_SceneTileSnapshots[player].RequestedHashes;
+				requestedHashes.resize(msg->HashCount);
+				memcpy(requestedHashes.data(), packet->data + sizeof(MsgSceneTileRequest), requestedHashes.size() * sizeof(unsigned long long));
+				m_SendSceneTiles[player] = true;
+				m_Mutex[player].unlock();
+			}
+		}
+	}
 
-					m_DataUncompressedCurrent[player][STAT_CURRENT] += sceneData->UncompressedSize;
-					m_DataUncompressedTotal[player] += sceneData->UncompressedSize;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-					// Wait for the  messages to leave to avoid congestion
-					if (lineY % 250 == 0) {
-						do {
-							m_Server->GetStatistics(m_ClientConnections[player].ClientId, &rns);
+	void NetworkServer::SendSceneTiles(short player) {
+		SceneTileSnapshot &sceneTileSnapshot = m_SceneTileSnapshots[player];
+		std::vector<unsigned long long> requestedHashes;
+		m_Mutex[player].lock();
+		requestedHashes.swap(sceneTileSnapshot.RequestedHashes);
+		m_SendSceneTiles[player] = false;
+		m_Mutex[player].unlock();
 
-							m_SendBufferBytes[player] = (int)rns.bytesInSendBuffer[MEDIUM_PRIORITY] + (int)rns.bytesInSendBuffer[HIGH_PRIORITY];
-							m_SendBufferMessages[player] = (int)rns.messageInSendBuffer[MEDIUM_PRIORITY] + (int)rns.messageInSendBuffer[HIGH_PRIORITY];
+		// Hashes that aren't in the snapshot came from a request for an older manifest
+		requestedHashes.erase(std::remove_if(requestedHashes.begin(), requestedHashes.end(), [&sceneTileSnapshot](unsigned long long hash) { return sceneTileSnapshot.TileIndices.find(hash) == sceneTileSnapshot.TileIndices.end(); }), requestedHashes.end());
 
-							RakSleep(25);
-						} while (rns.messageInSendBuffer[HIGH_PRIORITY] > 1000 && IsPlayerConnected(player));
+		int layerTileCount = sceneTileSnapshot.Columns * sceneTileSnapshot.Rows;
+		size_t tileMessageSize = sizeof(MsgSceneTile) + static_cast<size_t>(LZ4_compressBound(c_SceneTileSize * c_SceneTileSize));
+		if (m_SceneTileMessages[player].size() < c_SceneTileBatchSize * tileMessageSize) { m_SceneTileMessages[player].resize(c_SceneTileBatchSize * tileMessageSize); }
+		RakNet::RakNetStatistics rns;
 
-						if (!IsPlayerConnected(player)) {
-							break;
-						}
+		// Tiles are compressed a batch at a time on the encoder pool, and each batch is sent in order before the next one is compressed
+		for (int batchStart = 0; batchStart < static_cast<int>(requestedHashes.size()) && IsPlayerConnected(player); batchStart += c_SceneTileBatchSize) {
+			int batchEnd = std::min(batchStart + c_SceneTileBatchSize, static_cast<int>(requestedHashes.size()));
+			int grainSize = std::max((batchEnd - batchStart + m_EncoderPool.GetConcurrency() - 1) / m_EncoderPool.GetConcurrency(), 1);
+			int chunkCount = m_EncoderPool.GetParallelForChunkCount(batchStart, batchEnd, grainSize);
+			while (m_SceneTileLZ4States[player].size() < static_cast<size_t>(chunkCount)) {
+				m_SceneTileLZ4States[player].push_back(malloc(LZ4_sizeofStateHC()));
+			}
+			m_EncoderPool.Wait(m_EncoderPool.ParallelFor(batchStart, batchEnd, grainSize, [this, player, &sceneTileSnapshot, &requestedHashes, layerTileCount, batchStart, tileMessageSize](int chunkStart, int chunkEnd, int chunkIndex) {
+				void *lz4State = m_SceneTileLZ4States[player][chunkIndex];
+				for (int requestIndex = chunkStart; requestIndex < chunkEnd; ++requestIndex) {
+					unsigned long long hash = requestedHashes[requestIndex];
+					int tileIndex = sceneTileSnapshot.TileIndices.at(hash);
+					int tileX = ((tileIndex % layerTileCount) % sceneTileSnapshot.Columns) * c_SceneTileSize;
+					int tileY = ((tileIndex % layerTileCount) / sceneTileSnapshot.Columns) * c_SceneTileSize;
+					int size = std::min(c_SceneTileSize, sceneTileSnapshot.Width - tileX) * std::min(c_SceneTileSize, sceneTileSnapshot.Height - tileY);
+					const unsigned char *tilePixels = &sceneTileSnapshot.Pixels[static_cast<size_t>(tileIndex) * c_SceneTileSize * c_SceneTileSize];
+
+					MsgSceneTile *tileData = reinterpret_cast<MsgSceneTile *>(&m_SceneTileMessages[player][(requestIndex - batchStart) * tileMessageSize]);
+					unsigned char *payload = reinterpret_cast<unsigned char *>(tileData) + sizeof(MsgSceneTile);
+					tileData->Id = ID_SRV_SCENE;
+					tileData->SceneId = m_SceneID;
+					tileData->Hash = hash;
+					tileData->UncompressedSize = size;
+					tileData->DataSize = size;
+
+					int result = LZ4_compress_HC_extStateHC(lz4State, reinterpret_cast<const char *>(tilePixels), reinterpret_cast<char *>(payload), size, size, m_SceneCompressionLevel);
+					// Compression failed or ineffective, send as is
+					if (result <= 0 || result >= size) {
+						memcpy(payload, tilePixels, size);
+					} else {
+						tileData->DataSize = result;
 					}
 				}
-				if (lineX + lineWidth >= g_SceneMan.GetSceneWidth()) {
+			}));
+
+			for (int requestIndex = batchStart; requestIndex < batchEnd; ++requestIndex) {
+				// Only wait when the client can't keep up, and only until there's room again rather than for a fixed time
+				m_Server->GetStatistics(m_ClientConnections[player].ClientId, &rns);
+				while (rns.bytesInSendBuffer[HIGH_PRIORITY] > c_SceneSendBufferBudget && IsPlayerConnected(player)) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					m_Server->GetStatistics(m_ClientConnections[player].ClientId, &rns);
+				}
+				m_SendBufferBytes[player] = static_cast<int>(rns.bytesInSendBuffer[MEDIUM_PRIORITY] + rns.bytesInSendBuffer[HIGH_PRIORITY]);
+				m_SendBufferMessages[player] = static_cast<int>(rns.messageInSendBuffer[MEDIUM_PRIORITY] + rns.messageInSendBuffer[HIGH_PRIORITY]);
+				if (!IsPlayerConnected(player)) {
 					break;
 				}
-			}
-			release_bitmap(bmp);
-		}
 
-		m_SceneLock[player].unlock();
+				const MsgSceneTile *tileData = reinterpret_cast<const MsgSceneTile *>(&m_SceneTileMessages[player][(requestIndex - batchStart) * tileMessageSize]);
+				int payloadSize = static_cast<int>(sizeof(MsgSceneTile)) + tileData->DataSize;
+				// Ordered, so the scene end message can't overtake any of the tiles
+				m_Server->Send(reinterpret_cast<const char *>(tileData), payloadSize, HIGH_PRIORITY, RELIABLE_ORDERED, 0, m_ClientConnections[player].ClientId, false);
 
-		m_SendSceneSetupData[player] = false;
-		m_SendSceneData[player] = false;
-		m_SendFrameData[player] = false;
+				m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_DataSentTotal[player] += payloadSize;
+
+				m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_TerrainDataSentTotal[player] += payloadSize;
+
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += tileData->UncompressedSize;
+				m_DataUncompressedTotal[player] += tileData->UncompressedSize;
+			}
+		}
+		// Free the snapshot, but leave RequestedHashes alone since a request can arrive at any time
+		sceneTileSnapshot.Pixels = std::vector<unsigned char>();
+		sceneTileSnapshot.Hashes = std::vector<unsigned long long>();
+		sceneTileSnapshot.TileIndices.clear();
 
 		SendSceneEndMsg(player);
 	}
@@ -874,159 +1110,191 @@ namespace RTE {
 
 	void NetworkServer::ClearTerrainChangeQueue(short player) {
 		m_Mutex[player].lock();
-		while (!m_PendingTerrainChanges[player].empty()) {
-			m_PendingTerrainChanges[player].pop();
-		}
-		while (!m_CurrentTerrainChanges[player].empty()) {
-			m_CurrentTerrainChanges[player].pop();
-		}
+		m_PendingTerrainDeltas[player].clear();
 		m_Mutex[player].unlock();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool NetworkServer::NeedToProcessTerrainChanges(short player) {
-		bool result;
-
-		m_Mutex[player].lock();
-		result = !m_PendingTerrainChanges[player].empty();
-		m_Mutex[player].unlock();
-
-		return result;
+	void NetworkServer::ResetTerrainShadow() {
+		Scene *scene = g_SceneMan.GetScene();
+		SLTerrain *terrain = scene ? scene->GetTerrain() : nullptr;
+		if (!m_IsInServerMode || !terrain) {
+			for (std::vector<unsigned char> &terrainShadowLayer : m_TerrainShadow) {
+				terrainShadowLayer = std::vector<unsigned char>();
+			}
+			m_TerrainShadowWidth = 0;
+			m_TerrainShadowHeight = 0;
+			m_TerrainDeltaColumns = 0;
+			m_TerrainDeltaRows = 0;
+			m_DirtyTerrainTiles.clear();
+			m_DirtyTerrainTileIndices.clear();
+			return;
+		}
+		const BITMAP *layerBitmaps[2] = { terrain->GetBGColorBitmap(), terrain->GetFGColorBitmap() };
+		m_TerrainShadowWidth = layerBitmaps[0]->w;
+		m_TerrainShadowHeight = layerBitmaps[0]->h;
+		for (int layer = 0; layer < 2; ++layer) {
+			m_TerrainShadow[layer].resize(static_cast<size_t>(m_TerrainShadowWidth) * m_TerrainShadowHeight);
+			for (int line = 0; line < m_TerrainShadowHeight; ++line) {
+				memcpy(&m_TerrainShadow[layer][static_cast<size_t>(line) * m_TerrainShadowWidth], layerBitmaps[layer]->line[line], m_TerrainShadowWidth);
+			}
+		}
+		m_TerrainDeltaColumns = (m_TerrainShadowWidth + c_TerrainDeltaTileSize - 1) / c_TerrainDeltaTileSize;
+		m_TerrainDeltaRows = (m_TerrainShadowHeight + c_TerrainDeltaTileSize - 1) / c_TerrainDeltaTileSize;
+		m_DirtyTerrainTiles.assign(static_cast<size_t>(m_TerrainDeltaColumns) * m_TerrainDeltaRows * 2, 0);
+		m_DirtyTerrainTileIndices.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void NetworkServer::ProcessTerrainChanges(short player) {
-		m_Mutex[player].lock();
-		while (!m_PendingTerrainChanges[player].empty()) {
-			m_CurrentTerrainChanges[player].push(m_PendingTerrainChanges[player].front());
-			m_PendingTerrainChanges[player].pop();
+	void NetworkServer::EncodeTerrainChanges() {
+		if (m_DirtyTerrainTileIndices.empty()) {
+			return;
 		}
-		m_Mutex[player].unlock();
+		Scene *scene = g_SceneMan.GetScene();
+		SLTerrain *terrain = scene ? scene->GetTerrain() : nullptr;
+		if (!terrain || terrain->GetBGColorBitmap()->w != m_TerrainShadowWidth || terrain->GetBGColorBitmap()->h != m_TerrainShadowHeight) {
+			ResetTerrainShadow();
+			return;
+		}
+		// Encoding doesn't affect the sim, so its Jobs don't take child keys from the sim stream either, or running a server would change the sim's random numbers.
+		RandomStreamScope effectsStreamScope(RandomStreams::EffectsStream);
+		int dirtyTileCount = static_cast<int>(m_DirtyTerrainTileIndices.size());
+		size_t terrainDeltaMessageSize = sizeof(MsgTerrainChange) + static_cast<size_t>(LZ4_compressBound(c_TerrainDeltaMaxDataSize));
+		std::shared_ptr<TerrainDeltaBatch> terrainDeltaBatch = std::make_shared<TerrainDeltaBatch>();
+		terrainDeltaBatch->Messages.resize(dirtyTileCount * terrainDeltaMessageSize);
+		terrainDeltaBatch->MessageSizes.resize(dirtyTileCount);
+
+		// Every tile only touches its own part of the shadow, so they're spread over the worker threads. Each chunk gets its own compression state
+		int grainSize = std::max((dirtyTileCount + g_ThreadMan.GetConcurrency() - 1) / g_ThreadMan.GetConcurrency(), 16);
+		int chunkCount = g_ThreadMan.GetParallelForChunkCount(0, dirtyTileCount, grainSize);
+		while (m_TerrainDeltaLZ4States.size() < static_cast<size_t>(chunkCount)) {
+			m_TerrainDeltaLZ4States.push_back(malloc(LZ4_sizeofState()));
+		}
+		g_ThreadMan.Wait(g_ThreadMan.ParallelFor(0, dirtyTileCount, grainSize, [this, &terrainDeltaBatch, terrainDeltaMessageSize](int chunkStart, int chunkEnd, int chunkIndex) {
+			for (int dirtyTile = chunkStart; dirtyTile < chunkEnd; ++dirtyTile) {
+				MsgTerrainChange *msg = reinterpret_cast<MsgTerrainChange *>(&terrainDeltaBatch->Messages[dirtyTile * terrainDeltaMessageSize]);
+				terrainDeltaBatch->MessageSizes[dirtyTile] = EncodeTerrainDelta(m_DirtyTerrainTileIndices[dirtyTile], msg, m_TerrainDeltaLZ4States[chunkIndex]);
+			}
+		}));
 
-		while (!m_CurrentTerrainChanges[player].empty()) {
-			int maxSize = 1280;
-
-			SceneMan::TerrainChange terrainChange = m_CurrentTerrainChanges[player].front();
-			m_CurrentTerrainChanges[player].pop();
-
-			// Fragment region if it does not fit one packet
-			if (terrainChange.w * terrainChange.h > maxSize) {
-				int size = 0;
-				int height = 1;
-				int heightStart = 0;
-
-				for (int y = 0; y < terrainChange.h; y++) {
-					height++;
-					size += terrainChange.w;
-
-					// Store changed block if the size is over the MTU or if it's the last block.
-					if (size + terrainChange.w >= maxSize || y == terrainChange.h - 1) {
-						SceneMan::TerrainChange tcf;
-						tcf.x = terrainChange.x;
-						tcf.y = terrainChange.y + heightStart;
-						tcf.w = terrainChange.w;
-						tcf.h = height;
-						tcf.back = terrainChange.back;
-						tcf.color = terrainChange.color;
-
-						SendTerrainChangeMsg(player, tcf);
-
-						size = 0;
-						heightStart = y;
-						height = 1;
-					}
-				}
-			} else {
-				SendTerrainChangeMsg(player, terrainChange);
+		for (int tileIndex : m_DirtyTerrainTileIndices) {
+			m_DirtyTerrainTiles[tileIndex] = 0;
+		}
+		m_DirtyTerrainTileIndices.clear();
+
+		if (std::none_of(terrainDeltaBatch->MessageSizes.begin(), terrainDeltaBatch->MessageSizes.end(), [](int messageSize) { return messageSize > 0; })) {
+			return;
+		}
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (IsPlayerConnected(player)) {
+				m_Mutex[player].lock();
+				m_PendingTerrainDeltas[player].emplace_back(terrainDeltaBatch);
+				m_Mutex[player].unlock();
 			}
 		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void NetworkServer::SendTerrainChangeMsg(short player, SceneMan::TerrainChange terrainChange) {
-		if (terrainChange.w == 1 && terrainChange.h == 1) {
-			MsgTerrainChange msg;
-			msg.Id = ID_SRV_TERRAIN;
-			msg.X = terrainChange.x;
-			msg.Y = terrainChange.y;
-			msg.W = terrainChange.w;
-			msg.H = terrainChange.h;
-			msg.DataSize = 0;
-			msg.UncompressedSize = 0;
-			msg.SceneId = m_SceneID;
-			msg.Color = terrainChange.color;
-			msg.Back = terrainChange.back;
-
-			int payloadSize = sizeof(MsgTerrainChange);
-
-			m_Server->Send((const char *)&msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
-
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
-
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
+	int NetworkServer::EncodeTerrainDelta(int tileIndex, MsgTerrainChange *msg, void *lz4State) {
+		int layerTileCount = m_TerrainDeltaColumns * m_TerrainDeltaRows;
+		int layer = tileIndex / layerTileCount;
+		int tileX = ((tileIndex % layerTileCount) % m_TerrainDeltaColumns) * c_TerrainDeltaTileSize;
+		int tileY = ((tileIndex % layerTileCount) / m_TerrainDeltaColumns) * c_TerrainDeltaTileSize;
+		int tileWidth = std::min(c_TerrainDeltaTileSize, m_TerrainShadowWidth - tileX);
+		int tileHeight = std::min(c_TerrainDeltaTileSize, m_TerrainShadowHeight - tileY);
+
+		SLTerrain *terrain = g_SceneMan.GetScene()->GetTerrain();
+		const BITMAP *layerBitmap = (layer == 0) ? terrain->GetBGColorBitmap() : terrain->GetFGColorBitmap();
+
+		// A bitmask of which pixels changed followed by just the changed colors. Unchanged pixels cost a bit each before compression and next to nothing after
+		std::array<unsigned char, c_TerrainDeltaMaxDataSize> deltaData;
+		int maskSize = (tileWidth * tileHeight + 7) / 8;
+		std::fill_n(deltaData.begin(), maskSize, 0);
+		int dataSize = maskSize;
+		for (int line = 0; line < tileHeight; ++line) {
+			const unsigned char *terrainPixels = layerBitmap->line[tileY + line] + tileX;
+			unsigned char *shadowPixels = &m_TerrainShadow[layer][static_cast<size_t>(tileY + line) * m_TerrainShadowWidth + tileX];
+			if (memcmp(terrainPixels, shadowPixels, tileWidth) == 0) {
+				continue;
+			}
+			for (int pixel = 0; pixel < tileWidth; ++pixel) {
+				if (terrainPixels[pixel] != shadowPixels[pixel]) {
+					int maskBit = line * tileWidth + pixel;
+					deltaData[maskBit / 8] |= static_cast<unsigned char>(1 << (maskBit % 8));
+					deltaData[dataSize++] = terrainPixels[pixel];
+					shadowPixels[pixel] = terrainPixels[pixel];
+				}
+			}
+		}
+		if (dataSize == maskSize) {
+			return 0;
+		}
 
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataUncompressedTotal[player] += payloadSize;
+		msg->Id = ID_SRV_TERRAIN;
+		msg->X = tileX;
+		msg->Y = tileY;
+		msg->W = tileWidth;
+		msg->H = tileHeight;
+		msg->Back = layer == 0;
+		msg->SceneId = m_SceneID;
+		msg->UncompressedSize = dataSize;
+		msg->DataSize = dataSize;
+
+		unsigned char *payload = reinterpret_cast<unsigned char *>(msg) + sizeof(MsgTerrainChange);
+		int result = LZ4_compress_fast_extState(lz4State, reinterpret_cast<const char *>(deltaData.data()), reinterpret_cast<char *>(payload), dataSize, LZ4_compressBound(c_TerrainDeltaMaxDataSize), 1);
+		// Compression failed or ineffective, send as is
+		if (result <= 0 || result >= dataSize) {
+			memcpy(payload, deltaData.data(), dataSize);
 		} else {
-			MsgTerrainChange *msg = (MsgTerrainChange *)m_PixelLineBuffer[player];
-			msg->Id = ID_SRV_TERRAIN;
-			msg->X = terrainChange.x;
-			msg->Y = terrainChange.y;
-			msg->W = terrainChange.w;
-			msg->H = terrainChange.h;
-			int size = msg->W * msg->H;
-			msg->DataSize = size;
-			msg->UncompressedSize = size;
-			msg->SceneId = m_SceneID;
-			msg->Color = terrainChange.color;
-			msg->Back = terrainChange.back;
-
-			Scene * scene = g_SceneMan.GetScene();
-			SLTerrain * terrain = scene->GetTerrain();
+			msg->DataSize = result;
+		}
+		return static_cast<int>(sizeof(MsgTerrainChange)) + msg->DataSize;
+	}
 
-			const BITMAP *bmp = 0;
-			bmp = msg->Back ? terrain->GetBGColorBitmap() : terrain->GetFGColorBitmap();
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			unsigned char *dest = (unsigned char *)(m_TerrainChangeBuffer[player]);
+	bool NetworkServer::NeedToProcessTerrainChanges(short player) {
+		bool result;
 
-			// Copy bitmap data
-			for (int y = 0; y < msg->H && msg->Y + y < bmp->h; y++) {
-				memcpy(dest, bmp->line[msg->Y + y] + msg->X, msg->W);
-				dest += msg->W;
-			}
+		m_Mutex[player].lock();
+		result = !m_PendingTerrainDeltas[player].empty();
+		m_Mutex[player].unlock();
 
-			int result = 0;
+		return result;
+	}
 
-			result = LZ4_compress_HC_extStateHC(m_LZ4CompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange)), size, size, LZ4HC_CLEVEL_OPT_MIN);
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Compression failed or ineffective, send as is
-			if (result == 0 || result == size) {
-#ifdef _WIN32
-				memcpy_s(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange), c_MaxPixelLineBufferSize, m_TerrainChangeBuffer[player], size);
-#else
-				memcpy(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange), m_TerrainChangeBuffer[player], size);
-#endif
-			} else {
-				msg->DataSize = result;
-			}
+	void NetworkServer::ProcessTerrainChanges(short player) {
+		std::deque<std::shared_ptr<const TerrainDeltaBatch>> terrainDeltaBatches;
+		m_Mutex[player].lock();
+		terrainDeltaBatches.swap(m_PendingTerrainDeltas[player]);
+		m_Mutex[player].unlock();
 
-			int payloadSize = sizeof(MsgTerrainChange) + msg->DataSize;
+		size_t terrainDeltaMessageSize = sizeof(MsgTerrainChange) + static_cast<size_t>(LZ4_compressBound(c_TerrainDeltaMaxDataSize));
+		for (const std::shared_ptr<const TerrainDeltaBatch> &terrainDeltaBatch : terrainDeltaBatches) {
+			for (size_t messageIndex = 0; messageIndex < terrainDeltaBatch->MessageSizes.size(); ++messageIndex) {
+				int payloadSize = terrainDeltaBatch->MessageSizes[messageIndex];
+				if (payloadSize == 0) {
+					continue;
+				}
+				const MsgTerrainChange *msg = reinterpret_cast<const MsgTerrainChange *>(&terrainDeltaBatch->Messages[messageIndex * terrainDeltaMessageSize]);
 
-			m_Server->Send((const char *)msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
+				// Ordered on a channel of their own, so a later change to a tile can't be overwritten by an earlier one without holding up anything else
+				m_Server->Send(reinterpret_cast<const char *>(msg), payloadSize, MEDIUM_PRIORITY, RELIABLE_ORDERED, c_TerrainDeltaChannel, m_ClientConnections[player].ClientId, false);
 
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
+				m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_DataSentTotal[player] += payloadSize;
 
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
+				m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_TerrainDataSentTotal[player] += payloadSize;
 
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->UncompressedSize;
-			m_DataUncompressedTotal[player] += msg->UncompressedSize;
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->W * msg->H;
+				m_DataUncompressedTotal[player] += msg->W * msg->H;
+			}
 		}
 	}
 
@@ -1069,6 +1337,7 @@ namespace RTE {
 		MsgFrameSetup msgFrameSetup;
 		msgFrameSetup.Id = ID_SRV_FRAME_SETUP;
 		msgFrameSetup.FrameNumber = m_FrameNumbers[player];
+		msgFrameSetup.FrameSequence = m_FrameSequences[player];
 		msgFrameSetup.TargetPosX = g_FrameMan.GetTargetPos(player).m_X;
 		msgFrameSetup.TargetPosY = g_FrameMan.GetTargetPos(player).m_Y;
 
@@ -1076,8 +1345,9 @@ namespace RTE {
 			msgFrameSetup.OffsetX[i] = g_FrameMan.SLOffset[player][i].m_X;
 			msgFrameSetup.OffsetY[i] = g_FrameMan.SLOffset[player][i].m_Y;
 		}
+		msgFrameSetup.EntityReplication = m_UseEntityReplication;
 
-		int payloadSize = sizeof(MsgSceneSetup);
+		int payloadSize = sizeof(MsgFrameSetup);
 
 		m_Server->Send((const char *)&msgFrameSetup, payloadSize, MEDIUM_PRIORITY, RELIABLE_ORDERED, 0, m_ClientConnections[player].ClientId, false);
 
@@ -1183,18 +1453,21 @@ namespace RTE {
 			if (m_BackBuffer8[player]->w != frameManBmp->w || m_BackBuffer8[player]->h != frameManBmp->h) {
 				DestroyBackBuffer(player);
 				CreateBackBuffer(player, frameManBmp->w, frameManBmp->h);
+				ResetFrameBoxHistory(player);
 				//g_ConsoleMan.PrintString("SERVER: Backbuffer recreated");
 			}
 		}
 
 		m_FrameNumbers[player]++;
 		if (m_FrameNumbers[player] >= c_FramesToRemember) { m_FrameNumbers[player] = 0; }
+		m_FrameSequences[player]++;
 
 		// Save a copy of buffer to avoid tearing when the original is updated by frame man
 		blit(frameManBmp, m_BackBuffer8[player], 0, 0, 0, 0, frameManBmp->w, frameManBmp->h);
 		blit(frameManGUIBmp, m_BackBufferGUI8[player], 0, 0, 0, 0, frameManGUIBmp->w, frameManGUIBmp->h);
 
 		SendFrameSetupMsg(player);
+		if (m_UseEntityReplication) { SendEntitySnapshot(player); }
 		SendPostEffectData(player);
 		SendSoundData(player);
 		SendMusicData(player);
@@ -1208,17 +1481,33 @@ namespace RTE {
 		m_SendEven[player] = !m_SendEven[player];
 
 		if (m_TransmitAsBoxes) {
-			MsgFrameBox *frameData = (MsgFrameBox *)m_PixelLineBuffer[player];
-			frameData->FrameNumber = m_FrameNumbers[player];
-
-			// Save message ID
-			frameData->Id = ID_SRV_FRAME_BOX;
-			frameData->BoxWidth = m_BoxWidth;
-			frameData->BoxHeight = m_BoxHeight;
-
 			int bw = m_BackBuffer8[player]->w / m_BoxWidth;
 			int bh = m_BackBuffer8[player]->h / m_BoxHeight;
 
+			int boxStride = m_BoxWidth * m_BoxHeight;
+			SentFrameBoxes sentFrame;
+			sentFrame.FrameSequence = m_FrameSequences[player];
+
+			if (m_UseDeltaCompression) {
+				ProcessFrameBoxAcks(player);
+
+				int boxColumns = (m_BackBuffer8[player]->w + m_BoxWidth - 1) / m_BoxWidth;
+				int boxCount = boxColumns * ((m_BackBuffer8[player]->h + m_BoxHeight - 1) / m_BoxHeight);
+				if (m_FrameBoxColumns[player] != boxColumns || m_FrameBoxHistory[player][0].Hashes.size() != static_cast<size_t>(boxCount)) {
+					ResetFrameBoxHistory(player);
+					m_FrameBoxColumns[player] = boxColumns;
+					for (FrameBoxHistory &frameBoxHistory : m_FrameBoxHistory[player]) {
+						frameBoxHistory.Pixels.assign(boxCount * boxStride, 0);
+						frameBoxHistory.Hashes.assign(boxCount, 0);
+						frameBoxHistory.Sequences.assign(boxCount, 0);
+						frameBoxHistory.ChainStarts.assign(boxCount, 0);
+					}
+				}
+			}
+
+			// Gather up every box of both layers that's due this frame, in the order they get sent
+			std::vector<FrameBoxJob> &frameBoxJobs = m_FrameBoxJobs[player];
+			frameBoxJobs.clear();
 			for (int by = 0; by <= bh; by++) {
 				int step = 1;
 				int startLine = 0;
@@ -1239,114 +1528,62 @@ namespace RTE {
 					if (bpx >= m_BackBuffer8[player]->w || bpy >= m_BackBuffer8[player]->h) {
 						break;
 					}
-
-					frameData->BoxX = bpx;
-					frameData->BoxY = bpy;
-
-					int maxWidth = m_BoxWidth;
-					if (bpx + m_BoxWidth >= m_BackBuffer8[player]->w) {
-						maxWidth = m_BackBuffer8[player]->w - bpx;
-						frameData->BoxWidth = maxWidth;
-					}
-
-					int maxHeight = m_BoxHeight;
-					if (bpy + m_BoxHeight >= m_BackBuffer8[player]->h) {
-						maxHeight = m_BackBuffer8[player]->h - bpy;
-						frameData->BoxHeight = maxHeight;
-					}
-
-					int size = maxWidth * maxHeight;
-					frameData->UncompressedSize = size;
-					frameData->DataSize = size;
+					int maxWidth = std::min(m_BoxWidth, m_BackBuffer8[player]->w - bpx);
+					int maxHeight = std::min(m_BoxHeight, m_BackBuffer8[player]->h - bpy);
 
 					for (int layer = 0; layer < 2; layer++) {
-						bool boxIsEmpty = true;
-						int line = 0;
-
-						const BITMAP *backBuffer = 0;
-						if (layer == 0) {
-							backBuffer = m_BackBuffer8[player];
-						} else if (layer == 1) {
-							backBuffer = m_BackBufferGUI8[player];
-						}
-
-						frameData->Layer = layer;
-
-						unsigned char *dest = (unsigned char *)(m_TerrainChangeBuffer[player]);
-
-						// Copy block to line buffer and also check if block is empty
-						for (line = 0; line < maxHeight; line++) {
-							// Copy bitmap data
-							memcpy(dest, backBuffer->line[bpy + line] + bpx, maxWidth);
-							dest += maxWidth;
-						}
-
-						// Check if block is empty
-						unsigned long *pixelInt = (unsigned long *)m_TerrainChangeBuffer[player];
-						int counter = 0;
-
-						for (counter = 0; counter < size; counter += sizeof(unsigned long)) {
-							if (*pixelInt > 0) {
-								boxIsEmpty = false;
-								break;
-							}
-							pixelInt++;
-						}
-						if (boxIsEmpty && counter > size) {
-							pixelInt--;
-							counter -= sizeof(unsigned long);
-
-							const unsigned char *pixelChr = (unsigned char *)pixelInt;
-							for (; counter < size; counter++) {
-								if (*pixelChr > 0) {
-									boxIsEmpty = false;
-									break;
-								}
-								pixelChr++;
-							}
-						}
-
-						if (!boxIsEmpty) {
-							int result = 0;
-
-							if (m_UseHighCompression) {
-								result = LZ4_compress_HC_extStateHC(m_LZ4CompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgFrameBox)), size, size, compressionMethod);
-							} else if (m_UseFastCompression) {
-								result = LZ4_compress_fast_extState(m_LZ4FastCompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgFrameBox)), size, size, accelerationFactor);
-							}
-
-							// Compression failed or ineffective, send as is
-							if (result == 0 || result == backBuffer->w) {
-#ifdef _WIN32
-								memcpy_s(m_PixelLineBuffer[player] + sizeof(MsgFrameBox), c_MaxPixelLineBufferSize, m_TerrainChangeBuffer[player], size);
-#else
-								memcpy(m_PixelLineBuffer[player] + sizeof(MsgFrameBox), m_TerrainChangeBuffer[player], size);
-#endif
-							} else {
-								frameData->DataSize = result;
-							}
-
-							m_FullBlocks[player]++;
-						} else {
-							frameData->DataSize = 0;
-							m_EmptyBlocks[player]++;
-						}
+						frameBoxJobs.push_back({ bpx, bpy, maxWidth, maxHeight, layer, by * m_FrameBoxColumns[player] + bx, 0, false });
+					}
+				}
+			}
 
-						int payloadSize = frameData->DataSize + sizeof(MsgFrameBox);
+			// Every box is encoded independently, so they're spread over the encoder pool. Each chunk gets its own compression state and scratch space
+			int boxJobCount = static_cast<int>(frameBoxJobs.size());
+			int grainSize = std::max((boxJobCount + m_EncoderPool.GetConcurrency() - 1) / m_EncoderPool.GetConcurrency(), 1);
+			int chunkCount = m_EncoderPool.GetParallelForChunkCount(0, boxJobCount, grainSize);
+			size_t frameBoxMessageSize = sizeof(MsgFrameBox) + boxStride;
+			if (m_FrameBoxMessages[player].size() < boxJobCount * frameBoxMessageSize) { m_FrameBoxMessages[player].resize(boxJobCount * frameBoxMessageSize); }
+			while (m_FrameBoxEncoders[player].size() < static_cast<size_t>(chunkCount)) {
+				m_FrameBoxEncoders[player].push_back({ malloc(std::max(LZ4_sizeofStateHC(), LZ4_sizeofState())), std::vector<unsigned char>(boxStride) });
+			}
+			m_EncoderPool.Wait(m_EncoderPool.ParallelFor(0, boxJobCount, grainSize, [this, player, boxStride, frameBoxMessageSize](int chunkStart, int chunkEnd, int chunkIndex) {
+				FrameBoxEncoder &frameBoxEncoder = m_FrameBoxEncoders[player][chunkIndex];
+				if (frameBoxEncoder.BoxPixels.size() < static_cast<size_t>(boxStride)) { frameBoxEncoder.BoxPixels.resize(boxStride); }
+				for (int jobIndex = chunkStart; jobIndex < chunkEnd; ++jobIndex) {
+					EncodeFrameBox(player, m_FrameBoxJobs[player][jobIndex], reinterpret_cast<MsgFrameBox *>(&m_FrameBoxMessages[player][jobIndex * frameBoxMessageSize]), frameBoxEncoder);
+				}
+			}));
+
+			// Send the encoded boxes in order, so interlacing and the client's frame acknowledgements see the same sequence as before
+			for (int jobIndex = 0; jobIndex < boxJobCount; ++jobIndex) {
+				const FrameBoxJob &frameBoxJob = frameBoxJobs[jobIndex];
+				int uncompressedSize = frameBoxJob.Width * frameBoxJob.Height;
+				if (frameBoxJob.PayloadSize == 0) {
+					m_UnchangedBlocks[player]++;
+					m_DataUncompressedCurrent[player][STAT_CURRENT] += uncompressedSize;
+					m_DataUncompressedTotal[player] += uncompressedSize;
+					continue;
+				}
+				if (frameBoxJob.IsEmpty) {
+					m_EmptyBlocks[player]++;
+				} else {
+					m_FullBlocks[player]++;
+				}
+				if (m_UseDeltaCompression) { sentFrame.Boxes.emplace_back(frameBoxJob.Layer, frameBoxJob.BoxIndex); }
 
-						m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
+				int payloadSize = frameBoxJob.PayloadSize;
+				m_Server->Send(reinterpret_cast<const char *>(&m_FrameBoxMessages[player][jobIndex * frameBoxMessageSize]), payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
 
-						m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_DataSentTotal[player] += payloadSize;
+				m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_DataSentTotal[player] += payloadSize;
 
-						m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_FrameDataSentTotal[player] += payloadSize;
+				m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_FrameDataSentTotal[player] += payloadSize;
 
-						m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
-						m_DataUncompressedTotal[player] += frameData->UncompressedSize;
-					}
-				}
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += uncompressedSize;
+				m_DataUncompressedTotal[player] += uncompressedSize;
 			}
+			if (!sentFrame.Boxes.empty()) { m_UnacknowledgedFrames[player].emplace_back(std::move(sentFrame)); }
 		} else {
 			MsgFrameLine *frameData = (MsgFrameLine *)m_PixelLineBuffer[player];
 			frameData->FrameNumber = m_FrameNumbers[player];
@@ -1461,6 +1698,339 @@ namespace RTE {
 		return 0;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::EncodeFrameBox(short player, FrameBoxJob &frameBoxJob, MsgFrameBox *frameData, FrameBoxEncoder &frameBoxEncoder) {
+		const BITMAP *backBuffer = (frameBoxJob.Layer == 0) ? m_BackBuffer8[player] : m_BackBufferGUI8[player];
+		int size = frameBoxJob.Width * frameBoxJob.Height;
+		unsigned char *boxPixels = frameBoxEncoder.BoxPixels.data();
+		for (int line = 0; line < frameBoxJob.Height; line++) {
+			memcpy(boxPixels + line * frameBoxJob.Width, backBuffer->line[frameBoxJob.BoxY + line] + frameBoxJob.BoxX, frameBoxJob.Width);
+		}
+
+		frameData->Id = ID_SRV_FRAME_BOX;
+		frameData->FrameNumber = m_FrameNumbers[player];
+		frameData->FrameSequence = m_FrameSequences[player];
+		frameData->Layer = frameBoxJob.Layer;
+		frameData->BoxX = frameBoxJob.BoxX;
+		frameData->BoxY = frameBoxJob.BoxY;
+		frameData->BoxWidth = frameBoxJob.Width;
+		frameData->BoxHeight = frameBoxJob.Height;
+		frameData->UncompressedSize = size;
+		frameData->DataSize = size;
+		frameData->ReferenceSequence = 0;
+
+		if (m_UseDeltaCompression) {
+			// Each box has its own slot in the history, so boxes can be compared and updated from any thread
+			FrameBoxHistory &frameBoxHistory = m_FrameBoxHistory[player][frameBoxJob.Layer];
+			unsigned long long boxHash = HashFrameBox(boxPixels, size);
+
+			// The client already has exactly this, or will find out it doesn't through the acknowledgements and have the box sent again
+			if (boxHash == frameBoxHistory.Hashes[frameBoxJob.BoxIndex]) {
+				frameBoxJob.PayloadSize = 0;
+				return;
+			}
+			unsigned char *sentPixels = &frameBoxHistory.Pixels[frameBoxJob.BoxIndex * m_BoxWidth * m_BoxHeight];
+			frameData->ReferenceSequence = frameBoxHistory.Sequences[frameBoxJob.BoxIndex];
+			if (frameData->ReferenceSequence != 0) {
+				// XOR against what the client has, so only the changed pixels are non-zero and compress to next to nothing
+				for (int pixel = 0; pixel < size; ++pixel) {
+					unsigned char sentPixel = sentPixels[pixel];
+					sentPixels[pixel] = boxPixels[pixel];
+					boxPixels[pixel] ^= sentPixel;
+				}
+			} else {
+				memcpy(sentPixels, boxPixels, size);
+				frameBoxHistory.ChainStarts[frameBoxJob.BoxIndex] = m_FrameSequences[player];
+			}
+			frameBoxHistory.Hashes[frameBoxJob.BoxIndex] = boxHash;
+			frameBoxHistory.Sequences[frameBoxJob.BoxIndex] = m_FrameSequences[player];
+		}
+
+		// An empty delta would mean the box didn't change, which the hash should've caught, but the client still needs to know it got it
+		frameBoxJob.IsEmpty = frameData->ReferenceSequence == 0 && IsFrameBoxEmpty(boxPixels, size);
+		if (frameBoxJob.IsEmpty) {
+			frameData->DataSize = 0;
+		} else {
+			unsigned char *payload = reinterpret_cast<unsigned char *>(frameData) + sizeof(MsgFrameBox);
+			int result = 0;
+			if (m_UseHighCompression) {
+				result = LZ4_compress_HC_extStateHC(frameBoxEncoder.LZ4State, reinterpret_cast<const char *>(boxPixels), reinterpret_cast<char *>(payload), size, size, m_HighCompressionLevel);
+			} else if (m_UseFastCompression) {
+				result = LZ4_compress_fast_extState(frameBoxEncoder.LZ4State, reinterpret_cast<const char *>(boxPixels), reinterpret_cast<char *>(payload), size, size, m_FastAccelerationFactor);
+			}
+			// Compression failed or ineffective, send as is
+			if (result <= 0 || result >= size) {
+				memcpy(payload, boxPixels, size);
+			} else {
+				frameData->DataSize = result;
+			}
+		}
+		frameBoxJob.PayloadSize = static_cast<int>(sizeof(MsgFrameBox)) + frameData->DataSize;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkServer::IsFrameBoxEmpty(const unsigned char *boxData, int size) {
+		int pixel = 0;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		// OR 16 pixels at a time together and only check the result once, empty boxes have to be read all the way through anyway
+		__m128i combinedPixels = _mm_setzero_si128();
+		for (; pixel + 16 <= size; pixel += 16) {
+			combinedPixels = _mm_or_si128(combinedPixels, _mm_loadu_si128(reinterpret_cast<const __m128i *>(boxData + pixel)));
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(combinedPixels, _mm_setzero_si128())) != 0xFFFF) {
+			return false;
+		}
+#else
+		unsigned long long combinedPixels = 0;
+		for (; pixel + static_cast<int>(sizeof(unsigned long long)) <= size; pixel += sizeof(unsigned long long)) {
+			unsigned long long pixels;
+			memcpy(&pixels, boxData + pixel, sizeof(unsigned long long));
+			combinedPixels |= pixels;
+		}
+		if (combinedPixels != 0) {
+			return false;
+		}
+#endif
+		for (; pixel < size; ++pixel) {
+			if (boxData[pixel] != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ReceiveFrameBoxAckMsg(RakNet::Packet *packet) {
+		if (packet->length < sizeof(MsgFrameBoxAck)) {
+			return;
+		}
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (m_ClientConnections[player].ClientId == packet->systemAddress) {
+				m_Mutex[player].lock();
+				m_PendingFrameBoxAcks[player].push(*reinterpret_cast<const MsgFrameBoxAck *>(packet->data));
+				m_Mutex[player].unlock();
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ProcessFrameBoxAcks(short player) {
+		std::queue<MsgFrameBoxAck> frameBoxAcks;
+		m_Mutex[player].lock();
+		frameBoxAcks.swap(m_PendingFrameBoxAcks[player]);
+		m_Mutex[player].unlock();
+
+		std::deque<SentFrameBoxes> &unacknowledgedFrames = m_UnacknowledgedFrames[player];
+		for (; !frameBoxAcks.empty(); frameBoxAcks.pop()) {
+			const MsgFrameBoxAck &frameBoxAck = frameBoxAcks.front();
+			// Acknowledgements arrive in order, so any older frame still waiting never got acknowledged and has to be assumed lost
+			while (!unacknowledgedFrames.empty() && unacknowledgedFrames.front().FrameSequence <= frameBoxAck.FrameSequence) {
+				const SentFrameBoxes &sentFrame = unacknowledgedFrames.front();
+				if (sentFrame.FrameSequence < frameBoxAck.FrameSequence || sentFrame.Boxes.size() != frameBoxAck.BoxCount) { InvalidateFrameBoxes(player, sentFrame); }
+				unacknowledgedFrames.pop_front();
+			}
+		}
+		while (unacknowledgedFrames.size() > c_MaxUnacknowledgedFrames) {
+			InvalidateFrameBoxes(player, unacknowledgedFrames.front());
+			unacknowledgedFrames.pop_front();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::InvalidateFrameBoxes(short player, const SentFrameBoxes &sentFrame) {
+		for (const auto &[layer, boxIndex] : sentFrame.Boxes) {
+			FrameBoxHistory &frameBoxHistory = m_FrameBoxHistory[player][layer];
+			// There's no telling which boxes the client dropped, but boxes sent whole since the lost frame don't depend on it anymore
+			if (static_cast<size_t>(boxIndex) < frameBoxHistory.Hashes.size() && frameBoxHistory.ChainStarts[boxIndex] <= sentFrame.FrameSequence) {
+				frameBoxHistory.Hashes[boxIndex] = 0;
+				frameBoxHistory.Sequences[boxIndex] = 0;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ResetFrameBoxHistory(short player) {
+		for (FrameBoxHistory &frameBoxHistory : m_FrameBoxHistory[player]) {
+			std::fill(frameBoxHistory.Hashes.begin(), frameBoxHistory.Hashes.end(), 0);
+			std::fill(frameBoxHistory.Sequences.begin(), frameBoxHistory.Sequences.end(), 0);
+		}
+		m_UnacknowledgedFrames[player].clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	unsigned long long NetworkServer::HashFrameBox(const unsigned char *boxData, int size) {
+		// FNV-1a over 8 byte words, folding the high half back down after each word since the multiplication only carries changes upwards. Then the leftover bytes
+		unsigned long long hash = 14695981039346656037ULL;
+		int wordCount = size / static_cast<int>(sizeof(unsigned long long));
+		for (int word = 0; word < wordCount; ++word) {
+			unsigned long long wordData;
+			std::memcpy(&wordData, boxData + word * sizeof(unsigned long long), sizeof(unsigned long long));
+			hash = (hash ^ wordData) * 1099511628211ULL;
+			hash ^= hash >> 32;
+		}
+		for (int byte = wordCount * static_cast<int>(sizeof(unsigned long long)); byte < size; ++byte) {
+			hash = (hash ^ boxData[byte]) * 1099511628211ULL;
+		}
+		return (hash != 0) ? hash : 1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkServer::GetEntityPresetIndex(const MOSprite *part, unsigned short &presetIndex) {
+		std::unordered_map<std::string, unsigned short> &presetIndices = m_EntityPresetIndices[{ &part->GetClass(), part->GetModuleID() }];
+		std::unordered_map<std::string, unsigned short>::const_iterator presetEntry = presetIndices.find(part->GetPresetName());
+		if (presetEntry == presetIndices.end()) {
+			// Presets the client can't look up are remembered as well, so they don't get looked up again every sim update. They're marked with an index past the end of the table
+			const std::string &className = part->GetClassName();
+			std::string moduleAndPresetName = part->GetModuleAndPresetName();
+			bool canBeLookedUp = m_EntityPresets.size() < c_MaxEntityPresets && className.size() <= std::numeric_limits<unsigned char>::max() && moduleAndPresetName.size() <= std::numeric_limits<unsigned char>::max();
+			if (canBeLookedUp) { canBeLookedUp = dynamic_cast<const MOSprite *>(g_PresetMan.GetEntityPreset(className, moduleAndPresetName)) != nullptr; }
+
+			unsigned short newPresetIndex = canBeLookedUp ? static_cast<unsigned short>(m_EntityPresets.size()) : c_MaxEntityPresets;
+			if (canBeLookedUp) { m_EntityPresets.push_back({ newPresetIndex, className, std::move(moduleAndPresetName) }); }
+			presetEntry = presetIndices.try_emplace(part->GetPresetName(), newPresetIndex).first;
+		}
+		presetIndex = presetEntry->second;
+		return presetIndex != c_MaxEntityPresets;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::SendEntitySnapshot(short player) {
+		std::queue<unsigned int> entitySnapshotAcks;
+		m_Mutex[player].lock();
+		bool snapshotPending = m_EntitySnapshotPending[player];
+		if (snapshotPending) { std::swap(m_OutgoingEntitySnapshots[player], m_PendingEntitySnapshots[player]); }
+		m_EntitySnapshotPending[player] = false;
+		m_OutgoingEntityPresets[player].clear();
+		m_OutgoingEntityPresets[player].swap(m_PendingEntityPresets[player]);
+		entitySnapshotAcks.swap(m_PendingEntitySnapshotAcks[player]);
+		m_Mutex[player].unlock();
+
+		// The Presets go reliably and ahead of the snapshot, so they're usually there by the time the snapshot referring to them is. Entities whose Preset isn't yet just don't get drawn for a frame
+		MsgEntityPresets *presetsMsg = reinterpret_cast<MsgEntityPresets *>(m_PixelLineBuffer[player]);
+		presetsMsg->Id = ID_SRV_ENTITY_PRESETS;
+		presetsMsg->PresetCount = 0;
+		int presetsPayloadSize = sizeof(MsgEntityPresets);
+		auto sendPresetsMsg = [this, player, presetsMsg, &presetsPayloadSize]() {
+			m_Server->Send(reinterpret_cast<const char *>(presetsMsg), presetsPayloadSize, MEDIUM_PRIORITY, RELIABLE_ORDERED, 0, m_ClientConnections[player].ClientId, false);
+
+			m_DataSentCurrent[player][STAT_CURRENT] += presetsPayloadSize;
+			m_DataSentTotal[player] += presetsPayloadSize;
+
+			m_OtherDataSentCurrent[player][STAT_CURRENT] += presetsPayloadSize;
+			m_OtherDataSentTotal[player] += presetsPayloadSize;
+
+			presetsMsg->PresetCount = 0;
+			presetsPayloadSize = sizeof(MsgEntityPresets);
+		};
+		for (const EntityPresetDefinition *entityPreset : m_OutgoingEntityPresets[player]) {
+			int entrySize = sizeof(unsigned short) + 2 + static_cast<int>(entityPreset->ClassName.size() + entityPreset->ModuleAndPresetName.size());
+			if (presetsPayloadSize + entrySize > c_MaxPixelLineBufferSize) { sendPresetsMsg(); }
+
+			unsigned char *entryData = m_PixelLineBuffer[player] + presetsPayloadSize;
+			std::memcpy(entryData, &entityPreset->Index, sizeof(unsigned short));
+			entryData += sizeof(unsigned short);
+			for (const std::string *presetString : { &entityPreset->ClassName, &entityPreset->ModuleAndPresetName }) {
+				*entryData++ = static_cast<unsigned char>(presetString->size());
+				std::memcpy(entryData, presetString->data(), presetString->size());
+				entryData += presetString->size();
+			}
+			presetsMsg->PresetCount++;
+			presetsPayloadSize += entrySize;
+		}
+		if (presetsMsg->PresetCount > 0) { sendPresetsMsg(); }
+
+		std::deque<EntitySnapshot> &sentEntitySnapshots = m_SentEntitySnapshots[player];
+		for (; !entitySnapshotAcks.empty(); entitySnapshotAcks.pop()) {
+			unsigned int acknowledgedSequence = entitySnapshotAcks.front();
+			// Acknowledgements of snapshots that aren't kept anymore, or were sent before the history was reset, can't be used as a baseline
+			bool isKept = std::any_of(sentEntitySnapshots.begin(), sentEntitySnapshots.end(), [acknowledgedSequence](const EntitySnapshot &sentEntitySnapshot) { return sentEntitySnapshot.GetSequence() == acknowledgedSequence; });
+			if (isKept && acknowledgedSequence > m_AcknowledgedEntitySnapshots[player]) { m_AcknowledgedEntitySnapshots[player] = acknowledgedSequence; }
+		}
+		if (!snapshotPending) {
+			return;
+		}
+		const EntitySnapshot *baseline = nullptr;
+		for (const EntitySnapshot &sentEntitySnapshot : sentEntitySnapshots) {
+			if (sentEntitySnapshot.GetSequence() == m_AcknowledgedEntitySnapshots[player]) {
+				baseline = &sentEntitySnapshot;
+				break;
+			}
+		}
+		EntitySnapshot &entitySnapshot = m_OutgoingEntitySnapshots[player];
+		entitySnapshot.SetSequence(++m_EntitySnapshotSequences[player]);
+		std::vector<unsigned char> &entitySnapshotData = m_EntitySnapshotData[player];
+		entitySnapshot.Encode(baseline, entitySnapshotData);
+
+		int dataSize = static_cast<int>(entitySnapshotData.size());
+		std::vector<unsigned char> &entitySnapshotMessage = m_EntitySnapshotMessages[player];
+		entitySnapshotMessage.resize(sizeof(MsgEntitySnapshot) + std::max(LZ4_compressBound(dataSize), dataSize));
+
+		MsgEntitySnapshot *snapshotMsg = reinterpret_cast<MsgEntitySnapshot *>(entitySnapshotMessage.data());
+		snapshotMsg->Id = ID_SRV_ENTITY_SNAPSHOT;
+		snapshotMsg->Sequence = entitySnapshot.GetSequence();
+		snapshotMsg->BaselineSequence = baseline ? baseline->GetSequence() : 0;
+		snapshotMsg->EntityCount = static_cast<unsigned int>(entitySnapshot.GetEntities().size());
+		snapshotMsg->UncompressedSize = dataSize;
+
+		char *compressedData = reinterpret_cast<char *>(entitySnapshotMessage.data() + sizeof(MsgEntitySnapshot));
+		int compressedSize = (dataSize > 0) ? LZ4_compress_fast_extState(m_LZ4FastCompressionState[player], reinterpret_cast<const char *>(entitySnapshotData.data()), compressedData, dataSize, LZ4_compressBound(dataSize), m_FastAccelerationFactor) : 0;
+		if (compressedSize <= 0 || compressedSize >= dataSize) {
+			// Compression failed or ineffective, send as is
+			if (dataSize > 0) { std::memcpy(compressedData, entitySnapshotData.data(), dataSize); }
+			snapshotMsg->DataSize = dataSize;
+		} else {
+			snapshotMsg->DataSize = compressedSize;
+		}
+		int payloadSize = sizeof(MsgEntitySnapshot) + snapshotMsg->DataSize;
+		// Sequenced on a channel of their own, so a late snapshot is dropped instead of drawn without holding up or being held up by the terrain deltas
+		m_Server->Send(reinterpret_cast<const char *>(snapshotMsg), payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, c_EntitySnapshotChannel, m_ClientConnections[player].ClientId, false);
+
+		m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataSentTotal[player] += payloadSize;
+
+		m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_FrameDataSentTotal[player] += payloadSize;
+
+		m_DataUncompressedCurrent[player][STAT_CURRENT] += sizeof(MsgEntitySnapshot) + dataSize;
+		m_DataUncompressedTotal[player] += sizeof(MsgEntitySnapshot) + dataSize;
+
+		sentEntitySnapshots.emplace_back(std::move(entitySnapshot));
+		while (sentEntitySnapshots.size() > c_MaxUnacknowledgedFrames) {
+			sentEntitySnapshots.pop_front();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ReceiveEntitySnapshotAckMsg(RakNet::Packet *packet) {
+		if (packet->length < sizeof(MsgEntitySnapshotAck)) {
+			return;
+		}
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (m_ClientConnections[player].ClientId == packet->systemAddress) {
+				m_Mutex[player].lock();
+				m_PendingEntitySnapshotAcks[player].push(reinterpret_cast<const MsgEntitySnapshotAck *>(packet->data)->Sequence);
+				m_Mutex[player].unlock();
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ResetEntitySnapshotHistory(short player) {
+		m_SentEntitySnapshots[player].clear();
+		m_AcknowledgedEntitySnapshots[player] = 0;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::UpdateStats(short player) {
@@ -1546,6 +2116,7 @@ namespace RTE {
 
 		m_FullBlocks[c_MaxClients] = 0;
 		m_EmptyBlocks[c_MaxClients] = 0;
+		m_UnchangedBlocks[c_MaxClients] = 0;
 
 
 		for (short i = 0; i < MAX_STAT_RECORDS; i++) {
@@ -1572,6 +2143,7 @@ namespace RTE {
 
 				m_FullBlocks[c_MaxClients] += m_FullBlocks[i];
 				m_EmptyBlocks[c_MaxClients] += m_EmptyBlocks[i];
+				m_UnchangedBlocks[c_MaxClients] += m_UnchangedBlocks[i];
 			}
 
 			// Update compression ratio
@@ -1584,7 +2156,7 @@ namespace RTE {
 
 			// Jesus christ
 			std::snprintf(buf, sizeof(buf),
-					  "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nTotal Data %lu MB",
+					  "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlocks unchanged: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nTotal Data %lu MB",
 					  (i == c_MaxClients) ? "- TOTALS - " : playerName.c_str(),
 					  (i < c_MaxClients) ? m_Ping[i] : 0,
 					  static_cast<double>(m_DataSentCurrent[i][STAT_SHOWN]) / 125000,
@@ -1598,6 +2170,7 @@ namespace RTE {
 					  m_FramesSkipped[i] / 1000,
 					  m_FullBlocks[i] / 1000,
 					  m_EmptyBlocks[i] / 1000,
+					  m_UnchangedBlocks[i] / 1000,
 					  emptyRatio,
 					  (i < c_MaxClients) ? fps : 0,
 					  (i < c_MaxClients) ? m_MsecPerSendCall[i] : 0,
@@ -1709,6 +2282,9 @@ namespace RTE {
 			}
 		}
 
+		// Merge the terrain changes made since the last update per tile and encode them once for every client
+		EncodeTerrainChanges();
+
 		DrawStatisticsData();
 
 		// Clear sound events for unconnected players because AudioMan does not know about their state and stores broadcast sounds to their event lists
@@ -1781,6 +2357,15 @@ namespace RTE {
 				case ID_CLT_SCENE_ACCEPTED:
 					ReceiveSceneAcceptedMsg(packet);
 					break;
+				case ID_CLT_SCENE_TILE_REQUEST:
+					ReceiveSceneTileRequestMsg(packet);
+					break;
+				case ID_CLT_FRAME_BOX_ACK:
+					ReceiveFrameBoxAckMsg(packet);
+					break;
+				case ID_CLT_ENTITY_SNAPSHOT_ACK:
+					ReceiveEntitySnapshotAckMsg(packet);
+					break;
 				case ID_CONNECTION_REQUEST_ACCEPTED:
 					break;
 				case ID_NAT_SERVER_REGISTER_ACCEPTED:
@@ -5,6 +5,8 @@
 #include "SceneMan.h"
 
 #include "NetworkClient.h"
+#include "EntitySnapshot.h"
+#include "JobPool.h"
 
 #define g_NetworkServer NetworkServer::Instance()
 
@@ -137,6 +139,12 @@ namespace RTE {
 		/// </summary>
 		/// <returns>Whether threads will be put to sleep if server completed frame faster than it normally should or not.</returns>
 		bool GetServerSimSleepWhenIdle() const { return m_SimSleepWhenIdle; }
+
+		/// <summary>
+		/// Gets whether replicable MovableObjects are sent to the clients as entity snapshots for them to draw, instead of as part of the frame pixels.
+		/// </summary>
+		/// <returns>Whether entity replication is used.</returns>
+		bool UsesEntityReplication() const { return m_UseEntityReplication; }
 #pragma endregion
 
 #pragma region Concrete Methods
@@ -165,10 +173,37 @@ namespace RTE {
 		void ResetScene();
 
 		/// <summary>
-		/// 
+		/// Marks the terrain tiles a change covers as changed, so they're encoded and sent to the clients at the start of the next sim update. Only called from the main thread.
 		/// </summary>
-		/// <param name="terrainChange"></param>
+		/// <param name="terrainChange">The changed area. Has to be within the Scene already.</param>
 		void RegisterTerrainChange(SceneMan::TerrainChange terrainChange);
+
+		/// <summary>
+		/// Hashes the content of a frame box to tell whether it changed since it was last sent. Also names scene tiles in the clients' scene tile caches, which is why clients use it too.
+		/// </summary>
+		/// <param name="boxData">The box content.</param>
+		/// <param name="size">The size of the box content, in bytes.</param>
+		/// <returns>The hash of the box content. Never 0.</returns>
+		static unsigned long long HashFrameBox(const unsigned char *boxData, int size);
+#pragma endregion
+
+#pragma region Entity Replication
+		/// <summary>
+		/// Starts capturing the entity snapshot of this sim update. Only called from the main thread, right before the MovableObjects are drawn to the MO color layer.
+		/// </summary>
+		void BeginEntitySnapshot();
+
+		/// <summary>
+		/// Captures a root MovableObject into the entity snapshot being captured, if it and everything drawn along with it can be replicated. Only called from the main thread.
+		/// </summary>
+		/// <param name="movableObject">The MovableObject to capture.</param>
+		/// <returns>Whether the MovableObject was captured, in which case it shouldn't be drawn to the MO color layer.</returns>
+		bool AddReplicatedEntity(const MovableObject *movableObject);
+
+		/// <summary>
+		/// Splits the captured entity snapshot into one for every client holding just the entities in its view, and hands them over to the send threads. Only called from the main thread.
+		/// </summary>
+		void EndEntitySnapshot();
 #pragma endregion
 
 	protected:
@@ -186,6 +221,99 @@ namespace RTE {
 			std::string PlayerName; //!<
 		};
 
+		/// <summary>
+		/// The boxes sent for a frame, kept until the client acknowledges how many of them it received.
+		/// </summary>
+		struct SentFrameBoxes {
+			unsigned int FrameSequence; //!< The sequence number of the frame.
+			std::vector<std::pair<int, int>> Boxes; //!< The layer and index of every box sent for the frame.
+		};
+
+		/// <summary>
+		/// What the server knows about the content a client holds for each box of one layer. Used to skip unchanged boxes and XOR changed ones against what was sent before.
+		/// </summary>
+		struct FrameBoxHistory {
+			std::vector<unsigned char> Pixels; //!< The content last sent for each box, one full box size apart.
+			std::vector<unsigned long long> Hashes; //!< The hash of the content last sent for each box, or 0 if the box has to be sent again whether it changed or not.
+			std::vector<unsigned int> Sequences; //!< The sequence number of the frame each box was last sent in, or 0 if the client can't be relied on to have that content.
+			std::vector<unsigned int> ChainStarts; //!< The sequence number of the frame each box was last sent whole in, i.e. the oldest frame its current chain of deltas depends on.
+		};
+
+		/// <summary>
+		/// A box of one frame layer to be encoded on the encoder pool, and the result of encoding it.
+		/// </summary>
+		struct FrameBoxJob {
+			int BoxX; //!< The X position of the box in the frame.
+			int BoxY; //!< The Y position of the box in the frame.
+			int Width; //!< The width of the box, smaller than the box width at the right edge of the frame.
+			int Height; //!< The height of the box, smaller than the box height at the bottom edge of the frame.
+			int Layer; //!< The frame layer the box is on. 0 is the frame, 1 is the GUI.
+			int BoxIndex; //!< The index of the box in the frame box history.
+			int PayloadSize; //!< The size of the encoded message, or 0 if the box didn't change and doesn't need to be sent.
+			bool IsEmpty; //!< Whether the box is empty and was encoded without any data.
+		};
+
+		/// <summary>
+		/// Per-chunk state for encoding frame boxes, so chunks running on different threads never share anything.
+		/// </summary>
+		struct FrameBoxEncoder {
+			void *LZ4State = nullptr; //!< LZ4 compression state, big enough for both the fast and high compression functions. OWNED.
+			std::vector<unsigned char> BoxPixels; //!< Scratch space boxes get copied into and delta encoded in before compression.
+		};
+
+		/// <summary>
+		/// A copy of a Scene's terrain split into tiles, taken when the tile manifest is sent to a client, so the tiles it requests later match the hashes it was sent even if the terrain changed since.
+		/// </summary>
+		struct SceneTileSnapshot {
+			int Width; //!< The width of the Scene when the snapshot was taken.
+			int Height; //!< The height of the Scene when the snapshot was taken.
+			int Columns; //!< The number of tile columns in each layer.
+			int Rows; //!< The number of tile rows in each layer.
+			std::vector<unsigned char> Pixels; //!< The content of every tile, background layer first, each layer row by row, one full tile size apart. Edge tiles only use the start of their slot.
+			std::vector<unsigned long long> Hashes; //!< The hash of every tile, in the same order.
+			std::unordered_map<unsigned long long, int> TileIndices; //!< The index of the first tile with each hash.
+			std::vector<unsigned long long> RequestedHashes; //!< The hashes the client requested and the send thread hasn't picked up yet. Guarded by m_Mutex.
+		};
+
+		/// <summary>
+		/// A Preset in the table of Presets the entities in entity snapshots refer to.
+		/// </summary>
+		struct EntityPresetDefinition {
+			unsigned short Index; //!< The index of the Preset in the table.
+			std::string ClassName; //!< The class name of the Preset.
+			std::string ModuleAndPresetName; //!< The module and preset name of the Preset, which the client looks it up by.
+		};
+
+		/// <summary>
+		/// A root MovableObject captured into the entity snapshot of the current sim update.
+		/// </summary>
+		struct ReplicatedEntity {
+			Vector Pos; //!< The position of the MovableObject.
+			float Radius; //!< The radius of the MovableObject, Attachables included.
+			int FirstState; //!< The index of the first captured state of the MovableObject's parts.
+			int EndState; //!< One past the index of the last captured state of the MovableObject's parts.
+		};
+
+		/// <summary>
+		/// The terrain changes of one sim update, encoded once and shared by every client they're sent to.
+		/// </summary>
+		struct TerrainDeltaBatch {
+			std::vector<unsigned char> Messages; //!< The encoded message of each changed tile, one maximum message size apart.
+			std::vector<int> MessageSizes; //!< The size of each message, or 0 if the tile ended up the same as before and there's nothing to send.
+		};
+
+		static constexpr int c_MaxEncoderThreads = 4; //!< The most worker threads the encoder pool gets, so the send threads don't take too many cores away from the sim.
+		static constexpr int c_MaxUnacknowledgedFrames = 30; //!< How many frames with boxes can wait for an acknowledgement before the oldest are treated as lost.
+		static constexpr int c_SceneTileSize = 64; //!< The width and height of the tiles the Scene's terrain is transferred in. One tile has to fit in c_MaxPixelLineBufferSize.
+		static constexpr int c_SceneTileBatchSize = 256; //!< How many tiles are compressed on the encoder pool at once before they're sent, so sending can start before everything is compressed.
+		static constexpr unsigned int c_SceneSendBufferBudget = 512 * 1024; //!< How many bytes of scene tiles may wait in RakNet's send buffer before sending more waits for it to drain.
+		static constexpr int c_TerrainDeltaTileSize = 32; //!< The width and height of the tiles terrain changes are tracked and sent in. Small enough that an encoded tile always fits in one packet.
+		static constexpr int c_TerrainDeltaMaxDataSize = (c_TerrainDeltaTileSize * c_TerrainDeltaTileSize / 8) + (c_TerrainDeltaTileSize * c_TerrainDeltaTileSize); //!< The size of the bitmask and colors of a tile with every pixel changed.
+		static constexpr char c_TerrainDeltaChannel = 1; //!< The RakNet ordering channel terrain deltas are sent on, so they're ordered among themselves without waiting on anything else.
+		static constexpr char c_EntitySnapshotChannel = 2; //!< The RakNet ordering channel entity snapshots are sent on. Sequenced messages share the ordering state of their channel, so they must not share one with ordered messages.
+		static constexpr int c_MaxEntityPresets = std::numeric_limits<unsigned short>::max(); //!< How many Presets the table of entity Presets can hold.
+		static constexpr float c_EntityInterestMargin = 64.0F; //!< How far outside a client's view entities still get sent to it, on top of their radius, so they don't pop in late when the view moves.
+
 		bool m_IsInServerMode = false; //!<
 
 		bool m_SleepWhenIdle; //!< If true puts thread to sleep if it didn't receive anything for 10 seconds to avoid melting the CPU at 100% even if there are no connections.
@@ -244,13 +372,20 @@ namespace RTE {
 
 		bool m_SendSceneSetupData[c_MaxClients]; //!<
 		bool m_SendSceneData[c_MaxClients]; //!<
+		bool m_SendSceneTiles[c_MaxClients]; //!< Whether the client requested scene tiles that haven't been sent yet.
 		bool m_SceneAvailable[c_MaxClients]; //!<
 		bool m_SendFrameData[c_MaxClients]; //!<
 		std::mutex m_SceneLock[c_MaxClients]; //!<
 
-		unsigned char m_TerrainChangeBuffer[c_MaxClients][c_MaxPixelLineBufferSize]; //!<
-		std::queue<SceneMan::TerrainChange> m_PendingTerrainChanges[c_MaxClients]; //!<
-		std::queue<SceneMan::TerrainChange> m_CurrentTerrainChanges[c_MaxClients]; //!<
+		int m_TerrainShadowWidth; //!< The width of the terrain layers in m_TerrainShadow.
+		int m_TerrainShadowHeight; //!< The height of the terrain layers in m_TerrainShadow.
+		int m_TerrainDeltaColumns; //!< The number of terrain delta tile columns in each layer.
+		int m_TerrainDeltaRows; //!< The number of terrain delta tile rows in each layer.
+		std::vector<unsigned char> m_TerrainShadow[2]; //!< The background and foreground terrain layers as of the last terrain changes that were encoded. Changes are found by comparing the changed tiles against this. Only touched from the main thread.
+		std::vector<unsigned char> m_DirtyTerrainTiles; //!< Whether each terrain delta tile changed since the last changes were encoded, background layer first, each layer row by row. Only touched from the main thread.
+		std::vector<int> m_DirtyTerrainTileIndices; //!< The indices of the tiles marked in m_DirtyTerrainTiles, so encoding doesn't have to look through all of them.
+		std::vector<void *> m_TerrainDeltaLZ4States; //!< LZ4 compression state of each chunk the changed tiles get split into. OWNED.
+		std::deque<std::shared_ptr<const TerrainDeltaBatch>> m_PendingTerrainDeltas[c_MaxClients]; //!< The encoded terrain changes each client's send thread hasn't sent yet, oldest first. Guarded by m_Mutex.
 
 		std::mutex m_Mutex[c_MaxClients]; //!<
 
@@ -279,8 +414,45 @@ namespace RTE {
 		int m_BoxWidth; //!< Width of the transmitted CPU block. Different values may improve bandwidth usage.
 		int m_BoxHeight; //!< Height of the transmitted CPU block. Different values may improve bandwidth usage.
 
+		bool m_UseDeltaCompression; //!< Whether boxes that didn't change since they were last sent are skipped, and changed ones are XORed against their last sent content before compression.
+		unsigned int m_FrameSequences[c_MaxClients]; //!< The sequence number of the last frame sent to each client. 0 until the first frame is sent.
+		int m_FrameBoxColumns[c_MaxClients]; //!< The number of box columns in each client's frame history.
+		FrameBoxHistory m_FrameBoxHistory[c_MaxClients][2]; //!< The state of each box of both frame layers, per client. Only touched from the client's send thread.
+		std::deque<SentFrameBoxes> m_UnacknowledgedFrames[c_MaxClients]; //!< The frames with boxes each client hasn't acknowledged yet, oldest first. Only touched from the client's send thread.
+		std::vector<FrameBoxJob> m_FrameBoxJobs[c_MaxClients]; //!< The boxes being encoded for each client's current frame, in the order they get sent.
+		std::vector<unsigned char> m_FrameBoxMessages[c_MaxClients]; //!< The encoded message of each box in m_FrameBoxJobs, one maximum message size apart.
+		std::vector<FrameBoxEncoder> m_FrameBoxEncoders[c_MaxClients]; //!< The encoder state of each chunk the boxes get split into, per client.
+		JobPool m_EncoderPool; //!< The worker threads the send threads spread their encoding over. Separate from ThreadMan's pool so the send threads and the sim never end up running each other's Jobs while they wait.
+		std::queue<MsgFrameBoxAck> m_PendingFrameBoxAcks[c_MaxClients]; //!< Acknowledgements received from each client that its send thread hasn't processed yet. Guarded by m_Mutex.
+
+		int m_SceneCompressionLevel; //!< LZ4 high compression level the Scene's terrain tiles are compressed at. 9 is the default, 12 is highest.
+		SceneTileSnapshot m_SceneTileSnapshots[c_MaxClients]; //!< The terrain tiles each client was sent the manifest of, kept until the tiles it requested are sent.
+		std::vector<unsigned char> m_SceneTileMessages[c_MaxClients]; //!< The encoded message of each tile in the batch being sent, one maximum message size apart.
+		std::vector<void *> m_SceneTileLZ4States[c_MaxClients]; //!< LZ4 high compression state of each chunk the tile batches get split into, per client. OWNED.
+
+		bool m_UseEntityReplication; //!< Whether replicable MovableObjects are left out of the MO color layer and sent as entity snapshots for the clients to draw.
+		std::map<std::pair<const Entity::ClassInfo *, int>, std::unordered_map<std::string, unsigned short>> m_EntityPresetIndices; //!< The table index of every entity Preset, by class and module, then preset name. Only touched from the main thread.
+		std::deque<EntityPresetDefinition> m_EntityPresets; //!< The table of entity Presets. Only added to from the main thread, and never moves its elements so the send threads can hold on to them.
+		std::vector<bool> m_EntityPresetsSent[c_MaxClients]; //!< Whether each entity Preset was handed over to be sent to each client. Only touched from the main thread.
+		std::vector<ReplicatedEntity> m_ReplicatedEntities; //!< The root MovableObjects captured into the entity snapshot of the current sim update.
+		std::vector<EntitySnapshot::EntityState> m_CapturedEntityStates; //!< The states of every part of the captured MovableObjects, in drawing order.
+		std::vector<const MOSprite *> m_CapturedEntityParts; //!< Scratch space for the parts of the MovableObject being captured.
+		bool m_CapturingEntitySnapshot; //!< Whether an entity snapshot is being captured, i.e. BeginEntitySnapshot was called without EndEntitySnapshot yet.
+		EntitySnapshot m_PendingEntitySnapshots[c_MaxClients]; //!< The latest entity snapshot of each client, waiting for its send thread. Guarded by m_Mutex.
+		std::vector<const EntityPresetDefinition *> m_PendingEntityPresets[c_MaxClients]; //!< The entity Presets each client has to be sent before its pending snapshot. Guarded by m_Mutex.
+		bool m_EntitySnapshotPending[c_MaxClients]; //!< Whether each client's pending entity snapshot wasn't taken by its send thread yet. Guarded by m_Mutex.
+		EntitySnapshot m_OutgoingEntitySnapshots[c_MaxClients]; //!< The entity snapshot each client's send thread is sending. Only touched from the client's send thread.
+		std::vector<const EntityPresetDefinition *> m_OutgoingEntityPresets[c_MaxClients]; //!< The entity Presets each client's send thread is sending. Only touched from the client's send thread.
+		unsigned int m_EntitySnapshotSequences[c_MaxClients]; //!< The sequence number of the last entity snapshot sent to each client. Only touched from the client's send thread.
+		unsigned int m_AcknowledgedEntitySnapshots[c_MaxClients]; //!< The sequence number of the latest entity snapshot each client acknowledged, or 0 if none. Only touched from the client's send thread.
+		std::deque<EntitySnapshot> m_SentEntitySnapshots[c_MaxClients]; //!< The entity snapshots sent to each client that later ones may be delta encoded against, oldest first. Only touched from the client's send thread.
+		std::queue<unsigned int> m_PendingEntitySnapshotAcks[c_MaxClients]; //!< Entity snapshot acknowledgements received from each client that its send thread hasn't processed yet. Guarded by m_Mutex.
+		std::vector<unsigned char> m_EntitySnapshotData[c_MaxClients]; //!< Scratch space entity snapshots are encoded into before compression, per client.
+		std::vector<unsigned char> m_EntitySnapshotMessages[c_MaxClients]; //!< Scratch space entity snapshot messages are compressed into, per client.
+
 		int m_EmptyBlocks[MAX_STAT_RECORDS]; //!<
 		int m_FullBlocks[MAX_STAT_RECORDS]; //!<
+		int m_UnchangedBlocks[MAX_STAT_RECORDS]; //!< Number of blocks skipped because the client already had their content.
 		int m_SendBufferBytes[MAX_STAT_RECORDS]; //!<
 		int m_SendBufferMessages[MAX_STAT_RECORDS]; //!<
 		int m_DelayedFrames[c_MaxClients]; //!<
@@ -437,36 +609,67 @@ namespace RTE {
 		bool NeedToSendSceneData(short player) const { return m_SendSceneData[player]; }
 
 		/// <summary>
-		/// 
+		/// Splits the Scene's terrain into tiles, hashes them on the encoder pool and sends the client the manifest of tile hashes. The tiles themselves are sent once the client requests the ones it doesn't have cached.
 		/// </summary>
-		/// <param name="player"></param>
+		/// <param name="player">The player to send the manifest to.</param>
 		void SendSceneData(short player);
 
 		/// <summary>
-		/// 
+		/// Receives a client's request for the scene tiles it doesn't have cached.
 		/// </summary>
-		/// <param name="player"></param>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveSceneTileRequestMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Gets whether a client requested scene tiles that haven't been sent yet.
+		/// </summary>
+		/// <param name="player">The player to check for.</param>
+		/// <returns>Whether there are scene tiles to send.</returns>
+		bool NeedToSendSceneTiles(short player) const { return m_SendSceneTiles[player]; }
+
+		/// <summary>
+		/// Compresses the scene tiles a client requested on the encoder pool and sends them, keeping RakNet's send buffer within c_SceneSendBufferBudget. Ends the scene transfer once done.
+		/// </summary>
+		/// <param name="player">The player to send the tiles to.</param>
+		void SendSceneTiles(short player);
+
+		/// <summary>
+		/// Discards the encoded terrain changes a client's send thread hasn't sent yet. Done when a client is about to be sent the whole terrain anyway.
+		/// </summary>
+		/// <param name="player">The player to discard the terrain changes of.</param>
 		void ClearTerrainChangeQueue(short player);
 
 		/// <summary>
-		/// 
+		/// Copies the current Scene's terrain layers as the base terrain changes are compared against, and forgets any changed tiles. Only called from the main thread.
 		/// </summary>
-		/// <param name="player"></param>
-		/// <returns></returns>
-		bool NeedToProcessTerrainChanges(short player);
+		void ResetTerrainShadow();
 
 		/// <summary>
-		/// 
+		/// Encodes the terrain tiles that changed since this was last called on the worker threads, and queues the encoded changes for every connected client. Only called from the main thread.
 		/// </summary>
-		/// <param name="player"></param>
-		void ProcessTerrainChanges(short player);
+		void EncodeTerrainChanges();
 
 		/// <summary>
-		/// 
+		/// Encodes the pixels of a terrain tile that differ from the terrain shadow into a terrain change message, and updates the shadow to match.
 		/// </summary>
-		/// <param name="player"></param>
-		/// <param name="terrainChange"></param>
-		void SendTerrainChangeMsg(short player, SceneMan::TerrainChange terrainChange);
+		/// <param name="tileIndex">The index of the tile in m_DirtyTerrainTiles.</param>
+		/// <param name="msg">The message to encode into. Has to have room for c_TerrainDeltaMaxDataSize compressed bytes after the header.</param>
+		/// <param name="lz4State">The LZ4 compression state to use.</param>
+		/// <returns>The size of the encoded message, or 0 if no pixel of the tile changed.</returns>
+		int EncodeTerrainDelta(int tileIndex, MsgTerrainChange *msg, void *lz4State);
+
+		/// <summary>
+		/// Gets whether there are encoded terrain changes a client's send thread hasn't sent yet.
+		/// </summary>
+		/// <param name="player">The player to check for.</param>
+		/// <returns>Whether there are terrain changes to send.</returns>
+		bool NeedToProcessTerrainChanges(short player);
+
+		/// <summary>
+		/// Sends a client every encoded terrain change queued for it.
+		/// </summary>
+		/// <param name="player">The player to send the terrain changes to.</param>
+		void ProcessTerrainChanges(short player);
 
 		/// <summary>
 		/// 
@@ -521,6 +724,76 @@ namespace RTE {
 		/// <param name="player"></param>
 		/// <returns></returns>
 		int SendFrame(short player);
+
+		/// <summary>
+		/// Copies, delta encodes and compresses a single frame box into its message. Boxes can be encoded concurrently, as long as each uses its own FrameBoxEncoder.
+		/// </summary>
+		/// <param name="player">The player the box is for.</param>
+		/// <param name="frameBoxJob">The box to encode. Its PayloadSize and IsEmpty are set by this.</param>
+		/// <param name="frameData">The message to encode the box into, followed by room for the uncompressed box.</param>
+		/// <param name="frameBoxEncoder">The encoder state to use.</param>
+		void EncodeFrameBox(short player, FrameBoxJob &frameBoxJob, MsgFrameBox *frameData, FrameBoxEncoder &frameBoxEncoder);
+
+		/// <summary>
+		/// Checks whether every pixel of a frame box is 0, i.e. the mask color.
+		/// </summary>
+		/// <param name="boxData">The box content.</param>
+		/// <param name="size">The size of the box content, in bytes.</param>
+		/// <returns>Whether the box is empty.</returns>
+		static bool IsFrameBoxEmpty(const unsigned char *boxData, int size);
+
+		/// <summary>
+		/// Queues up a frame box acknowledgement from a client for its send thread to process.
+		/// </summary>
+		/// <param name="packet">The packet holding the MsgFrameBoxAck.</param>
+		void ReceiveFrameBoxAckMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Processes the frame box acknowledgements received from a client since the last frame. Boxes whose chain of deltas went through a frame the client didn't fully receive get sent whole again.
+		/// </summary>
+		/// <param name="player">The player to process the acknowledgements of.</param>
+		void ProcessFrameBoxAcks(short player);
+
+		/// <summary>
+		/// Marks the boxes of a frame the client didn't fully receive as unknown to the client, unless they've been sent whole since.
+		/// </summary>
+		/// <param name="player">The player the frame was sent to.</param>
+		/// <param name="sentFrame">The frame that wasn't fully received.</param>
+		void InvalidateFrameBoxes(short player, const SentFrameBoxes &sentFrame);
+
+		/// <summary>
+		/// Forgets everything about what a client holds for each box, so every box gets sent whole again. Done whenever the client's frame buffers may have been reset.
+		/// </summary>
+		/// <param name="player">The player to reset the frame box history of.</param>
+		void ResetFrameBoxHistory(short player);
+#pragma endregion
+
+#pragma region Entity Replication Handling
+		/// <summary>
+		/// Gets the index of a Preset in the table of entity Presets, adding it to the table if it isn't in it yet. Only called from the main thread.
+		/// </summary>
+		/// <param name="part">The MOSprite to get the Preset index of.</param>
+		/// <param name="presetIndex">Set to the index of the Preset.</param>
+		/// <returns>Whether the Preset is in the table. False if the client can't look the Preset up, or the table is full.</returns>
+		bool GetEntityPresetIndex(const MOSprite *part, unsigned short &presetIndex);
+
+		/// <summary>
+		/// Sends a client the entity Presets and entity snapshot handed over to its send thread since the last frame, delta encoding the snapshot against the latest one the client acknowledged.
+		/// </summary>
+		/// <param name="player">The player to send the entity snapshot to.</param>
+		void SendEntitySnapshot(short player);
+
+		/// <summary>
+		/// Queues up an entity snapshot acknowledgement from a client for its send thread to process.
+		/// </summary>
+		/// <param name="packet">The packet holding the MsgEntitySnapshotAck.</param>
+		void ReceiveEntitySnapshotAckMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Forgets which entity snapshots a client has, so the next one gets encoded whole. Done whenever the client may have dropped its snapshots.
+		/// </summary>
+		/// <param name="player">The player to reset the entity snapshot history of.</param>
+		void ResetEntitySnapshotHistory(short player);
 #pragma endregion
 
 #pragma region Network Stats Handling
@@ -2,6 +2,12 @@
 #include "MovableMan.h"
 #include "FrameMan.h"
 #include "AudioMan.h"
+#include "ActivityMan.h"
+#include "SceneMan.h"
+#include "ConsoleMan.h"
+#include "ThreadMan.h"
+#include "Activity.h"
+#include "Scene.h"
 #include "Timer.h"
 
 #include "GUI.h"
@@ -9,15 +15,42 @@
 
 namespace RTE {
 
+	thread_local PerformanceMan::ProfilingBuffer *PerformanceMan::s_ProfilingBuffer = nullptr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::ProfilingScope::Begin(const char *name, const char *detail) {
+		m_Name = name;
+		m_Detail = detail;
+		m_StartTime = g_TimerMan.GetAbsoluteTime();
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PerformanceMan::Clear() {
 		m_ShowPerfStats = false;
 		m_AdvancedPerfStats = true;
 		m_CurrentPing = 0;
+		m_RotatedSpriteCacheHits = 0;
+		m_RotatedSpriteCacheMisses = 0;
 		m_FrameTimer = nullptr;
 		m_MSPFs.clear();
 		m_MSPFAverage = 0;
+		m_BenchmarkSimUpdateCount = 0;
+		m_BenchmarkSeed = 0;
+		for (std::vector<uint64_t> &counterSamples : m_BenchmarkCounterSamples) {
+			counterSamples.clear();
+		}
+		for (std::vector<long> &moCountSamples : m_BenchmarkMOCountSamples) {
+			moCountSamples.clear();
+		}
+		m_PerfMeasureTraced.fill(false);
+		m_CapturingTrace.store(false, std::memory_order_relaxed);
+		m_TraceCaptureRequested = 0;
+		m_TraceUpdatesRemaining = 0;
+		m_TraceWritePending = false;
+		m_ScriptScopeStack.clear();
+		// The profiling buffers and interned names are deliberately kept, threads hold on to their buffer for as long as they live and recorded events point into the names.
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +105,7 @@ namespace RTE {
 
 	void PerformanceMan::StartPerformanceMeasurement(PerformanceCounters counter) {
 		m_PerfMeasureStart.at(counter) = g_TimerMan.GetAbsoluteTime();
+		m_PerfMeasureTraced.at(counter) = IsCapturingTrace();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -79,11 +113,17 @@ namespace RTE {
 	void PerformanceMan::StopPerformanceMeasurement(PerformanceCounters counter) {
 		m_PerfMeasureStop.at(counter) = g_TimerMan.GetAbsoluteTime();
 		AddPerformanceSample(counter, m_PerfMeasureStop.at(counter) - m_PerfMeasureStart.at(counter));
+		if (m_PerfMeasureTraced.at(counter)) {
+			RecordProfilingEvent(m_PerfCounterNames.at(counter).c_str(), nullptr, m_PerfMeasureStart.at(counter));
+			m_PerfMeasureTraced.at(counter) = false;
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PerformanceMan::NewPerformanceSample() {
+		UpdateTraceCapture();
+
 		m_Sample++;
 		if (m_Sample >= c_MaxSamples) { m_Sample = 0; }
 
@@ -115,6 +155,237 @@ namespace RTE {
 		return totalPerformanceMeasurement / c_Average;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::SetBenchmarkToRun(int simUpdateCount, unsigned int seed) {
+		m_BenchmarkSimUpdateCount = std::max(simUpdateCount, 0);
+		m_BenchmarkSeed = seed;
+		for (std::vector<uint64_t> &counterSamples : m_BenchmarkCounterSamples) {
+			counterSamples.clear();
+			counterSamples.reserve(m_BenchmarkSimUpdateCount);
+		}
+		for (std::vector<long> &moCountSamples : m_BenchmarkMOCountSamples) {
+			moCountSamples.clear();
+			moCountSamples.reserve(m_BenchmarkSimUpdateCount);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::RecordBenchmarkSample() {
+		for (int counter = 0; counter < PerformanceCounters::PerfCounterCount; ++counter) {
+			m_BenchmarkCounterSamples.at(counter).emplace_back(m_PerfData.at(counter).at(m_Sample));
+		}
+		m_BenchmarkMOCountSamples.at(BenchmarkMOCounts::BenchmarkActors).emplace_back(g_MovableMan.GetActorCount());
+		m_BenchmarkMOCountSamples.at(BenchmarkMOCounts::BenchmarkItems).emplace_back(g_MovableMan.GetItemCount());
+		m_BenchmarkMOCountSamples.at(BenchmarkMOCounts::BenchmarkParticles).emplace_back(g_MovableMan.GetParticleCount());
+		m_BenchmarkMOCountSamples.at(BenchmarkMOCounts::BenchmarkMOIDs).emplace_back(g_MovableMan.GetMOIDCount());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::CaptureTrace(int simUpdateCount) {
+		if (IsCapturingTrace() || m_TraceWritePending) {
+			g_ConsoleMan.PrintString("ERROR: A profiling trace is already being captured!");
+			return;
+		}
+		m_TraceCaptureRequested = std::max(simUpdateCount, 1);
+		g_ConsoleMan.PrintString("SYSTEM: Capturing a profiling trace of the next " + std::to_string(m_TraceCaptureRequested) + " sim updates...");
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::StartScope(const std::string &name) {
+		m_ScriptScopeStack.emplace_back(IsCapturingTrace() ? InternProfilingName(name) : nullptr, g_TimerMan.GetAbsoluteTime());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::EndScope() {
+		if (m_ScriptScopeStack.empty()) {
+			return;
+		}
+		const auto &[scopeName, scopeStartTime] = m_ScriptScopeStack.back();
+		if (scopeName) { RecordProfilingEvent(scopeName, nullptr, scopeStartTime); }
+		m_ScriptScopeStack.pop_back();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const char * PerformanceMan::InternProfilingName(const std::string &name) {
+		std::lock_guard<std::mutex> namesLock(m_ProfilingNamesMutex);
+		return m_ProfilingNames.emplace(name).first->c_str();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::RecordProfilingEvent(const char *name, const char *detail, long long startTime) {
+		if (!IsCapturingTrace()) {
+			return;
+		}
+		ProfilingBuffer *profilingBuffer = GetProfilingBuffer();
+		// Only this thread ever writes to its buffer, so a relaxed read of the count is enough. The release store publishes the event to the thread writing the trace.
+		uint64_t eventIndex = profilingBuffer->EventCount.load(std::memory_order_relaxed);
+		profilingBuffer->Events[eventIndex % c_ProfilingBufferSize] = { name, detail, startTime, g_TimerMan.GetAbsoluteTime() - startTime };
+		profilingBuffer->EventCount.store(eventIndex + 1, std::memory_order_release);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	PerformanceMan::ProfilingBuffer * PerformanceMan::GetProfilingBuffer() {
+		if (!s_ProfilingBuffer) {
+			std::unique_ptr<ProfilingBuffer> newProfilingBuffer = std::make_unique<ProfilingBuffer>();
+			newProfilingBuffer->Events.resize(c_ProfilingBufferSize);
+			newProfilingBuffer->EventCount.store(0, std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> buffersLock(m_ProfilingBuffersMutex);
+			newProfilingBuffer->ThreadID = static_cast<int>(m_ProfilingBuffers.size());
+			if (g_ThreadMan.IsWorkerThread()) {
+				newProfilingBuffer->ThreadName = "Worker " + std::to_string(g_ThreadMan.GetCurrentThreadIndex());
+			} else {
+				newProfilingBuffer->ThreadName = (newProfilingBuffer->ThreadID == 0) ? "Main" : "Thread " + std::to_string(newProfilingBuffer->ThreadID);
+			}
+			s_ProfilingBuffer = newProfilingBuffer.get();
+			m_ProfilingBuffers.emplace_back(std::move(newProfilingBuffer));
+		}
+		return s_ProfilingBuffer;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::UpdateTraceCapture() {
+		if (m_TraceWritePending) {
+			WriteTrace(System::GetWorkingDirectory() + "ProfilingTrace.json");
+			m_TraceWritePending = false;
+		}
+		if (IsCapturingTrace() && --m_TraceUpdatesRemaining <= 0) {
+			// Scopes still open on other threads are dropped once capturing stops, so the trace is written an update later to give any events that just made it in time to land.
+			m_CapturingTrace.store(false, std::memory_order_relaxed);
+			m_TraceWritePending = true;
+		}
+		if (m_TraceCaptureRequested > 0 && !IsCapturingTrace() && !m_TraceWritePending) {
+			// Nothing is recording at this point, so the counts can be reset without racing any writer. The main thread's buffer gets created here so it always shows up first in the trace.
+			GetProfilingBuffer();
+			std::lock_guard<std::mutex> buffersLock(m_ProfilingBuffersMutex);
+			for (const std::unique_ptr<ProfilingBuffer> &profilingBuffer : m_ProfilingBuffers) {
+				profilingBuffer->EventCount.store(0, std::memory_order_relaxed);
+			}
+			m_TraceUpdatesRemaining = m_TraceCaptureRequested;
+			m_TraceCaptureRequested = 0;
+			m_CapturingTrace.store(true, std::memory_order_release);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PerformanceMan::WriteTrace(const std::string &filePath) {
+		std::ofstream traceFile(filePath);
+		if (!traceFile.is_open()) {
+			g_ConsoleMan.PrintString("ERROR: Failed to open \"" + filePath + "\" to write the profiling trace to!");
+			return false;
+		}
+		int writtenEventCount = 0;
+		bool droppedEvents = false;
+
+		traceFile << "{\"traceEvents\":[\n";
+		std::lock_guard<std::mutex> buffersLock(m_ProfilingBuffersMutex);
+		for (const std::unique_ptr<ProfilingBuffer> &profilingBuffer : m_ProfilingBuffers) {
+			traceFile << ((profilingBuffer->ThreadID > 0) ? ",\n" : "");
+			traceFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << profilingBuffer->ThreadID << ",\"args\":{\"name\":\"" << profilingBuffer->ThreadName << "\"}}";
+
+			uint64_t eventCount = profilingBuffer->EventCount.load(std::memory_order_acquire);
+			uint64_t firstEvent = (eventCount > c_ProfilingBufferSize) ? eventCount - c_ProfilingBufferSize : 0;
+			droppedEvents = droppedEvents || firstEvent > 0;
+			for (uint64_t eventIndex = firstEvent; eventIndex < eventCount; ++eventIndex) {
+				const ProfilingEvent &profilingEvent = profilingBuffer->Events[eventIndex % c_ProfilingBufferSize];
+				traceFile << ",\n{\"name\":\"" << EscapeJSONString(profilingEvent.Name) << "\",\"cat\":\"Sim\",\"ph\":\"X\",\"ts\":" << profilingEvent.StartTime << ",\"dur\":" << profilingEvent.Duration << ",\"pid\":0,\"tid\":" << profilingBuffer->ThreadID;
+				if (profilingEvent.Detail) { traceFile << ",\"args\":{\"detail\":\"" << EscapeJSONString(profilingEvent.Detail) << "\"}"; }
+				traceFile << "}";
+				writtenEventCount++;
+			}
+		}
+		traceFile << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		if (!traceFile.good()) {
+			g_ConsoleMan.PrintString("ERROR: Failed to write the profiling trace to \"" + filePath + "\"!");
+			return false;
+		}
+		g_ConsoleMan.PrintString("SYSTEM: Wrote " + std::to_string(writtenEventCount) + " profiling events to \"" + filePath + "\"." + (droppedEvents ? " Some threads ran out of buffer space, so their oldest events were dropped." : ""));
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PerformanceMan::WriteBenchmarkResults(const std::string &filePath) const {
+		std::ofstream resultsFile(filePath);
+		if (!resultsFile.is_open()) {
+			g_ConsoleMan.PrintString("ERROR: Failed to open \"" + filePath + "\" to write the benchmark results to!");
+			return false;
+		}
+		const Activity *activity = g_ActivityMan.GetActivity();
+		const Scene *scene = g_SceneMan.GetScene();
+		size_t recordedSampleCount = m_BenchmarkCounterSamples.at(PerformanceCounters::SimTotal).size();
+
+		resultsFile << "{\n";
+		resultsFile << "\t\"Activity\": \"" << EscapeJSONString(activity ? activity->GetPresetName() : "None") << "\",\n";
+		resultsFile << "\t\"Scene\": \"" << EscapeJSONString(scene ? scene->GetPresetName() : "None") << "\",\n";
+		resultsFile << "\t\"Seed\": " << m_BenchmarkSeed << ",\n";
+		resultsFile << "\t\"RequestedSimUpdates\": " << m_BenchmarkSimUpdateCount << ",\n";
+		resultsFile << "\t\"RecordedSimUpdates\": " << recordedSampleCount << ",\n";
+		resultsFile << "\t\"WorkerThreads\": " << g_ThreadMan.GetWorkerCount() << ",\n";
+
+		// Timings are nearest-rank percentiles over every recorded sim update, in microseconds.
+		resultsFile << "\t\"CountersMicroseconds\": {\n";
+		for (int counter = 0; counter < PerformanceCounters::PerfCounterCount; ++counter) {
+			std::vector<uint64_t> sortedSamples = m_BenchmarkCounterSamples.at(counter);
+			std::sort(sortedSamples.begin(), sortedSamples.end());
+			auto percentile = [&sortedSamples](double fraction) {
+				return sortedSamples.empty() ? 0 : sortedSamples.at(std::min(static_cast<size_t>(std::ceil(fraction * static_cast<double>(sortedSamples.size()))), sortedSamples.size()) - 1);
+			};
+			uint64_t sampleSum = std::accumulate(sortedSamples.begin(), sortedSamples.end(), static_cast<uint64_t>(0));
+
+			resultsFile << "\t\t\"" << m_PerfCounterNames.at(counter) << "\": { ";
+			resultsFile << "\"p50\": " << percentile(0.5) << ", \"p95\": " << percentile(0.95) << ", \"p99\": " << percentile(0.99) << ", ";
+			resultsFile << "\"Mean\": " << (sortedSamples.empty() ? 0 : sampleSum / sortedSamples.size()) << ", \"Max\": " << (sortedSamples.empty() ? 0 : sortedSamples.back()) << " }";
+			resultsFile << ((counter < PerformanceCounters::PerfCounterCount - 1) ? ",\n" : "\n");
+		}
+		resultsFile << "\t},\n";
+
+		const std::array<std::string, BenchmarkMOCounts::BenchmarkMOCountCount> moCountNames = { "Actors", "Items", "Particles", "MOIDs" };
+		resultsFile << "\t\"MOCounts\": {\n";
+		for (int moCount = 0; moCount < BenchmarkMOCounts::BenchmarkMOCountCount; ++moCount) {
+			const std::vector<long> &moCountSamples = m_BenchmarkMOCountSamples.at(moCount);
+			long peakCount = moCountSamples.empty() ? 0 : *std::max_element(moCountSamples.begin(), moCountSamples.end());
+			long long countSum = std::accumulate(moCountSamples.begin(), moCountSamples.end(), 0LL);
+
+			resultsFile << "\t\t\"" << moCountNames.at(moCount) << "\": { ";
+			resultsFile << "\"Final\": " << (moCountSamples.empty() ? 0 : moCountSamples.back()) << ", \"Peak\": " << peakCount << ", \"Mean\": " << (moCountSamples.empty() ? 0 : countSum / static_cast<long long>(moCountSamples.size())) << " }";
+			resultsFile << ((moCount < BenchmarkMOCounts::BenchmarkMOCountCount - 1) ? ",\n" : "\n");
+		}
+		resultsFile << "\t},\n";
+
+		resultsFile << "\t\"PeakMemoryBytes\": " << System::GetPeakMemoryUsage() << "\n";
+		resultsFile << "}\n";
+
+		return resultsFile.good();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string PerformanceMan::EscapeJSONString(const std::string &stringToEscape) {
+		// Names come from data files and scripts, so escape anything that would break the JSON string they're written into.
+		std::string escapedString;
+		for (char character : stringToEscape) {
+			if (character == '"' || character == '\\') {
+				escapedString += '\\';
+			} else if (static_cast<unsigned char>(character) < ' ') {
+				character = ' ';
+			}
+			escapedString += character;
+		}
+		return escapedString;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PerformanceMan::Draw(AllegroBitmap &bitmapToDrawTo) {
@@ -173,6 +444,10 @@ namespace RTE {
 			}
 			g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_StatsOffsetX, c_StatsHeight + 100, str, GUIFont::Left);
 
+			const RotatedSpriteCache &rotatedSpriteCache = g_FrameMan.GetRotatedSpriteCache();
+			std::snprintf(str, sizeof(str), "Rotated Sprite Cache: %.0f%% Hits | %d Sprites | %.1f / %d MB", GetRotatedSpriteCacheHitRate() * 100.0F, rotatedSpriteCache.GetCount(), static_cast<float>(rotatedSpriteCache.GetMemoryUsage()) / (1024.0F * 1024.0F), rotatedSpriteCache.GetMemoryBudget());
+			g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_StatsOffsetX, c_StatsHeight + 110, str, GUIFont::Left);
+
 			// If in split screen mode don't draw graphs because they don't fit anyway.
 			if (m_AdvancedPerfStats && g_FrameMan.GetScreenCount() == 1) { DrawPeformanceGraphs(bitmapToDrawTo); }
 		}
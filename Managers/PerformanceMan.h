@@ -2,13 +2,13 @@
 #define _RTEPERFORMANCEMAN_
 
 #include "Singleton.h"
+#include "Timer.h"
 
 #define g_PerformanceMan PerformanceMan::Instance()
 
 namespace RTE {
 
 	class AllegroBitmap;
-	class Timer;
 
 	/// <summary>
 	/// Singleton manager responsible for all performance stats counting and drawing.
@@ -32,6 +32,56 @@ namespace RTE {
 			PerfCounterCount
 		};
 
+		/// <summary>
+		/// Records how long it was alive as one event in the profiling trace, if a trace is being captured when it is created. Can be used from any thread and nests naturally with other scopes.
+		/// </summary>
+		class ProfilingScope {
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to start a ProfilingScope with a fixed name.
+			/// </summary>
+			/// <param name="name">The name of the scope. Has to outlive the trace, so it should be a string literal.</param>
+			explicit ProfilingScope(const char *name) : m_Name(nullptr), m_Detail(nullptr), m_StartTime(0) { if (PerformanceMan::Instance().IsCapturingTrace()) { Begin(name, nullptr); } }
+
+			/// <summary>
+			/// Constructor method used to start a ProfilingScope with a fixed name and a detail that tells apart different instances of it, e.g. which Actor is being updated.
+			/// </summary>
+			/// <param name="name">The name of the scope. Has to outlive the trace, so it should be a string literal.</param>
+			/// <param name="detail">The detail of this instance of the scope. Only copied when a trace is being captured.</param>
+			ProfilingScope(const char *name, const std::string &detail) : m_Name(nullptr), m_Detail(nullptr), m_StartTime(0) { if (PerformanceMan::Instance().IsCapturingTrace()) { Begin(name, PerformanceMan::Instance().InternProfilingName(detail)); } }
+
+			/// <summary>
+			/// Constructor method used to start a ProfilingScope whose name is only known at runtime, e.g. a Lua function.
+			/// </summary>
+			/// <param name="name">The name of the scope. Only copied when a trace is being captured.</param>
+			/// <param name="detail">The detail of this instance of the scope. Only copied when a trace is being captured.</param>
+			ProfilingScope(const std::string &name, const std::string &detail) : m_Name(nullptr), m_Detail(nullptr), m_StartTime(0) { if (PerformanceMan::Instance().IsCapturingTrace()) { Begin(PerformanceMan::Instance().InternProfilingName(name), PerformanceMan::Instance().InternProfilingName(detail)); } }
+
+			/// <summary>
+			/// Destructor method used to end this ProfilingScope and record it into the calling thread's trace buffer.
+			/// </summary>
+			~ProfilingScope() { if (m_Name) { PerformanceMan::Instance().RecordProfilingEvent(m_Name, m_Detail, m_StartTime); } }
+
+		private:
+
+			const char *m_Name; //!< The name of this scope, or nullptr if no trace was being captured when it started.
+			const char *m_Detail; //!< The detail of this instance of the scope, or nullptr if there is none.
+			long long m_StartTime; //!< The time this scope started at, in microseconds.
+
+			/// <summary>
+			/// Starts timing this ProfilingScope.
+			/// </summary>
+			/// <param name="name">The name of the scope.</param>
+			/// <param name="detail">The detail of this instance of the scope, or nullptr if there is none.</param>
+			void Begin(const char *name, const char *detail);
+
+			// Disallow the use of some implicit methods.
+			ProfilingScope(const ProfilingScope &reference) = delete;
+			ProfilingScope & operator=(const ProfilingScope &rhs) = delete;
+		};
+
 #pragma region Creation
 		/// <summary>
 		///  Constructor method used to instantiate a PerformanceMan object in system memory. Create() should be called before using the object.
@@ -133,8 +183,143 @@ namespace RTE {
 		void SetCurrentPing(int ping) { m_CurrentPing = ping; }
 #pragma endregion
 
+#pragma region Rotated Sprite Cache Counters
+		/// <summary>
+		/// Counts one lookup in FrameMan's RotatedSpriteCache.
+		/// </summary>
+		/// <param name="hit">Whether the rotated sprite was already cached.</param>
+		void RecordRotatedSpriteCacheAccess(bool hit) { hit ? ++m_RotatedSpriteCacheHits : ++m_RotatedSpriteCacheMisses; }
+
+		/// <summary>
+		/// Gets the number of rotated sprite draws that were served from the cache since the counters were last reset.
+		/// </summary>
+		/// <returns>The number of rotated sprite cache hits.</returns>
+		unsigned long long GetRotatedSpriteCacheHits() const { return m_RotatedSpriteCacheHits; }
+
+		/// <summary>
+		/// Gets the number of rotated sprite draws that had to render and cache the sprite since the counters were last reset.
+		/// </summary>
+		/// <returns>The number of rotated sprite cache misses.</returns>
+		unsigned long long GetRotatedSpriteCacheMisses() const { return m_RotatedSpriteCacheMisses; }
+
+		/// <summary>
+		/// Gets the fraction of rotated sprite draws that were served from the cache since the counters were last reset.
+		/// </summary>
+		/// <returns>The rotated sprite cache hit rate, between 0 and 1. 0 if nothing was drawn yet.</returns>
+		float GetRotatedSpriteCacheHitRate() const { unsigned long long lookups = m_RotatedSpriteCacheHits + m_RotatedSpriteCacheMisses; return lookups > 0 ? static_cast<float>(static_cast<double>(m_RotatedSpriteCacheHits) / static_cast<double>(lookups)) : 0.0F; }
+
+		/// <summary>
+		/// Resets the rotated sprite cache hit and miss counters.
+		/// </summary>
+		void ResetRotatedSpriteCacheCounters() { m_RotatedSpriteCacheHits = 0; m_RotatedSpriteCacheMisses = 0; }
+#pragma endregion
+
+#pragma region Profiling Trace
+		/// <summary>
+		/// Gets whether a profiling trace is currently being captured, i.e. whether ProfilingScopes record anything.
+		/// </summary>
+		/// <returns>Whether a profiling trace is being captured.</returns>
+		bool IsCapturingTrace() const { return m_CapturingTrace.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Requests a profiling trace of the given number of sim updates. Capturing starts with the next sim update, and the trace is written to "ProfilingTrace.json" in Chrome's trace event format once it's done.
+		/// </summary>
+		/// <param name="simUpdateCount">The number of sim updates to capture.</param>
+		void CaptureTrace(int simUpdateCount = c_DefaultTraceCaptureLength);
+
+		/// <summary>
+		/// Starts a named profiling scope on the main thread, for use from Lua where there's no RAII. Has to be closed with EndScope in the same sim update.
+		/// </summary>
+		/// <param name="name">The name of the scope.</param>
+		void StartScope(const std::string &name);
+
+		/// <summary>
+		/// Ends the last profiling scope started with StartScope. Does nothing if there is none.
+		/// </summary>
+		void EndScope();
+
+		/// <summary>
+		/// Gets a copy of a string that stays valid for the rest of the program, so it can be referenced by profiling events. Thread safe.
+		/// </summary>
+		/// <param name="name">The string to copy.</param>
+		/// <returns>A pointer to the stored copy of the string. The same string always gives the same pointer.</returns>
+		const char * InternProfilingName(const std::string &name);
+
+		/// <summary>
+		/// Records a finished profiling scope into the calling thread's trace buffer. Does nothing if no trace is being captured. Thread safe.
+		/// </summary>
+		/// <param name="name">The name of the scope. Has to outlive the trace.</param>
+		/// <param name="detail">The detail of this instance of the scope, or nullptr if there is none. Has to outlive the trace.</param>
+		/// <param name="startTime">The time the scope started at, in microseconds.</param>
+		void RecordProfilingEvent(const char *name, const char *detail, long long startTime);
+#pragma endregion
+
+#pragma region Benchmarking
+		/// <summary>
+		/// Gets whether a benchmark run was requested through the command-line, in which case the normal game loop is replaced by a fixed number of unthrottled sim updates.
+		/// </summary>
+		/// <returns>Whether a benchmark run was requested.</returns>
+		bool IsSetToRunBenchmark() const { return m_BenchmarkSimUpdateCount > 0; }
+
+		/// <summary>
+		/// Gets the number of sim updates the benchmark run should do.
+		/// </summary>
+		/// <returns>The number of sim updates the benchmark run should do.</returns>
+		int GetBenchmarkSimUpdateCount() const { return m_BenchmarkSimUpdateCount; }
+
+		/// <summary>
+		/// Gets the seed the RNG should be set to before the benchmark Activity starts.
+		/// </summary>
+		/// <returns>The seed to start the benchmark with.</returns>
+		unsigned int GetBenchmarkSeed() const { return m_BenchmarkSeed; }
+
+		/// <summary>
+		/// Requests a benchmark run and clears any previously recorded benchmark samples.
+		/// </summary>
+		/// <param name="simUpdateCount">The number of sim updates to run. 0 or less cancels the request.</param>
+		/// <param name="seed">The seed to set the RNG to before the benchmark Activity starts.</param>
+		void SetBenchmarkToRun(int simUpdateCount, unsigned int seed);
+
+		/// <summary>
+		/// Stores the current sample of every performance counter, along with the current MO counts, as one benchmark sample. Should be called once at the end of every benchmarked sim update.
+		/// </summary>
+		void RecordBenchmarkSample();
+
+		/// <summary>
+		/// Writes the timing distribution of every performance counter, the MO counts and the peak memory usage over all recorded benchmark samples to a JSON file.
+		/// </summary>
+		/// <param name="filePath">The path of the file to write.</param>
+		/// <returns>Whether the file was written successfully.</returns>
+		bool WriteBenchmarkResults(const std::string &filePath) const;
+#pragma endregion
+
 	protected:
 
+		/// <summary>
+		/// A single finished profiling scope.
+		/// </summary>
+		struct ProfilingEvent {
+			const char *Name; //!< The name of the scope.
+			const char *Detail; //!< The detail of this instance of the scope, or nullptr if there is none.
+			long long StartTime; //!< The time the scope started at, in microseconds.
+			long long Duration; //!< How long the scope lasted, in microseconds.
+		};
+
+		/// <summary>
+		/// A ring buffer of profiling events written by a single thread. Only the owning thread writes to it, and it publishes each event through EventCount so the trace can be read without locking.
+		/// </summary>
+		struct ProfilingBuffer {
+			int ThreadID; //!< The ID this thread is shown under in the trace, in the order threads first recorded anything.
+			std::string ThreadName; //!< The name this thread is shown under in the trace.
+			std::vector<ProfilingEvent> Events; //!< The ring of events. Once it's full the oldest events get overwritten.
+			std::atomic<uint64_t> EventCount; //!< The total number of events written since the capture started, including overwritten ones.
+		};
+
+		static thread_local ProfilingBuffer *s_ProfilingBuffer; //!< The calling thread's profiling buffer, or nullptr if it hasn't recorded anything yet.
+
+		static constexpr int c_DefaultTraceCaptureLength = 60; //!< How many sim updates a profiling trace captures when no length is given.
+		static constexpr int c_ProfilingBufferSize = 65536; //!< How many events each thread's profiling buffer holds before overwriting the oldest ones.
+
 		static constexpr int c_MSPFAverageSampleSize = 10; //!< How many samples to use to calculate average MSPF value.
 		static constexpr int c_MaxSamples = 120; //!< How many performance samples to store, directly affects graph size.
 		static constexpr int c_Average = 10; //!< How many samples to use to calculate average value displayed on screen.
@@ -156,11 +341,35 @@ namespace RTE {
 		int m_MSPFAverage; //!< The average of the MSPF reading buffer above, calculated each frame.
 		int m_CurrentPing; //!< Current ping value to display on screen.
 
+		unsigned long long m_RotatedSpriteCacheHits; //!< The number of rotated sprite draws served from the cache since the counters were last reset.
+		unsigned long long m_RotatedSpriteCacheMisses; //!< The number of rotated sprite draws that had to render and cache the sprite since the counters were last reset.
+
 		std::array<std::array<int, c_MaxSamples>, PerformanceCounters::PerfCounterCount>  m_PerfPercentages; //!< Array to store percentages from SimTotal.
 		std::array<std::array<uint64_t, c_MaxSamples>, PerformanceCounters::PerfCounterCount> m_PerfData; //!< Array to store performance measurements in microseconds.
 		std::array<uint64_t, PerformanceCounters::PerfCounterCount> m_PerfMeasureStart; //!< Current measurement start time in microseconds.
 		std::array<uint64_t, PerformanceCounters::PerfCounterCount> m_PerfMeasureStop; //!< Current measurement stop time in microseconds.
 		std::array<std::string, PerformanceCounters::PerfCounterCount> m_PerfCounterNames; //!< Performance counter names displayed on screen.
+		std::array<bool, PerformanceCounters::PerfCounterCount> m_PerfMeasureTraced; //!< Whether the current measurement of each counter started while a profiling trace was being captured, so it gets recorded into the trace when it stops.
+
+		std::atomic<bool> m_CapturingTrace; //!< Whether a profiling trace is currently being captured.
+		int m_TraceCaptureRequested; //!< The number of sim updates to capture once the next sim update starts. 0 means no capture was requested.
+		int m_TraceUpdatesRemaining; //!< The number of sim updates left in the current capture.
+		bool m_TraceWritePending; //!< Whether a finished capture still needs to be written out.
+		std::mutex m_ProfilingBuffersMutex; //!< Mutex guarding the list of profiling buffers against threads registering theirs concurrently.
+		std::vector<std::unique_ptr<ProfilingBuffer>> m_ProfilingBuffers; //!< The profiling buffer of every thread that ever recorded a profiling event.
+		std::mutex m_ProfilingNamesMutex; //!< Mutex guarding the interned profiling names.
+		std::unordered_set<std::string> m_ProfilingNames; //!< Every interned profiling name. Elements never move, so pointers to them stay valid.
+		std::vector<std::pair<const char *, long long>> m_ScriptScopeStack; //!< The names and start times of the scopes started through StartScope that haven't been ended yet.
+
+		/// <summary>
+		/// The kinds of MOs counted for each benchmark sample.
+		/// </summary>
+		enum BenchmarkMOCounts { BenchmarkActors = 0, BenchmarkItems, BenchmarkParticles, BenchmarkMOIDs, BenchmarkMOCountCount };
+
+		int m_BenchmarkSimUpdateCount; //!< The number of sim updates the requested benchmark run should do. 0 means no benchmark was requested.
+		unsigned int m_BenchmarkSeed; //!< The seed the RNG is set to before the benchmark Activity starts.
+		std::array<std::vector<uint64_t>, PerformanceCounters::PerfCounterCount> m_BenchmarkCounterSamples; //!< Every recorded benchmark sample of each performance counter, in microseconds.
+		std::array<std::vector<long>, BenchmarkMOCounts::BenchmarkMOCountCount> m_BenchmarkMOCountSamples; //!< Every recorded benchmark sample of each kind of MO count.
 
 	private:
 
@@ -185,6 +394,33 @@ namespace RTE {
 		uint64_t GetPerformanceCounterAverage(PerformanceCounters counter) const;
 #pragma endregion
 
+#pragma region Profiling Trace
+		/// <summary>
+		/// Gets the calling thread's profiling buffer, creating it if this is the first time the thread records anything.
+		/// </summary>
+		/// <returns>The calling thread's profiling buffer.</returns>
+		ProfilingBuffer * GetProfilingBuffer();
+
+		/// <summary>
+		/// Starts, stops and writes out requested profiling traces. Called at the start of every sim update, so captures always cover whole updates.
+		/// </summary>
+		void UpdateTraceCapture();
+
+		/// <summary>
+		/// Writes every event in the profiling buffers to a file in Chrome's trace event format.
+		/// </summary>
+		/// <param name="filePath">The path of the file to write.</param>
+		/// <returns>Whether the file was written successfully.</returns>
+		bool WriteTrace(const std::string &filePath);
+#pragma endregion
+
+		/// <summary>
+		/// Escapes a string so it can be written between quotes in a JSON file.
+		/// </summary>
+		/// <param name="stringToEscape">The string to escape.</param>
+		/// <returns>The escaped string.</returns>
+		static std::string EscapeJSONString(const std::string &stringToEscape);
+
 		/// <summary>
 		/// Draws the performance graphs to the screen. This will be called by Draw() if advanced performance stats are enabled.
 		/// </summary>
@@ -37,15 +37,17 @@ namespace RTE {
 		m_BlueGlow = glowFile.GetAsBitmap();
 		m_BlueGlowHash = glowFile.GetHash();
 
-		// Create temporary bitmaps to rotate post effects in.
-		m_TempEffectBitmaps = {
-			{16, create_bitmap(16, 16)},
-			{32, create_bitmap(32, 32)},
-			{64, create_bitmap(64, 64)},
-			{128, create_bitmap(128, 128)},
-			{256, create_bitmap(256, 256)},
-			{512, create_bitmap(512, 512)}
-		};
+		// Create temporary bitmaps to rotate post effects in. Headless servers never post-process, they only pass the effects on to clients.
+		if (!System::IsHeadless()) {
+			m_TempEffectBitmaps = {
+				{16, create_bitmap(16, 16)},
+				{32, create_bitmap(32, 32)},
+				{64, create_bitmap(64, 64)},
+				{128, create_bitmap(128, 128)},
+				{256, create_bitmap(256, 256)},
+				{512, create_bitmap(512, 512)}
+			};
+		}
 
 		return 0;
 	}
@@ -131,7 +133,7 @@ namespace RTE {
 		// If we didn't find a match then the bitmap size is greater than 512 but that's the biggest we've got, so return it
 		if (correspondingBitmapSizeEntry == m_TempEffectBitmaps.end()) { correspondingBitmapSizeEntry = m_TempEffectBitmaps.find(512); }
 
-		return correspondingBitmapSizeEntry->second;
+		return (correspondingBitmapSizeEntry != m_TempEffectBitmaps.end()) ? correspondingBitmapSizeEntry->second : nullptr;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
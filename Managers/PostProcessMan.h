@@ -117,7 +117,7 @@ namespace RTE {
 		/// Gets a temporary bitmap of specified size to rotate post effects in.
 		/// </summary>
 		/// <param name="bitmapSize">Size of bitmap to get.</param>
-		/// <returns>Pointer to the temporary bitmap.</returns>
+		/// <returns>Pointer to the temporary bitmap, or nullptr when running headless, where there are none.</returns>
 		BITMAP * GetTempEffectBitmap(BITMAP *bitmap) const;
 #pragma endregion
 
@@ -901,6 +901,9 @@ void PresetMan::RegisterGroup(std::string newGroup, int whichModule)
     m_TotalGroupRegister.sort();
     m_TotalGroupRegister.unique();
 
+    // Give it an ID right away so group lookups don't need to deal with it being unknown
+    Entity::RegisterGroupID(newGroup);
+
     // Register in the specified module too
     m_pDataModules[whichModule]->RegisterGroup(newGroup);
 }
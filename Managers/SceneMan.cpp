@@ -30,6 +30,7 @@
 #include "MOPixel.h"
 #include "Atom.h"
 #include "Material.h"
+#include "PerformanceMan.h"
 // Temp
 #include "Controller.h"
 
@@ -160,6 +161,7 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits) {
 	if (!pNewScene) {
 		return -1;
 	}
+	auto sceneLoadTimerStart = std::chrono::high_resolution_clock::now();
 
 	g_MovableMan.PurgeAllMOs();
 	g_PostProcessMan.ClearScenePostEffects();
@@ -217,6 +219,7 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits) {
     m_pMOIDLayer = new SceneLayer();
     m_pMOIDLayer->Create(pBitmap, false, Vector(), m_pCurrentScene->WrapsX(), m_pCurrentScene->WrapsY(), Vector(1.0, 1.0));
     pBitmap = 0;
+    m_MOIDBroadphase.Create(GetSceneWidth(), GetSceneHeight(), m_pCurrentScene->WrapsX(), m_pCurrentScene->WrapsY(), c_MOIDLayerBitDepth);
 
     // Create the Debug SceneLayer
     if (m_DrawRayCastVisualizations || m_DrawPixelCheckVisualizations) {
@@ -234,6 +237,10 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits) {
 	g_NetworkServer.LockScene(false);
 	g_NetworkServer.ResetScene();
 
+	if (g_SettingsMan.IsMeasuringModuleLoadTime()) {
+		std::chrono::milliseconds sceneLoadElapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - sceneLoadTimerStart);
+		g_ConsoleMan.PrintString("Scene load duration is: " + std::to_string(sceneLoadElapsedTime.count()) + "ms");
+	}
     return 0;
 }
 
@@ -403,6 +410,7 @@ void SceneMan::Destroy()
     delete m_pCurrentScene;
     delete m_pDebugLayer;
     delete m_pMOIDLayer;
+    m_MOIDBroadphase.Destroy();
     delete m_pMOColorLayer;
     delete m_pUnseenRevealSound;
 
@@ -612,7 +620,7 @@ MOID SceneMan::GetMOIDPixel(int pixelX, int pixelY)
        pixelY >= m_pMOIDLayer->GetBitmap()->h)
         return g_NoMOID;
 
-	MOID moid = getpixel(m_pMOIDLayer->GetBitmap(), pixelX, pixelY);
+	MOID moid = g_SettingsMan.UseMOIDBroadphase() ? m_MOIDBroadphase.GetMOIDPixel(pixelX, pixelY) : getpixel(m_pMOIDLayer->GetBitmap(), pixelX, pixelY);
 	if (g_SettingsMan.SimplifiedCollisionDetection()) {
 		if (moid != ColorKeys::g_NoMOID && moid != ColorKeys::g_MOIDMaskColor) {
 			const MOSprite *mo = dynamic_cast<MOSprite *>(g_MovableMan.GetMOFromID(moid));
@@ -905,6 +913,14 @@ void SceneMan::RegisterMOIDDrawing(const Vector &center, float radius)
 
 void SceneMan::ClearAllMOIDDrawings()
 {
+    // Nothing but the debug view draws to the MOID layer with the broadphase enabled, and that clears the layer itself before drawing
+    if (g_SettingsMan.UseMOIDBroadphase())
+    {
+        m_MOIDBroadphase.ClearObjects();
+        m_MOIDDrawings.clear();
+        return;
+    }
+
     for (list<IntRect>::iterator itr = m_MOIDDrawings.begin(); itr != m_MOIDDrawings.end(); ++itr)
         ClearMOIDRect(itr->m_Left, itr->m_Top, itr->m_Right, itr->m_Bottom);
 
@@ -912,6 +928,38 @@ void SceneMan::ClearAllMOIDDrawings()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawMOIDRepresentation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws the MOID representation of a MovableObject and its Attachables
+//                  to the MOID layer, or registers it with the MOID broadphase if that
+//                  is enabled, so it gets hit by MOID pixel queries.
+
+void SceneMan::DrawMOIDRepresentation(MovableObject *movableObject)
+{
+    if (g_SettingsMan.UseMOIDBroadphase())
+        m_MOIDBroadphase.Add(movableObject);
+    else
+        movableObject->Draw(m_pMOIDLayer->GetBitmap(), Vector(), g_DrawMOID, true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearMOIDRepresentation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Erases the MOID representation of a MovableObject and its Attachables
+//                  from the MOID layer, or unregisters it from the MOID broadphase if
+//                  that is enabled, so it stops getting hit by MOID pixel queries.
+
+void SceneMan::ClearMOIDRepresentation(MovableObject *movableObject)
+{
+    if (g_SettingsMan.UseMOIDBroadphase())
+        m_MOIDBroadphase.Remove(movableObject);
+    else
+        movableObject->Draw(m_pMOIDLayer->GetBitmap(), Vector(), g_DrawNoMOID, true);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOIDRect
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1243,6 +1291,24 @@ bool SceneMan::TryPenetrate(int posX,
 //    float spraySpread = 10.0;
     float impMag = impulse.GetMagnitude();
 
+    // Particles traveling in parallel can't touch the terrain, so only decide whether this penetrates here and redo the whole thing for real during the serial merge.
+    if (MovableMan::IsDeferringTravelCommands())
+    {
+        if (impMag < sceneMat->GetIntegrity())
+            return false;
+
+        retardation = -(sceneMat->GetIntegrity() / impMag);
+        MovableMan::DeferTravelCommand([this, posX, posY, materialID, impulse, velocity, airRatio, numPenetrations, removeOrphansRadius, removeOrphansMaxArea, removeOrphansRate]() {
+            // A command merged before this one may have already knocked out or replaced the pixel, in which case this particle never hit what it penetrated.
+            if (_getpixel(m_pCurrentScene->GetTerrain()->GetMaterialBitmap(), posX, posY) != materialID)
+                return;
+
+            float deferredRetardation = 0;
+            TryPenetrate(posX, posY, impulse, velocity, deferredRetardation, airRatio, numPenetrations, removeOrphansRadius, removeOrphansMaxArea, removeOrphansRate);
+        });
+        return true;
+    }
+
     // Test if impulse force is enough to penetrate
     if (impMag >= sceneMat->GetIntegrity())
     {
@@ -1366,6 +1432,7 @@ bool SceneMan::TryPenetrate(int posX,
 						RegisterTerrainChange(posX, testY, 1, 1, g_MaskColor, false);
                         _putpixel(pFGColor, posX, testY, g_MaskColor);
                         _putpixel(pMaterial, posX, testY, g_MaterialAir);
+                        m_pCurrentScene->GetTerrain()->MarkDirtyTiles(posX, testY, 1, 1);
                     }
                     // There is support, so stop checking
                     else
@@ -1637,6 +1704,7 @@ void SceneMan::RestoreUnseenBox(const int posX, const int posY, const int width,
 //TODO Every raycast should use some shared line drawing method (or maybe something more efficient if it exists, that needs looking into) instead of having a ton of duplicated code.
 bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip, bool reveal)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastUnseenRay");
     if (!m_pCurrentScene->GetUnseenLayer(team))
         return false;
 
@@ -1772,6 +1840,7 @@ bool SceneMan::CastUnseeRay(int team, const Vector &start, const Vector &ray, Ve
 
 bool SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool wrap)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastMaterialRay");
 
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
@@ -1890,6 +1959,7 @@ float SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned
 
 bool SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool checkMOs)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastNotMaterialRay");
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
     bool foundPixel = false;
@@ -2200,6 +2270,7 @@ float SceneMan::CastMaxStrengthRay(const Vector &start, const Vector &end, int s
 
 bool SceneMan::CastStrengthRay(const Vector &start, const Vector &ray, float strength, Vector &result, int skip, unsigned char ignoreMaterial, bool wrap)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastStrengthRay");
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
     bool foundPixel = false;
@@ -2416,6 +2487,7 @@ bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float str
 
 MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastMORay");
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
     MOID hitMOID = g_NoMOID;
@@ -2544,6 +2616,7 @@ MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID
 
 bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID targetMOID, Vector &resultPos, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastFindMORay");
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
     MOID hitMOID = g_NoMOID;
@@ -2653,6 +2726,7 @@ bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID target
 
 float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip)
 {
+    PerformanceMan::ProfilingScope profilingScope("SceneMan::CastObstacleRay");
     int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
     bool hitObstacle = false;
@@ -3151,7 +3225,14 @@ float SceneMan::ShortestDistanceY(float val1, float val2, bool checkBounds, int
 
 bool SceneMan::ObscuredPoint(int x, int y, int team)
 {
-    bool obscured = m_pMOIDLayer->GetPixel(x, y) != g_NoMOID || m_pCurrentScene->GetTerrain()->GetPixel(x, y) != g_MaterialAir;
+    bool obscured;
+    if (g_SettingsMan.UseMOIDBroadphase())
+    {
+        WrapPosition(x, y);
+        obscured = m_MOIDBroadphase.GetMOIDPixel(x, y) != g_NoMOID || m_pCurrentScene->GetTerrain()->GetPixel(x, y) != g_MaterialAir;
+    }
+    else
+        obscured = m_pMOIDLayer->GetPixel(x, y) != g_NoMOID || m_pCurrentScene->GetTerrain()->GetPixel(x, y) != g_MaterialAir;
 
     if (team != Activity::NoTeam)
         obscured = obscured || IsUnseen(x, y, team);
@@ -3292,13 +3373,9 @@ bool SceneMan::AddTerrainObject(TerrainObject *pObject)
         return false;
 
     bool result =  m_pCurrentScene->GetTerrain()->ApplyObject(pObject);
+	// Applying the object marked the tiles it covers as changed, so this only cleans around it and whatever else changed since the last clean
 	if (result)
-	{
-		Vector corner = pObject->GetPos() + pObject->GetBitmapOffset();
-		Box box = Box(corner, pObject->GetBitmapWidth(), pObject->GetBitmapHeight());
-		
-		m_pCurrentScene->GetTerrain()->CleanAirBox(box, GetScene()->WrapsX(), GetScene()->WrapsY());
-	}
+		m_pCurrentScene->GetTerrain()->CleanAir();
 	return result;
 }
 
@@ -3514,6 +3591,12 @@ void SceneMan::Draw(BITMAP *pTargetBitmap, BITMAP *pTargetGUIBitmap, const Vecto
             pTerrain->Draw(pTargetBitmap, targetBox);
             break;
         case g_LayerMOID:
+            // The broadphase only draws the MOs that were queried, so fill in the whole layer just for viewing it
+            if (g_SettingsMan.UseMOIDBroadphase())
+            {
+                clear_to_color(m_pMOIDLayer->GetBitmap(), g_NoMOID);
+                m_MOIDBroadphase.DrawAll(m_pMOIDLayer->GetBitmap());
+            }
             m_pMOIDLayer->Draw(pTargetBitmap, targetBox);
             break;
         // Draw normally
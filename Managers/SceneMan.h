@@ -18,6 +18,7 @@
 #include "Timer.h"
 #include "Box.h"
 #include "Singleton.h"
+#include "MOIDBroadphase.h"
 
 #include "ActivityMan.h"
 
@@ -790,6 +791,42 @@ public:
     void ClearAllMOIDDrawings();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawMOIDRepresentation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws the MOID representation of a MovableObject and its Attachables
+//                  to the MOID layer, or registers it with the MOID broadphase if that
+//                  is enabled, so it gets hit by MOID pixel queries.
+// Arguments:       The MovableObject to draw. Ownership is NOT transferred!
+// Return value:    None.
+
+    void DrawMOIDRepresentation(MovableObject *movableObject);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearMOIDRepresentation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Erases the MOID representation of a MovableObject and its Attachables
+//                  from the MOID layer, or unregisters it from the MOID broadphase if
+//                  that is enabled, so it stops getting hit by MOID pixel queries.
+// Arguments:       The MovableObject to erase. Ownership is NOT transferred!
+// Return value:    None.
+
+    void ClearMOIDRepresentation(MovableObject *movableObject);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UnregisterMOIDRepresentation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes a MovableObject from the MOID broadphase without drawing
+//                  anything, so it can be safely deleted. Does nothing when the MOID
+//                  broadphase is disabled or the MovableObject isn't registered.
+// Arguments:       The MovableObject to remove.
+// Return value:    None.
+
+    void UnregisterMOIDRepresentation(const MovableObject *movableObject) { m_MOIDBroadphase.Remove(movableObject); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOIDRect
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1686,6 +1723,8 @@ public:
     SceneLayer *m_pMOIDLayer;
     // All the areas drawn within on the MOID layer since last Update
     std::list<IntRect> m_MOIDDrawings;
+    // Answers MOID pixel queries instead of the MOID layer when enabled in settings, so not every MO has to be drawn to the layer each sim update
+    MOIDBroadphase m_MOIDBroadphase;
 
     // Debug layer for seeing cast rays etc
     SceneLayer *m_pDebugLayer;
@@ -8,6 +8,7 @@
 #include "UInputMan.h"
 #include "NetworkClient.h"
 #include "NetworkServer.h"
+#include "ThreadMan.h"
 
 namespace RTE {
 
@@ -42,6 +43,7 @@ namespace RTE {
 
 		m_RecommendedMOIDCount = 240;
 		m_SimplifiedCollisionDetection = false;
+		m_UseMOIDBroadphase = false;
 
 		m_SkipIntro = false;
 		m_ShowToolTips = true;
@@ -108,6 +110,8 @@ namespace RTE {
 			reader >> g_FrameMan.m_ForceDedicatedFullScreenGfxDriver;
 		} else if (propName == "TwoPlayerSplitscreenVertSplit") {
 			reader >> g_FrameMan.m_TwoPlayerVSplit;
+		} else if (propName == "RotatedSpriteCacheMemoryBudget") {
+			g_FrameMan.m_RotatedSpriteCache.SetMemoryBudget(std::stoi(reader.ReadPropValue()));
 		} else if (propName == "MasterVolume") {
 			g_AudioMan.SetMasterVolume(std::stof(reader.ReadPropValue()) / 100.0F);
 		} else if (propName == "MuteMaster") {
@@ -167,14 +171,26 @@ namespace RTE {
 			reader >> g_SceneMan.m_DefaultSceneName;
 		} else if (propName == "DisableLuaJIT") {
 			reader >> g_LuaMan.m_DisableLuaJIT;
+		} else if (propName == "LuaScriptUpdateBudget") {
+			reader >> g_LuaMan.m_ScriptUpdateBudget;
+		} else if (propName == "LuaScriptProfiling") {
+			reader >> g_LuaMan.m_ScriptProfilingEnabled;
 		} else if (propName == "RecommendedMOIDCount") {
 			reader >> m_RecommendedMOIDCount;
 		} else if (propName == "SimplifiedCollisionDetection") {
 			reader >> m_SimplifiedCollisionDetection;
+		} else if (propName == "UseMOIDBroadphase") {
+			reader >> m_UseMOIDBroadphase;
 		} else if (propName == "EnableParticleSettling") {
 			reader >> g_MovableMan.m_SettlingEnabled;
 		} else if (propName == "EnableMOSubtraction") {
 			reader >> g_MovableMan.m_MOSubtractionEnabled;
+		} else if (propName == "ParallelParticleTravel") {
+			reader >> g_MovableMan.m_ParallelParticleTravel;
+		} else if (propName == "PixelParticleStore") {
+			reader >> g_MovableMan.m_PixelParticleStoreEnabled;
+		} else if (propName == "WorkerThreadCount") {
+			reader >> g_ThreadMan.m_WorkerThreadCount;
 		} else if (propName == "DeltaTime") {
 			g_TimerMan.SetDeltaTimeSecs(std::stof(reader.ReadPropValue()));
 		} else if (propName == "RealToSimCap") {
@@ -243,10 +259,16 @@ namespace RTE {
 			reader >> g_NetworkServer.m_UseFastCompression;
 		} else if (propName == "ServerHighCompressionLevel") {
 			reader >> g_NetworkServer.m_HighCompressionLevel;
+		} else if (propName == "ServerSceneCompressionLevel") {
+			reader >> g_NetworkServer.m_SceneCompressionLevel;
 		} else if (propName == "ServerFastAccelerationFactor") {
 			reader >> g_NetworkServer.m_FastAccelerationFactor;
 		} else if (propName == "ServerUseInterlacing") {
 			reader >> g_NetworkServer.m_UseInterlacing;
+		} else if (propName == "ServerUseDeltaCompression") {
+			reader >> g_NetworkServer.m_UseDeltaCompression;
+		} else if (propName == "ServerUseEntityReplication") {
+			reader >> g_NetworkServer.m_UseEntityReplication;
 		} else if (propName == "ServerEncodingFps") {
 			reader >> g_NetworkServer.m_EncodingFps;
 		} else if (propName == "ServerSleepWhenIdle") {
@@ -292,6 +314,7 @@ namespace RTE {
 		writer.NewPropertyWithValue("ForceVirtualFullScreenGfxDriver", g_FrameMan.m_ForceVirtualFullScreenGfxDriver);
 		writer.NewPropertyWithValue("ForceDedicatedFullScreenGfxDriver", g_FrameMan.m_ForceDedicatedFullScreenGfxDriver);
 		writer.NewPropertyWithValue("TwoPlayerSplitscreenVertSplit", g_FrameMan.m_TwoPlayerVSplit);
+		writer.NewPropertyWithValue("RotatedSpriteCacheMemoryBudget", g_FrameMan.m_RotatedSpriteCache.GetMemoryBudget());
 
 		writer.NewLine(false, 2);
 		writer.NewDivider(false);
@@ -343,10 +366,16 @@ namespace RTE {
 		writer.NewLineString("// Engine Settings", false);
 		writer.NewLine(false);
 		writer.NewPropertyWithValue("DisableLuaJIT", g_LuaMan.m_DisableLuaJIT);
+		writer.NewPropertyWithValue("LuaScriptUpdateBudget", g_LuaMan.m_ScriptUpdateBudget);
+		writer.NewPropertyWithValue("LuaScriptProfiling", g_LuaMan.m_ScriptProfilingEnabled);
 		writer.NewPropertyWithValue("RecommendedMOIDCount", m_RecommendedMOIDCount);
 		writer.NewPropertyWithValue("SimplifiedCollisionDetection", m_SimplifiedCollisionDetection);
+		writer.NewPropertyWithValue("UseMOIDBroadphase", m_UseMOIDBroadphase);
 		writer.NewPropertyWithValue("EnableParticleSettling", g_MovableMan.m_SettlingEnabled);
 		writer.NewPropertyWithValue("EnableMOSubtraction", g_MovableMan.m_MOSubtractionEnabled);
+		writer.NewPropertyWithValue("ParallelParticleTravel", g_MovableMan.m_ParallelParticleTravel);
+		writer.NewPropertyWithValue("PixelParticleStore", g_MovableMan.m_PixelParticleStoreEnabled);
+		writer.NewPropertyWithValue("WorkerThreadCount", g_ThreadMan.m_WorkerThreadCount);
 		writer.NewPropertyWithValue("DeltaTime", g_TimerMan.GetDeltaTimeSecs());
 		writer.NewPropertyWithValue("RealToSimCap", g_TimerMan.GetRealToSimCap());
 
@@ -406,8 +435,11 @@ namespace RTE {
 		writer.NewPropertyWithValue("ServerUseHighCompression", g_NetworkServer.m_UseHighCompression);
 		writer.NewPropertyWithValue("ServerUseFastCompression", g_NetworkServer.m_UseFastCompression);
 		writer.NewPropertyWithValue("ServerHighCompressionLevel", g_NetworkServer.m_HighCompressionLevel);
+		writer.NewPropertyWithValue("ServerSceneCompressionLevel", g_NetworkServer.m_SceneCompressionLevel);
 		writer.NewPropertyWithValue("ServerFastAccelerationFactor", g_NetworkServer.m_FastAccelerationFactor);
 		writer.NewPropertyWithValue("ServerUseInterlacing", g_NetworkServer.m_UseInterlacing);
+		writer.NewPropertyWithValue("ServerUseDeltaCompression", g_NetworkServer.m_UseDeltaCompression);
+		writer.NewPropertyWithValue("ServerUseEntityReplication", g_NetworkServer.m_UseEntityReplication);
 		writer.NewPropertyWithValue("ServerEncodingFps", g_NetworkServer.m_EncodingFps);
 		writer.NewPropertyWithValue("ServerSleepWhenIdle", g_NetworkServer.m_SleepWhenIdle);
 		writer.NewPropertyWithValue("ServerSimSleepWhenIdle", g_NetworkServer.m_SimSleepWhenIdle);
@@ -68,6 +68,12 @@ namespace RTE {
 		/// </summary>
 		/// <returns>Whether simplified collision detection is enabled or not.</returns>
 		bool SimplifiedCollisionDetection() const { return m_SimplifiedCollisionDetection; }
+
+		/// <summary>
+		/// Gets whether MOID layer queries are answered by the MOID broadphase instead of drawing every MO to the MOID layer each sim update.
+		/// </summary>
+		/// <returns>Whether the MOID broadphase is enabled or not.</returns>
+		bool UseMOIDBroadphase() const { return m_UseMOIDBroadphase; }
 #pragma endregion
 
 #pragma region Gameplay Settings
@@ -418,13 +424,13 @@ namespace RTE {
 		void SetMenuTransitionDurationMultiplier(float newSpeed) { m_MenuTransitionDurationMultiplier = std::max(0.0F, newSpeed); }
 
 		/// <summary>
-		/// Gets whether the duration of module loading (extraction included) is being measured or not. For benchmarking purposes.
+		/// Gets whether the duration of module loading (extraction included) and Scene loading is being measured or not. For benchmarking purposes.
 		/// </summary>
 		/// <returns>Whether duration is being measured or not.</returns>
 		bool IsMeasuringModuleLoadTime() const { return m_MeasureModuleLoadTime; }
 
 		/// <summary>
-		/// Sets whether the duration of module loading (extraction included) should be measured or not. For benchmarking purposes.
+		/// Sets whether the duration of module loading (extraction included) and Scene loading should be measured or not. For benchmarking purposes.
 		/// </summary>
 		/// <param name="measure">Whether duration should be measured or not.</param>
 		void MeasureModuleLoadTime(bool measure) { m_MeasureModuleLoadTime = measure; }
@@ -457,6 +463,7 @@ namespace RTE {
 
 		int m_RecommendedMOIDCount; //!< Recommended max MOID's before removing actors from scenes.
 		bool m_SimplifiedCollisionDetection; //!< Whether simplified collision detection (reduced MOID layer sampling) is enabled.
+		bool m_UseMOIDBroadphase; //!< Whether MOID layer queries are answered by the MOID broadphase instead of drawing every MO to the MOID layer each sim update.
 
 		bool m_SkipIntro; //!< Whether to play the intro of the game or skip directly to the main menu.
 		bool m_ShowToolTips; //!< Whether ToolTips are enabled or not.
@@ -468,7 +475,7 @@ namespace RTE {
 		bool m_DrawHandAndFootGroupVisualizations; //!< Whether to draw Actor HandGroups and FootGroups to the Scene MO color Bitmap.
 		bool m_DrawLimbPathVisualizations; //!< Whether to draw Actor LimbPaths to the Scene MO color Bitmap.
 		bool m_PrintDebugInfo; //!< Print some debug info in console.
-		bool m_MeasureModuleLoadTime; //!< Whether to measure the duration of data module loading (extraction included). For benchmarking purposes.
+		bool m_MeasureModuleLoadTime; //!< Whether to measure the duration of data module loading (extraction included) and Scene loading. For benchmarking purposes.
 
 		std::list<std::string> m_VisibleAssemblyGroupsList; //!< List of assemblies groups always shown in editors.
 		std::map<std::string, bool> m_DisabledMods; //!< Map of the module names we disabled.
@@ -1,62 +1,61 @@
-//////////////////////////////////////////////////////////////////////////////////////////
-// File:            ThreadMan.cpp
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Source file for the ThreadMan class.
-// Project:         Retro Terrain Engine
-// Author(s):       
-//                  
-//                  
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Inclusions of header files
-
-
 #include "ThreadMan.h"
 
-using namespace std;
+namespace RTE {
 
-namespace RTE
-{
+	const std::string ThreadMan::c_ClassName = "ThreadMan";
 
-#define DELTABUFFERSIZE 30
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-const string ThreadMan::m_ClassName = "ThreadMan";
+	void ThreadMan::Clear() {
+		m_WorkerThreadCount = 0;
+		m_FrameJobs.clear();
+	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Clear
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears all the member variables of this ThreadMan, effectively
-//                  resetting the members of this abstraction level only.
+	int ThreadMan::Initialize() {
+		int workerCount = m_WorkerThreadCount;
+		if (workerCount <= 0) { workerCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0); }
 
-void ThreadMan::Clear()
-{
-}
+		Start(workerCount);
+		return 0;
+	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Create
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Makes the ThreadMan object ready for use.
+	void ThreadMan::Destroy() {
+		CompleteFrameJobs();
+		Stop();
 
-int ThreadMan::Create()
-{
-
-	return 0;
-}
+		int workerThreadCount = m_WorkerThreadCount;
+		Clear();
+		m_WorkerThreadCount = workerThreadCount;
+	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Destroy
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Destroys and resets (through Clear()) the ThreadMan object.
+	ThreadMan::JobHandle ThreadMan::SubmitFrameJob(std::function<void()> work, const std::vector<JobHandle> &dependencies) {
+		JobHandle job = Submit(std::move(work), dependencies);
+		std::lock_guard<std::mutex> frameJobsLock(m_FrameJobsMutex);
+		m_FrameJobs.emplace_back(job);
+		return job;
+	}
 
-void ThreadMan::Destroy()
-{
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-
-    Clear();
+	void ThreadMan::CompleteFrameJobs() {
+		std::vector<JobHandle> frameJobs;
+		// Frame Jobs may submit more frame Jobs, so keep draining until nothing new shows up.
+		while (true) {
+			{
+				std::lock_guard<std::mutex> frameJobsLock(m_FrameJobsMutex);
+				if (m_FrameJobs.empty()) {
+					break;
+				}
+				frameJobs.swap(m_FrameJobs);
+			}
+			WaitForAll(frameJobs);
+			frameJobs.clear();
+		}
+	}
 }
-
-} // namespace RTE
\ No newline at end of file
@@ -202,6 +202,11 @@ namespace RTE {
 		/// Updates the real time ticks based on the actual clock time and adds it to the accumulator which the simulation ticks will draw from in whole DeltaTime-sized chunks.
 		/// </summary>
 		void Update();
+
+		/// <summary>
+		/// Replaces whatever real time was accumulated with exactly one DeltaTime, so the next UpdateSim does one sim update no matter how fast or slow the last one was. Used to run the sim unthrottled, e.g. when benchmarking.
+		/// </summary>
+		void SetAccumulatorToOneSimUpdate() { m_SimAccumulator = m_DeltaTime; }
 #pragma endregion
 
 #pragma region Network Handling
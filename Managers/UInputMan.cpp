@@ -109,6 +109,10 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int UInputMan::Initialize() {
+		// Headless servers only ever get input from clients over the network, and there are no local devices to install anyway.
+		if (System::IsHeadless()) {
+			return 0;
+		}
 		if (install_keyboard() != 0) { RTEAbort("Failed to initialize keyboard!"); }
 		setlocale(LC_ALL, "C");
 
@@ -728,6 +732,12 @@ namespace RTE {
 	int UInputMan::Update() {
 		m_LastDeviceWhichControlledGUICursor = InputDevice::DEVICE_KEYB_ONLY;
 
+		// Headless servers never installed any local devices, so only the input received from clients needs updating.
+		if (System::IsHeadless()) {
+			UpdateNetworkMouseMovement();
+			return 0;
+		}
+
 		if (keyboard_needs_poll()) { poll_keyboard(); }
 		if (mouse_needs_poll()) { poll_mouse(); }
 		poll_joystick();
@@ -826,6 +836,8 @@ namespace RTE {
 				g_ConsoleMan.SaveInputLog("Console.input.log");
 			} else if (KeyPressed(KEY_F5)) {
 				g_ConsoleMan.ClearLog();
+			} else if (KeyPressed(KEY_F6)) {
+				g_PerformanceMan.CaptureTrace();
 			}
 
 			if (g_PerformanceMan.IsShowingPerformanceStats()) {
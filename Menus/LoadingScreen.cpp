@@ -24,6 +24,18 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void LoadingScreen::Create(AllegroScreen *guiScreen, AllegroInput *guiInput, bool progressReportDisabled) {
+		if (!m_LoadingLogWriter) {
+			m_LoadingLogWriter = std::make_unique<Writer>("LogLoading.txt");
+			if (!m_LoadingLogWriter->WriterOK()) {
+				ShowMessageBox("Failed to instantiate the Loading Log writer!\nModule loading will proceed without being logged!");
+				m_LoadingLogWriter.reset();
+			}
+		}
+		// There's nothing to show the loading screen on when running headless, so only the loading log is kept.
+		if (System::IsHeadless()) {
+			return;
+		}
+
 		GUIControlManager loadingScreenManager;
 		RTEAssert(loadingScreenManager.Create(guiScreen, guiInput, "Base.rte/GUIs/Skins/Menus", "LoadingScreenSkin.ini"), "Failed to create GUI Control Manager and load it from Base.rte/GUIs/Skins/Menus/LoadingScreenSkin.ini");
 		loadingScreenManager.Load("Base.rte/GUIs/LoadingGUI.ini");
@@ -42,14 +54,6 @@ namespace RTE {
 
 		if (!progressReportDisabled) { draw_sprite(g_FrameMan.GetBackBuffer32(), m_ProgressListboxBitmap, m_ProgressListboxPosX, m_ProgressListboxPosY); }
 		g_FrameMan.FlipFrameBuffers();
-
-		if (!m_LoadingLogWriter) {
-			m_LoadingLogWriter = std::make_unique<Writer>("LogLoading.txt");
-			if (!m_LoadingLogWriter->WriterOK()) {
-				ShowMessageBox("Failed to instantiate the Loading Log writer!\nModule loading will proceed without being logged!");
-				m_LoadingLogWriter.reset();
-			}
-		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
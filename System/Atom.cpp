@@ -969,8 +969,18 @@ namespace RTE {
 		// Draw the trail
 		if (g_TimerMan.DrawnSimUpdate() && m_TrailLength) {
 			int length = static_cast<int>(static_cast<float>(m_TrailLength) * RandomNum(1.0F - m_TrailLengthVariation, 1.0F));
-			for (int i = trailPoints.size() - std::min(length, static_cast<int>(trailPoints.size())); i < trailPoints.size(); ++i) {
-				putpixel(trailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+			if (MovableMan::IsDeferringTravelCommands()) {
+				std::vector<std::pair<int, int>> drawnTrailPoints(trailPoints.end() - std::min(length, static_cast<int>(trailPoints.size())), trailPoints.end());
+				MovableMan::DeferTravelCommand([trailBitmap, drawnTrailPoints, trailColor = m_TrailColor.GetIndex()]() {
+					for (const auto &[trailPointX, trailPointY] : drawnTrailPoints) {
+						putpixel(trailBitmap, trailPointX, trailPointY, trailColor);
+					}
+				});
+			} else {
+				int trailPointCount = static_cast<int>(trailPoints.size());
+				for (int i = trailPointCount - std::min(length, trailPointCount); i < trailPointCount; ++i) {
+					putpixel(trailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+				}
 			}
 		}
 
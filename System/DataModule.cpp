@@ -21,6 +21,8 @@ namespace RTE {
 		m_PresetList.clear();
 		m_EntityList.clear();
 		m_TypeMap.clear();
+		m_GroupIndex.clear();
+		m_GroupIndexChangeCount = 0;
 		m_MaterialMappings.fill(0);
 		m_ScanFolderContents = false;
 		m_IgnoreMissingItems = false;
@@ -216,6 +218,8 @@ namespace RTE {
 				entityToAdd->Clone(existingEntity);
 				// Make sure the existing one is still marked as the Original Preset
 				existingEntity->m_IsOriginalPreset = true;
+				// The overwritten Preset can be in different groups than before
+				m_GroupIndex.clear();
 				// Alter the instance entry to reflect the data file location of the new definition
 				if (readFromFile != "Same") {
 					std::list<PresetEntry>::iterator itr = m_PresetList.begin();
@@ -290,22 +294,25 @@ namespace RTE {
 			return false;
 		}
 
-		bool foundAny = false;
-
-		// Find either the Entity typelist that contains all entities in this DataModule, or the specific class' typelist (which will get all derived classes too)
-		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::iterator classItr = m_TypeMap.find((type.empty() || type == "All") ? "Entity" : type);
-
-		if (classItr != m_TypeMap.end()) {
-			RTEAssert(!classItr->second.empty(), "DataModule has class entry without instances in its map!?");
+		// Use either the Entity typelist that contains all entities in this DataModule, or the specific class' typelist (which will get all derived classes too)
+		const std::string &typeToGet = (type.empty() || type == "All") ? "Entity" : type;
 
-			for (const std::pair<std::string, Entity *> &instance : classItr->second) {
-				if (instance.second->IsInGroup(group)) {
-					entityList.push_back(instance.second); // Get the grouped entities, without transferring ownership
-					foundAny = true;
-				}
-			}
+		// Every Entity is in the Any and All groups, and none are in the None group, so these don't need the index
+		if (group == "Any" || group == "All") {
+			return GetAllOfType(entityList, typeToGet);
 		}
-		return foundAny;
+		int groupID = Entity::GetGroupID(group);
+		if (group == "None" || groupID < 0) {
+			return false;
+		}
+		const std::vector<std::vector<Entity *>> *groupIndex = GetGroupIndex(typeToGet);
+		if (!groupIndex || static_cast<size_t>(groupID) >= groupIndex->size()) {
+			return false;
+		}
+		// Get the grouped entities, without transferring ownership
+		const std::vector<Entity *> &groupEntities = (*groupIndex)[groupID];
+		entityList.insert(entityList.end(), groupEntities.begin(), groupEntities.end());
+		return !groupEntities.empty();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -410,6 +417,38 @@ namespace RTE {
 			// NOTE We're adding the entity to the class category list but not transferring ownership. Also, we're not checking for collisions as they're assumed to have been checked for already
 			(*classItr).second.push_back(std::pair<std::string, Entity *>(entityToAdd->GetPresetName(), entityToAdd));
 		}
+		m_GroupIndex.clear();
 		return true;
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const std::vector<std::vector<Entity *>> * DataModule::GetGroupIndex(const std::string &type) {
+		if (m_GroupIndexChangeCount != Entity::GetPresetGroupChangeCount()) {
+			m_GroupIndex.clear();
+			m_GroupIndexChangeCount = Entity::GetPresetGroupChangeCount();
+		}
+		if (std::unordered_map<std::string, std::vector<std::vector<Entity *>>>::const_iterator groupIndexEntry = m_GroupIndex.find(type); groupIndexEntry != m_GroupIndex.end()) {
+			return &groupIndexEntry->second;
+		}
+		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::const_iterator classItr = m_TypeMap.find(type);
+		if (classItr == m_TypeMap.end()) {
+			return nullptr;
+		}
+		RTEAssert(!classItr->second.empty(), "DataModule has class entry without instances in its map!?");
+
+		std::vector<std::vector<Entity *>> &groupIndex = m_GroupIndex[type];
+		for (const auto &[presetName, entity] : classItr->second) {
+			for (const std::string &groupName : *entity->GetGroupList()) {
+				int groupID = Entity::GetGroupID(groupName);
+				if (groupID < 0) {
+					continue;
+				}
+				if (static_cast<size_t>(groupID) >= groupIndex.size()) { groupIndex.resize(groupID + 1); }
+				// The group list can have the same group more than once, but the index shouldn't
+				if (groupIndex[groupID].empty() || groupIndex[groupID].back() != entity) { groupIndex[groupID].emplace_back(entity); }
+			}
+		}
+		return &groupIndex;
+	}
 }
\ No newline at end of file
@@ -292,6 +292,14 @@ namespace RTE {
 		/// </summary>
 		std::map<std::string, std::list<std::pair<std::string, Entity *>>> m_TypeMap;
 
+		/// <summary>
+		/// Map of class names to the Entities of that class and its derivatives in each group, indexed by group ID, in the same order as in the type map.
+		/// Each class' index is made the first time a group of that class is asked for, and all of them are thrown away whenever any Preset's groups change.
+		/// The Entity instances are NOT owned by this map.
+		/// </summary>
+		std::unordered_map<std::string, std::vector<std::vector<Entity *>>> m_GroupIndex;
+		unsigned int m_GroupIndexChangeCount; //!< The Entity Preset group change count the group index was made at.
+
 	private:
 
 		static const std::string c_ClassName; //!< A string with the friendly-formatted type name of this object.
@@ -324,6 +332,13 @@ namespace RTE {
 		/// <param name="entityToAdd">The new object instance to add. OWNERSHIP IS NOT TRANSFERRED!</param>
 		/// <returns>Whether the Entity was added successfully or not.</returns>
 		bool AddToTypeMap(Entity *entityToAdd);
+
+		/// <summary>
+		/// Gets the group index of a class, making it first if needed.
+		/// </summary>
+		/// <param name="type">The name of the class to get the group index of.</param>
+		/// <returns>The Entities of the class and its derivatives in each group, indexed by group ID, or nullptr if there are no Entities of the class in this. Ownership is NOT transferred!</returns>
+		const std::vector<std::vector<Entity *>> * GetGroupIndex(const std::string &type);
 #pragma endregion
 
 		/// <summary>
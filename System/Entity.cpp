@@ -8,38 +8,34 @@ namespace RTE {
 
 	Entity::ClassInfo Entity::m_sClass("Entity");
 	Entity::ClassInfo * Entity::ClassInfo::s_ClassHead = 0;
+	unsigned int Entity::s_PresetGroupChangeCount = 0;
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Entity::Clear() {
-		m_PresetName = "None";
+		// All blank Entities can share the same PresetData, so clearing doesn't have to allocate anything
+		static const std::shared_ptr<const PresetData> defaultPresetData = std::make_shared<PresetData>();
+		m_PresetData = defaultPresetData;
 		m_IsOriginalPreset = false;
 		m_DefinedInModule = -1;
-		m_PresetDescription.clear();
-		m_Groups.clear();
-		m_LastGroupSearch.clear();
-		m_LastGroupResult = false;
 		m_RandomWeight = 100;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int Entity::Create() {
-		m_Groups.push_back("All"); // Special "All" group that includes.. all
+		GetWritablePresetData().Groups.push_back("All"); // Special "All" group that includes.. all
+		SetGroupBit(RegisterGroupID("All"), true);
 		return 0;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int Entity::Create(const Entity &reference) {
-		m_PresetName = reference.m_PresetName;
+		// The PresetData is only shared here, it'll get copied if either this or the reference changes it later
+		m_PresetData = reference.m_PresetData;
 		// Note how m_IsOriginalPreset is NOT assigned, automatically indicating that the copy is not an original Preset!
 		m_DefinedInModule = reference.m_DefinedInModule;
-		m_PresetDescription = reference.m_PresetDescription;
-
-		for (const std::string &group : reference.m_Groups) {
-			m_Groups.push_back(group);
-		}
 		m_RandomWeight = reference.m_RandomWeight;
 		return 0;
 	}
@@ -59,24 +55,25 @@ namespace RTE {
 		} else if (propName == "PresetName" || propName == "InstanceName") {
 			SetPresetName(reader.ReadPropValue());
 			// Preset name might have "[ModuleName]/" preceding it, detect it here and select proper module!
-			int slashPos = m_PresetName.find_first_of('/');
-			if (slashPos != std::string::npos) { m_PresetName = m_PresetName.substr(slashPos + 1); }
+			int slashPos = GetPresetName().find_first_of('/');
+			if (slashPos != std::string::npos) { GetWritablePresetData().PresetName.erase(0, slashPos + 1); }
 			// Mark this so that the derived class knows it should be added to the PresetMan when it's done reading all properties.
 			m_IsOriginalPreset = true;
 			// Indicate where this was read from
 			m_DefinedInModule = reader.GetReadModuleID();
 		} else if (propName == "Description") {
 			std::string descriptionValue = reader.ReadPropValue();
+			std::string &presetDescription = GetWritablePresetData().Description;
 			if (descriptionValue == "MultiLineText") {
-				m_PresetDescription.clear();
+				presetDescription.clear();
 				while (reader.NextProperty() && reader.ReadPropName() == "AddLine") {
-					m_PresetDescription += reader.ReadPropValue() + "\n\n";
+					presetDescription += reader.ReadPropValue() + "\n\n";
 				}
-				if (!m_PresetDescription.empty()) {
-					m_PresetDescription.resize(m_PresetDescription.size() - 2);
+				if (!presetDescription.empty()) {
+					presetDescription.resize(presetDescription.size() - 2);
 				}
 			} else {
-				m_PresetDescription = descriptionValue;
+				presetDescription = descriptionValue;
 			}
 		} else if (propName == "RandomWeight") {
 			reader >> m_RandomWeight;
@@ -102,16 +99,16 @@ namespace RTE {
 
 		// Is an original preset definition
 		if (m_IsOriginalPreset) {
-			writer.NewPropertyWithValue("PresetName", m_PresetName);
+			writer.NewPropertyWithValue("PresetName", GetPresetName());
 		// Only write out a copy reference if there is one
-		} else if (!m_PresetName.empty() && m_PresetName != "None") {
+		} else if (!GetPresetName().empty() && GetPresetName() != "None") {
 			writer.NewPropertyWithValue("CopyOf", GetModuleAndPresetName());
 		}
-		if (!m_PresetDescription.empty()) { writer.NewPropertyWithValue("Description", m_PresetDescription); }
+		if (!GetDescription().empty()) { writer.NewPropertyWithValue("Description", GetDescription()); }
 
 		// TODO: Make proper save system that knows not to save redundant data!
 		/*
-		for (list<string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr) {
+		for (list<string>::const_iterator itr = m_PresetData->Groups.begin(); itr != m_PresetData->Groups.end(); ++itr) {
 			writer.NewPropertyWithValue("AddToGroup", *itr);
 		}
 		*/
@@ -171,11 +168,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool Entity::IsInGroup(const std::string &whichGroup) {
-		// Do quick check against last search try to see if we can answer without searching again
-		if (!whichGroup.empty() && m_LastGroupSearch == whichGroup) {
-			return m_LastGroupResult;
-		}
+	bool Entity::IsInGroup(const std::string &whichGroup) const {
 		// Searched for Any or All yields ALL
 		if (whichGroup == "Any" || whichGroup == "All") {
 			return true;
@@ -184,16 +177,76 @@ namespace RTE {
 		if (whichGroup == "None") {
 			return false;
 		}
-		for (std::list<std::string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr) {
-			if (whichGroup == *itr) {
-				// Save the search result for quicker response next time
-				m_LastGroupSearch = whichGroup;
-				return m_LastGroupResult = true;
+		int groupID = GetGroupID(whichGroup);
+		if (groupID < 0 || static_cast<size_t>(groupID / 64) >= m_PresetData->GroupBits.size()) {
+			return false;
+		}
+		return (m_PresetData->GroupBits[groupID / 64] >> (groupID % 64)) & 1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Entity::AddToGroup(const std::string &newGroup) {
+		std::list<std::string> &groups = GetWritablePresetData().Groups;
+		groups.push_back(newGroup);
+		groups.sort();
+		groups.unique();
+		SetGroupBit(RegisterGroupID(newGroup), true);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Entity::RemoveFromGroup(const std::string &groupToRemoveFrom) {
+		GetWritablePresetData().Groups.remove(groupToRemoveFrom);
+		if (int groupID = GetGroupID(groupToRemoveFrom); groupID >= 0) { SetGroupBit(groupID, false); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int Entity::GetGroupID(const std::string &groupName) {
+		const std::unordered_map<std::string, int> &groupIDMap = GetGroupIDMap();
+		std::unordered_map<std::string, int>::const_iterator groupIDEntry = groupIDMap.find(groupName);
+		return (groupIDEntry != groupIDMap.end()) ? groupIDEntry->second : -1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int Entity::RegisterGroupID(const std::string &groupName) {
+		std::unordered_map<std::string, int> &groupIDMap = GetGroupIDMap();
+		return groupIDMap.try_emplace(groupName, static_cast<int>(groupIDMap.size())).first->second;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::unordered_map<std::string, int> & Entity::GetGroupIDMap() {
+		static std::unordered_map<std::string, int> groupIDMap;
+		return groupIDMap;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Entity::SetGroupBit(int groupID, bool inGroup) {
+		std::vector<std::uint64_t> &groupBits = GetWritablePresetData().GroupBits;
+		if (static_cast<size_t>(groupID / 64) >= groupBits.size()) {
+			if (!inGroup) {
+				return;
 			}
+			groupBits.resize(groupID / 64 + 1, 0);
+		}
+		if (inGroup) {
+			groupBits[groupID / 64] |= std::uint64_t(1) << (groupID % 64);
+		} else {
+			groupBits[groupID / 64] &= ~(std::uint64_t(1) << (groupID % 64));
 		}
-		// Save the search result for quicker response next time
-		m_LastGroupSearch = whichGroup;
-		return m_LastGroupResult = false;
+		if (m_IsOriginalPreset) { s_PresetGroupChangeCount++; }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Entity::PresetData & Entity::GetWritablePresetData() {
+		if (m_PresetData.use_count() > 1) { m_PresetData = std::make_shared<PresetData>(*m_PresetData); }
+		// The PresetData is only ever created by this or Clear, and is never const in itself, so it's safe to change once this is its only user
+		return const_cast<PresetData &>(*m_PresetData);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
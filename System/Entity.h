@@ -308,7 +308,7 @@ namespace RTE {
 		/// Gets the name of this Entity's data Preset.
 		/// </summary>
 		/// <returns>A string reference with the instance name of this Entity.</returns>
-		const std::string & GetPresetName() const { return m_PresetName; }
+		const std::string & GetPresetName() const { return m_PresetData->PresetName; }
 
 		/// <summary>
 		/// Sets the name of this Entity's data Preset.
@@ -317,19 +317,19 @@ namespace RTE {
 		/// <param name="calledFromLua">Whether this method was called from Lua, in which case this change is cosmetic only and shouldn't affect scripts.</param>
 		// TODO: Replace the calledFromLua flag with some DisplayName property
 		// TODO: Figure out how to handle if same name was set, still make it wasgivenname = true?
-		virtual void SetPresetName(const std::string &newName, bool calledFromLua = false) { /*if (m_PresetName != newName) { m_IsOriginalPreset = true; }*/ m_IsOriginalPreset = calledFromLua ? m_IsOriginalPreset : true; m_PresetName = newName; }
+		virtual void SetPresetName(const std::string &newName, bool calledFromLua = false) { /*if (m_PresetName != newName) { m_IsOriginalPreset = true; }*/ m_IsOriginalPreset = calledFromLua ? m_IsOriginalPreset : true; GetWritablePresetData().PresetName = newName; }
 
 		/// <summary>
 		/// Gets the plain text description of this Entity's data Preset.
 		/// </summary>
 		/// <returns>A string reference with the plain text description name of this Preset.</returns>
-		const std::string & GetDescription() const { return m_PresetDescription; }
+		const std::string & GetDescription() const { return m_PresetData->Description; }
 
 		/// <summary>
 		/// Sets the plain text description of this Entity's data Preset. Shouldn't be more than a couple of sentences.
 		/// </summary>
 		/// <param name="newDesc">A string reference with the preset description.</param>
-		void SetDescription(const std::string &newDesc) { m_PresetDescription = newDesc; }
+		void SetDescription(const std::string &newDesc) { GetWritablePresetData().Description = newDesc; }
 
 		/// <summary>
 		/// Gets the name of this Entity's data Preset, preceded by the name of the Data Module it was defined in, separated with a '/'.
@@ -369,32 +369,52 @@ namespace RTE {
 		/// Gets the list of groups this is member of.
 		/// </summary>
 		/// <returns>A pointer to a list of strings which describes the groups this is added to. Ownership is NOT transferred!</returns>
-		const std::list<std::string> * GetGroupList() { return &m_Groups; }
+		const std::list<std::string> * GetGroupList() const { return &m_PresetData->Groups; }
 
 		/// <summary>
 		/// Shows whether this is part of a specific group or not.
 		/// </summary>
 		/// <param name="whichGroup">A string which describes the group to check for.</param>
 		/// <returns>Whether this Entity is in the specified group or not.</returns>
-		bool IsInGroup(const std::string &whichGroup);
+		bool IsInGroup(const std::string &whichGroup) const;
 
 		/// <summary>
 		/// Adds this Entity to a new grouping.
 		/// </summary>
 		/// <param name="newGroup">A string which describes the group to add this to. Duplicates will be ignored.</param>
-		void AddToGroup(const std::string &newGroup) { m_Groups.push_back(newGroup); m_Groups.sort(); m_Groups.unique(); m_LastGroupSearch.clear(); }
+		void AddToGroup(const std::string &newGroup);
 
 		/// <summary>
 		/// Removes this Entity from the specified grouping.
 		/// </summary>
 		/// <param name="groupToRemoveFrom">A string which describes the group to remove this from.</param>
-		void RemoveFromGroup(const std::string &groupToRemoveFrom) { m_Groups.remove(groupToRemoveFrom); m_LastGroupSearch.clear(); }
+		void RemoveFromGroup(const std::string &groupToRemoveFrom);
 
 		/// <summary>
 		/// Returns random weight used in PresetMan::GetRandomBuyableOfGroupFromTech.
 		/// </summary>
 		/// <returns>This item's random weight from 0 to 100.</returns>
 		int GetRandomWeight() const { return m_RandomWeight; }
+
+		/// <summary>
+		/// Gets the ID of a group name. Group IDs are shared by all Entities and stay the same until the game is closed.
+		/// </summary>
+		/// <param name="groupName">The name of the group to get the ID of.</param>
+		/// <returns>The ID of the group, or -1 if no Entity has been added to a group with that name and it hasn't been registered.</returns>
+		static int GetGroupID(const std::string &groupName);
+
+		/// <summary>
+		/// Gets the ID of a group name, giving it a new ID if it doesn't have one yet.
+		/// </summary>
+		/// <param name="groupName">The name of the group to get or make the ID of.</param>
+		/// <returns>The ID of the group.</returns>
+		static int RegisterGroupID(const std::string &groupName);
+
+		/// <summary>
+		/// Gets the number of times an original Preset was added to or removed from a group, so anything indexing Presets by group can tell when it needs to index them again.
+		/// </summary>
+		/// <returns>The number of group changes to original Presets so far.</returns>
+		static unsigned int GetPresetGroupChangeCount() { return s_PresetGroupChangeCount; }
 #pragma endregion
 
 #pragma region Lua Script Handling
@@ -449,26 +469,51 @@ namespace RTE {
 	protected:
 
 		static Entity::ClassInfo m_sClass; //!< Type description of this Entity.
+		static unsigned int s_PresetGroupChangeCount; //!< The number of times an original Preset was added to or removed from a group.
+
+		/// <summary>
+		/// The Preset data that is read in once and then very rarely changed. It's shared between a Preset and everything cloned from it, and only copied when one of them changes it.
+		/// </summary>
+		struct PresetData {
+			std::string PresetName = "None"; //!< The name of the Preset data this was cloned from, if any.
+			std::string Description; //!< The description of the preset in user friendly plain text that will show up in menus etc.
+			std::list<std::string> Groups; //!< List of all tags associated with this. The groups are used to categorize and organize Entities.
+			std::vector<std::uint64_t> GroupBits; //!< Bitset of the IDs of all the groups in Groups, so checking for a group doesn't need any string comparisons.
+		};
 
-		std::string m_PresetName; //!< The name of the Preset data this was cloned from, if any.
-		std::string m_PresetDescription; //!< The description of the preset in user friendly plain text that will show up in menus etc.
+		std::shared_ptr<const PresetData> m_PresetData; //!< The PresetData of this, possibly shared with the Preset this was cloned from and its other clones. Never nullptr.
 
 		bool m_IsOriginalPreset; //!< Whether this is to be added to the PresetMan as an original preset instance.
 		int m_DefinedInModule; //!< The DataModule ID that this was successfully added to at some point. -1 if not added to anything yet.
 
-		//TODO Consider replacing this with an unordered_set. See https://github.com/cortex-command-community/Cortex-Command-Community-Project-Source/issues/88
-		std::list<std::string> m_Groups; //!< List of all tags associated with this. The groups are used to categorize and organize Entities.
-		std::string m_LastGroupSearch; //!< Last group search string, for more efficient response on multiple tries for the same group name.
-		bool m_LastGroupResult; //!< Last group search result, for more efficient response on multiple tries for the same group name.
 
 		int m_RandomWeight; //!< Random weight used when picking item using PresetMan::GetRandomBuyableOfGroupFromTech. From 0 to 100. 0 means item won't be ever picked.
 
+		/// <summary>
+		/// Gets the PresetData of this for changing, first making a copy of it if it's shared with any other Entity.
+		/// </summary>
+		/// <returns>A reference to the PresetData that only this Entity uses.</returns>
+		PresetData & GetWritablePresetData();
+
+		/// <summary>
+		/// Adds or removes a group ID in this' group bitset, and keeps count of it if this is an original Preset.
+		/// </summary>
+		/// <param name="groupID">The ID of the group to add or remove.</param>
+		/// <param name="inGroup">Whether this should be in the group or not.</param>
+		void SetGroupBit(int groupID, bool inGroup);
+
 		// Forbidding copying
 		Entity(const Entity &reference) {}
 		Entity & operator=(const Entity &rhs) { return *this; }
 
 	private:
 
+		/// <summary>
+		/// Gets the map of all group names that have been given an ID to their IDs. Kept in a function so it exists before any static Entity gets added to a group.
+		/// </summary>
+		/// <returns>A reference to the map of group names to group IDs.</returns>
+		static std::unordered_map<std::string, int> & GetGroupIDMap();
+
 		/// <summary>
 		/// Clears all the member variables of this Entity, effectively resetting the members of this abstraction level only.
 		/// </summary>
@@ -0,0 +1,189 @@
+#include "EntitySnapshot.h"
+#include "Attachable.h"
+#include "MOSParticle.h"
+#include "SettingsMan.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void EntitySnapshot::Encode(const EntitySnapshot *baseline, std::vector<unsigned char> &data) const {
+		std::unordered_map<unsigned int, const EntityState *> baselineEntities;
+		if (baseline) {
+			baselineEntities.reserve(baseline->m_Entities.size());
+			for (const EntityState &baselineEntity : baseline->m_Entities) {
+				baselineEntities.try_emplace(baselineEntity.UniqueID, &baselineEntity);
+			}
+		}
+		data.clear();
+		data.reserve(m_Entities.size() * (sizeof(unsigned int) + 1 + sizeof(EntityState)));
+
+		auto appendField = [&data](const auto &field) {
+			const unsigned char *fieldBytes = reinterpret_cast<const unsigned char *>(&field);
+			data.insert(data.end(), fieldBytes, fieldBytes + sizeof(field));
+		};
+		for (const EntityState &entity : m_Entities) {
+			unsigned char encodedFields = AllFields;
+			if (std::unordered_map<unsigned int, const EntityState *>::const_iterator baselineEntry = baselineEntities.find(entity.UniqueID); baselineEntry != baselineEntities.end()) {
+				const EntityState &baselineEntity = *baselineEntry->second;
+				encodedFields = 0;
+				if (entity.PresetIndex != baselineEntity.PresetIndex) { encodedFields |= PresetField; }
+				if (entity.PosX != baselineEntity.PosX || entity.PosY != baselineEntity.PosY) { encodedFields |= PositionField; }
+				if (entity.Rotation != baselineEntity.Rotation) { encodedFields |= RotationField; }
+				if (entity.Scale != baselineEntity.Scale) { encodedFields |= ScaleField; }
+				if (entity.Frame != baselineEntity.Frame) { encodedFields |= FrameField; }
+				if (entity.Flags != baselineEntity.Flags) { encodedFields |= FlagsField; }
+			}
+			appendField(entity.UniqueID);
+			appendField(encodedFields);
+			if (encodedFields & PresetField) { appendField(entity.PresetIndex); }
+			if (encodedFields & PositionField) {
+				appendField(entity.PosX);
+				appendField(entity.PosY);
+			}
+			if (encodedFields & RotationField) { appendField(entity.Rotation); }
+			if (encodedFields & ScaleField) { appendField(entity.Scale); }
+			if (encodedFields & FrameField) { appendField(entity.Frame); }
+			if (encodedFields & FlagsField) { appendField(entity.Flags); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool EntitySnapshot::Decode(const EntitySnapshot *baseline, const unsigned char *data, size_t dataSize, size_t entityCount) {
+		m_Entities.clear();
+
+		std::unordered_map<unsigned int, const EntityState *> baselineEntities;
+		if (baseline) {
+			baselineEntities.reserve(baseline->m_Entities.size());
+			for (const EntityState &baselineEntity : baseline->m_Entities) {
+				baselineEntities.try_emplace(baselineEntity.UniqueID, &baselineEntity);
+			}
+		}
+		size_t readPos = 0;
+		auto readField = [data, dataSize, &readPos](auto &field) {
+			if (readPos + sizeof(field) > dataSize) {
+				return false;
+			}
+			std::memcpy(&field, data + readPos, sizeof(field));
+			readPos += sizeof(field);
+			return true;
+		};
+		m_Entities.reserve(entityCount);
+		for (size_t entityIndex = 0; entityIndex < entityCount; ++entityIndex) {
+			EntityState entity;
+			unsigned char encodedFields = 0;
+			if (!readField(entity.UniqueID) || !readField(encodedFields)) {
+				break;
+			}
+			if (std::unordered_map<unsigned int, const EntityState *>::const_iterator baselineEntry = baselineEntities.find(entity.UniqueID); baselineEntry != baselineEntities.end()) {
+				entity = *baselineEntry->second;
+			} else if (encodedFields != AllFields) {
+				// Entities that are new since the baseline have to come with every field, otherwise the data was encoded against something else
+				break;
+			}
+			bool fieldsRead = (!(encodedFields & PresetField) || readField(entity.PresetIndex)) &&
+				(!(encodedFields & PositionField) || (readField(entity.PosX) && readField(entity.PosY))) &&
+				(!(encodedFields & RotationField) || readField(entity.Rotation)) &&
+				(!(encodedFields & ScaleField) || readField(entity.Scale)) &&
+				(!(encodedFields & FrameField) || readField(entity.Frame)) &&
+				(!(encodedFields & FlagsField) || readField(entity.Flags));
+			if (!fieldsRead) {
+				break;
+			}
+			m_Entities.emplace_back(entity);
+		}
+		if (m_Entities.size() != entityCount || readPos != dataSize) {
+			m_Entities.clear();
+			return false;
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool EntitySnapshot::IsReplicable(const MovableObject *movableObject) {
+		static const Entity::ClassInfo *mosParticleClass = Entity::ClassInfo::GetClass("MOSParticle");
+		static const Entity::ClassInfo *mosRotatingClass = Entity::ClassInfo::GetClass("MOSRotating");
+		static const Entity::ClassInfo *attachableClass = Entity::ClassInfo::GetClass("Attachable");
+
+		const Entity::ClassInfo *objectClass = &movableObject->GetClass();
+		if (objectClass == mosParticleClass) {
+			return !movableObject->GetScreenEffect();
+		}
+		if (objectClass != mosRotatingClass && objectClass != attachableClass) {
+			return false;
+		}
+		// The AtomGroup visualizations get drawn over the root, which clients can't do
+		if (g_SettingsMan.DrawAtomGroupVisualizations()) {
+			return false;
+		}
+		std::vector<const MOSRotating *> partsToCheck = { static_cast<const MOSRotating *>(movableObject) };
+		while (!partsToCheck.empty()) {
+			const MOSRotating *partToCheck = partsToCheck.back();
+			partsToCheck.pop_back();
+			if (partToCheck->GetWoundCount(false, false, false) > 0) {
+				return false;
+			}
+			for (const Attachable *attachable : partToCheck->GetAttachables()) {
+				if (&attachable->GetClass() != attachableClass) {
+					return false;
+				}
+				partsToCheck.emplace_back(attachable);
+			}
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void EntitySnapshot::GetDrawnParts(const MovableObject *movableObject, std::vector<const MOSprite *> &parts) {
+		if (const MOSParticle *particle = dynamic_cast<const MOSParticle *>(movableObject)) {
+			parts.emplace_back(particle);
+		} else {
+			AddDrawnParts(movableObject, parts);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void EntitySnapshot::AddDrawnParts(const MovableObject *movableObject, std::vector<const MOSprite *> &parts) {
+		const MOSRotating *part = static_cast<const MOSRotating *>(movableObject);
+		for (const Attachable *attachable : part->GetAttachables()) {
+			if (!attachable->IsDrawnAfterParent() && attachable->IsDrawnNormallyByParent()) { AddDrawnParts(attachable, parts); }
+		}
+		parts.emplace_back(part);
+		for (const Attachable *attachable : part->GetAttachables()) {
+			if (attachable->IsDrawnAfterParent() && attachable->IsDrawnNormallyByParent()) { AddDrawnParts(attachable, parts); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	EntitySnapshot::EntityState EntitySnapshot::CaptureState(const MOSprite *part, unsigned short presetIndex) {
+		EntityState entityState;
+		entityState.UniqueID = static_cast<unsigned int>(part->GetUniqueID());
+		entityState.PresetIndex = presetIndex;
+		entityState.Frame = static_cast<unsigned short>(part->GetFrame());
+		entityState.Flags = part->IsHFlipped() ? HFlipped : 0;
+
+		Vector spritePos;
+		if (const MOSRotating *rotatingPart = dynamic_cast<const MOSRotating *>(part)) {
+			spritePos = rotatingPart->GetPos().GetFloored();
+			if (rotatingPart->IsRecoiled()) { spritePos += rotatingPart->GetRecoilOffset(); }
+
+			int rotation = static_cast<int>(std::lround(rotatingPart->GetRotMatrix().GetAllegroAngle() * 256.0F)) % 65536;
+			entityState.Rotation = static_cast<unsigned short>((rotation < 0) ? rotation + 65536 : rotation);
+			entityState.Scale = static_cast<unsigned short>(std::clamp(std::lround(rotatingPart->GetScale() * 256.0F), 0L, 65535L));
+		} else {
+			// MOSParticles aren't flipped, rotated or scaled, so send where the sprite's corner ends up instead and save the client from rounding the sprite offset the same way
+			spritePos = part->GetPos() + part->GetSpriteOffset();
+			entityState.Rotation = 0;
+			entityState.Scale = 256;
+			entityState.Flags = Unrotated;
+		}
+		entityState.PosX = static_cast<short>(std::clamp(spritePos.GetFloorIntX(), static_cast<int>(std::numeric_limits<short>::min()), static_cast<int>(std::numeric_limits<short>::max())));
+		entityState.PosY = static_cast<short>(std::clamp(spritePos.GetFloorIntY(), static_cast<int>(std::numeric_limits<short>::min()), static_cast<int>(std::numeric_limits<short>::max())));
+		return entityState;
+	}
+}
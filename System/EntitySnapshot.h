@@ -0,0 +1,164 @@
+#ifndef _RTEENTITYSNAPSHOT_
+#define _RTEENTITYSNAPSHOT_
+
+namespace RTE {
+
+	class MovableObject;
+	class MOSprite;
+
+	/// <summary>
+	/// The quantized drawing state of the MovableObjects a network client can see, so the client can draw them itself from its own copy of their Presets instead of receiving them as pixels.
+	/// Only MovableObjects that are drawn as nothing but plain sprites can be replicated. Snapshots are delta encoded against an older snapshot the client has, so entities that didn't change only cost their ID.
+	/// </summary>
+	class EntitySnapshot {
+
+	public:
+
+		/// <summary>
+		/// Flags describing how an entity's sprite is drawn.
+		/// </summary>
+		enum EntityFlags : unsigned char {
+			HFlipped = 1, //!< The sprite is flipped horizontally before it's rotated.
+			Unrotated = 2 //!< The position is the upper left corner of the sprite, which is drawn without rotating or scaling it, the way MOSParticles are drawn.
+		};
+
+		/// <summary>
+		/// The drawing state of a single MOSprite, quantized for sending.
+		/// </summary>
+		struct EntityState {
+			unsigned int UniqueID; //!< The UniqueID of the MOSprite, truncated to 32 bits. Identifies the entity across snapshots.
+			unsigned short PresetIndex; //!< The index of the MOSprite's Preset in the table of Presets the server sent the client.
+			short PosX; //!< The floored X position of the sprite's pivot point in the Scene, recoil included.
+			short PosY; //!< The floored Y position of the sprite's pivot point in the Scene, recoil included.
+			unsigned short Rotation; //!< The rotation angle, in 65536 steps per circle.
+			unsigned short Scale; //!< The scale, in 8.8 fixed point.
+			unsigned short Frame; //!< The sprite frame.
+			unsigned char Flags; //!< The EntityFlags describing how the sprite is drawn.
+
+			/// <summary>
+			/// Gets the rotation angle in Allegro's 256 steps per circle, for drawing.
+			/// </summary>
+			/// <returns>The rotation angle in Allegro's units.</returns>
+			float GetAllegroAngle() const { return static_cast<float>(Rotation) / 256.0F; }
+
+			/// <summary>
+			/// Gets the scale as a floating point number, for drawing.
+			/// </summary>
+			/// <returns>The scale.</returns>
+			float GetScale() const { return static_cast<float>(Scale) / 256.0F; }
+		};
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate an EntitySnapshot object in system memory.
+		/// </summary>
+		EntitySnapshot() { Clear(); }
+#pragma endregion
+
+#pragma region Getters and Setters
+		/// <summary>
+		/// Gets the sequence number of this EntitySnapshot, which snapshots delta encoded against it refer to it by.
+		/// </summary>
+		/// <returns>The sequence number of this EntitySnapshot. 0 if it wasn't sent yet.</returns>
+		unsigned int GetSequence() const { return m_Sequence; }
+
+		/// <summary>
+		/// Sets the sequence number of this EntitySnapshot.
+		/// </summary>
+		/// <param name="newSequence">The new sequence number. Has to be higher than that of every snapshot sent before.</param>
+		void SetSequence(unsigned int newSequence) { m_Sequence = newSequence; }
+
+		/// <summary>
+		/// Gets the entities in this EntitySnapshot.
+		/// </summary>
+		/// <returns>The state of every entity, in drawing order.</returns>
+		const std::vector<EntityState> & GetEntities() const { return m_Entities; }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Removes every entity from this EntitySnapshot.
+		/// </summary>
+		void Reset() { Clear(); }
+
+		/// <summary>
+		/// Adds an entity on top of the ones already in this EntitySnapshot.
+		/// </summary>
+		/// <param name="entityState">The state of the entity to add.</param>
+		void AddEntity(const EntityState &entityState) { m_Entities.emplace_back(entityState); }
+
+		/// <summary>
+		/// Delta encodes the entities of this EntitySnapshot against a baseline snapshot. Entities that are in the baseline only carry the fields that changed.
+		/// </summary>
+		/// <param name="baseline">The snapshot to encode against, or nullptr to encode every entity whole.</param>
+		/// <param name="data">The buffer to encode into. Replaces whatever it held.</param>
+		void Encode(const EntitySnapshot *baseline, std::vector<unsigned char> &data) const;
+
+		/// <summary>
+		/// Replaces the entities of this EntitySnapshot with ones decoded from data made by Encode.
+		/// </summary>
+		/// <param name="baseline">The snapshot the data was encoded against, or nullptr if it was encoded whole.</param>
+		/// <param name="data">The encoded data.</param>
+		/// <param name="dataSize">The size of the encoded data, in bytes.</param>
+		/// <param name="entityCount">The number of entities that were encoded.</param>
+		/// <returns>Whether the data decoded into exactly that many entities. This EntitySnapshot is left empty otherwise.</returns>
+		bool Decode(const EntitySnapshot *baseline, const unsigned char *data, size_t dataSize, size_t entityCount);
+#pragma endregion
+
+#pragma region Capturing
+		/// <summary>
+		/// Gets whether a MovableObject and everything drawn along with it are plain sprites a client can draw from their Presets.
+		/// That means MOSParticles without screen effects, and MOSRotatings and Attachables without wounds whose Attachables are all such Attachables too.
+		/// </summary>
+		/// <param name="movableObject">The MovableObject to check. Has to be a root MovableObject, i.e. not attached to anything.</param>
+		/// <returns>Whether the MovableObject can be replicated.</returns>
+		static bool IsReplicable(const MovableObject *movableObject);
+
+		/// <summary>
+		/// Gets a replicable MovableObject and every Attachable drawn along with it, in the order they're drawn.
+		/// </summary>
+		/// <param name="movableObject">The MovableObject to get the parts of. Should have been checked with IsReplicable first.</param>
+		/// <param name="parts">The vector to add the parts to.</param>
+		static void GetDrawnParts(const MovableObject *movableObject, std::vector<const MOSprite *> &parts);
+
+		/// <summary>
+		/// Quantizes the drawing state of a part of a replicable MovableObject.
+		/// </summary>
+		/// <param name="part">The part to capture the state of.</param>
+		/// <param name="presetIndex">The index of the part's Preset in the table of Presets the client is sent.</param>
+		/// <returns>The quantized drawing state of the part.</returns>
+		static EntityState CaptureState(const MOSprite *part, unsigned short presetIndex);
+#pragma endregion
+
+	private:
+
+		/// <summary>
+		/// Bits telling which fields of an entity are in its encoded record.
+		/// </summary>
+		enum EncodedFields : unsigned char {
+			PresetField = 1,
+			PositionField = 2,
+			RotationField = 4,
+			ScaleField = 8,
+			FrameField = 16,
+			FlagsField = 32,
+			AllFields = 63
+		};
+
+		unsigned int m_Sequence; //!< The sequence number of this EntitySnapshot.
+		std::vector<EntityState> m_Entities; //!< The state of every entity, in drawing order.
+
+		/// <summary>
+		/// Adds a replicable MOSRotating or Attachable and the Attachables drawn along with it to a list of parts, recursively, in the order MOSRotating::Draw draws them.
+		/// </summary>
+		/// <param name="movableObject">The MovableObject to add the parts of.</param>
+		/// <param name="parts">The vector to add the parts to.</param>
+		static void AddDrawnParts(const MovableObject *movableObject, std::vector<const MOSprite *> &parts);
+
+		/// <summary>
+		/// Clears all the member variables of this EntitySnapshot, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear() { m_Sequence = 0; m_Entities.clear(); }
+	};
+}
+#endif
@@ -0,0 +1,232 @@
+#include "JobPool.h"
+#include "RTETools.h"
+
+namespace RTE {
+
+	thread_local const JobPool *JobPool::s_WorkerPool = nullptr;
+	thread_local int JobPool::s_WorkerIndex = -1;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Clear() {
+		m_Workers.clear();
+		m_WorkerQueues.clear();
+		{
+			std::lock_guard<std::mutex> queueLock(m_GlobalQueue.Mutex);
+			m_GlobalQueue.Jobs.clear();
+		}
+		m_StopWorkers = false;
+		m_QueuedJobCount = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Start(int workerCount) {
+		m_StopWorkers = false;
+		m_WorkerQueues.reserve(workerCount);
+		for (int workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+			m_WorkerQueues.emplace_back(std::make_unique<WorkerQueue>());
+		}
+		// Queues need to all exist before any worker starts, otherwise an early worker could try to steal from a queue that's still being created.
+		m_Workers.reserve(workerCount);
+		for (int workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+			m_Workers.emplace_back(&JobPool::WorkerThreadFunction, this, workerIndex);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Stop() {
+		{
+			std::lock_guard<std::mutex> wakeLock(m_WakeMutex);
+			m_StopWorkers = true;
+		}
+		m_WakeCondition.notify_all();
+		for (std::thread &worker : m_Workers) {
+			if (worker.joinable()) { worker.join(); }
+		}
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	JobPool::JobHandle JobPool::Submit(std::function<void()> work, const std::vector<JobHandle> &dependencies) {
+		return SubmitJob(std::move(work), GetRNG().NextChildKey(), 0, dependencies);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	JobPool::JobHandle JobPool::SubmitJob(std::function<void()> work, uint64_t randomKey, uint64_t randomStreamIndex, const std::vector<JobHandle> &dependencies) {
+		JobHandle job = std::make_shared<Job>(std::move(work), randomKey, randomStreamIndex);
+
+		for (const JobHandle &dependency : dependencies) {
+			if (!dependency) {
+				continue;
+			}
+			std::lock_guard<std::mutex> continuationsLock(dependency->m_ContinuationsMutex);
+			if (!dependency->IsCompleted()) {
+				job->m_PendingDependencies.fetch_add(1, std::memory_order_relaxed);
+				dependency->m_Continuations.emplace_back(job);
+			}
+		}
+		// Drop the guard count. If every dependency was already done (or completed while we were chaining) this schedules the Job right away.
+		ReleaseDependency(job);
+		return job;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int JobPool::GetParallelForChunkCount(int rangeStart, int rangeEnd, int grainSize) const {
+		int rangeSize = rangeEnd - rangeStart;
+		if (rangeSize <= 0) {
+			return 0;
+		}
+		// A few chunks per thread lets faster threads pick up the slack from slower ones without drowning the queues in tiny Jobs.
+		if (grainSize < 1) { grainSize = std::max(rangeSize / (GetConcurrency() * 4), 1); }
+		return (rangeSize + grainSize - 1) / grainSize;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	JobPool::JobHandle JobPool::ParallelFor(int rangeStart, int rangeEnd, int grainSize, const std::function<void(int chunkStart, int chunkEnd, int chunkIndex)> &work, const std::vector<JobHandle> &dependencies) {
+		int chunkCount = GetParallelForChunkCount(rangeStart, rangeEnd, grainSize);
+		if (chunkCount == 0) {
+			return Submit([]() {}, dependencies);
+		}
+		int chunkSize = (rangeEnd - rangeStart + chunkCount - 1) / chunkCount;
+		// Shared between the chunks so the caller doesn't need to keep its function object alive until the Jobs are done.
+		auto sharedWork = std::make_shared<std::function<void(int, int, int)>>(work);
+		// One key per dispatch rather than one number per chunk, so how many chunks the range happens to be split into doesn't advance the caller's stream.
+		uint64_t randomKey = GetRNG().NextChildKey();
+
+		std::vector<JobHandle> chunkJobs;
+		chunkJobs.reserve(chunkCount);
+		for (int chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+			int chunkStart = rangeStart + chunkIndex * chunkSize;
+			int chunkEnd = std::min(chunkStart + chunkSize, rangeEnd);
+			chunkJobs.emplace_back(SubmitJob([sharedWork, chunkStart, chunkEnd, chunkIndex]() { (*sharedWork)(chunkStart, chunkEnd, chunkIndex); }, randomKey, static_cast<uint64_t>(chunkIndex), dependencies));
+		}
+		return SubmitJob([]() {}, randomKey, static_cast<uint64_t>(chunkCount), chunkJobs);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Wait(const JobHandle &job) {
+		if (!job) {
+			return;
+		}
+		while (!job->IsCompleted()) {
+			if (JobHandle nextJob = TakeJob()) {
+				Execute(nextJob);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Enqueue(const JobHandle &job) {
+		WorkerQueue &queue = IsWorkerThread() ? *m_WorkerQueues[s_WorkerIndex] : m_GlobalQueue;
+		// Count before pushing so the count never drops below the number of Jobs actually queued.
+		m_QueuedJobCount.fetch_add(1, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> queueLock(queue.Mutex);
+			queue.Jobs.emplace_back(job);
+		}
+		if (!m_Workers.empty()) {
+			// Taking the wake mutex makes sure a worker that just checked the count and is about to sleep doesn't miss this notification.
+			{ std::lock_guard<std::mutex> wakeLock(m_WakeMutex); }
+			m_WakeCondition.notify_one();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::ReleaseDependency(const JobHandle &job) {
+		if (job->m_PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) { Enqueue(job); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	JobPool::JobHandle JobPool::TakeJob() {
+		if (m_QueuedJobCount.load(std::memory_order_acquire) <= 0) {
+			return nullptr;
+		}
+		JobHandle job = nullptr;
+
+		if (IsWorkerThread()) {
+			WorkerQueue &ownQueue = *m_WorkerQueues[s_WorkerIndex];
+			std::lock_guard<std::mutex> queueLock(ownQueue.Mutex);
+			if (!ownQueue.Jobs.empty()) {
+				job = std::move(ownQueue.Jobs.back());
+				ownQueue.Jobs.pop_back();
+			}
+		}
+		if (!job) {
+			std::lock_guard<std::mutex> queueLock(m_GlobalQueue.Mutex);
+			if (!m_GlobalQueue.Jobs.empty()) {
+				job = std::move(m_GlobalQueue.Jobs.front());
+				m_GlobalQueue.Jobs.pop_front();
+			}
+		}
+		if (!job) {
+			int queueCount = static_cast<int>(m_WorkerQueues.size());
+			// Workers start stealing from their neighbour so they don't all gang up on the first queue, and skip their own queue which was already checked.
+			int firstVictim = IsWorkerThread() ? s_WorkerIndex + 1 : 0;
+			int victimCount = IsWorkerThread() ? queueCount - 1 : queueCount;
+			for (int attempt = 0; attempt < victimCount && !job; ++attempt) {
+				WorkerQueue &victimQueue = *m_WorkerQueues[(firstVictim + attempt) % queueCount];
+				std::lock_guard<std::mutex> queueLock(victimQueue.Mutex);
+				if (!victimQueue.Jobs.empty()) {
+					job = std::move(victimQueue.Jobs.front());
+					victimQueue.Jobs.pop_front();
+				}
+			}
+		}
+		if (job) { m_QueuedJobCount.fetch_sub(1, std::memory_order_acq_rel); }
+		return job;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::Execute(const JobHandle &job) {
+		// Jobs executed inline by a waiting thread must not draw from that thread's stream either, otherwise the results would change with how the Jobs happened to be spread over the threads.
+		RandomStream *previousStream = g_ThreadRandomStream;
+		g_ThreadRandomStream = &job->m_RandomStream;
+		job->m_Work();
+		g_ThreadRandomStream = previousStream;
+		job->m_Work = nullptr;
+
+		std::vector<JobHandle> continuations;
+		{
+			std::lock_guard<std::mutex> continuationsLock(job->m_ContinuationsMutex);
+			job->m_Completed.store(true, std::memory_order_release);
+			continuations.swap(job->m_Continuations);
+		}
+		for (const JobHandle &continuation : continuations) {
+			ReleaseDependency(continuation);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobPool::WorkerThreadFunction(int workerIndex) {
+		s_WorkerPool = this;
+		s_WorkerIndex = workerIndex;
+
+		// Only exit once the queues are empty, so a thread still waiting on one of this pool's Jobs when it's stopped isn't left waiting on work nobody will pick up.
+		while (true) {
+			if (JobHandle job = TakeJob()) {
+				Execute(job);
+			} else if (m_StopWorkers.load(std::memory_order_acquire)) {
+				break;
+			} else {
+				std::unique_lock<std::mutex> wakeLock(m_WakeMutex);
+				m_WakeCondition.wait(wakeLock, [this]() { return m_StopWorkers.load(std::memory_order_acquire) || m_QueuedJobCount.load(std::memory_order_acquire) > 0; });
+			}
+		}
+		s_WorkerPool = nullptr;
+		s_WorkerIndex = -1;
+	}
+}
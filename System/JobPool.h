@@ -0,0 +1,224 @@
+#ifndef _RTEJOBPOOL_
+#define _RTEJOBPOOL_
+
+#include "RandomStream.h"
+
+namespace RTE {
+
+	/// <summary>
+	/// A work-stealing pool of worker threads that Jobs can be submitted into. Pools are fully separate from each other, a thread waiting on one pool only ever executes that pool's Jobs.
+	/// </summary>
+	class JobPool {
+
+	public:
+
+		/// <summary>
+		/// A unit of work that can be scheduled on a JobPool. Jobs are only ever handled through JobHandles.
+		/// </summary>
+		class Job {
+			friend class JobPool;
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to instantiate a Job object in system memory.
+			/// </summary>
+			/// <param name="work">The function this Job will execute.</param>
+			/// <param name="randomKey">The key of the dispatch this Job belongs to, which its random number stream is derived from.</param>
+			/// <param name="randomStreamIndex">The index of this Job within its dispatch, which its random number stream is derived from.</param>
+			Job(std::function<void()> work, uint64_t randomKey, uint64_t randomStreamIndex) : m_Work(std::move(work)), m_RandomStream(randomKey, randomStreamIndex), m_PendingDependencies(1), m_Completed(false) {}
+
+			/// <summary>
+			/// Gets whether this Job has finished executing.
+			/// </summary>
+			/// <returns>Whether this Job has finished executing.</returns>
+			bool IsCompleted() const { return m_Completed.load(std::memory_order_acquire); }
+
+		private:
+
+			std::function<void()> m_Work; //!< The function this Job executes.
+			RandomStream m_RandomStream; //!< The random number stream this Job draws from, derived from the submitting thread's stream and the Job's index in its dispatch so the Job's results don't depend on which thread executes it.
+			std::atomic<int> m_PendingDependencies; //!< The number of Jobs that need to complete before this one can be scheduled, plus one guard count held while the Job is being submitted.
+			std::atomic<bool> m_Completed; //!< Whether this Job has finished executing.
+			std::mutex m_ContinuationsMutex; //!< Mutex guarding the continuations list against Jobs being chained while this one completes.
+			std::vector<std::shared_ptr<Job>> m_Continuations; //!< Jobs that depend on this Job and should be scheduled once it completes.
+
+			// Disallow the use of some implicit methods.
+			Job(const Job &reference) = delete;
+			Job & operator=(const Job &rhs) = delete;
+		};
+
+		using JobHandle = std::shared_ptr<Job>; //!< Convenience for the handle type returned by all job submission methods.
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a JobPool object in system memory. Start() should be called before using the object.
+		/// </summary>
+		JobPool() { Clear(); }
+
+		/// <summary>
+		/// Starts the worker threads of this JobPool.
+		/// </summary>
+		/// <param name="workerCount">The number of worker threads to start. Can be 0, in which case every Job runs on the thread that waits on it.</param>
+		void Start(int workerCount);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a JobPool object before deletion from system memory.
+		/// </summary>
+		~JobPool() { Stop(); }
+
+		/// <summary>
+		/// Lets the worker threads finish the Jobs that are still queued, joins them and resets (through Clear()) the JobPool object.
+		/// </summary>
+		void Stop();
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the number of worker threads in this JobPool. The thread that waits on a Job also executes work, so this can be 0 and everything still runs, just serially.
+		/// </summary>
+		/// <returns>The number of worker threads in this JobPool.</returns>
+		int GetWorkerCount() const { return static_cast<int>(m_Workers.size()); }
+
+		/// <summary>
+		/// Gets the number of threads that can execute this JobPool's Jobs concurrently, i.e. the workers plus the thread waiting on them. Useful for sizing per-thread scratch buffers.
+		/// </summary>
+		/// <returns>The number of threads that can execute Jobs concurrently.</returns>
+		int GetConcurrency() const { return GetWorkerCount() + 1; }
+
+		/// <summary>
+		/// Gets the index of the calling thread in this JobPool. Worker threads are 1 to GetWorkerCount(), any other thread, including workers of other pools, is 0. Always smaller than GetConcurrency().
+		/// </summary>
+		/// <returns>The index of the calling thread in this JobPool.</returns>
+		int GetCurrentThreadIndex() const { return IsWorkerThread() ? s_WorkerIndex + 1 : 0; }
+
+		/// <summary>
+		/// Gets whether the calling thread is one of this JobPool's worker threads.
+		/// </summary>
+		/// <returns>Whether the calling thread is one of this JobPool's worker threads.</returns>
+		bool IsWorkerThread() const { return s_WorkerPool == this; }
+#pragma endregion
+
+#pragma region Job Submission
+		/// <summary>
+		/// Submits a Job to this JobPool. The Job will not start until all of its dependencies have completed.
+		/// The Job's random number stream is derived from a child key of the calling thread's stream without drawing from it, so only threads with their own stream and Jobs themselves should submit, or they'd race on the simulation stream.
+		/// </summary>
+		/// <param name="work">The function to execute.</param>
+		/// <param name="dependencies">Jobs that need to complete before this one can start. Empty or already completed handles are ignored.</param>
+		/// <returns>A handle to the submitted Job, which can be waited on or used as a dependency for other Jobs.</returns>
+		JobHandle Submit(std::function<void()> work, const std::vector<JobHandle> &dependencies = {});
+
+		/// <summary>
+		/// Splits the range [rangeStart, rangeEnd) into chunks of at most grainSize elements and submits each chunk as a separate Job.
+		/// All the chunks share one child key of the calling thread's stream and each chunk's random number stream is picked by its index, so results are only reproducible across machines if the chunking is, i.e. with a fixed grainSize.
+		/// </summary>
+		/// <param name="rangeStart">The first index of the range.</param>
+		/// <param name="rangeEnd">One past the last index of the range.</param>
+		/// <param name="grainSize">The maximum number of elements per chunk. Values below 1 pick a chunk size that gives each thread a few chunks to balance over.</param>
+		/// <param name="work">The function to execute for each chunk. Takes the chunk's start and end indices and the index of the chunk.</param>
+		/// <param name="dependencies">Jobs that need to complete before any chunk can start.</param>
+		/// <returns>A handle to a Job that completes once all the chunks have completed.</returns>
+		JobHandle ParallelFor(int rangeStart, int rangeEnd, int grainSize, const std::function<void(int chunkStart, int chunkEnd, int chunkIndex)> &work, const std::vector<JobHandle> &dependencies = {});
+
+		/// <summary>
+		/// Gets the number of chunks ParallelFor will split the given range into. Used to size per-chunk output buffers before submitting.
+		/// </summary>
+		/// <param name="rangeStart">The first index of the range.</param>
+		/// <param name="rangeEnd">One past the last index of the range.</param>
+		/// <param name="grainSize">The grain size that will be passed to ParallelFor.</param>
+		/// <returns>The number of chunks the range will be split into.</returns>
+		int GetParallelForChunkCount(int rangeStart, int rangeEnd, int grainSize) const;
+
+		/// <summary>
+		/// Blocks until the given Job has completed. The calling thread executes other pending Jobs of this JobPool while it waits, so waiting from inside a Job can't deadlock the pool.
+		/// </summary>
+		/// <param name="job">The Job to wait for. Empty handles return immediately.</param>
+		void Wait(const JobHandle &job);
+
+		/// <summary>
+		/// Blocks until all the given Jobs have completed.
+		/// </summary>
+		/// <param name="jobs">The Jobs to wait for.</param>
+		void WaitForAll(const std::vector<JobHandle> &jobs) { for (const JobHandle &job : jobs) { Wait(job); } }
+#pragma endregion
+
+	protected:
+
+		/// <summary>
+		/// A worker's local job queue. The owning worker pushes and pops at the back, other threads steal from the front so they take the oldest and usually largest work first.
+		/// </summary>
+		struct WorkerQueue {
+			std::mutex Mutex; //!< Mutex guarding the queue.
+			std::deque<JobHandle> Jobs; //!< The queued Jobs.
+		};
+
+		static thread_local const JobPool *s_WorkerPool; //!< The JobPool the calling thread is a worker of, or nullptr if it isn't a worker of any.
+		static thread_local int s_WorkerIndex; //!< The index of the calling worker thread into its pool's m_WorkerQueues, or -1 if the calling thread is not a worker.
+
+		std::vector<std::thread> m_Workers; //!< The worker threads.
+		std::vector<std::unique_ptr<WorkerQueue>> m_WorkerQueues; //!< The local job queue of each worker thread.
+		WorkerQueue m_GlobalQueue; //!< Queue for Jobs submitted from threads outside the pool.
+
+		std::atomic<bool> m_StopWorkers; //!< Whether the worker threads should exit.
+		std::atomic<int> m_QueuedJobCount; //!< The number of Jobs currently sitting in any queue, used to let idle workers sleep.
+		std::mutex m_WakeMutex; //!< Mutex for the idle worker condition variable.
+		std::condition_variable m_WakeCondition; //!< Condition variable idle workers sleep on until Jobs are queued.
+
+	private:
+
+#pragma region Scheduling
+		/// <summary>
+		/// Creates a Job with the given random number stream and schedules it once all its dependencies have completed.
+		/// </summary>
+		/// <param name="work">The function to execute.</param>
+		/// <param name="randomKey">The key of the dispatch this Job belongs to.</param>
+		/// <param name="randomStreamIndex">The index of this Job within its dispatch.</param>
+		/// <param name="dependencies">Jobs that need to complete before this one can start.</param>
+		/// <returns>A handle to the submitted Job.</returns>
+		JobHandle SubmitJob(std::function<void()> work, uint64_t randomKey, uint64_t randomStreamIndex, const std::vector<JobHandle> &dependencies);
+
+		/// <summary>
+		/// Pushes a Job whose dependencies have all completed into the calling worker's queue, or the global queue if called from outside the pool, and wakes a worker.
+		/// </summary>
+		/// <param name="job">The Job to schedule.</param>
+		void Enqueue(const JobHandle &job);
+
+		/// <summary>
+		/// Drops one dependency count from a Job and schedules it if that was the last one.
+		/// </summary>
+		/// <param name="job">The Job to release.</param>
+		void ReleaseDependency(const JobHandle &job);
+
+		/// <summary>
+		/// Takes the next Job for the calling thread to execute. Checks the calling worker's own queue first, then the global queue, then tries to steal from the other workers.
+		/// </summary>
+		/// <returns>The next Job to execute, or nullptr if there's nothing queued anywhere.</returns>
+		JobHandle TakeJob();
+
+		/// <summary>
+		/// Executes a Job with its own random number stream, marks it completed and schedules any continuations that were only waiting on it.
+		/// </summary>
+		/// <param name="job">The Job to execute.</param>
+		void Execute(const JobHandle &job);
+
+		/// <summary>
+		/// The main loop of each worker thread. Executes Jobs until the pool is stopped and nothing is left queued, sleeping while there's nothing queued.
+		/// </summary>
+		/// <param name="workerIndex">The index of this worker into m_WorkerQueues.</param>
+		void WorkerThreadFunction(int workerIndex);
+#pragma endregion
+
+		/// <summary>
+		/// Clears all the member variables of this JobPool, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		JobPool(const JobPool &reference) = delete;
+		JobPool & operator=(const JobPool &rhs) = delete;
+	};
+}
+#endif
@@ -0,0 +1,214 @@
+#include "MOIDBroadphase.h"
+#include "MovableObject.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::Clear() {
+		m_Width = 0;
+		m_Height = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
+		m_ColorDepth = 8;
+		m_Columns = 0;
+		m_Rows = 0;
+		m_Entries.clear();
+		m_EntryIndices.clear();
+		m_Cells.clear();
+		m_UsedCells.clear();
+		m_FootprintPool.clear();
+		m_FootprintsDrawn = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int MOIDBroadphase::Create(int width, int height, bool wrapsX, bool wrapsY, int colorDepth) {
+		RTEAssert(width > 0 && height > 0, "Tried to create a MOIDBroadphase with no area!");
+		ClearObjects();
+
+		m_Width = width;
+		m_Height = height;
+		m_WrapsX = wrapsX;
+		m_WrapsY = wrapsY;
+		m_ColorDepth = colorDepth;
+		m_Columns = (width + c_CellSize - 1) / c_CellSize;
+		m_Rows = (height + c_CellSize - 1) / c_CellSize;
+
+		m_Cells.clear();
+		m_Cells.resize(static_cast<size_t>(m_Columns * m_Rows));
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::Destroy() {
+		ClearObjects();
+		for (const auto &[footprintSize, footprints] : m_FootprintPool) {
+			for (BITMAP *footprint : footprints) {
+				destroy_bitmap(footprint);
+			}
+		}
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::ClearObjects() {
+		for (Entry &entry : m_Entries) {
+			ReleaseEntry(entry);
+		}
+		m_Entries.clear();
+		m_EntryIndices.clear();
+		for (size_t usedCell : m_UsedCells) {
+			m_Cells[usedCell].clear();
+		}
+		m_UsedCells.clear();
+		m_FootprintsDrawn = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::Add(MovableObject *object) {
+		if (!object || m_Cells.empty()) {
+			return;
+		}
+		size_t entryIndex = m_Entries.size();
+		if (std::unordered_map<const MovableObject *, size_t>::iterator existingEntry = m_EntryIndices.find(object); existingEntry != m_EntryIndices.end()) {
+			ReleaseEntry(m_Entries[existingEntry->second]);
+			existingEntry->second = entryIndex;
+		} else {
+			m_EntryIndices.try_emplace(object, entryIndex);
+		}
+		const Vector &center = object->GetPos();
+		float radius = object->GetRadius() * std::max(object->GetScale(), 1.0F) + c_BoundsPadding;
+		m_Entries.push_back({ object, center, radius, nullptr, 0, 0 });
+
+		int firstColumn = static_cast<int>(std::floor((center.m_X - radius) / static_cast<float>(c_CellSize)));
+		int lastColumn = static_cast<int>(std::floor((center.m_X + radius) / static_cast<float>(c_CellSize)));
+		int firstRow = static_cast<int>(std::floor((center.m_Y - radius) / static_cast<float>(c_CellSize)));
+		int lastRow = static_cast<int>(std::floor((center.m_Y + radius) / static_cast<float>(c_CellSize)));
+		if (m_WrapsX) {
+			lastColumn = std::min(lastColumn, firstColumn + m_Columns - 1);
+		} else {
+			firstColumn = std::clamp(firstColumn, 0, m_Columns - 1);
+			lastColumn = std::clamp(lastColumn, 0, m_Columns - 1);
+		}
+		if (m_WrapsY) {
+			lastRow = std::min(lastRow, firstRow + m_Rows - 1);
+		} else {
+			firstRow = std::clamp(firstRow, 0, m_Rows - 1);
+			lastRow = std::clamp(lastRow, 0, m_Rows - 1);
+		}
+		for (int row = firstRow; row <= lastRow; ++row) {
+			int wrappedRow = ((row % m_Rows) + m_Rows) % m_Rows;
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				size_t cellIndex = static_cast<size_t>(wrappedRow * m_Columns + ((column % m_Columns) + m_Columns) % m_Columns);
+				if (m_Cells[cellIndex].empty()) { m_UsedCells.emplace_back(cellIndex); }
+				m_Cells[cellIndex].emplace_back(entryIndex);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::Remove(const MovableObject *object) {
+		if (std::unordered_map<const MovableObject *, size_t>::iterator existingEntry = m_EntryIndices.find(object); existingEntry != m_EntryIndices.end()) {
+			ReleaseEntry(m_Entries[existingEntry->second]);
+			m_EntryIndices.erase(existingEntry);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOID MOIDBroadphase::GetMOIDPixel(int pixelX, int pixelY) {
+		if (m_Cells.empty() || pixelX < 0 || pixelX >= m_Width || pixelY < 0 || pixelY >= m_Height) {
+			return g_NoMOID;
+		}
+		const std::vector<size_t> &cell = m_Cells[static_cast<size_t>((pixelY / c_CellSize) * m_Columns + (pixelX / c_CellSize))];
+
+		// Later registrations are drawn over earlier ones, so check them first.
+		for (std::vector<size_t>::const_reverse_iterator entryIndex = cell.crbegin(); entryIndex != cell.crend(); ++entryIndex) {
+			Entry &entry = m_Entries[*entryIndex];
+			if (!entry.Object) {
+				continue;
+			}
+			float distanceX = ShortestDistance(entry.Center.m_X, static_cast<float>(pixelX), m_Width, m_WrapsX);
+			float distanceY = ShortestDistance(entry.Center.m_Y, static_cast<float>(pixelY), m_Height, m_WrapsY);
+			if ((distanceX * distanceX) + (distanceY * distanceY) > entry.Radius * entry.Radius) {
+				continue;
+			}
+			DrawFootprint(entry);
+
+			int footprintX = pixelX - entry.FootprintLeft;
+			int footprintY = pixelY - entry.FootprintTop;
+			if (m_WrapsX) { footprintX = ((footprintX % m_Width) + m_Width) % m_Width; }
+			if (m_WrapsY) { footprintY = ((footprintY % m_Height) + m_Height) % m_Height; }
+			if (footprintX >= 0 && footprintX < entry.Footprint->w && footprintY >= 0 && footprintY < entry.Footprint->h) {
+				if (MOID footprintMOID = getpixel(entry.Footprint, footprintX, footprintY); footprintMOID != g_NoMOID) {
+					return footprintMOID;
+				}
+			}
+		}
+		return g_NoMOID;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::DrawAll(BITMAP *targetBitmap) const {
+		for (const Entry &entry : m_Entries) {
+			if (entry.Object) { entry.Object->Draw(targetBitmap, Vector(), g_DrawMOID, true); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::DrawFootprint(Entry &entry) {
+		if (entry.Footprint) {
+			return;
+		}
+		int footprintSize = c_MinFootprintSize;
+		while (footprintSize < static_cast<int>(std::ceil(entry.Radius)) * 2 + 2) {
+			footprintSize *= 2;
+		}
+		if (std::vector<BITMAP *> &pooledFootprints = m_FootprintPool[footprintSize]; !pooledFootprints.empty()) {
+			entry.Footprint = pooledFootprints.back();
+			pooledFootprints.pop_back();
+		} else {
+			entry.Footprint = create_bitmap_ex(m_ColorDepth, footprintSize, footprintSize);
+		}
+		clear_to_color(entry.Footprint, g_NoMOID);
+
+		// Center the footprint on where the object is now rather than where it was registered, same as drawing it to the MOID layer now would.
+		const Vector &objectPos = entry.Object->GetPos();
+		entry.FootprintLeft = static_cast<int>(std::floor(objectPos.m_X)) - (footprintSize / 2);
+		entry.FootprintTop = static_cast<int>(std::floor(objectPos.m_Y)) - (footprintSize / 2);
+		entry.Object->Draw(entry.Footprint, Vector(static_cast<float>(entry.FootprintLeft), static_cast<float>(entry.FootprintTop)), g_DrawMOID, true);
+		m_FootprintsDrawn++;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDBroadphase::ReleaseEntry(Entry &entry) {
+		if (entry.Footprint) {
+			m_FootprintPool[entry.Footprint->w].emplace_back(entry.Footprint);
+			entry.Footprint = nullptr;
+		}
+		entry.Object = nullptr;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float MOIDBroadphase::ShortestDistance(float from, float to, int size, bool wraps) {
+		float distance = to - from;
+		if (wraps) {
+			float halfSize = static_cast<float>(size) / 2.0F;
+			if (distance > halfSize) {
+				distance -= static_cast<float>(size);
+			} else if (distance < -halfSize) {
+				distance += static_cast<float>(size);
+			}
+		}
+		return distance;
+	}
+}
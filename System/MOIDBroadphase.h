@@ -0,0 +1,162 @@
+#ifndef _RTEMOIDBROADPHASE_
+#define _RTEMOIDBROADPHASE_
+
+#include "Vector.h"
+
+namespace RTE {
+
+	class MovableObject;
+
+	/// <summary>
+	/// Answers MOID pixel queries without drawing every MovableObject to the scene-wide MOID layer each sim update.
+	/// Registered objects are bucketed into a uniform grid by their bounding circles. Only when a query lands inside an object's circle is the object's MOID representation drawn, into a small bitmap of its own that is reused for every other query on it until it changes.
+	/// Not thread safe, same as the MOID layer it stands in for.
+	/// </summary>
+	class MOIDBroadphase {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a MOIDBroadphase object in system memory. Create() should be called before using the object.
+		/// </summary>
+		MOIDBroadphase() { Clear(); }
+
+		/// <summary>
+		/// Makes the MOIDBroadphase object ready for use, covering a Scene of the given size.
+		/// </summary>
+		/// <param name="width">The width of the Scene, in pixels.</param>
+		/// <param name="height">The height of the Scene, in pixels.</param>
+		/// <param name="wrapsX">Whether the Scene wraps around horizontally.</param>
+		/// <param name="wrapsY">Whether the Scene wraps around vertically.</param>
+		/// <param name="colorDepth">The color depth of the MOID layer, which the objects' MOID representations are drawn in.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Create(int width, int height, bool wrapsX, bool wrapsY, int colorDepth);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a MOIDBroadphase object before deletion from system memory.
+		/// </summary>
+		~MOIDBroadphase() { Destroy(); }
+
+		/// <summary>
+		/// Destroys and resets (through Clear()) the MOIDBroadphase object.
+		/// </summary>
+		void Destroy();
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets whether an object is currently registered with this MOIDBroadphase.
+		/// </summary>
+		/// <param name="object">The object to check.</param>
+		/// <returns>Whether the object is registered.</returns>
+		bool IsRegistered(const MovableObject *object) const { return m_EntryIndices.find(object) != m_EntryIndices.end(); }
+
+		/// <summary>
+		/// Gets the number of MOID representations that were drawn to answer queries since the objects were last cleared.
+		/// </summary>
+		/// <returns>The number of drawn MOID representations.</returns>
+		int GetFootprintsDrawn() const { return m_FootprintsDrawn; }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Unregisters every object, e.g. before deleting them or registering them all again with their new MOIDs.
+		/// </summary>
+		void ClearObjects();
+
+		/// <summary>
+		/// Registers an object's MOID representation, including its Attachables, at its current position. Registering an object that is already registered moves it on top of everything else, like drawing it to the MOID layer again would.
+		/// </summary>
+		/// <param name="object">The object to register. Ownership is NOT transferred!</param>
+		void Add(MovableObject *object);
+
+		/// <summary>
+		/// Unregisters an object's MOID representation. Does nothing if it isn't registered.
+		/// </summary>
+		/// <param name="object">The object to unregister.</param>
+		void Remove(const MovableObject *object);
+
+		/// <summary>
+		/// Gets the MOID of the topmost registered object at a pixel, drawing the MOID representations of the objects whose bounding circles contain it if they weren't yet.
+		/// </summary>
+		/// <param name="pixelX">The X coordinate of the pixel. Has to be wrapped into the Scene already.</param>
+		/// <param name="pixelY">The Y coordinate of the pixel. Has to be wrapped into the Scene already.</param>
+		/// <returns>The MOID at the pixel, or g_NoMOID if there is none.</returns>
+		MOID GetMOIDPixel(int pixelX, int pixelY);
+
+		/// <summary>
+		/// Draws the MOID representation of every registered object to a BITMAP, in the order they were registered. Used for filling the MOID layer when something needs all of it.
+		/// </summary>
+		/// <param name="targetBitmap">The BITMAP to draw to. Should be Scene-sized and cleared to g_NoMOID.</param>
+		void DrawAll(BITMAP *targetBitmap) const;
+#pragma endregion
+
+	private:
+
+		static constexpr int c_CellSize = 64; //!< The width and height of each grid cell, in pixels.
+		static constexpr int c_MinFootprintSize = 16; //!< The smallest footprint bitmap size. Footprint bitmaps are sized in powers of two from here so they can be pooled.
+		static constexpr float c_BoundsPadding = 2.0F; //!< How much the bounding circles are padded by, to cover recoil and rounding.
+
+		/// <summary>
+		/// A registered object along with its bounds and, once drawn, its MOID representation.
+		/// </summary>
+		struct Entry {
+			MovableObject *Object; //!< The registered object, or nullptr if it was unregistered or registered again later. Not owned.
+			Vector Center; //!< The position of the object when it was registered.
+			float Radius; //!< The radius of the bounding circle around Center that covers the object and all its Attachables.
+			BITMAP *Footprint; //!< The object's MOID representation, or nullptr if it wasn't needed yet. Owned by the pool.
+			int FootprintLeft; //!< The Scene X coordinate of the upper left corner of Footprint. Not wrapped.
+			int FootprintTop; //!< The Scene Y coordinate of the upper left corner of Footprint. Not wrapped.
+		};
+
+		int m_Width; //!< The width of the Scene, in pixels.
+		int m_Height; //!< The height of the Scene, in pixels.
+		bool m_WrapsX; //!< Whether the Scene wraps around horizontally.
+		bool m_WrapsY; //!< Whether the Scene wraps around vertically.
+		int m_ColorDepth; //!< The color depth footprints are drawn in.
+		int m_Columns; //!< The number of grid columns.
+		int m_Rows; //!< The number of grid rows.
+
+		std::vector<Entry> m_Entries; //!< Every registration since the objects were last cleared, in registration order, which is also the drawing order.
+		std::unordered_map<const MovableObject *, size_t> m_EntryIndices; //!< The index of the current entry of each registered object.
+		std::vector<std::vector<size_t>> m_Cells; //!< The indices of the entries whose bounds overlap each cell, row by row, in registration order.
+		std::vector<size_t> m_UsedCells; //!< The cells that have had entries added since the objects were last cleared, so clearing doesn't have to visit every cell.
+		std::unordered_map<int, std::vector<BITMAP *>> m_FootprintPool; //!< Unused footprint bitmaps, by size.
+		int m_FootprintsDrawn; //!< The number of footprints drawn since the objects were last cleared.
+
+		/// <summary>
+		/// Draws an entry's MOID representation into a footprint bitmap if it wasn't yet.
+		/// </summary>
+		/// <param name="entry">The entry to draw the footprint of.</param>
+		void DrawFootprint(Entry &entry);
+
+		/// <summary>
+		/// Unregisters an entry and returns its footprint bitmap to the pool.
+		/// </summary>
+		/// <param name="entry">The entry to release.</param>
+		void ReleaseEntry(Entry &entry);
+
+		/// <summary>
+		/// Gets the shortest distance along one axis from one coordinate to another, taking wrapping into account.
+		/// </summary>
+		/// <param name="from">The coordinate to measure from.</param>
+		/// <param name="to">The coordinate to measure to.</param>
+		/// <param name="size">The size of the Scene along this axis.</param>
+		/// <param name="wraps">Whether the Scene wraps along this axis.</param>
+		/// <returns>The shortest signed distance from one coordinate to the other.</returns>
+		static float ShortestDistance(float from, float to, int size, bool wraps);
+
+		/// <summary>
+		/// Clears all the member variables of this MOIDBroadphase, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		MOIDBroadphase(const MOIDBroadphase &reference) = delete;
+		MOIDBroadphase & operator=(const MOIDBroadphase &rhs) = delete;
+	};
+}
+#endif
@@ -30,7 +30,13 @@ namespace RTE {
 		ID_SRV_TERRAIN,
 		ID_SRV_POST_EFFECTS,
 		ID_SRV_SOUND_EVENTS,
-		ID_SRV_MUSIC_EVENTS
+		ID_SRV_MUSIC_EVENTS,
+		ID_CLT_FRAME_BOX_ACK,
+		ID_SRV_SCENE_TILE_MANIFEST,
+		ID_CLT_SCENE_TILE_REQUEST,
+		ID_SRV_ENTITY_PRESETS,
+		ID_SRV_ENTITY_SNAPSHOT,
+		ID_CLT_ENTITY_SNAPSHOT_ACK
 	};
 
 // Pack the structs so 1 byte members are exactly 1 byte in memory instead of being aligned by 4 bytes (padding) so the correct representation is sent over the network without empty bytes consumed by alignment.
@@ -100,12 +106,15 @@ namespace RTE {
 	struct MsgFrameSetup {
 		unsigned char Id;
 		unsigned char FrameNumber;
+		unsigned int FrameSequence; //!< Ever increasing number of the frame, which frame boxes refer to for delta encoding. Unlike FrameNumber it doesn't wrap around.
 
 		short int TargetPosX;
 		short int TargetPosY;
 
 		float OffsetX[c_MaxLayersStoredForNetwork];
 		float OffsetY[c_MaxLayersStoredForNetwork];
+
+		bool EntityReplication; //!< Whether replicable MovableObjects are left out of the frame and sent as entity snapshots for the client to draw.
 	};
 
 	/// <summary>
@@ -135,6 +144,50 @@ namespace RTE {
 		unsigned char BoxHeight;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
+
+		unsigned int FrameSequence; //!< The sequence number of the frame this box belongs to.
+		unsigned int ReferenceSequence; //!< The sequence number of the frame whose content of this box the data is XORed against, or 0 if the data is the box content itself.
+	};
+
+	/// <summary>
+	/// Tells the server how many of the frame boxes it sent for a frame arrived and could be decoded, so it knows when deltas were built against content the client doesn't have.
+	/// </summary>
+	struct MsgFrameBoxAck {
+		unsigned char Id;
+
+		unsigned int FrameSequence;
+		unsigned short int BoxCount;
+	};
+
+	/// <summary>
+	/// Adds Presets to the table of Presets the entities in entity snapshots refer to. Followed by PresetCount entries of an unsigned short table index,
+	/// then the class name and the module and preset name of the Preset, each as an unsigned char length followed by that many characters.
+	/// </summary>
+	struct MsgEntityPresets {
+		unsigned char Id;
+		unsigned short int PresetCount;
+	};
+
+	/// <summary>
+	/// The drawing state of the replicable MovableObjects in the player's view, as made by EntitySnapshot::Encode. LZ4 compressed unless DataSize equals UncompressedSize.
+	/// </summary>
+	struct MsgEntitySnapshot {
+		unsigned char Id;
+
+		unsigned int Sequence; //!< Ever increasing number of the snapshot, which later snapshots refer to as their baseline once it was acknowledged.
+		unsigned int BaselineSequence; //!< The sequence number of the snapshot the data is delta encoded against, or 0 if it's encoded whole.
+		unsigned int EntityCount;
+		unsigned int DataSize;
+		unsigned int UncompressedSize;
+	};
+
+	/// <summary>
+	/// Tells the server an entity snapshot arrived and was decoded, so later snapshots can be delta encoded against it.
+	/// </summary>
+	struct MsgEntitySnapshotAck {
+		unsigned char Id;
+
+		unsigned int Sequence;
 	};
 
 	/// <summary>
@@ -194,15 +247,32 @@ namespace RTE {
 	};
 
 	/// <summary>
-	/// 
+	/// Lists the content hash of every terrain tile of the Scene, so the client can fill the tiles it has cached and request only the rest.
+	/// Followed by TileCount hashes as unsigned long longs, background layer first, each layer row by row.
 	/// </summary>
-	struct MsgSceneLine {
+	struct MsgSceneTileManifest {
 		unsigned char Id;
 		unsigned char SceneId;
-		unsigned short int X;
-		unsigned short int Y;
-		unsigned short int Width;
-		unsigned char Layer;
+		unsigned short int TileSize;
+		unsigned int TileCount;
+	};
+
+	/// <summary>
+	/// Asks the server for the content of the terrain tiles the client doesn't have cached. Followed by HashCount hashes as unsigned long longs.
+	/// </summary>
+	struct MsgSceneTileRequest {
+		unsigned char Id;
+		unsigned char SceneId;
+		unsigned int HashCount;
+	};
+
+	/// <summary>
+	/// The content of a terrain tile. Goes to every tile in the manifest with the same hash.
+	/// </summary>
+	struct MsgSceneTile {
+		unsigned char Id;
+		unsigned char SceneId;
+		unsigned long long Hash;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
 	};
@@ -222,7 +292,8 @@ namespace RTE {
 	};
 
 	/// <summary>
-	/// 
+	/// The pixels of a terrain tile that changed during a sim update, merged over every change made to the tile.
+	/// The data is a bitmask of the changed pixels, row by row, followed by the new color of each changed pixel in the same order. LZ4 compressed unless that didn't make it smaller.
 	/// </summary>
 	struct MsgTerrainChange {
 		unsigned char Id;
@@ -232,7 +303,6 @@ namespace RTE {
 		unsigned short int W;
 		unsigned short int H;
 		bool Back;
-		unsigned char Color;
 		unsigned char SceneId;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
@@ -2,13 +2,32 @@
 
 namespace RTE {
 
+	int PathFinder::s_NextPathRequestTicket = PathFinder::c_NoPathRequestTicket + 1;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Clear() {
 		m_NodeGrid.clear();
+		m_GridWidth = 0;
+		m_GridHeight = 0;
 		m_NodeDimension = 20;
 		m_DigStrength = 1;
 		m_Pather = 0;
+		m_PatherAllocate = 2000;
+		m_SnapshotNodePositions.reset();
+		m_SnapshotAdjacentNodes.reset();
+		m_QueuedPathRequests.clear();
+		m_PathRequestBatches.clear();
+		m_PendingPathRequestTickets.clear();
+		m_CompletedPathRequests.clear();
+		m_ClusterColumns = 0;
+		m_ClusterRows = 0;
+		m_RightBorderCrossings.clear();
+		m_BottomBorderCrossings.clear();
+		m_ClusterEntrances.clear();
+		m_ClusterChanged.clear();
+		m_ClusterCostLayers.clear();
+		m_ClusterCostLayerUseCount = 0;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -24,39 +43,37 @@ namespace RTE {
 		int nodeXCount = std::ceil(static_cast<float>(sceneWidth) / static_cast<float>(m_NodeDimension));
 		int nodeYCount = std::ceil(static_cast<float>(sceneHeight) / static_cast<float>(m_NodeDimension));
 
-		// Create and assign scene coordinate positions for all nodes
-		PathNode *node = 0;
+		m_GridWidth = nodeXCount;
+		m_GridHeight = nodeYCount;
+
+		// Create and assign scene coordinate positions for all nodes, column by column in one block so they never move after this
+		m_NodeGrid.reserve(nodeXCount * nodeYCount);
 		Vector nodePos = Vector(static_cast<float>(nodeDimension) / 2.0F, static_cast<float>(nodeDimension) / 2.0F);
 		for (int x = 0; x < nodeXCount; ++x) {
 			// Make sure no cell centers are off the scene (since they can overlap the far edge of the scene)
 			if (nodePos.m_X >= sceneWidth) { nodePos.m_X = sceneWidth - 1; }
 			// Start the column height over at middle of the top node each new column
 			nodePos.m_Y = static_cast<float>(nodeDimension) / 2.0F;
-			// Create the new column and fill it out
-			std::vector<PathNode *> newColumn;
 			for (int y = 0; y < nodeYCount; ++y) {
 				// Make sure no cell centers are off the scene (since they can overlap the far edge of the scene)
 				if (nodePos.m_Y >= sceneHeight) { nodePos.m_Y = sceneHeight - 1; }
 				// Create the new node with its in-scene position in the center of it
-				node = new PathNode(nodePos);
+				m_NodeGrid.emplace_back(nodePos);
 				// Move current position down for the next node in the column
 				nodePos.m_Y += nodeDimension;
-				// Add the newly created node to the column, transferring ownership to it
-				newColumn.push_back(node);
 			}
 			// Move current position one to the right for the next column
 			nodePos.m_X += nodeDimension;
-			// Add the entire new column to the right end of the grid
-			m_NodeGrid.push_back(newColumn);
 		}
 		// Assign all the adjacent nodes on each node, taking into account scene wrapping etc.
+		PathNode *node = 0;
 		int wrappedUp;
 		int wrappedRight;
 		int wrappedDown;
 		int wrappedLeft;
 		for (int x = 0; x < nodeXCount; ++x) {
 			for (int y = 0; y < nodeYCount; ++y) {
-				node = m_NodeGrid[x][y];
+				node = GetPathNode(x, y);
 
 				wrappedLeft = x - 1;
 				if (wrappedLeft < 0 && scene->WrapsX()) { wrappedLeft = nodeXCount - 1; }
@@ -68,26 +85,36 @@ namespace RTE {
 				if (wrappedDown >= nodeYCount && scene->WrapsY()) { wrappedDown = 0; }
 
 				// Leave nulls if any are out of bounds, even after wrapping (ie there was no wrapping in effect in that direction)
-				if (wrappedUp >= 0) { node->Up = m_NodeGrid[x][wrappedUp]; }
-				if (wrappedRight < nodeXCount) { node->Right = m_NodeGrid[wrappedRight][y]; }
-				if (wrappedDown < nodeYCount) { node->Down = m_NodeGrid[x][wrappedDown]; }
-				if (wrappedLeft >= 0) { node->Left = m_NodeGrid[wrappedLeft][y]; }
+				if (wrappedUp >= 0) { node->Up = GetPathNode(x, wrappedUp); }
+				if (wrappedRight < nodeXCount) { node->Right = GetPathNode(wrappedRight, y); }
+				if (wrappedDown < nodeYCount) { node->Down = GetPathNode(x, wrappedDown); }
+				if (wrappedLeft >= 0) { node->Left = GetPathNode(wrappedLeft, y); }
 
 				// Diagonals
-				if (wrappedUp >= 0 && wrappedRight < nodeXCount) { node->UpRight = m_NodeGrid[wrappedRight][wrappedUp]; }
-				if (wrappedRight < nodeXCount && wrappedDown < nodeYCount) { node->RightDown = m_NodeGrid[wrappedRight][wrappedDown]; }
-				if (wrappedDown < nodeYCount && wrappedLeft >= 0) { node->DownLeft = m_NodeGrid[wrappedLeft][wrappedDown]; }
-				if (wrappedLeft >= 0 && wrappedUp >= 0) { node->LeftUp = m_NodeGrid[wrappedLeft][wrappedUp]; }
+				if (wrappedUp >= 0 && wrappedRight < nodeXCount) { node->UpRight = GetPathNode(wrappedRight, wrappedUp); }
+				if (wrappedRight < nodeXCount && wrappedDown < nodeYCount) { node->RightDown = GetPathNode(wrappedRight, wrappedDown); }
+				if (wrappedDown < nodeYCount && wrappedLeft >= 0) { node->DownLeft = GetPathNode(wrappedLeft, wrappedDown); }
+				if (wrappedLeft >= 0 && wrappedUp >= 0) { node->LeftUp = GetPathNode(wrappedLeft, wrappedUp); }
 			}
 		}
+		// Split the grid into clusters for hierarchical pathfinding. Their entrances and costs are worked out the first time a path needs them
+		m_ClusterColumns = (nodeXCount + c_ClusterSize - 1) / c_ClusterSize;
+		m_ClusterRows = (nodeYCount + c_ClusterSize - 1) / c_ClusterSize;
+		int clusterCount = m_ClusterColumns * m_ClusterRows;
+		m_RightBorderCrossings.assign(clusterCount, {});
+		m_BottomBorderCrossings.assign(clusterCount, {});
+		m_ClusterEntrances.assign(clusterCount, std::make_shared<const ClusterEntrances>());
+		m_ClusterChanged.assign(clusterCount, 1);
+
 		// Create and allocate the pather class which will do the work
 		m_Pather = new MicroPather(this, allocate);
+		m_PatherAllocate = allocate;
 
 		// If the scene wraps we must find the cost over the seam before doing RecalculateAllCosts() the first time
 		// since the cost is equal to max(node->LeftCost, node->m_Left->RightCost)
 		if (scene->WrapsX()) {
 			for (int y = 0; y < nodeYCount; ++y) {
-				node = m_NodeGrid[0][y];
+				node = GetPathNode(0, y);
 				if (node->Left) { node->Left->RightCost = CostAlongLine(node->Pos, node->Left->Pos); }
 			}
 		}
@@ -100,11 +127,9 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Destroy() {
-		for (unsigned int x = 0; x < m_NodeGrid.size(); ++x) {
-			for (unsigned int y = 0; y < m_NodeGrid[x].size(); ++y) {
-				delete m_NodeGrid[x][y];
-				m_NodeGrid[x][y] = 0;
-			}
+		// The workers only touch their own batches, but there's no point letting them finish solving paths nobody will pick up after this
+		for (const std::shared_ptr<PathRequestBatch> &batch : m_PathRequestBatches) {
+			g_ThreadMan.Wait(batch->Job);
 		}
 		delete m_Pather;
 		Clear();
@@ -133,31 +158,15 @@ namespace RTE {
 
 		// Do the actual pathfinding, fetch out the list of states that comprise the best path
 		std::vector<void *> statePath;
-		int result = m_Pather->Solve(static_cast<void *>(m_NodeGrid[startNodeX][startNodeY]), static_cast<void *>(m_NodeGrid[endNodeX][endNodeY]), &statePath, &totalCostResult);
-
-		// We got something back
-		if (!statePath.empty()) {
-			// Replace the approximate first point from the pathfound path with the exact starting point
-			pathResult.push_back(start);
-			std::vector<void *>::iterator itr = statePath.begin();
-			itr++;
+		int result = m_Pather->Solve(static_cast<void *>(GetPathNode(startNodeX, startNodeY)), static_cast<void *>(GetPathNode(endNodeX, endNodeY)), &statePath, &totalCostResult);
 
-			// Convert from a list of state void pointers to a list of scene position vectors
-			for (; itr != statePath.end(); ++itr) {
-				pathResult.push_back((static_cast<PathNode *>(*itr))->Pos);
-			}
-
-			// Adjust the last point to be exactly where the end is supposed to be (really?)
-			if (pathResult.size() > 2) {
-				pathResult.pop_back();
-				pathResult.push_back(end);
-			}
-			// Empty path, give exact start and end
-		} else {
-			pathResult.push_back(start);
-			pathResult.push_back(end);
+		// Convert from a list of state void pointers to a list of scene position vectors
+		std::vector<Vector> nodePositions;
+		nodePositions.reserve(statePath.size());
+		for (void *state : statePath) {
+			nodePositions.push_back((static_cast<PathNode *>(state))->Pos);
 		}
-		// TODO: Clean up the path, remove series of nodes in the same direction etc?
+		BuildPathResult(start, end, nodePositions, pathResult);
 		return result;
 	}
 
@@ -167,12 +176,10 @@ namespace RTE {
 		RTEAssert(g_SceneMan.GetScene(), "Scene doesn't exist or isn't loaded when recalculating PathFinder!");
 
 		// Update all the costs going out from each node
-		for (const std::vector<PathNode *> &nodeEntry : m_NodeGrid) {
-			for (PathNode *pathNode : nodeEntry) {
-				UpdateNodeCosts(pathNode);
-				// Should reset the changed flag since we're about to reset the pather
-				pathNode->IsChanged = false;
-			}
+		for (PathNode &pathNode : m_NodeGrid) {
+			UpdateNodeCosts(&pathNode);
+			// Should reset the changed flag since we're about to reset the pather
+			pathNode.IsChanged = false;
 		}
 		// Reset the pather when costs change, as per the docs
 		m_Pather->Reset();
@@ -220,10 +227,8 @@ namespace RTE {
 		m_Pather->Reset();
 
 		// Reset the changed flag on all nodes
-		for (const std::vector<PathNode *> &nodeEntry : m_NodeGrid) {
-			for (PathNode *pathNode : nodeEntry) {
-				pathNode->IsChanged = false;
-			}
+		for (PathNode &pathNode : m_NodeGrid) {
+			pathNode.IsChanged = false;
 		}
 	}
 
@@ -237,59 +242,16 @@ namespace RTE {
 
 	void PathFinder::AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) {
 		const PathNode *node = static_cast<PathNode *>(state);
+		const std::array<PathNode *, 8> adjacentNodes = { node->Up, node->Right, node->Down, node->Left, node->UpRight, node->RightDown, node->DownLeft, node->LeftUp };
+		const std::array<float, 8> adjacentStrengths = { node->UpCost, node->RightCost, node->DownCost, node->LeftCost, node->UpRightCost, node->RightDownCost, node->DownLeftCost, node->LeftUpCost };
 		micropather::StateCost adjCost;
-		float strength = 0.0F;
-
-		// Add cost for digging upwards
-		if (node->Up) {
-			strength = node->UpCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 2000.0F : strength * 4.0F); // Four times more expensive when digging
-			adjCost.state = static_cast<void *>(node->Up);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->Right) {
-			strength = node->RightCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
-			adjCost.state = static_cast<void *>(node->Right);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->Down) {
-			strength = node->DownCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
-			adjCost.state = static_cast<void *>(node->Down);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->Left) {
-			strength = node->LeftCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
-			adjCost.state = static_cast<void *>(node->Left);
-			adjacentList->push_back(adjCost);
-		}
-
-		// Add cost for digging at 45 degrees and for digging upwards
-		if (node->UpRight) {
-			strength = node->UpRightCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
-			adjCost.state = static_cast<void *>(node->UpRight);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->RightDown) {
-			strength = node->RightDownCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 1414.0F : strength * 1.4F);
-			adjCost.state = static_cast<void *>(node->RightDown);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->DownLeft) {
-			strength = node->DownLeftCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 1414.0F : strength * 1.4F);
-			adjCost.state = static_cast<void *>(node->DownLeft);
-			adjacentList->push_back(adjCost);
-		}
-		if (node->LeftUp) {
-			strength = node->LeftUpCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
-			adjCost.state = static_cast<void *>(node->LeftUp);
-			adjacentList->push_back(adjCost);
+
+		for (int direction = 0; direction < 8; ++direction) {
+			if (adjacentNodes[direction]) {
+				adjCost.cost = GetAdjacentNodeCost(direction, adjacentStrengths[direction], m_DigStrength);
+				adjCost.state = static_cast<void *>(adjacentNodes[direction]);
+				adjacentList->push_back(adjCost);
+			}
 		}
 	}
 
@@ -312,6 +274,9 @@ namespace RTE {
 
 		// Mark this as already changed so the above expensive calculation isn't done redundantly
 		node->IsChanged = true;
+		// The costs inside this node's cluster, and possibly its entrances, need working out again before the next hierarchical path
+		int nodeIndex = static_cast<int>(node - m_NodeGrid.data());
+		m_ClusterChanged[((nodeIndex % m_GridHeight) / c_ClusterSize) * m_ClusterColumns + (nodeIndex / m_GridHeight) / c_ClusterSize] = 1;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -327,18 +292,623 @@ namespace RTE {
 
 		// Truncate the influence
 		if (firstX < 0) { firstX = 0; }
-		if (lastX >= m_NodeGrid.size()) { lastX = m_NodeGrid.size() - 1; }
+		if (lastX >= m_GridWidth) { lastX = m_GridWidth - 1; }
 		if (firstY < 0) { firstY = 0; }
-		if (lastY >= m_NodeGrid[0].size()) { lastY = m_NodeGrid[0].size() - 1; }
+		if (lastY >= m_GridHeight) { lastY = m_GridHeight - 1; }
 
 		// Only iterate through the grid where the box overlaps any edges
 		PathNode *node = 0;
 		for (int nodeX = firstX; nodeX <= lastX; ++nodeX) {
 			for (int nodeY = firstY; nodeY <= lastY; ++nodeY) {
-				node = m_NodeGrid[nodeX][nodeY];
+				node = GetPathNode(nodeX, nodeY);
 				// Update all the costs going out from each node which is found to be affected by the box
 				if (!node->IsChanged) { UpdateNodeCosts(node); }
 			}
 		}
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::SubmitPathRequest(int team, Vector start, Vector end, float digStrength) {
+		// Make sure start and end are within scene bounds, same as when calculating the path directly
+		g_SceneMan.ForceBounds(start);
+		g_SceneMan.ForceBounds(end);
+
+		int ticket = s_NextPathRequestTicket++;
+		if (s_NextPathRequestTicket <= c_NoPathRequestTicket) { s_NextPathRequestTicket = c_NoPathRequestTicket + 1; }
+
+		m_QueuedPathRequests.push_back({ ticket, team, start, end, digStrength });
+		m_PendingPathRequestTickets.insert(ticket);
+		return ticket;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PathFinder::GetPathRequestResult(int ticket, std::list<Vector> &pathResult, float &totalCostResult, int &unrefinedWaypointCountResult) {
+		std::unordered_map<int, CompletedPathRequest>::iterator completedRequest = m_CompletedPathRequests.find(ticket);
+		if (completedRequest == m_CompletedPathRequests.end()) {
+			return false;
+		}
+		pathResult.swap(completedRequest->second.Path);
+		totalCostResult = completedRequest->second.TotalCost;
+		unrefinedWaypointCountResult = completedRequest->second.UnrefinedWaypointCount;
+		m_CompletedPathRequests.erase(completedRequest);
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::GetTeamsWithQueuedPathRequests(std::vector<int> &teams) const {
+		teams.clear();
+		for (const QueuedPathRequest &queuedRequest : m_QueuedPathRequests) {
+			if (m_PendingPathRequestTickets.find(queuedRequest.Ticket) != m_PendingPathRequestTickets.end() && std::find(teams.begin(), teams.end(), queuedRequest.Team) == teams.end()) {
+				teams.push_back(queuedRequest.Team);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::DispatchPathRequests(int team) {
+		std::shared_ptr<PathRequestBatch> batch = std::make_shared<PathRequestBatch>();
+
+		// Coalesce requests that go between the same nodes with the same dig strength, they'd get the exact same node path anyway. The map keeps the solves ordered by dig strength.
+		std::map<std::tuple<float, int, int>, int> solveIndices;
+		std::vector<QueuedPathRequest> remainingRequests;
+		for (const QueuedPathRequest &queuedRequest : m_QueuedPathRequests) {
+			if (queuedRequest.Team != team) {
+				remainingRequests.push_back(queuedRequest);
+			} else if (m_PendingPathRequestTickets.find(queuedRequest.Ticket) != m_PendingPathRequestTickets.end()) {
+				batch->Requests.push_back({ queuedRequest, -1 });
+				solveIndices.insert({ { queuedRequest.DigStrength, GetNodeIndex(queuedRequest.Start), GetNodeIndex(queuedRequest.End) }, -1 });
+			}
+		}
+		m_QueuedPathRequests.swap(remainingRequests);
+		if (batch->Requests.empty()) {
+			return;
+		}
+
+		batch->Solves.reserve(solveIndices.size());
+		for (auto &[solveKey, solveIndex] : solveIndices) {
+			solveIndex = static_cast<int>(batch->Solves.size());
+			batch->Solves.push_back({ std::get<1>(solveKey), std::get<2>(solveKey), std::get<0>(solveKey), {}, 0, MicroPather::NO_SOLUTION, false, 0 });
+		}
+		for (std::pair<QueuedPathRequest, int> &batchRequest : batch->Requests) {
+			batchRequest.second = solveIndices.at({ batchRequest.first.DigStrength, GetNodeIndex(batchRequest.first.Start), GetNodeIndex(batchRequest.first.End) });
+		}
+		batch->PatherAllocate = m_PatherAllocate;
+		TakeCostSnapshot(batch->Snapshot);
+
+		// Paths spanning several clusters get solved over the cluster entrances, which need to be up to date for the dig strengths they use
+		std::set<float> hierarchicalDigStrengths;
+		for (PathSolve &solve : batch->Solves) {
+			int startCluster = GetClusterIndex(batch->Snapshot, solve.StartNode);
+			int endCluster = GetClusterIndex(batch->Snapshot, solve.EndNode);
+			int clusterDistanceX = std::abs(startCluster % m_ClusterColumns - endCluster % m_ClusterColumns);
+			int clusterDistanceY = std::abs(startCluster / m_ClusterColumns - endCluster / m_ClusterColumns);
+			if (batch->Snapshot.WrapsX) { clusterDistanceX = std::min(clusterDistanceX, m_ClusterColumns - clusterDistanceX); }
+			if (batch->Snapshot.WrapsY) { clusterDistanceY = std::min(clusterDistanceY, m_ClusterRows - clusterDistanceY); }
+
+			solve.Hierarchical = std::max(clusterDistanceX, clusterDistanceY) >= c_MinHierarchicalClusterDistance;
+			if (solve.Hierarchical) { hierarchicalDigStrengths.insert(solve.DigStrength); }
+		}
+		if (!hierarchicalDigStrengths.empty()) {
+			UpdateClusters(batch->Snapshot, hierarchicalDigStrengths);
+			batch->Clusters = m_ClusterEntrances;
+			for (float digStrength : hierarchicalDigStrengths) {
+				batch->ClusterCosts.insert({ digStrength, m_ClusterCostLayers.at(digStrength).Costs });
+			}
+			// Throw out the cluster costs of the dig strengths that haven't been needed for the longest, the batch keeps its own references to the ones it uses
+			while (m_ClusterCostLayers.size() > c_MaxCachedDigStrengths) {
+				std::map<float, ClusterCostLayer>::iterator leastRecentlyUsedLayer = std::min_element(m_ClusterCostLayers.begin(), m_ClusterCostLayers.end(), [](const auto &layer, const auto &otherLayer) { return layer.second.LastUsed < otherLayer.second.LastUsed; });
+				m_ClusterCostLayers.erase(leastRecentlyUsedLayer);
+			}
+		}
+
+		batch->Job = g_ThreadMan.ParallelFor(0, static_cast<int>(batch->Solves.size()), 0, [batch](int chunkStart, int chunkEnd, int chunkIndex) { SolvePathRange(*batch, chunkStart, chunkEnd); });
+		// Without any workers nothing would ever pick the job up, so solve it right away and it'll be collected on the next update like any other
+		if (g_ThreadMan.GetWorkerCount() == 0) { g_ThreadMan.Wait(batch->Job); }
+
+		m_PathRequestBatches.push_back(batch);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::CollectPathRequests() {
+		std::vector<Vector> nodePositions;
+		for (std::vector<std::shared_ptr<PathRequestBatch>>::iterator batchItr = m_PathRequestBatches.begin(); batchItr != m_PathRequestBatches.end();) {
+			const PathRequestBatch &batch = **batchItr;
+			if (!batch.Job->IsCompleted()) {
+				++batchItr;
+				continue;
+			}
+			for (const auto &[request, solveIndex] : batch.Requests) {
+				// Requests that were cancelled while being solved are simply dropped
+				if (m_PendingPathRequestTickets.erase(request.Ticket) == 0) {
+					continue;
+				}
+				const PathSolve &solve = batch.Solves[solveIndex];
+				nodePositions.clear();
+				for (int nodeIndex : solve.NodePath) {
+					nodePositions.push_back((*batch.Snapshot.NodePositions)[nodeIndex]);
+				}
+				CompletedPathRequest &completedRequest = m_CompletedPathRequests[request.Ticket];
+				BuildPathResult(request.Start, request.End, nodePositions, completedRequest.Path);
+				// It's ok if start and end nodes happen to be the same, the exact locations are in the path regardless
+				completedRequest.TotalCost = (solve.Result == MicroPather::SOLVED || solve.Result == MicroPather::START_END_SAME) ? solve.TotalCost : -1.0F;
+				completedRequest.UnrefinedWaypointCount = std::min(solve.UnrefinedNodeCount, std::max(static_cast<int>(completedRequest.Path.size()) - 1, 0));
+			}
+			batchItr = m_PathRequestBatches.erase(batchItr);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::GetAdjacentNodeCost(int direction, float strength, float digStrength) {
+		// Up, Right, Down, Left, UpRight, RightDown, DownLeft, LeftUp. Digging upwards is four times, and at 45 degrees upwards three times, more expensive
+		static constexpr std::array<float, 8> baseCosts = { 1.0F, 1.0F, 1.0F, 1.0F, 1.4F, 1.4F, 1.4F, 1.4F };
+		static constexpr std::array<float, 8> diggableMultipliers = { 4.0F, 1.0F, 1.0F, 1.0F, 4.2F, 1.4F, 1.4F, 4.2F };
+		static constexpr std::array<float, 8> undiggableMultipliers = { 2000.0F, 1000.0F, 1000.0F, 1000.0F, 2828.0F, 1414.0F, 1414.0F, 2828.0F };
+
+		return baseCosts[direction] + strength * ((strength > digStrength) ? undiggableMultipliers[direction] : diggableMultipliers[direction]);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::GetNodeIndex(const Vector &pos) const {
+		int nodeX = std::floor(pos.m_X / static_cast<float>(m_NodeDimension));
+		int nodeY = std::floor(pos.m_Y / static_cast<float>(m_NodeDimension));
+		return nodeX * m_GridHeight + nodeY;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::TakeCostSnapshot(PathCostSnapshot &snapshot) {
+		int nodeCount = static_cast<int>(m_NodeGrid.size());
+
+		// The node layout never changes, so it only needs to be flattened the first time and can be shared by every snapshot after
+		if (!m_SnapshotNodePositions) {
+			std::vector<Vector> nodePositions(nodeCount);
+			std::vector<std::array<int, 8>> adjacentNodes(nodeCount);
+			for (int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+				const PathNode &node = m_NodeGrid[nodeIndex];
+				nodePositions[nodeIndex] = node.Pos;
+				const std::array<const PathNode *, 8> adjacents = { node.Up, node.Right, node.Down, node.Left, node.UpRight, node.RightDown, node.DownLeft, node.LeftUp };
+				for (int direction = 0; direction < 8; ++direction) {
+					adjacentNodes[nodeIndex][direction] = adjacents[direction] ? static_cast<int>(adjacents[direction] - m_NodeGrid.data()) : -1;
+				}
+			}
+			m_SnapshotNodePositions = std::make_shared<const std::vector<Vector>>(std::move(nodePositions));
+			m_SnapshotAdjacentNodes = std::make_shared<const std::vector<std::array<int, 8>>>(std::move(adjacentNodes));
+		}
+		snapshot.SceneWidth = g_SceneMan.GetSceneWidth();
+		snapshot.SceneHeight = g_SceneMan.GetSceneHeight();
+		snapshot.WrapsX = g_SceneMan.SceneWrapsX();
+		snapshot.WrapsY = g_SceneMan.SceneWrapsY();
+		snapshot.GridWidth = m_GridWidth;
+		snapshot.GridHeight = m_GridHeight;
+		snapshot.ClusterColumns = m_ClusterColumns;
+		snapshot.ClusterRows = m_ClusterRows;
+		snapshot.NodePositions = m_SnapshotNodePositions;
+		snapshot.AdjacentNodes = m_SnapshotAdjacentNodes;
+
+		snapshot.AdjacentCosts.resize(nodeCount);
+		for (int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+			const PathNode &node = m_NodeGrid[nodeIndex];
+			snapshot.AdjacentCosts[nodeIndex] = { node.UpCost, node.RightCost, node.DownCost, node.LeftCost, node.UpRightCost, node.RightDownCost, node.DownLeftCost, node.LeftUpCost };
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SolvePathRange(PathRequestBatch &batch, int solveStart, int solveEnd) {
+		// Node indices are offset by one when used as states, so node 0 isn't mistaken for a null state
+		auto toState = [](int nodeIndex) { return reinterpret_cast<void *>(static_cast<intptr_t>(nodeIndex) + 1); };
+
+		PathCostSnapshotGraph snapshotGraph(batch.Snapshot);
+		MicroPather pather(&snapshotGraph, batch.PatherAllocate);
+		std::vector<void *> statePath;
+		float currentDigStrength = -1.0F;
+
+		for (int solveIndex = solveStart; solveIndex < solveEnd; ++solveIndex) {
+			PathSolve &solve = batch.Solves[solveIndex];
+			if (solve.Hierarchical && SolveHierarchical(batch, solve)) {
+				continue;
+			}
+			// The pather caches costs, so it has to be reset whenever the dig strength changes. Solves are sorted by it so this rarely happens.
+			if (solve.DigStrength != currentDigStrength) {
+				currentDigStrength = solve.DigStrength;
+				snapshotGraph.SetDigStrength(currentDigStrength);
+				pather.Reset();
+			}
+			statePath.clear();
+			solve.Result = pather.Solve(toState(solve.StartNode), toState(solve.EndNode), &statePath, &solve.TotalCost);
+			solve.NodePath.clear();
+			for (void *state : statePath) {
+				solve.NodePath.push_back(static_cast<int>(reinterpret_cast<intptr_t>(state) - 1));
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::BuildPathResult(const Vector &start, const Vector &end, const std::vector<Vector> &nodePositions, std::list<Vector> &pathResult) {
+		pathResult.clear();
+
+		// We got something back
+		if (!nodePositions.empty()) {
+			// Replace the approximate first point from the pathfound path with the exact starting point
+			pathResult.push_back(start);
+			pathResult.insert(pathResult.end(), nodePositions.begin() + 1, nodePositions.end());
+
+			// Adjust the last point to be exactly where the end is supposed to be (really?)
+			if (pathResult.size() > 2) {
+				pathResult.pop_back();
+				pathResult.push_back(end);
+			}
+			// Empty path, give exact start and end
+		} else {
+			pathResult.push_back(start);
+			pathResult.push_back(end);
+		}
+		// TODO: Clean up the path, remove series of nodes in the same direction etc?
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::PathCostSnapshotGraph::LeastCostEstimate(void *startState, void *endState) {
+		return EstimateSnapshotCost(m_Snapshot, static_cast<int>(reinterpret_cast<intptr_t>(startState) - 1), static_cast<int>(reinterpret_cast<intptr_t>(endState) - 1));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::PathCostSnapshotGraph::AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) {
+		int nodeIndex = static_cast<int>(reinterpret_cast<intptr_t>(state) - 1);
+		const std::array<int, 8> &adjacentNodes = (*m_Snapshot.AdjacentNodes)[nodeIndex];
+		const std::array<float, 8> &adjacentStrengths = m_Snapshot.AdjacentCosts[nodeIndex];
+		micropather::StateCost adjCost;
+
+		for (int direction = 0; direction < 8; ++direction) {
+			if (adjacentNodes[direction] >= 0) {
+				adjCost.cost = GetAdjacentNodeCost(direction, adjacentStrengths[direction], m_DigStrength);
+				adjCost.state = reinterpret_cast<void *>(static_cast<intptr_t>(adjacentNodes[direction]) + 1);
+				adjacentList->push_back(adjCost);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::array<int, 4> PathFinder::GetClusterBounds(const PathCostSnapshot &snapshot, int clusterIndex) {
+		int firstX = (clusterIndex % snapshot.ClusterColumns) * c_ClusterSize;
+		int firstY = (clusterIndex / snapshot.ClusterColumns) * c_ClusterSize;
+		return { firstX, firstY, std::min(firstX + c_ClusterSize, snapshot.GridWidth) - 1, std::min(firstY + c_ClusterSize, snapshot.GridHeight) - 1 };
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::GetIndexInCluster(const PathCostSnapshot &snapshot, int clusterIndex, int nodeIndex) {
+		int firstX = (clusterIndex % snapshot.ClusterColumns) * c_ClusterSize;
+		int firstY = (clusterIndex / snapshot.ClusterColumns) * c_ClusterSize;
+		int clusterHeight = std::min(firstY + c_ClusterSize, snapshot.GridHeight) - firstY;
+		return (nodeIndex / snapshot.GridHeight - firstX) * clusterHeight + (nodeIndex % snapshot.GridHeight - firstY);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::EstimateSnapshotCost(const PathCostSnapshot &snapshot, int startNode, int endNode) {
+		const Vector &startPos = (*snapshot.NodePositions)[startNode];
+		const Vector &endPos = (*snapshot.NodePositions)[endNode];
+
+		// Same wrapping as SceneMan::ShortestDistance, without touching SceneMan from the worker threads
+		float distanceX = std::abs(endPos.m_X - startPos.m_X);
+		float distanceY = std::abs(endPos.m_Y - startPos.m_Y);
+		if (snapshot.WrapsX && distanceX > static_cast<float>(snapshot.SceneWidth) / 2.0F) { distanceX = static_cast<float>(snapshot.SceneWidth) - distanceX; }
+		if (snapshot.WrapsY && distanceY > static_cast<float>(snapshot.SceneHeight) / 2.0F) { distanceY = static_cast<float>(snapshot.SceneHeight) - distanceY; }
+		return std::sqrt(distanceX * distanceX + distanceY * distanceY);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SearchCluster(const PathCostSnapshot &snapshot, int clusterIndex, int sourceNode, int targetNode, float digStrength, bool reverse, std::vector<float> &nodeCosts, std::vector<int> &nextNodes) {
+		auto [firstX, firstY, lastX, lastY] = GetClusterBounds(snapshot, clusterIndex);
+		int clusterNodeCount = (lastX - firstX + 1) * (lastY - firstY + 1);
+		nodeCosts.assign(clusterNodeCount, FLT_MAX);
+		nextNodes.assign(clusterNodeCount, -1);
+
+		using OpenNode = std::pair<float, int>;
+		std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> openNodes;
+		nodeCosts[GetIndexInCluster(snapshot, clusterIndex, sourceNode)] = 0;
+		openNodes.push({ 0.0F, sourceNode });
+
+		while (!openNodes.empty()) {
+			auto [nodeCost, node] = openNodes.top();
+			openNodes.pop();
+			if (nodeCost > nodeCosts[GetIndexInCluster(snapshot, clusterIndex, node)]) {
+				continue;
+			} else if (node == targetNode) {
+				break;
+			}
+			const std::array<int, 8> &adjacentNodes = (*snapshot.AdjacentNodes)[node];
+			for (int direction = 0; direction < 8; ++direction) {
+				int adjacentNode = adjacentNodes[direction];
+				if (adjacentNode < 0 || GetClusterIndex(snapshot, adjacentNode) != clusterIndex) {
+					continue;
+				}
+				// Searching in reverse means going against the edges, so use the cost of coming from the adjacent node instead of going to it
+				int oppositeDirection = GetOppositeDirection(direction);
+				float adjacentCost = nodeCost + (reverse ? GetAdjacentNodeCost(oppositeDirection, snapshot.AdjacentCosts[adjacentNode][oppositeDirection], digStrength) : GetAdjacentNodeCost(direction, snapshot.AdjacentCosts[node][direction], digStrength));
+				int adjacentIndexInCluster = GetIndexInCluster(snapshot, clusterIndex, adjacentNode);
+				if (adjacentCost < nodeCosts[adjacentIndexInCluster]) {
+					nodeCosts[adjacentIndexInCluster] = adjacentCost;
+					nextNodes[adjacentIndexInCluster] = node;
+					openNodes.push({ adjacentCost, adjacentNode });
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::FindBorderCrossings(const PathCostSnapshot &snapshot, int clusterIndex, int direction, std::vector<std::pair<int, int>> &crossings) {
+		crossings.clear();
+		auto [firstX, firstY, lastX, lastY] = GetClusterBounds(snapshot, clusterIndex);
+		bool rightBorder = direction == 1;
+		int borderLength = rightBorder ? (lastY - firstY + 1) : (lastX - firstX + 1);
+		int oppositeDirection = GetOppositeDirection(direction);
+
+		for (int spanStart = 0; spanStart < borderLength; spanStart += c_EntranceSpan) {
+			int spanEnd = std::min(spanStart + c_EntranceSpan, borderLength);
+			float spanMiddle = static_cast<float>(spanStart + spanEnd - 1) / 2.0F;
+			std::pair<int, int> bestCrossing = { -1, -1 };
+			float bestCrossingStrength = FLT_MAX;
+			float bestDistanceFromMiddle = FLT_MAX;
+
+			for (int borderPos = spanStart; borderPos < spanEnd; ++borderPos) {
+				int node = rightBorder ? (lastX * snapshot.GridHeight + firstY + borderPos) : ((firstX + borderPos) * snapshot.GridHeight + lastY);
+				int acrossNode = (*snapshot.AdjacentNodes)[node][direction];
+				// Nothing across a non-wrapping scene edge, and a scene only one cluster wide wraps back into the same cluster
+				if (acrossNode < 0 || GetClusterIndex(snapshot, acrossNode) == clusterIndex) {
+					continue;
+				}
+				// Prefer the crossing with the least material in the way both ways, and the one closest to the middle of the span if it's all the same
+				float crossingStrength = snapshot.AdjacentCosts[node][direction] + snapshot.AdjacentCosts[acrossNode][oppositeDirection];
+				float distanceFromMiddle = std::abs(static_cast<float>(borderPos) - spanMiddle);
+				if (crossingStrength < bestCrossingStrength || (crossingStrength == bestCrossingStrength && distanceFromMiddle < bestDistanceFromMiddle)) {
+					bestCrossing = { node, acrossNode };
+					bestCrossingStrength = crossingStrength;
+					bestDistanceFromMiddle = distanceFromMiddle;
+				}
+			}
+			if (bestCrossing.first >= 0) { crossings.push_back(bestCrossing); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<const std::vector<float>> PathFinder::CalculateClusterCosts(const PathCostSnapshot &snapshot, int clusterIndex, const ClusterEntrances &entrances, float digStrength) {
+		int entranceCount = static_cast<int>(entrances.Nodes.size());
+		std::vector<float> entranceCosts(entranceCount * entranceCount, FLT_MAX);
+		std::vector<float> nodeCosts;
+		std::vector<int> notUsed;
+
+		for (int fromEntrance = 0; fromEntrance < entranceCount; ++fromEntrance) {
+			SearchCluster(snapshot, clusterIndex, entrances.Nodes[fromEntrance], -1, digStrength, false, nodeCosts, notUsed);
+			for (int toEntrance = 0; toEntrance < entranceCount; ++toEntrance) {
+				entranceCosts[fromEntrance * entranceCount + toEntrance] = nodeCosts[GetIndexInCluster(snapshot, clusterIndex, entrances.Nodes[toEntrance])];
+			}
+		}
+		return std::make_shared<const std::vector<float>>(std::move(entranceCosts));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::UpdateClusters(const PathCostSnapshot &snapshot, const std::set<float> &digStrengths) {
+		int clusterCount = m_ClusterColumns * m_ClusterRows;
+		auto getLeftCluster = [&](int clusterIndex) { return (clusterIndex % m_ClusterColumns > 0) ? clusterIndex - 1 : ((snapshot.WrapsX && m_ClusterColumns > 1) ? clusterIndex + m_ClusterColumns - 1 : -1); };
+		auto getUpCluster = [&](int clusterIndex) { return (clusterIndex / m_ClusterColumns > 0) ? clusterIndex - m_ClusterColumns : ((snapshot.WrapsY && m_ClusterRows > 1) ? clusterIndex + (m_ClusterRows - 1) * m_ClusterColumns : -1); };
+
+		// Every border of a changed cluster may have better entrances now. Each border belongs to the cluster on its left or top side
+		std::vector<char> rightBorderOutdated(clusterCount, 0);
+		std::vector<char> bottomBorderOutdated(clusterCount, 0);
+		for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
+			if (m_ClusterChanged[clusterIndex]) {
+				rightBorderOutdated[clusterIndex] = 1;
+				bottomBorderOutdated[clusterIndex] = 1;
+				if (int leftCluster = getLeftCluster(clusterIndex); leftCluster >= 0) { rightBorderOutdated[leftCluster] = 1; }
+				if (int upCluster = getUpCluster(clusterIndex); upCluster >= 0) { bottomBorderOutdated[upCluster] = 1; }
+			}
+		}
+		// Changed clusters need their costs redone, and so do the clusters on the other side of any border whose entrances moved
+		std::vector<char> clusterOutdated = m_ClusterChanged;
+		std::vector<std::pair<int, int>> newCrossings;
+		auto updateBorder = [&](int clusterIndex, int direction, std::vector<std::pair<int, int>> &crossings) {
+			FindBorderCrossings(snapshot, clusterIndex, direction, newCrossings);
+			if (newCrossings != crossings) {
+				for (const std::vector<std::pair<int, int>> *borderCrossings : { &crossings, &newCrossings }) {
+					for (const auto &[node, acrossNode] : *borderCrossings) {
+						clusterOutdated[GetClusterIndex(snapshot, acrossNode)] = 1;
+					}
+				}
+				clusterOutdated[clusterIndex] = 1;
+				crossings.swap(newCrossings);
+			}
+		};
+		for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
+			if (rightBorderOutdated[clusterIndex]) { updateBorder(clusterIndex, 1, m_RightBorderCrossings[clusterIndex]); }
+			if (bottomBorderOutdated[clusterIndex]) { updateBorder(clusterIndex, 2, m_BottomBorderCrossings[clusterIndex]); }
+		}
+
+		// Gather the entrances of the outdated clusters from all four of their borders
+		for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
+			if (!clusterOutdated[clusterIndex]) {
+				continue;
+			}
+			std::shared_ptr<ClusterEntrances> entrances = std::make_shared<ClusterEntrances>();
+			auto addLink = [&entrances](int node, int acrossNode, int direction) {
+				std::vector<int>::iterator entranceNode = std::find(entrances->Nodes.begin(), entrances->Nodes.end(), node);
+				if (entranceNode == entrances->Nodes.end()) {
+					entrances->Nodes.push_back(node);
+					entrances->Links.emplace_back();
+					entranceNode = entrances->Nodes.end() - 1;
+				}
+				entrances->Links[entranceNode - entrances->Nodes.begin()].push_back({ acrossNode, direction });
+			};
+			for (const auto &[node, acrossNode] : m_RightBorderCrossings[clusterIndex]) { addLink(node, acrossNode, 1); }
+			for (const auto &[node, acrossNode] : m_BottomBorderCrossings[clusterIndex]) { addLink(node, acrossNode, 2); }
+			if (int leftCluster = getLeftCluster(clusterIndex); leftCluster >= 0) {
+				for (const auto &[node, acrossNode] : m_RightBorderCrossings[leftCluster]) { addLink(acrossNode, node, 3); }
+			}
+			if (int upCluster = getUpCluster(clusterIndex); upCluster >= 0) {
+				for (const auto &[node, acrossNode] : m_BottomBorderCrossings[upCluster]) { addLink(acrossNode, node, 0); }
+			}
+			m_ClusterEntrances[clusterIndex] = entrances;
+			for (auto &[digStrength, clusterCostLayer] : m_ClusterCostLayers) {
+				clusterCostLayer.Outdated[clusterIndex] = 1;
+			}
+		}
+		std::fill(m_ClusterChanged.begin(), m_ClusterChanged.end(), 0);
+
+		// Work out the costs between the entrances of every outdated cluster for each needed dig strength. Clusters don't depend on each other, so they're done in parallel
+		m_ClusterCostLayerUseCount++;
+		for (float digStrength : digStrengths) {
+			std::map<float, ClusterCostLayer>::iterator clusterCostLayerEntry = m_ClusterCostLayers.find(digStrength);
+			if (clusterCostLayerEntry == m_ClusterCostLayers.end()) {
+				clusterCostLayerEntry = m_ClusterCostLayers.insert({ digStrength, { std::vector<std::shared_ptr<const std::vector<float>>>(clusterCount), std::vector<char>(clusterCount, 1), 0 } }).first;
+			}
+			ClusterCostLayer &clusterCostLayer = clusterCostLayerEntry->second;
+			clusterCostLayer.LastUsed = m_ClusterCostLayerUseCount;
+
+			std::vector<int> outdatedClusters;
+			for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
+				if (clusterCostLayer.Outdated[clusterIndex]) { outdatedClusters.push_back(clusterIndex); }
+			}
+			g_ThreadMan.Wait(g_ThreadMan.ParallelFor(0, static_cast<int>(outdatedClusters.size()), 0, [&](int chunkStart, int chunkEnd, int chunkIndex) {
+				for (int outdatedIndex = chunkStart; outdatedIndex < chunkEnd; ++outdatedIndex) {
+					int clusterIndex = outdatedClusters[outdatedIndex];
+					clusterCostLayer.Costs[clusterIndex] = CalculateClusterCosts(snapshot, clusterIndex, *m_ClusterEntrances[clusterIndex], digStrength);
+				}
+			}));
+			std::fill(clusterCostLayer.Outdated.begin(), clusterCostLayer.Outdated.end(), 0);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PathFinder::SolveHierarchical(const PathRequestBatch &batch, PathSolve &solve) {
+		const PathCostSnapshot &snapshot = batch.Snapshot;
+		const std::vector<std::shared_ptr<const std::vector<float>>> &clusterCosts = batch.ClusterCosts.at(solve.DigStrength);
+		int startCluster = GetClusterIndex(snapshot, solve.StartNode);
+		int endCluster = GetClusterIndex(snapshot, solve.EndNode);
+
+		// Find the way out of the start cluster to each of its entrances, and the way from each entrance of the end cluster to the end
+		std::vector<float> startNodeCosts;
+		std::vector<int> startPreviousNodes;
+		SearchCluster(snapshot, startCluster, solve.StartNode, -1, solve.DigStrength, false, startNodeCosts, startPreviousNodes);
+		std::vector<float> endNodeCosts;
+		std::vector<int> endNextNodes;
+		SearchCluster(snapshot, endCluster, solve.EndNode, -1, solve.DigStrength, true, endNodeCosts, endNextNodes);
+
+		// A* over the entrances of all the clusters, with the start and end only connected to the entrances of their own clusters
+		static constexpr int endState = -1;
+		static constexpr int startState = -2;
+		std::unordered_map<int, std::pair<float, int>> bestCosts;
+		using OpenEntrance = std::pair<float, std::pair<float, int>>;
+		std::priority_queue<OpenEntrance, std::vector<OpenEntrance>, std::greater<OpenEntrance>> openEntrances;
+		auto openEntrance = [&](int node, int previousNode, float cost) {
+			if (cost >= FLT_MAX) {
+				return;
+			}
+			std::unordered_map<int, std::pair<float, int>>::iterator bestCost = bestCosts.find(node);
+			if (bestCost == bestCosts.end() || cost < bestCost->second.first) {
+				bestCosts[node] = { cost, previousNode };
+				openEntrances.push({ cost + ((node == endState) ? 0.0F : EstimateSnapshotCost(snapshot, node, solve.EndNode)), { cost, node } });
+			}
+		};
+		const ClusterEntrances &startEntrances = *batch.Clusters[startCluster];
+		for (int entranceNode : startEntrances.Nodes) {
+			openEntrance(entranceNode, startState, startNodeCosts[GetIndexInCluster(snapshot, startCluster, entranceNode)]);
+		}
+		bool foundEnd = false;
+		while (!openEntrances.empty()) {
+			auto [estimatedCost, costAndNode] = openEntrances.top();
+			auto [cost, node] = costAndNode;
+			openEntrances.pop();
+			if (cost > bestCosts[node].first) {
+				continue;
+			} else if (node == endState) {
+				foundEnd = true;
+				break;
+			}
+			int cluster = GetClusterIndex(snapshot, node);
+			const ClusterEntrances &entrances = *batch.Clusters[cluster];
+			const std::vector<float> &entranceCosts = *clusterCosts[cluster];
+			int entranceCount = static_cast<int>(entrances.Nodes.size());
+			int entrance = static_cast<int>(std::find(entrances.Nodes.begin(), entrances.Nodes.end(), node) - entrances.Nodes.begin());
+
+			if (cluster == endCluster) { openEntrance(endState, node, cost + endNodeCosts[GetIndexInCluster(snapshot, cluster, node)]); }
+			for (int otherEntrance = 0; otherEntrance < entranceCount; ++otherEntrance) {
+				if (otherEntrance != entrance) { openEntrance(entrances.Nodes[otherEntrance], node, cost + entranceCosts[entrance * entranceCount + otherEntrance]); }
+			}
+			for (const auto &[acrossNode, direction] : entrances.Links[entrance]) {
+				openEntrance(acrossNode, node, cost + GetAdjacentNodeCost(direction, snapshot.AdjacentCosts[node][direction], solve.DigStrength));
+			}
+		}
+		if (!foundEnd) {
+			return false;
+		}
+		std::vector<int> abstractPath = { solve.EndNode };
+		for (int node = bestCosts[endState].second; node != startState; node = bestCosts[node].second) {
+			abstractPath.push_back(node);
+		}
+		abstractPath.push_back(solve.StartNode);
+		std::reverse(abstractPath.begin(), abstractPath.end());
+
+		// Refine the path node by node through the first few clusters, the rest is left as entrances until the Actor gets closer and asks again
+		solve.NodePath.assign(1, solve.StartNode);
+		solve.UnrefinedNodeCount = 0;
+		int refinedClusterCount = 0;
+		std::vector<float> legNodeCosts;
+		std::vector<int> legPreviousNodes;
+		std::vector<int> legNodes;
+		for (size_t pathIndex = 1; pathIndex < abstractPath.size(); ++pathIndex) {
+			int fromNode = abstractPath[pathIndex - 1];
+			int toNode = abstractPath[pathIndex];
+			int cluster = GetClusterIndex(snapshot, fromNode);
+			if (fromNode == toNode) {
+				continue;
+			} else if (refinedClusterCount >= c_RefinedClusterCount) {
+				solve.NodePath.push_back(toNode);
+				solve.UnrefinedNodeCount++;
+				continue;
+			} else if (GetClusterIndex(snapshot, toNode) != cluster) {
+				// Crossing into the next cluster is a single step
+				solve.NodePath.push_back(toNode);
+				continue;
+			}
+			legNodes.clear();
+			if (pathIndex == abstractPath.size() - 1) {
+				// The reverse search from the end already knows the way there from anywhere in the end cluster
+				for (int node = endNextNodes[GetIndexInCluster(snapshot, cluster, fromNode)]; node >= 0; node = (node == toNode) ? -1 : endNextNodes[GetIndexInCluster(snapshot, cluster, node)]) {
+					legNodes.push_back(node);
+				}
+			} else {
+				// The search from the start already knows the way out of the start cluster, anywhere else needs a search of its own
+				const std::vector<int> *previousNodes = &startPreviousNodes;
+				if (pathIndex > 1) {
+					SearchCluster(snapshot, cluster, fromNode, toNode, solve.DigStrength, false, legNodeCosts, legPreviousNodes);
+					previousNodes = &legPreviousNodes;
+				}
+				for (int node = toNode; node != fromNode && node >= 0; node = (*previousNodes)[GetIndexInCluster(snapshot, cluster, node)]) {
+					legNodes.push_back(node);
+				}
+				std::reverse(legNodes.begin(), legNodes.end());
+			}
+			solve.NodePath.insert(solve.NodePath.end(), legNodes.begin(), legNodes.end());
+			refinedClusterCount++;
+		}
+		solve.TotalCost = bestCosts[endState].first;
+		solve.Result = MicroPather::SOLVED;
+		return true;
+	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "Box.h"
 #include "Scene.h"
+#include "ThreadMan.h"
 #include "System/MicroPather/micropather.h"
 
 using namespace micropather;
@@ -56,6 +57,8 @@ namespace RTE {
 
 	public:
 
+		static constexpr int c_NoPathRequestTicket = 0; //!< Ticket value that never refers to a path request, for marking that nothing is being waited on.
+
 #pragma region Creation
 		/// <summary>
 		/// Constructor method used to instantiate a PathFinder object.
@@ -136,6 +139,63 @@ namespace RTE {
 		void AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) override;
 #pragma endregion
 
+#pragma region Asynchronous PathFinding
+		/// <summary>
+		/// Queues a path to be solved on the worker threads. Requests are only handed to the workers by DispatchPathRequests, and their results can be picked up with GetPathRequestResult on a later update.
+		/// </summary>
+		/// <param name="team">The team the path is for. Requests are dispatched per team, since each team's own doors don't block it.</param>
+		/// <param name="start">Start position on the scene to find the path from.</param>
+		/// <param name="end">End position on the scene to find the path to.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <returns>The ticket to pick the result up with. Never c_NoPathRequestTicket.</returns>
+		int SubmitPathRequest(int team, Vector start, Vector end, float digStrength = 1);
+
+		/// <summary>
+		/// Gets whether a path request is still queued or being solved.
+		/// </summary>
+		/// <param name="ticket">The ticket of the path request.</param>
+		/// <returns>Whether the path request is still waiting for its result.</returns>
+		bool IsPathRequestPending(int ticket) const { return m_PendingPathRequestTickets.find(ticket) != m_PendingPathRequestTickets.end(); }
+
+		/// <summary>
+		/// Picks up the result of a completed path request. The result is handed over only once, after which the ticket is forgotten.
+		/// </summary>
+		/// <param name="ticket">The ticket of the path request.</param>
+		/// <param name="pathResult">A list which will be filled out with waypoints between the start and end, same as with CalculatePath.</param>
+		/// <param name="totalCostResult">The total minimum difficulty cost calculated between the two points on the scene.</param>
+		/// <param name="unrefinedWaypointCountResult">
+		/// How many waypoints at the end of the path are only cluster entrances, which a long path is left as past the first few clusters.
+		/// These are in the right order, but far apart and not worked out node by node, so the path should be requested again before getting to them.
+		/// </param>
+		/// <returns>Whether a result was available. False if the request is still pending, or the ticket is unknown or was cancelled.</returns>
+		bool GetPathRequestResult(int ticket, std::list<Vector> &pathResult, float &totalCostResult, int &unrefinedWaypointCountResult);
+
+		/// <summary>
+		/// Forgets about a path request. Its result, if it's still being solved, will be thrown away once done.
+		/// </summary>
+		/// <param name="ticket">The ticket of the path request.</param>
+		void CancelPathRequest(int ticket) { m_PendingPathRequestTickets.erase(ticket); m_CompletedPathRequests.erase(ticket); }
+
+		/// <summary>
+		/// Gets the teams that have path requests queued up that haven't been dispatched yet.
+		/// </summary>
+		/// <param name="teams">Vector to be filled with the teams that have queued path requests, each only once.</param>
+		void GetTeamsWithQueuedPathRequests(std::vector<int> &teams) const;
+
+		/// <summary>
+		/// Takes a snapshot of the current node costs and hands all of a team's queued path requests to the worker threads to be solved against it.
+		/// Requests that start and end in the same nodes with the same dig strength are only solved once.
+		/// Requests that span several clusters are solved over the cluster entrances, and only refined node by node for the first few clusters. Clusters whose costs changed are brought up to date first.
+		/// </summary>
+		/// <param name="team">The team whose queued path requests to dispatch.</param>
+		void DispatchPathRequests(int team);
+
+		/// <summary>
+		/// Picks up the solutions of all path request batches the workers have finished, so their results can be retrieved with GetPathRequestResult. Never blocks on unfinished batches.
+		/// </summary>
+		void CollectPathRequests();
+#pragma endregion
+
 #pragma region Misc
 		/// <summary>
 		/// Implementation of the abstract interface of Graph. This function is only used in DEBUG mode - it dumps output to stdout.
@@ -147,12 +207,161 @@ namespace RTE {
 
 	protected:
 
+		static constexpr int c_ClusterSize = 16; //!< The width and height of each cluster of the hierarchical path graph, in nodes.
+		static constexpr int c_EntranceSpan = 8; //!< The most nodes along a border between two clusters that share a single entrance.
+		static constexpr int c_MinHierarchicalClusterDistance = 2; //!< How many clusters apart the start and end of a path need to be for it to be solved over the cluster entrances instead of the whole node grid.
+		static constexpr int c_RefinedClusterCount = 2; //!< How many clusters along a hierarchical path get refined node by node. The rest of the path is left as cluster entrances.
+		static constexpr int c_MaxCachedDigStrengths = 8; //!< The most dig strengths to keep cluster costs around for.
+
 		MicroPather *m_Pather; //!< The actual pathing object that does the pathfinding work. Owned.
-		std::vector<std::vector<PathNode *>> m_NodeGrid;  //!< The array of PathNodes representing the grid on the scene. The nodes are owned by this.
+		std::vector<PathNode> m_NodeGrid; //!< The PathNodes representing the grid on the scene, column by column in one contiguous block. Never resized after creation, so pointers to nodes stay valid.
+		int m_GridWidth; //!< The number of node columns in the grid.
+		int m_GridHeight; //!< The number of node rows in the grid.
 		unsigned int m_NodeDimension; //!< The width and height of each node, in pixels on the scene.
 
 		float m_DigStrength; //!< What material strength the search is capable of digging through.
 
+		/// <summary>
+		/// A copy of all the node costs at one point in time, for solving paths on the worker threads while the live costs keep changing.
+		/// </summary>
+		struct PathCostSnapshot {
+			int SceneWidth; //!< The width of the scene when the snapshot was taken, for wrapping distances.
+			int SceneHeight; //!< The height of the scene when the snapshot was taken, for wrapping distances.
+			bool WrapsX; //!< Whether the scene wraps horizontally.
+			bool WrapsY; //!< Whether the scene wraps vertically.
+			int GridWidth; //!< The number of node columns.
+			int GridHeight; //!< The number of node rows.
+			int ClusterColumns; //!< The number of cluster columns.
+			int ClusterRows; //!< The number of cluster rows.
+			std::shared_ptr<const std::vector<Vector>> NodePositions; //!< The position of each node, indexed the same as the node grid flattened column by column. Shared between snapshots since it never changes.
+			std::shared_ptr<const std::vector<std::array<int, 8>>> AdjacentNodes; //!< The indices of the adjacent nodes of each node in the order Up, Right, Down, Left, UpRight, RightDown, DownLeft, LeftUp, or -1 where there is none. Shared between snapshots.
+			std::vector<std::array<float, 8>> AdjacentCosts; //!< The cost to each adjacent node of each node, in the same order as AdjacentNodes.
+		};
+
+		/// <summary>
+		/// A Graph over a PathCostSnapshot with a fixed dig strength, so each worker can run its own MicroPather on it.
+		/// </summary>
+		class PathCostSnapshotGraph : public Graph {
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to instantiate a PathCostSnapshotGraph object.
+			/// </summary>
+			/// <param name="snapshot">The snapshot to search. Ownership is NOT transferred!</param>
+			explicit PathCostSnapshotGraph(const PathCostSnapshot &snapshot) : m_Snapshot(snapshot), m_DigStrength(1) {}
+
+			/// <summary>
+			/// Sets the dig strength the adjacency costs are calculated with. The MicroPather using this needs to be reset after changing it.
+			/// </summary>
+			/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+			void SetDigStrength(float digStrength) { m_DigStrength = digStrength; }
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Same as PathFinder::LeastCostEstimate, but on the snapshot.
+			/// </summary>
+			float LeastCostEstimate(void *startState, void *endState) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Same as PathFinder::AdjacentCost, but on the snapshot.
+			/// </summary>
+			void AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Not used.
+			/// </summary>
+			void PrintStateInfo(void *state) override {}
+
+		private:
+
+			const PathCostSnapshot &m_Snapshot; //!< The snapshot being searched.
+			float m_DigStrength; //!< What material strength the search is capable of digging through.
+		};
+
+		/// <summary>
+		/// The entrances of one cluster of the hierarchical path graph, i.e. the nodes on its borders that paths cross into neighbouring clusters through.
+		/// </summary>
+		struct ClusterEntrances {
+			std::vector<int> Nodes; //!< The indices of the entrance nodes.
+			std::vector<std::vector<std::pair<int, int>>> Links; //!< For each entrance node, the entrance nodes of neighbouring clusters it leads to, and the direction each of those is in.
+		};
+
+		/// <summary>
+		/// The costs of going between the entrances of every cluster, for one dig strength.
+		/// </summary>
+		struct ClusterCostLayer {
+			std::vector<std::shared_ptr<const std::vector<float>>> Costs; //!< For each cluster, the costs from each of its entrances to each other, row by row. Replaced rather than changed, so batches can keep using old ones.
+			std::vector<char> Outdated; //!< For each cluster, whether its costs need to be worked out again before being used.
+			long long LastUsed; //!< The dispatch this layer was last used by, for throwing out the least recently used ones.
+		};
+
+		/// <summary>
+		/// A path request waiting to be dispatched.
+		/// </summary>
+		struct QueuedPathRequest {
+			int Ticket; //!< The ticket the request was given.
+			int Team; //!< The team the request is for.
+			Vector Start; //!< The exact start position of the path.
+			Vector End; //!< The exact end position of the path.
+			float DigStrength; //!< What material strength the search is capable of digging through.
+		};
+
+		/// <summary>
+		/// One distinct path to solve in a batch, shared by all the requests that coalesced into it.
+		/// </summary>
+		struct PathSolve {
+			int StartNode; //!< The index of the node to start from.
+			int EndNode; //!< The index of the node to end at.
+			float DigStrength; //!< What material strength the search is capable of digging through.
+			std::vector<int> NodePath; //!< The indices of the nodes along the solved path. Filled in by the workers.
+			float TotalCost; //!< The total cost of the solved path. Filled in by the workers.
+			int Result; //!< The MicroPather result of the solve. Filled in by the workers.
+			bool Hierarchical; //!< Whether this is solved over the cluster entrances instead of the whole node grid.
+			int UnrefinedNodeCount; //!< How many nodes at the end of NodePath are only cluster entrances. Filled in by the workers.
+		};
+
+		/// <summary>
+		/// All the path requests of one team handed to the workers at once, along with the snapshot they're solved against.
+		/// </summary>
+		struct PathRequestBatch {
+			PathCostSnapshot Snapshot; //!< The node costs the batch is solved against.
+			unsigned int PatherAllocate; //!< The block size each worker's MicroPather allocates its node cache from.
+			std::vector<PathSolve> Solves; //!< The distinct paths to solve, ordered by dig strength so workers rarely have to reset their pathers.
+			std::vector<std::pair<QueuedPathRequest, int>> Requests; //!< The requests in this batch and the index of the solve each one gets its result from.
+			std::vector<std::shared_ptr<const ClusterEntrances>> Clusters; //!< The entrances of every cluster at the time of dispatch, if any solve is hierarchical.
+			std::map<float, std::vector<std::shared_ptr<const std::vector<float>>>> ClusterCosts; //!< The costs between the entrances of every cluster for each dig strength of the hierarchical solves.
+			ThreadMan::JobHandle Job; //!< The job solving this batch.
+		};
+
+		/// <summary>
+		/// The result of a completed path request, waiting to be picked up.
+		/// </summary>
+		struct CompletedPathRequest {
+			std::list<Vector> Path; //!< The waypoints of the path, from the exact start to the exact end.
+			float TotalCost; //!< The total cost of the path.
+			int UnrefinedWaypointCount; //!< How many waypoints at the end of the path are only cluster entrances.
+		};
+
+		static int s_NextPathRequestTicket; //!< The ticket the next path request will be given. Shared by all PathFinders so tickets from a previous scene are never mistaken for new ones.
+
+		unsigned int m_PatherAllocate; //!< The block size the node cache of each MicroPather is allocated from.
+		std::shared_ptr<const std::vector<Vector>> m_SnapshotNodePositions; //!< The node positions handed to every snapshot.
+		std::shared_ptr<const std::vector<std::array<int, 8>>> m_SnapshotAdjacentNodes; //!< The node adjacency handed to every snapshot.
+
+		std::vector<QueuedPathRequest> m_QueuedPathRequests; //!< Path requests waiting to be dispatched.
+		std::vector<std::shared_ptr<PathRequestBatch>> m_PathRequestBatches; //!< Batches of path requests currently being solved by the workers.
+		std::unordered_set<int> m_PendingPathRequestTickets; //!< The tickets of all queued or dispatched path requests that haven't completed or been cancelled.
+		std::unordered_map<int, CompletedPathRequest> m_CompletedPathRequests; //!< The results of completed path requests that haven't been picked up yet.
+
+		int m_ClusterColumns; //!< The number of cluster columns.
+		int m_ClusterRows; //!< The number of cluster rows.
+		std::vector<std::vector<std::pair<int, int>>> m_RightBorderCrossings; //!< For each cluster, the entrances across its right border, as pairs of the node on this side and the node on the other.
+		std::vector<std::vector<std::pair<int, int>>> m_BottomBorderCrossings; //!< For each cluster, the entrances across its bottom border, as pairs of the node on this side and the node on the other.
+		std::vector<std::shared_ptr<const ClusterEntrances>> m_ClusterEntrances; //!< The entrances of each cluster. Replaced rather than changed, so batches can keep using old ones.
+		std::vector<char> m_ClusterChanged; //!< For each cluster, whether any of its node costs changed since the clusters were last brought up to date.
+		std::map<float, ClusterCostLayer> m_ClusterCostLayers; //!< The costs between cluster entrances for each recently used dig strength.
+		long long m_ClusterCostLayerUseCount; //!< The number of dispatches that have used cluster costs, for tracking which layers were used least recently.
+
 	private:
 
 #pragma region Path Cost Updates
@@ -181,6 +390,145 @@ namespace RTE {
 		void UpdateNodeCostsInBox(Box &box);
 #pragma endregion
 
+#pragma region Asynchronous PathFinding Helpers
+		/// <summary>
+		/// Gets the PathNode at a position in the node grid.
+		/// </summary>
+		/// <param name="x">The column of the node.</param>
+		/// <param name="y">The row of the node.</param>
+		/// <returns>The PathNode at that position.</returns>
+		PathNode * GetPathNode(int x, int y) { return &m_NodeGrid[x * m_GridHeight + y]; }
+
+		/// <summary>
+		/// Gets the cost of moving from a node to one of its adjacent nodes, given the strength of the material between them.
+		/// </summary>
+		/// <param name="direction">The direction of the adjacent node, in the order Up, Right, Down, Left, UpRight, RightDown, DownLeft, LeftUp.</param>
+		/// <param name="strength">The strength of the material between the nodes.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <returns>The cost of moving to the adjacent node.</returns>
+		static float GetAdjacentNodeCost(int direction, float strength, float digStrength);
+
+		/// <summary>
+		/// Gets the index of the node a scene position falls in, in the node grid flattened column by column. The position should already be within scene bounds.
+		/// </summary>
+		/// <param name="pos">The position to get the node of.</param>
+		/// <returns>The index of the node.</returns>
+		int GetNodeIndex(const Vector &pos) const;
+
+		/// <summary>
+		/// Copies the current node costs into a snapshot that can be searched while the live costs change.
+		/// </summary>
+		/// <param name="snapshot">The snapshot to fill out.</param>
+		void TakeCostSnapshot(PathCostSnapshot &snapshot);
+
+		/// <summary>
+		/// Solves a range of the distinct paths in a batch. Only touches the batch itself, so ranges can be solved on any thread.
+		/// </summary>
+		/// <param name="batch">The batch to solve paths of.</param>
+		/// <param name="solveStart">The first solve to do.</param>
+		/// <param name="solveEnd">One past the last solve to do.</param>
+		static void SolvePathRange(PathRequestBatch &batch, int solveStart, int solveEnd);
+
+		/// <summary>
+		/// Turns the nodes along a solved path into the waypoint list handed out to callers, replacing the first and last node with the exact start and end.
+		/// </summary>
+		/// <param name="start">The exact start position of the path.</param>
+		/// <param name="end">The exact end position of the path.</param>
+		/// <param name="nodePositions">The positions of the nodes along the path, in order. Can be empty if nothing was found.</param>
+		/// <param name="pathResult">The list to fill out with the waypoints. Cleared first.</param>
+		static void BuildPathResult(const Vector &start, const Vector &end, const std::vector<Vector> &nodePositions, std::list<Vector> &pathResult);
+#pragma endregion
+
+#pragma region Hierarchical PathFinding Helpers
+		/// <summary>
+		/// Gets the direction opposite to one of the eight adjacent node directions.
+		/// </summary>
+		/// <param name="direction">The direction, in the order Up, Right, Down, Left, UpRight, RightDown, DownLeft, LeftUp.</param>
+		/// <returns>The opposite direction.</returns>
+		static int GetOppositeDirection(int direction) { return (direction < 4) ? (direction + 2) % 4 : 4 + (direction - 2) % 4; }
+
+		/// <summary>
+		/// Gets the index of the cluster a node belongs to.
+		/// </summary>
+		/// <param name="snapshot">The snapshot the node is in.</param>
+		/// <param name="nodeIndex">The index of the node.</param>
+		/// <returns>The index of the cluster, row by row.</returns>
+		static int GetClusterIndex(const PathCostSnapshot &snapshot, int nodeIndex) { return ((nodeIndex % snapshot.GridHeight) / c_ClusterSize) * snapshot.ClusterColumns + (nodeIndex / snapshot.GridHeight) / c_ClusterSize; }
+
+		/// <summary>
+		/// Gets the node grid area a cluster covers.
+		/// </summary>
+		/// <param name="snapshot">The snapshot the cluster is in.</param>
+		/// <param name="clusterIndex">The index of the cluster.</param>
+		/// <returns>The first column, first row, last column and last row of the cluster, inclusive.</returns>
+		static std::array<int, 4> GetClusterBounds(const PathCostSnapshot &snapshot, int clusterIndex);
+
+		/// <summary>
+		/// Gets the index of a node within the cluster it belongs to, for indexing per-cluster search results.
+		/// </summary>
+		/// <param name="snapshot">The snapshot the node is in.</param>
+		/// <param name="clusterIndex">The index of the cluster the node belongs to.</param>
+		/// <param name="nodeIndex">The index of the node.</param>
+		/// <returns>The index of the node within the cluster, column by column.</returns>
+		static int GetIndexInCluster(const PathCostSnapshot &snapshot, int clusterIndex, int nodeIndex);
+
+		/// <summary>
+		/// Gets the least possible cost between two nodes of a snapshot, the same way LeastCostEstimate does.
+		/// </summary>
+		/// <param name="snapshot">The snapshot the nodes are in.</param>
+		/// <param name="startNode">The index of the node to start from.</param>
+		/// <param name="endNode">The index of the node to end at.</param>
+		/// <returns>The cost of the fastest possible way between the two nodes.</returns>
+		static float EstimateSnapshotCost(const PathCostSnapshot &snapshot, int startNode, int endNode);
+
+		/// <summary>
+		/// Finds the cheapest way from a node to every other node of its cluster, without leaving the cluster.
+		/// </summary>
+		/// <param name="snapshot">The snapshot to search.</param>
+		/// <param name="clusterIndex">The cluster to search in. The source node has to be in it.</param>
+		/// <param name="sourceNode">The node to search from.</param>
+		/// <param name="targetNode">A node to stop searching at once its cheapest cost is known, or -1 to search the whole cluster.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <param name="reverse">Whether to search for the costs from every node to the source node instead of the other way around.</param>
+		/// <param name="nodeCosts">Filled out with the cost of each node within the cluster, indexed by GetIndexInCluster. FLT_MAX where unreachable.</param>
+		/// <param name="nextNodes">Filled out with the node each node was reached from, or if reversed the node to go to next towards the source. -1 where there is none.</param>
+		static void SearchCluster(const PathCostSnapshot &snapshot, int clusterIndex, int sourceNode, int targetNode, float digStrength, bool reverse, std::vector<float> &nodeCosts, std::vector<int> &nextNodes);
+
+		/// <summary>
+		/// Picks the entrances across one border of a cluster, one per c_EntranceSpan nodes, at whichever crossing has the least material in the way.
+		/// </summary>
+		/// <param name="snapshot">The snapshot to pick entrances in.</param>
+		/// <param name="clusterIndex">The cluster whose border to pick entrances on.</param>
+		/// <param name="direction">The border to pick entrances on, either Right (1) or Down (2).</param>
+		/// <param name="crossings">Filled out with the picked entrances, as pairs of the node in this cluster and the node across the border.</param>
+		static void FindBorderCrossings(const PathCostSnapshot &snapshot, int clusterIndex, int direction, std::vector<std::pair<int, int>> &crossings);
+
+		/// <summary>
+		/// Works out the costs between every pair of entrances of a cluster.
+		/// </summary>
+		/// <param name="snapshot">The snapshot to work out costs in.</param>
+		/// <param name="clusterIndex">The cluster to work out costs of.</param>
+		/// <param name="entrances">The entrances of the cluster.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <returns>The costs from each entrance to each other, row by row.</returns>
+		static std::shared_ptr<const std::vector<float>> CalculateClusterCosts(const PathCostSnapshot &snapshot, int clusterIndex, const ClusterEntrances &entrances, float digStrength);
+
+		/// <summary>
+		/// Brings the cluster entrances and the costs between them for the given dig strengths up to date with a snapshot, redoing only the clusters whose costs changed since last time.
+		/// </summary>
+		/// <param name="snapshot">The snapshot of the current node costs.</param>
+		/// <param name="digStrengths">The dig strengths whose cluster costs are needed.</param>
+		void UpdateClusters(const PathCostSnapshot &snapshot, const std::set<float> &digStrengths);
+
+		/// <summary>
+		/// Solves a path over the cluster entrances of a batch, then refines the part of it in the first few clusters node by node. Only touches the batch itself, so it can be done on any thread.
+		/// </summary>
+		/// <param name="batch">The batch the solve is in.</param>
+		/// <param name="solve">The solve to do.</param>
+		/// <returns>Whether a path was found. If not, the solve should be done over the whole node grid instead.</returns>
+		static bool SolveHierarchical(const PathRequestBatch &batch, PathSolve &solve);
+#pragma endregion
+
 		/// <summary>
 		/// Clears all the member variables of this PathFinder, effectively resetting the members of this abstraction level only.
 		/// </summary>
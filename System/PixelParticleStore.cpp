@@ -0,0 +1,618 @@
+#include "PixelParticleStore.h"
+#include "MOPixel.h"
+#include "MOSRotating.h"
+#include "Atom.h"
+#include "SLTerrain.h"
+#include "MovableMan.h"
+#include "PresetMan.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::Clear() {
+		m_PosX.clear();
+		m_PosY.clear();
+		m_VelX.clear();
+		m_VelY.clear();
+		m_Mass.clear();
+		m_Sharpness.clear();
+		m_GlobalAccScalar.clear();
+		m_AirResistance.clear();
+		m_AirThreshold.clear();
+		m_MaterialID.clear();
+		m_Color.clear();
+		m_SpawnTick.clear();
+		m_Lifetime.clear();
+		m_RestTick.clear();
+		m_RestThreshold.clear();
+		m_VelOscillations.clear();
+		m_NumPenetrations.clear();
+		m_PrevError.clear();
+		m_ChangedDir.clear();
+		m_HitsMOs.clear();
+		m_Team.clear();
+		m_IgnoresTeamHits.clear();
+		m_MOToNotHit.clear();
+		m_MOIgnoreEndTick.clear();
+		m_DistanceTraveled.clear();
+		m_LethalRange.clear();
+		m_LethalSharpness.clear();
+		m_State.clear();
+		m_Preset.clear();
+		m_PresetCache.clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PixelParticleStore::IsEligible(const MovableObject *movableObject) {
+		const MOPixel *pixel = dynamic_cast<const MOPixel *>(movableObject);
+		if (!pixel || pixel->HasAnyScripts() || pixel->GetsHitByMOs() || pixel->IsMissionCritical() || pixel->IgnoreTerrain() || pixel->ProvidesPieMenuContext()) {
+			return false;
+		}
+		if (pixel->GetPinStrength() != 0 || pixel->GetScreenEffect() || pixel->m_RemoveOrphanTerrainRadius > 0 || !pixel->m_Forces.empty() || !pixel->m_ImpulseForces.empty()) {
+			return false;
+		}
+		const Atom *atom = pixel->GetAtom();
+		return atom && atom->GetTrailLength() == 0 && atom->GetOffset().IsZero();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::Add(const MOPixel &pixel) {
+		long long simTick = g_TimerMan.GetSimTickCount();
+		double ticksPerMS = static_cast<double>(g_TimerMan.GetTicksPerSecond()) * 0.001;
+		const Atom *atom = pixel.GetAtom();
+
+		m_PosX.emplace_back(pixel.GetPos().m_X);
+		m_PosY.emplace_back(pixel.GetPos().m_Y);
+		m_VelX.emplace_back(pixel.GetVel().m_X);
+		m_VelY.emplace_back(pixel.GetVel().m_Y);
+		m_Mass.emplace_back(pixel.GetMass());
+		m_Sharpness.emplace_back(pixel.GetSharpness());
+		m_GlobalAccScalar.emplace_back(pixel.GetGlobalAccScalar());
+		m_AirResistance.emplace_back(pixel.GetAirResistance());
+		m_AirThreshold.emplace_back(pixel.GetAirThreshold());
+		m_MaterialID.emplace_back(atom->GetMaterial()->GetIndex());
+		m_Color.emplace_back(pixel.GetColor().GetIndex());
+		m_SpawnTick.emplace_back(simTick - static_cast<long long>(pixel.m_AgeTimer.GetElapsedSimTimeMS() * ticksPerMS));
+		m_Lifetime.emplace_back(pixel.GetLifetime());
+		m_RestTick.emplace_back(simTick - static_cast<long long>(pixel.m_RestTimer.GetElapsedSimTimeMS() * ticksPerMS));
+		m_RestThreshold.emplace_back(pixel.GetRestThreshold());
+		m_VelOscillations.emplace_back(static_cast<unsigned char>(std::min(pixel.m_VelOscillations, 255)));
+		m_NumPenetrations.emplace_back(atom->GetNumPenetrations());
+		m_PrevError.emplace_back(0);
+		m_ChangedDir.emplace_back(1);
+		m_HitsMOs.emplace_back(pixel.HitsMOs());
+		m_Team.emplace_back(pixel.GetTeam());
+		m_IgnoresTeamHits.emplace_back(pixel.IgnoresTeamHits());
+		if (pixel.m_pMOToNotHit && !pixel.m_MOIgnoreTimer.IsPastSimTimeLimit()) {
+			double ignoreTimeLimit = pixel.m_MOIgnoreTimer.GetSimTimeLimitMS();
+			m_MOToNotHit.emplace_back(pixel.m_pMOToNotHit);
+			m_MOIgnoreEndTick.emplace_back(ignoreTimeLimit < 0 ? -1 : simTick + static_cast<long long>((ignoreTimeLimit - pixel.m_MOIgnoreTimer.GetElapsedSimTimeMS()) * ticksPerMS));
+		} else {
+			m_MOToNotHit.emplace_back(nullptr);
+			m_MOIgnoreEndTick.emplace_back(-1);
+		}
+		m_DistanceTraveled.emplace_back(pixel.m_DistanceTraveled);
+		m_LethalRange.emplace_back(pixel.m_LethalRange);
+		m_LethalSharpness.emplace_back(pixel.m_LethalSharpness);
+		m_State.emplace_back(pixel.m_ToSettle ? PixelState::ToSettle : PixelState::Flying);
+
+		std::pair<int, std::string> presetKey(pixel.GetModuleID(), pixel.GetPresetName());
+		auto cachedPreset = m_PresetCache.find(presetKey);
+		if (cachedPreset == m_PresetCache.end()) {
+			const MOPixel *preset = pixel.GetPresetName() == "None" ? nullptr : dynamic_cast<const MOPixel *>(g_PresetMan.GetEntityPreset(pixel.GetClassName(), pixel.GetPresetName(), pixel.GetModuleID()));
+			cachedPreset = m_PresetCache.try_emplace(presetKey, preset).first;
+		}
+		m_Preset.emplace_back(cachedPreset->second);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::PromoteAll(std::vector<MOPixel *> &promotedPixels) {
+		promotedPixels.reserve(promotedPixels.size() + m_PosX.size());
+		for (int index = 0; index < GetCount(); ++index) {
+			if (m_State[index] != PixelState::ToDelete) { promotedPixels.emplace_back(Promote(index)); }
+		}
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::PromoteMOHits(std::vector<MOPixel *> &promotedPixels) {
+		for (int index = 0; index < GetCount(); ++index) {
+			if (m_State[index] == PixelState::ToPromote) {
+				promotedPixels.emplace_back(Promote(index));
+				m_State[index] = PixelState::ToDelete;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOPixel * PixelParticleStore::Promote(int index) const {
+		long long simTick = g_TimerMan.GetSimTickCount();
+		double ticksPerMS = static_cast<double>(g_TimerMan.GetTicksPerSecond()) * 0.001;
+
+		Vector pos(m_PosX[index], m_PosY[index]);
+		Vector vel(m_VelX[index], m_VelY[index]);
+		MOPixel *pixel = nullptr;
+		if (m_Preset[index]) {
+			pixel = dynamic_cast<MOPixel *>(m_Preset[index]->Clone());
+			pixel->SetPos(pos);
+			pixel->SetVel(vel);
+			pixel->SetMass(m_Mass[index]);
+			pixel->SetColor(Color(m_Color[index]));
+			pixel->SetLifetime(m_Lifetime[index]);
+		} else {
+			pixel = new MOPixel(Color(m_Color[index]), m_Mass[index], pos, vel, new Atom(Vector(), m_MaterialID[index], nullptr), m_Lifetime[index]);
+		}
+		// Presets might have MO collisions that were only changed on this particular pixel, so make sure the promoted pixel behaves the same as it did in the store.
+		pixel->SetToHitMOs(m_HitsMOs[index]);
+		pixel->SetToGetHitByMOs(false);
+		pixel->SetTeam(m_Team[index]);
+		pixel->SetIgnoresTeamHits(m_IgnoresTeamHits[index]);
+		if (m_MOToNotHit[index] && (m_MOIgnoreEndTick[index] < 0 || m_MOIgnoreEndTick[index] > simTick)) {
+			pixel->SetWhichMOToNotHit(m_MOToNotHit[index], m_MOIgnoreEndTick[index] < 0 ? -1.0F : static_cast<float>(static_cast<double>(m_MOIgnoreEndTick[index] - simTick) / ticksPerMS * 0.001));
+		}
+		pixel->SetSharpness(m_Sharpness[index]);
+		pixel->SetGlobalAccScalar(m_GlobalAccScalar[index]);
+		pixel->SetAirResistance(m_AirResistance[index]);
+		pixel->SetAirThreshold(m_AirThreshold[index]);
+		pixel->SetRestThreshold(m_RestThreshold[index]);
+		pixel->SetAge(static_cast<double>(simTick - m_SpawnTick[index]) / ticksPerMS);
+		pixel->m_RestTimer.SetElapsedSimTimeMS(static_cast<double>(simTick - m_RestTick[index]) / ticksPerMS);
+		pixel->m_VelOscillations = m_VelOscillations[index];
+		pixel->m_ToSettle = m_State[index] == PixelState::ToSettle;
+		pixel->m_DistanceTraveled = m_DistanceTraveled[index];
+		pixel->m_LethalRange = m_LethalRange[index];
+		pixel->m_LethalSharpness = m_LethalSharpness[index];
+		return pixel;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PixelParticleStore::IsIgnoringMOHit(int index, MOID hitMOID) const {
+		const MovableObject *hitMO = g_MovableMan.GetMOFromID(hitMOID);
+		if (!hitMO) {
+			return false;
+		}
+		// Same MOIDs as MOPixel::Travel ignores, which are the ones of the MO to not hit and everything attached to it.
+		if (m_MOToNotHit[index] && (m_MOIgnoreEndTick[index] < 0 || m_MOIgnoreEndTick[index] >= g_TimerMan.GetSimTickCount())) {
+			for (const MovableObject *attachedTo = hitMO; attachedTo; attachedTo = attachedTo->GetParent()) {
+				if (attachedTo == m_MOToNotHit[index]) {
+					return true;
+				}
+			}
+		}
+		const MovableObject *hitRootMO = hitMO->GetRootParent();
+		return m_IgnoresTeamHits[index] && hitRootMO->IgnoresTeamHits() && hitRootMO->GetTeam() == m_Team[index];
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::Travel(int startIndex, int endIndex, TravelSet travelSet) {
+		const float deltaTime = g_TimerMan.GetDeltaTimeSecs();
+		const Vector globalAcc = g_SceneMan.GetGlobalAcc();
+		const long long simTick = g_TimerMan.GetSimTickCount();
+		const double ticksPerMS = static_cast<double>(g_TimerMan.GetTicksPerSecond()) * 0.001;
+
+		for (int index = startIndex; index < endIndex; ++index) {
+			if (m_State[index] == PixelState::ToDelete || (travelSet == TravelSet::HittingMOs && !m_HitsMOs[index]) || (travelSet == TravelSet::NotHittingMOs && m_HitsMOs[index])) {
+				continue;
+			}
+
+			// Apply forces, same as MovableObject::ApplyForces minus the force list which eligible pixels never have.
+			m_VelX[index] += globalAcc.m_X * m_GlobalAccScalar[index] * deltaTime;
+			m_VelY[index] += globalAcc.m_Y * m_GlobalAccScalar[index] * deltaTime;
+			if (m_AirResistance[index] > 0 && std::max(std::abs(m_VelX[index]), std::abs(m_VelY[index])) >= m_AirThreshold[index]) {
+				float airFactor = 1.0F - (m_AirResistance[index] * deltaTime);
+				m_VelX[index] *= airFactor;
+				m_VelY[index] *= airFactor;
+			}
+
+			const float prevPosX = m_PosX[index];
+			const float prevPosY = m_PosY[index];
+			const float prevVelX = m_VelX[index];
+			const float prevVelY = m_VelY[index];
+
+			if (std::max(std::abs(m_VelX[index]), std::abs(m_VelY[index])) <= 500.0F) { TravelPixel(index, deltaTime); }
+
+			// Pixels that ran into an MO are done here, the rest of their update happens once they've been promoted.
+			if (m_State[index] == PixelState::ToDelete || m_State[index] == PixelState::ToPromote) {
+				continue;
+			}
+
+			// Post travel, same as MovableObject::PostTravel.
+			if (m_Lifetime[index] && static_cast<double>(simTick - m_SpawnTick[index]) / ticksPerMS > static_cast<double>(m_Lifetime[index])) {
+				m_State[index] = PixelState::ToDelete;
+				continue;
+			}
+			if (!g_SceneMan.IsWithinBounds(static_cast<int>(m_PosX[index]), static_cast<int>(m_PosY[index]), 100)) {
+				m_State[index] = PixelState::ToDelete;
+				continue;
+			}
+			if (std::max(std::abs(m_VelX[index]), std::abs(m_VelY[index])) > 500.0F) {
+				Vector fixedVel(m_VelX[index], m_VelY[index]);
+				fixedVel.SetMagnitude(450.0F);
+				m_VelX[index] = fixedVel.m_X;
+				m_VelY[index] = fixedVel.m_Y;
+			}
+
+			// Rest detection, same as MOPixel::RestDetection followed by the settle check in MovableMan::Update.
+			if (m_VelX[index] * prevVelX + m_VelY[index] * prevVelY < 0) {
+				if (m_VelOscillations[index] >= 2 && m_RestThreshold[index] >= 0) {
+					m_State[index] = PixelState::ToSettle;
+				} else {
+					++m_VelOscillations[index];
+				}
+			} else {
+				m_VelOscillations[index] = 0;
+			}
+			if (std::abs(m_PosX[index] - prevPosX) >= 1.0F || std::abs(m_PosY[index] - prevPosY) >= 1.0F) { m_RestTick[index] = simTick; }
+
+			bool atRest = m_RestThreshold[index] >= 0 && static_cast<double>(simTick - m_RestTick[index]) / ticksPerMS > static_cast<double>(m_RestThreshold[index]);
+			if ((m_State[index] == PixelState::ToSettle || atRest) && g_SceneMan.OverAltitude(Vector(m_PosX[index], m_PosY[index]), 2, 0)) {
+				m_RestTick[index] = simTick;
+				m_State[index] = PixelState::Flying;
+				atRest = false;
+			}
+			if (atRest) { m_State[index] = PixelState::ToSettle; }
+
+			// Lethal range falloff, same as MOPixel::Update for a pixel without a trail.
+			if (m_HitsMOs[index] && m_Sharpness[index] > 0) {
+				m_DistanceTraveled[index] += std::max(std::abs(m_VelX[index]), std::abs(m_VelY[index])) * deltaTime;
+				if (m_DistanceTraveled[index] > m_LethalRange[index]) {
+					if (m_Sharpness[index] < m_LethalSharpness[index]) {
+						m_Sharpness[index] = std::max(m_Sharpness[index] * (1.0F - (20.0F * deltaTime)) - 0.1F, 0.0F);
+						if (m_LethalRange[index] > 0) {
+							float randomNum = RandomNum(0.0F, 0.5F);
+							int age = static_cast<int>(static_cast<double>(simTick - m_SpawnTick[index]) / ticksPerMS);
+							m_Lifetime[index] -= static_cast<unsigned long>(static_cast<float>(m_Lifetime[index] - age) * randomNum);
+							m_HitsMOs[index] = RandomNum() < 0.5F;
+						}
+					} else {
+						m_Sharpness[index] *= 1.0F - (10.0F * deltaTime);
+					}
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::TravelPixel(int index, float travelTime) {
+		Vector position(m_PosX[index], m_PosY[index]);
+		Vector velocity(m_VelX[index], m_VelY[index]);
+		const float mass = m_Mass[index];
+		const float sharpness = m_Sharpness[index];
+		const Material *material = g_SceneMan.GetMaterialFromID(m_MaterialID[index]);
+		int &numPenetrations = m_NumPenetrations[index];
+		const bool hitsMOs = m_HitsMOs[index];
+		MOID hitMOID = g_NoMOID;
+
+		int hitCount = 0;
+		int error = 0;
+		int dom = 0;
+		int sub = 0;
+		int domSteps = 0;
+		int subSteps = 0;
+
+		int intPos[2];
+		int hitPos[2];
+		int delta[2];
+		int delta2[2];
+		int increment[2];
+
+		float timeLeft = travelTime;
+		float segProgress = 0.0F;
+		float retardation;
+
+		bool hit[2] = { false, false };
+		bool sinkHit;
+		bool subStepped;
+		bool terminate = false;
+
+		const Material *hitMaterial = nullptr;
+		const Material *domMaterial = nullptr;
+		const Material *subMaterial = nullptr;
+		unsigned char hitMaterialID = 0;
+
+		Vector segTraj;
+		Vector hitAccel;
+
+		do {
+			intPos[X] = std::floor(position.m_X);
+			intPos[Y] = std::floor(position.m_Y);
+
+			segTraj = velocity * timeLeft * c_PPM;
+
+			delta[X] = std::floor(position.m_X + segTraj.m_X) - intPos[X];
+			delta[Y] = std::floor(position.m_Y + segTraj.m_Y) - intPos[Y];
+
+			hit[X] = false;
+			hit[Y] = false;
+			subSteps = 0;
+			subStepped = false;
+			sinkHit = false;
+			hitAccel.Reset();
+
+			if (delta[X] == 0 && delta[Y] == 0) {
+				break;
+			}
+
+			if (delta[X] < 0) {
+				increment[X] = -1;
+				delta[X] = -delta[X];
+			} else {
+				increment[X] = 1;
+			}
+			if (delta[Y] < 0) {
+				increment[Y] = -1;
+				delta[Y] = -delta[Y];
+			} else {
+				increment[Y] = 1;
+			}
+			delta2[X] = delta[X] << 1;
+			delta2[Y] = delta[Y] << 1;
+
+			if (delta[X] > delta[Y]) {
+				dom = X;
+				sub = Y;
+			} else {
+				dom = Y;
+				sub = X;
+			}
+
+			error = m_ChangedDir[index] ? delta2[sub] - delta[dom] : m_PrevError[index];
+
+			for (domSteps = 0; domSteps < delta[dom] && !(hit[X] || hit[Y]); ++domSteps) {
+				// Pixels can start out embedded in terrain if something large got copied over them.
+				if (domSteps == 0 && g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir) {
+					++hitCount;
+					hit[X] = hit[Y] = true;
+					if (g_SceneMan.TryPenetrate(intPos[X], intPos[Y], velocity * mass * sharpness, velocity, retardation, 0.5F, numPenetrations)) {
+						velocity += velocity * retardation;
+						continue;
+					} else {
+						velocity.SetXY(0, 0);
+						timeLeft = 0.0F;
+						break;
+					}
+				}
+
+				if (subStepped) { ++subSteps; }
+				subStepped = false;
+
+				intPos[dom] += increment[dom];
+				if (error >= 0) {
+					intPos[sub] += increment[sub];
+					subStepped = true;
+					error -= delta2[dom];
+				}
+				error += delta2[sub];
+
+				g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+
+				// Stop in front of any MO in the way and leave the actual collision to the promoted MOPixel, since that needs the full MO of both sides.
+				if (hitsMOs && (hitMOID = g_SceneMan.GetMOIDPixel(intPos[X], intPos[Y])) != g_NoMOID && !IsIgnoringMOHit(index, hitMOID)) {
+					intPos[dom] -= increment[dom];
+					if (subStepped) { intPos[sub] -= increment[sub]; }
+					g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+
+					m_PosX[index] = static_cast<float>(intPos[X]);
+					m_PosY[index] = static_cast<float>(intPos[Y]);
+					m_VelX[index] = velocity.m_X;
+					m_VelY[index] = velocity.m_Y;
+					m_State[index] = PixelState::ToPromote;
+					return;
+				}
+
+				if ((hitMaterialID = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]))) {
+					hitMaterial = g_SceneMan.GetMaterialFromID(hitMaterialID);
+					hitPos[X] = intPos[X];
+					hitPos[Y] = intPos[Y];
+					++hitCount;
+
+					if (hitMaterial->GetIndex() != g_MaterialOutOfBounds && g_SceneMan.TryPenetrate(intPos[X], intPos[Y], velocity * mass * sharpness, velocity, retardation, 0.65F, numPenetrations)) {
+						hit[dom] = hit[sub] = sinkHit = true;
+						++numPenetrations;
+						m_ChangedDir[index] = 0;
+						m_PrevError[index] = error;
+
+						hitAccel = velocity * retardation;
+					} else {
+						numPenetrations = 0;
+						m_ChangedDir[index] = 1;
+						m_PrevError[index] = error;
+
+						intPos[dom] -= increment[dom];
+						if (subStepped) { intPos[sub] -= increment[sub]; }
+						g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+
+						if (material->GetStickiness() >= RandomNum() && velocity.GetLargest() > 0.5F) {
+							ApplyToTerrain(index, intPos[X], intPos[Y]);
+							m_State[index] = PixelState::ToDelete;
+							terminate = hit[dom] = hit[sub] = true;
+							break;
+						}
+
+						if (delta[dom] && ((dom == X && g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y])) || (dom == Y && g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y])))) {
+							hit[dom] = true;
+							domMaterial = g_SceneMan.GetMaterialFromID((dom == X) ? g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y]) : g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y]));
+							hitAccel[dom] = -velocity[dom] - velocity[dom] * material->GetRestitution() * domMaterial->GetRestitution();
+						}
+						if (subStepped && delta[sub] && ((sub == X && g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y])) || (sub == Y && g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y])))) {
+							hit[sub] = true;
+							subMaterial = g_SceneMan.GetMaterialFromID((sub == X) ? g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y]) : g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y]));
+							hitAccel[sub] = -velocity[sub] - velocity[sub] * material->GetRestitution() * subMaterial->GetRestitution();
+						}
+
+						if (!hit[dom] && !hit[sub]) {
+							hit[dom] = true;
+							hitAccel[dom] = -velocity[dom] - velocity[dom] * material->GetRestitution() * hitMaterial->GetRestitution();
+							hit[sub] = true;
+							hitAccel[sub] = -velocity[sub] - velocity[sub] * material->GetRestitution() * hitMaterial->GetRestitution();
+						} else if (hit[dom] && !hit[sub]) {
+							hitAccel[sub] -= velocity[sub] * material->GetFriction() * domMaterial->GetFriction();
+						} else if (hit[sub] && !hit[dom]) {
+							hitAccel[dom] -= velocity[dom] * material->GetFriction() * subMaterial->GetFriction();
+						}
+					}
+				}
+
+				if (hit[X] || hit[Y]) {
+					segProgress = (static_cast<float>(domSteps + static_cast<int>(sinkHit)) < delta[dom]) ? (static_cast<float>(domSteps + static_cast<int>(sinkHit)) / std::fabs(static_cast<float>(segTraj[dom]))) : 1.0F;
+					timeLeft -= timeLeft * segProgress;
+
+					position[dom] += (domSteps + static_cast<int>(sinkHit)) * increment[dom];
+					if ((subSteps + static_cast<int>(subStepped && sinkHit)) < delta[sub]) {
+						position[sub] += (subSteps + static_cast<int>(subStepped && sinkHit)) * increment[sub];
+					} else {
+						position[sub] += segTraj[sub];
+					}
+					velocity += hitAccel;
+				}
+			}
+		} while ((hit[X] || hit[Y]) && hitCount < 100 && !terminate);
+
+		if (terminate) {
+			return;
+		}
+		if (!(hit[X] || hit[Y])) { position += segTraj; }
+		g_SceneMan.WrapPosition(position);
+
+		m_PosX[index] = position.m_X;
+		m_PosY[index] = position.m_Y;
+		m_VelX[index] = velocity.m_X;
+		m_VelY[index] = velocity.m_Y;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::ApplyToTerrain(int index, int posX, int posY) const {
+		unsigned char color = m_Color[index];
+		unsigned char settleMaterial = g_SceneMan.GetMaterialFromID(m_MaterialID[index])->GetSettleMaterial();
+
+		if (MovableMan::IsDeferringTravelCommands()) {
+			MovableMan::DeferTravelCommand([posX, posY, color, settleMaterial]() {
+				g_SceneMan.GetTerrain()->SetFGColorPixel(posX, posY, color);
+				g_SceneMan.RegisterTerrainChange(posX, posY, 1, 1, color, false);
+				g_SceneMan.GetTerrain()->SetMaterialPixel(posX, posY, settleMaterial);
+			});
+			return;
+		}
+		g_SceneMan.GetTerrain()->SetFGColorPixel(posX, posY, color);
+		g_SceneMan.RegisterTerrainChange(posX, posY, 1, 1, color, false);
+		g_SceneMan.GetTerrain()->SetMaterialPixel(posX, posY, settleMaterial);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::SettleAndRemoveDead(bool settlingEnabled) {
+		const SLTerrain *terrain = g_SceneMan.GetTerrain();
+		int keptCount = 0;
+
+		for (int index = 0; index < GetCount(); ++index) {
+			if (m_State[index] == PixelState::ToSettle && settlingEnabled) {
+				// Same piling as for regular particles in MovableMan::Update, so piles of pixels keep their shape.
+				const Material *material = g_SceneMan.GetMaterialFromID(m_MaterialID[index]);
+				Vector settlePos(m_PosX[index], m_PosY[index]);
+				const Material *terrMat = g_SceneMan.GetMaterialFromID(terrain->GetMaterialPixel(settlePos.GetFloorIntX(), settlePos.GetFloorIntY()));
+				int piling = material->GetPiling();
+				if (piling > 0) {
+					for (int s = 0; s < piling && (terrMat->GetIndex() == material->GetIndex() || terrMat->GetIndex() == material->GetSettleMaterial()); ++s) {
+						if ((piling - s) % 2 == 0) {
+							settlePos.m_Y -= 1.0F;
+						} else {
+							settlePos.m_X += (RandomNum() >= 0.5F ? 1.0F : -1.0F);
+						}
+						terrMat = g_SceneMan.GetMaterialFromID(terrain->GetMaterialPixel(settlePos.GetFloorIntX(), settlePos.GetFloorIntY()));
+					}
+				}
+				if (material->GetPriority() >= terrMat->GetPriority()) { ApplyToTerrain(index, settlePos.GetFloorIntX(), settlePos.GetFloorIntY()); }
+				continue;
+			}
+			if (m_State[index] == PixelState::ToDelete) {
+				continue;
+			}
+			if (keptCount != index) {
+				m_PosX[keptCount] = m_PosX[index];
+				m_PosY[keptCount] = m_PosY[index];
+				m_VelX[keptCount] = m_VelX[index];
+				m_VelY[keptCount] = m_VelY[index];
+				m_Mass[keptCount] = m_Mass[index];
+				m_Sharpness[keptCount] = m_Sharpness[index];
+				m_GlobalAccScalar[keptCount] = m_GlobalAccScalar[index];
+				m_AirResistance[keptCount] = m_AirResistance[index];
+				m_AirThreshold[keptCount] = m_AirThreshold[index];
+				m_MaterialID[keptCount] = m_MaterialID[index];
+				m_Color[keptCount] = m_Color[index];
+				m_SpawnTick[keptCount] = m_SpawnTick[index];
+				m_Lifetime[keptCount] = m_Lifetime[index];
+				m_RestTick[keptCount] = m_RestTick[index];
+				m_RestThreshold[keptCount] = m_RestThreshold[index];
+				m_VelOscillations[keptCount] = m_VelOscillations[index];
+				m_NumPenetrations[keptCount] = m_NumPenetrations[index];
+				m_PrevError[keptCount] = m_PrevError[index];
+				m_ChangedDir[keptCount] = m_ChangedDir[index];
+				m_HitsMOs[keptCount] = m_HitsMOs[index];
+				m_Team[keptCount] = m_Team[index];
+				m_IgnoresTeamHits[keptCount] = m_IgnoresTeamHits[index];
+				m_MOToNotHit[keptCount] = m_MOToNotHit[index];
+				m_MOIgnoreEndTick[keptCount] = m_MOIgnoreEndTick[index];
+				m_DistanceTraveled[keptCount] = m_DistanceTraveled[index];
+				m_LethalRange[keptCount] = m_LethalRange[index];
+				m_LethalSharpness[keptCount] = m_LethalSharpness[index];
+				m_State[keptCount] = m_State[index];
+				m_Preset[keptCount] = m_Preset[index];
+			}
+			++keptCount;
+		}
+
+		m_PosX.resize(keptCount);
+		m_PosY.resize(keptCount);
+		m_VelX.resize(keptCount);
+		m_VelY.resize(keptCount);
+		m_Mass.resize(keptCount);
+		m_Sharpness.resize(keptCount);
+		m_GlobalAccScalar.resize(keptCount);
+		m_AirResistance.resize(keptCount);
+		m_AirThreshold.resize(keptCount);
+		m_MaterialID.resize(keptCount);
+		m_Color.resize(keptCount);
+		m_SpawnTick.resize(keptCount);
+		m_Lifetime.resize(keptCount);
+		m_RestTick.resize(keptCount);
+		m_RestThreshold.resize(keptCount);
+		m_VelOscillations.resize(keptCount);
+		m_NumPenetrations.resize(keptCount);
+		m_PrevError.resize(keptCount);
+		m_ChangedDir.resize(keptCount);
+		m_HitsMOs.resize(keptCount);
+		m_Team.resize(keptCount);
+		m_IgnoresTeamHits.resize(keptCount);
+		m_MOToNotHit.resize(keptCount);
+		m_MOIgnoreEndTick.resize(keptCount);
+		m_DistanceTraveled.resize(keptCount);
+		m_LethalRange.resize(keptCount);
+		m_LethalSharpness.resize(keptCount);
+		m_State.resize(keptCount);
+		m_Preset.resize(keptCount);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PixelParticleStore::Draw(BITMAP *targetBitmap, const Vector &targetPos, bool drawMaterial) const {
+		const int targetX = static_cast<int>(targetPos.m_X);
+		const int targetY = static_cast<int>(targetPos.m_Y);
+
+		acquire_bitmap(targetBitmap);
+		for (int index = 0; index < GetCount(); ++index) {
+			unsigned char drawColor = drawMaterial ? g_SceneMan.GetMaterialFromID(m_MaterialID[index])->GetSettleMaterial() : m_Color[index];
+			putpixel(targetBitmap, static_cast<int>(std::floor(m_PosX[index])) - targetX, static_cast<int>(std::floor(m_PosY[index])) - targetY, drawColor);
+		}
+		release_bitmap(targetBitmap);
+	}
+}
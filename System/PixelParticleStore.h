@@ -0,0 +1,174 @@
+#ifndef _RTEPIXELPARTICLESTORE_
+#define _RTEPIXELPARTICLESTORE_
+
+#include "Vector.h"
+
+namespace RTE {
+
+	class MovableObject;
+	class MOPixel;
+
+	/// <summary>
+	/// A structure-of-arrays store for simple MOPixels. Keeps every piece of state a flying pixel needs in contiguous arrays so thousands of them can be traveled without chasing pointers.
+	/// Pixels in here are not MovableObjects, so they have no MOID, UniqueID or scripts. Pixels that hit MOs only check the MOID layer while in here, and are promoted back to full MOPixels as soon as they run into something so the collision itself is done by the regular code.
+	/// </summary>
+	class PixelParticleStore {
+
+	public:
+
+		/// <summary>
+		/// Which of the pixels in a range a call to Travel should handle.
+		/// </summary>
+		enum class TravelSet { All, HittingMOs, NotHittingMOs };
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a PixelParticleStore object in system memory.
+		/// </summary>
+		PixelParticleStore() { Clear(); }
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Removes all the pixels from this PixelParticleStore.
+		/// </summary>
+		void Reset() { Clear(); }
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the number of pixels currently in this PixelParticleStore.
+		/// </summary>
+		/// <returns>The number of pixels currently in this PixelParticleStore.</returns>
+		int GetCount() const { return static_cast<int>(m_PosX.size()); }
+
+		/// <summary>
+		/// Gets whether a MovableObject is a plain MOPixel that can be represented by this store without changing its behavior.
+		/// That means no scripts, not getting hit by MOs, no trail, no screen effect, no pinning, no terrain orphan removal and no pending forces. Hitting MOs is fine.
+		/// </summary>
+		/// <param name="movableObject">The MovableObject to check.</param>
+		/// <returns>Whether the MovableObject can be moved into this store.</returns>
+		static bool IsEligible(const MovableObject *movableObject);
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Copies the state of an eligible MOPixel into this store. The MOPixel itself is not touched and is still owned by the caller.
+		/// </summary>
+		/// <param name="pixel">The MOPixel to copy. Should have been checked with IsEligible first.</param>
+		void Add(const MOPixel &pixel);
+
+		/// <summary>
+		/// Creates full MOPixels for every pixel in this store and empties it. Used when the store gets disabled, so nothing that's flying gets lost.
+		/// </summary>
+		/// <param name="promotedPixels">The vector to add the newly created MOPixels to. Ownership IS transferred!</param>
+		void PromoteAll(std::vector<MOPixel *> &promotedPixels);
+
+		/// <summary>
+		/// Creates full MOPixels for every pixel that ran into an MO during travel and removes them from this store. The MOPixels are placed right in front of the MO they hit, so they collide with it on their next travel.
+		/// </summary>
+		/// <param name="promotedPixels">The vector to add the newly created MOPixels to. Ownership IS transferred!</param>
+		void PromoteMOHits(std::vector<MOPixel *> &promotedPixels);
+
+		/// <summary>
+		/// Applies forces to, travels, and does rest detection for the pixels in the range [startIndex, endIndex). Ranges can be traveled concurrently as long as they don't overlap and terrain side effects are deferred.
+		/// Pixels that hit MOs query the MOID layer, so they can only be traveled concurrently if those queries are thread safe, which they aren't with the MOID broadphase.
+		/// </summary>
+		/// <param name="startIndex">The first pixel to travel.</param>
+		/// <param name="endIndex">One past the last pixel to travel.</param>
+		/// <param name="travelSet">Which of the pixels in the range to travel. The others are left alone.</param>
+		void Travel(int startIndex, int endIndex, TravelSet travelSet = TravelSet::All);
+
+		/// <summary>
+		/// Copies every pixel that came to rest into the terrain and removes it, along with any pixels that expired during travel. Needs to be called after all ranges have been traveled for this sim update.
+		/// </summary>
+		/// <param name="settlingEnabled">Whether resting pixels should be settled. If not, they stay in the store.</param>
+		void SettleAndRemoveDead(bool settlingEnabled);
+
+		/// <summary>
+		/// Draws all the pixels in this store to a BITMAP of choice.
+		/// </summary>
+		/// <param name="targetBitmap">A pointer to a BITMAP to draw on.</param>
+		/// <param name="targetPos">The absolute position of the target bitmap's upper left corner in the Scene.</param>
+		/// <param name="drawMaterial">Whether to draw the pixels' settle materials instead of their colors.</param>
+		void Draw(BITMAP *targetBitmap, const Vector &targetPos, bool drawMaterial = false) const;
+#pragma endregion
+
+	protected:
+
+		/// <summary>
+		/// The lifecycle state of a pixel in the store.
+		/// </summary>
+		enum PixelState : unsigned char { Flying, ToSettle, ToPromote, ToDelete };
+
+		std::vector<float> m_PosX; //!< The X positions of the pixels, in pixels.
+		std::vector<float> m_PosY; //!< The Y positions of the pixels, in pixels.
+		std::vector<float> m_VelX; //!< The X velocities of the pixels, in m/s.
+		std::vector<float> m_VelY; //!< The Y velocities of the pixels, in m/s.
+		std::vector<float> m_Mass; //!< The masses of the pixels, in kg.
+		std::vector<float> m_Sharpness; //!< The sharpness of the pixels, used to scale their penetration impulse.
+		std::vector<float> m_GlobalAccScalar; //!< How much the global acceleration affects each pixel.
+		std::vector<float> m_AirResistance; //!< The air resistance of each pixel.
+		std::vector<float> m_AirThreshold; //!< The velocity each pixel needs to go faster than before air resistance applies.
+		std::vector<unsigned char> m_MaterialID; //!< The Material index of each pixel.
+		std::vector<unsigned char> m_Color; //!< The palette color index of each pixel.
+		std::vector<long long> m_SpawnTick; //!< The sim tick each pixel was created at, used for its age.
+		std::vector<unsigned long> m_Lifetime; //!< The lifetime of each pixel, in ms. 0 means unlimited.
+		std::vector<long long> m_RestTick; //!< The sim tick each pixel's rest timer was last reset at.
+		std::vector<int> m_RestThreshold; //!< How long each pixel needs to be still before it settles, in ms. Negative means it never settles.
+		std::vector<unsigned char> m_VelOscillations; //!< How many times in a row each pixel's velocity reversed direction.
+		std::vector<int> m_NumPenetrations; //!< The consecutive terrain penetrations of each pixel's Atom.
+		std::vector<int> m_PrevError; //!< The Bresenham error each pixel's trajectory ended at, to keep straight lines straight through penetrations.
+		std::vector<unsigned char> m_ChangedDir; //!< Whether each pixel's trajectory changed direction during its last travel.
+		std::vector<unsigned char> m_HitsMOs; //!< Whether each pixel hits MOs.
+		std::vector<int> m_Team; //!< The team each pixel belongs to.
+		std::vector<unsigned char> m_IgnoresTeamHits; //!< Whether each pixel passes through MOs of its own team that also ignore team hits.
+		std::vector<MovableObject *> m_MOToNotHit; //!< The MO each pixel was told not to hit, if any. Only compared against, never dereferenced, since it may have been deleted. The promoted MOPixel checks whether it's still valid. Not owned.
+		std::vector<long long> m_MOIgnoreEndTick; //!< The sim tick each pixel stops ignoring its MO to not hit at. Negative means never.
+		std::vector<float> m_DistanceTraveled; //!< An estimate of how far each pixel has traveled since its creation, in meters.
+		std::vector<float> m_LethalRange; //!< The distance in meters after which each pixel starts losing its sharpness and may stop hitting MOs.
+		std::vector<float> m_LethalSharpness; //!< The sharpness below which each pixel starts losing lifetime and may stop hitting MOs.
+		std::vector<PixelState> m_State; //!< The lifecycle state of each pixel.
+		std::vector<const MOPixel *> m_Preset; //!< The preset each pixel was created from, if any, so it can be promoted back with its original properties. Not owned.
+
+		std::map<std::pair<int, std::string>, const MOPixel *> m_PresetCache; //!< Presets looked up by module ID and PresetName, so adding pixels doesn't search PresetMan every time. Not owned.
+
+	private:
+
+		/// <summary>
+		/// Creates a full MOPixel with the state of a pixel in this store. The pixel itself is not removed.
+		/// </summary>
+		/// <param name="index">The index of the pixel to promote.</param>
+		/// <returns>The newly created MOPixel. Ownership IS transferred!</returns>
+		MOPixel * Promote(int index) const;
+
+		/// <summary>
+		/// Gets whether a pixel would pass through the MO that owns an MOID without hitting it, because it's still ignoring its MO to not hit or because both ignore hits from their own team.
+		/// </summary>
+		/// <param name="index">The index of the pixel to check.</param>
+		/// <param name="hitMOID">The MOID the pixel ran into.</param>
+		/// <returns>Whether the pixel ignores the MO.</returns>
+		bool IsIgnoringMOHit(int index, MOID hitMOID) const;
+
+		/// <summary>
+		/// Travels a single pixel through the terrain, stopping it in front of the first MO it runs into if it hits MOs. Mirrors Atom::Travel for a single unowned Atom with no offset or trail.
+		/// </summary>
+		/// <param name="index">The index of the pixel to travel.</param>
+		/// <param name="travelTime">The amount of time to travel for, in seconds.</param>
+		void TravelPixel(int index, float travelTime);
+
+		/// <summary>
+		/// Writes a pixel's color and settle material into the terrain.
+		/// </summary>
+		/// <param name="index">The index of the pixel to apply.</param>
+		/// <param name="posX">The X position to apply the pixel at.</param>
+		/// <param name="posY">The Y position to apply the pixel at.</param>
+		void ApplyToTerrain(int index, int posX, int posY) const;
+
+		/// <summary>
+		/// Clears all the member variables of this PixelParticleStore, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+	};
+}
+#endif
@@ -4,7 +4,14 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void ShowMessageBox(const std::string &message) { allegro_message(message.c_str()); }
+	void ShowMessageBox(const std::string &message) {
+		// There is no one to click a message box away on a headless server, so print it instead.
+		if (System::IsHeadless()) {
+			std::cerr << message << std::endl;
+			return;
+		}
+		allegro_message(message.c_str());
+	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3,18 +3,22 @@
 
 namespace RTE {
 
-	std::mt19937 g_RNG;
+	std::array<RandomStream, RandomStreams::RandomStreamCount> g_RandomStreams;
+	thread_local RandomStream *g_ThreadRandomStream = nullptr;
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void SeedRNG() {
-		// Pre-Seed generation
-		std::array<int, 624> seedData;
 		std::random_device randomDevice;
-		std::generate_n(seedData.data(), seedData.size(), std::ref(randomDevice));
+		SeedRNG((static_cast<uint64_t>(randomDevice()) << 32) | static_cast<uint64_t>(randomDevice()));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		std::seed_seq sequence(std::begin(seedData), std::end(seedData));
-		g_RNG.seed(sequence);
+	void SeedRNG(uint64_t seed) {
+		for (int stream = 0; stream < RandomStreams::RandomStreamCount; ++stream) {
+			g_RandomStreams[stream] = RandomStream(seed, static_cast<uint64_t>(stream));
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
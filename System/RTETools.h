@@ -5,12 +5,25 @@
 
 #include "RTEError.h"
 #include "Constants.h"
+#include "RandomStream.h"
 
 namespace RTE {
 
 	class Vector;
 
-	extern std::mt19937 g_RNG; //!< The random number generator used for all random functions.
+	/// <summary>
+	/// Enumeration for the independent random number streams. Randomness that doesn't affect the simulation draws from its own stream, so drawing, menus and audio can't change the outcome of a seeded sim.
+	/// </summary>
+	enum RandomStreams {
+		SimulationStream = 0,
+		EffectsStream,
+		InterfaceStream,
+		AudioStream,
+		RandomStreamCount
+	};
+
+	extern std::array<RandomStream, RandomStreams::RandomStreamCount> g_RandomStreams; //!< The random number streams of the main thread, all seeded together by SeedRNG.
+	extern thread_local RandomStream *g_ThreadRandomStream; //!< Random number stream that replaces the stream of g_RandomStreams the calling thread would use while set. JobPool sets each Job's own stream while executing it, so Jobs never race on g_RandomStreams.
 
 #pragma region Physics Constants Getters
 	/// <summary>
@@ -40,15 +53,60 @@ namespace RTE {
 
 #pragma region Random Numbers
 	/// <summary>
-	/// Seed the mt19937 random number generator. mt19937 is the standard mersenne_twister_engine.
+	/// Seeds every random number stream from a nondeterministic source.
 	/// </summary>
 	void SeedRNG();
 
 	/// <summary>
-	/// Seed the mt19937 random number generator. mt19937 is the standard mersenne_twister_engine.
+	/// Seeds every random number stream from a single seed. Each stream is derived from the seed independently, so the simulation stream only depends on the seed and not on how much the other streams were used.
+	/// </summary>
+	/// <param name="seed">Seed for the random number streams.</param>
+	void SeedRNG(uint64_t seed);
+
+	/// <summary>
+	/// Gets the random number stream the calling thread should use. This is the current stream of g_RandomStreams unless g_ThreadRandomStream was set on this thread.
+	/// </summary>
+	/// <returns>The random number stream the calling thread should use.</returns>
+	inline RandomStream & GetRNG() { return g_ThreadRandomStream ? *g_ThreadRandomStream : g_RandomStreams[RandomStreams::SimulationStream]; }
+
+	/// <summary>
+	/// Makes the calling thread draw its random numbers from one of the non-simulation streams for as long as it is alive. Used around drawing, menus and audio so they don't consume simulation randomness.
+	/// Does nothing on threads that already have their own stream set, since those are never the shared ones.
+	/// </summary>
+	class RandomStreamScope {
+
+	public:
+
+		/// <summary>
+		/// Constructor method used to switch the calling thread to a random number stream.
+		/// </summary>
+		/// <param name="stream">The stream to draw random numbers from.</param>
+		explicit RandomStreamScope(RandomStreams stream) : m_PreviousStream(g_ThreadRandomStream), m_Switched(!g_ThreadRandomStream) { if (m_Switched) { g_ThreadRandomStream = &g_RandomStreams[stream]; } }
+
+		/// <summary>
+		/// Destructor method used to switch the calling thread back to the stream it used before.
+		/// </summary>
+		~RandomStreamScope() { if (m_Switched) { g_ThreadRandomStream = m_PreviousStream; } }
+
+	private:
+
+		RandomStream *m_PreviousStream; //!< The stream the calling thread used before this scope.
+		bool m_Switched; //!< Whether this scope switched the stream, and so has to switch it back.
+
+		// Disallow the use of some implicit methods.
+		RandomStreamScope(const RandomStreamScope &reference) = delete;
+		RandomStreamScope & operator=(const RandomStreamScope &rhs) = delete;
+	};
+
+	/// <summary>
+	/// Fills an array with uniformly distributed random numbers in the range [min, max] from the calling thread's stream in one go. Much cheaper than calling RandomNum for each number when generating many at once.
 	/// </summary>
-	/// <param name="seed">Seed for the random number generator.</param>
-	inline void SeedRNG(unsigned int seed) { g_RNG.seed(seed); }
+	/// <param name="numbers">The array to fill.</param>
+	/// <param name="count">The number of elements to fill.</param>
+	/// <param name="min">Lower boundary of the range to pick numbers from.</param>
+	/// <param name="max">Upper boundary of the range to pick numbers from.</param>
+	template <typename floatType>
+	void RandomNums(floatType *numbers, size_t count, floatType min, floatType max) { GetRNG().FillUniform(numbers, count, min, std::nextafter(max, std::numeric_limits<floatType>::max())); }
 
 	/// <summary>
 	/// Function template which returns a uniformly distributed random number in the range [-1, 1].
@@ -56,7 +114,7 @@ namespace RTE {
 	/// <returns>Uniformly distributed random number in the range [-1, 1].</returns>
 	template <typename floatType = float>
 	typename std::enable_if<std::is_floating_point<floatType>::value, floatType>::type RandomNormalNum() {
-		return std::uniform_real_distribution<floatType>(floatType(-1.0), std::nextafter(floatType(1.0), std::numeric_limits<floatType>::max()))(g_RNG);
+		return std::uniform_real_distribution<floatType>(floatType(-1.0), std::nextafter(floatType(1.0), std::numeric_limits<floatType>::max()))(GetRNG());
 	}
 
 	/// <summary>
@@ -65,7 +123,7 @@ namespace RTE {
 	/// <returns>Uniformly distributed random number in the range [-1, 1].</returns>
 	template <typename intType>
 	typename std::enable_if<std::is_integral<intType>::value, intType>::type RandomNormalNum() {
-		return std::uniform_int_distribution<intType>(intType(-1), intType(1))(g_RNG);
+		return std::uniform_int_distribution<intType>(intType(-1), intType(1))(GetRNG());
 	}
 
 	/// <summary>
@@ -74,7 +132,7 @@ namespace RTE {
 	/// <returns>Uniformly distributed random number in the range [0, 1].</returns>
 	template <typename floatType = float>
 	typename std::enable_if<std::is_floating_point<floatType>::value, floatType>::type RandomNum() {
-		return std::uniform_real_distribution<floatType>(floatType(0.0), std::nextafter(floatType(1.0), std::numeric_limits<floatType>::max()))(g_RNG);
+		return std::uniform_real_distribution<floatType>(floatType(0.0), std::nextafter(floatType(1.0), std::numeric_limits<floatType>::max()))(GetRNG());
 	}
 
 	/// <summary>
@@ -83,7 +141,7 @@ namespace RTE {
 	/// <returns>Uniformly distributed random number in the range [0, 1].</returns>
 	template <typename intType>
 	typename std::enable_if<std::is_integral<intType>::value, intType>::type RandomNum() {
-		return std::uniform_int_distribution<intType>(intType(0), intType(1))(g_RNG);
+		return std::uniform_int_distribution<intType>(intType(0), intType(1))(GetRNG());
 	}
 
 	/// <summary>
@@ -95,7 +153,7 @@ namespace RTE {
 	template <typename floatType = float>
 	typename std::enable_if<std::is_floating_point<floatType>::value, floatType>::type RandomNum(floatType min, floatType max) {
 		if (max < min) { std::swap(min, max); }
-		return (std::uniform_real_distribution<floatType>(floatType(0.0), std::nextafter(max - min, std::numeric_limits<floatType>::max()))(g_RNG) + min);
+		return (std::uniform_real_distribution<floatType>(floatType(0.0), std::nextafter(max - min, std::numeric_limits<floatType>::max()))(GetRNG()) + min);
 	}
 
 	/// <summary>
@@ -107,7 +165,7 @@ namespace RTE {
 	template <typename intType>
 	typename std::enable_if<std::is_integral<intType>::value, intType>::type RandomNum(intType min, intType max) {
 		if (max < min) { std::swap(min, max); }
-		return (std::uniform_int_distribution<intType>(intType(0), max - min)(g_RNG) + min);
+		return (std::uniform_int_distribution<intType>(intType(0), max - min)(GetRNG()) + min);
 	}
 #pragma endregion
 
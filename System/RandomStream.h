@@ -0,0 +1,133 @@
+#ifndef _RTERANDOMSTREAM_
+#define _RTERANDOMSTREAM_
+
+namespace RTE {
+
+	/// <summary>
+	/// A counter-based random number generator. Each number is a hash of the stream's key and how many numbers were drawn before it, so streams are tiny, can be split into independent child streams for free, and batches of numbers can be generated without any dependency between them.
+	/// Meets the UniformRandomBitGenerator requirements, so it can be used with the standard distributions.
+	/// </summary>
+	class RandomStream {
+
+	public:
+
+		using result_type = uint64_t; //!< The type of the numbers this RandomStream generates, as required by UniformRandomBitGenerator.
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a RandomStream object in system memory. Seed() should be called before using the object, or every default constructed stream generates the same numbers.
+		/// </summary>
+		RandomStream() { Clear(); }
+
+		/// <summary>
+		/// Constructor method used to instantiate a RandomStream object in system memory and seed it.
+		/// </summary>
+		/// <param name="seed">The seed for this RandomStream.</param>
+		explicit RandomStream(uint64_t seed) { Seed(seed); }
+
+		/// <summary>
+		/// Constructor method used to instantiate a RandomStream that is independent of, but fully determined by, a key and a stream index. Used to give each subsystem or chunk of parallel work its own stream.
+		/// </summary>
+		/// <param name="key">The key to derive the stream from, usually a number drawn from a parent stream.</param>
+		/// <param name="streamIndex">The index of this stream among the streams derived from the same key.</param>
+		RandomStream(uint64_t key, uint64_t streamIndex) { Seed(key ^ Hash(streamIndex + c_Increment)); }
+
+		/// <summary>
+		/// Restarts this RandomStream from a seed.
+		/// </summary>
+		/// <param name="seed">The seed for this RandomStream.</param>
+		void Seed(uint64_t seed) { m_Key = Hash(seed); m_Counter = 0; m_ChildKeyCount = 0; }
+#pragma endregion
+
+#pragma region Child Streams
+		/// <summary>
+		/// Gets a new key to derive child streams from through the key and stream index constructor. Doesn't draw any numbers from this RandomStream, so how many children get derived doesn't change the numbers it generates.
+		/// </summary>
+		/// <returns>A key that only depends on this RandomStream's seed and the number of child keys taken from it before.</returns>
+		uint64_t NextChildKey() { return Hash(m_Key ^ Hash(++m_ChildKeyCount * c_Increment)); }
+#pragma endregion
+
+#pragma region UniformRandomBitGenerator
+		/// <summary>
+		/// Gets the smallest number this RandomStream can generate.
+		/// </summary>
+		/// <returns>The smallest number this RandomStream can generate.</returns>
+		static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+
+		/// <summary>
+		/// Gets the largest number this RandomStream can generate.
+		/// </summary>
+		/// <returns>The largest number this RandomStream can generate.</returns>
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		/// <summary>
+		/// Generates the next number in this RandomStream.
+		/// </summary>
+		/// <returns>A uniformly distributed number in the range [min(), max()].</returns>
+		result_type operator()() { return Generate(m_Counter++); }
+#pragma endregion
+
+#pragma region Batch Generation
+		/// <summary>
+		/// Fills an array with uniformly distributed floating point numbers in the range [min, max). Advances this RandomStream exactly as far as drawing the numbers one by one would, but every number is computed independently, so the loop vectorizes.
+		/// </summary>
+		/// <param name="numbers">The array to fill.</param>
+		/// <param name="count">The number of elements to fill.</param>
+		/// <param name="min">Lower boundary of the range to pick numbers from.</param>
+		/// <param name="max">Upper boundary of the range to pick numbers from.</param>
+		template <typename floatType>
+		void FillUniform(floatType *numbers, size_t count, floatType min, floatType max) {
+			static_assert(std::is_floating_point<floatType>::value, "RandomStream::FillUniform only generates floating point numbers!");
+			floatType range = max - min;
+			for (size_t i = 0; i < count; ++i) {
+				numbers[i] = min + range * ToUnitInterval<floatType>(Generate(m_Counter + i));
+			}
+			m_Counter += count;
+		}
+#pragma endregion
+
+	private:
+
+		static constexpr uint64_t c_Increment = 0x9E3779B97F4A7C15; //!< The golden ratio increment SplitMix64 walks its state by. Being odd, every counter value maps to a different hash input.
+
+		uint64_t m_Key; //!< The hashed seed of this RandomStream. Streams with different keys are independent.
+		uint64_t m_Counter; //!< The number of numbers drawn from this RandomStream since it was seeded.
+		uint64_t m_ChildKeyCount; //!< The number of child keys taken from this RandomStream since it was seeded.
+
+		/// <summary>
+		/// The SplitMix64 finalizer. Turns consecutive inputs into statistically independent outputs.
+		/// </summary>
+		/// <param name="value">The value to hash.</param>
+		/// <returns>The hashed value.</returns>
+		static constexpr uint64_t Hash(uint64_t value) {
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+			return value ^ (value >> 31);
+		}
+
+		/// <summary>
+		/// Generates the number at a given position in this RandomStream without advancing it.
+		/// </summary>
+		/// <param name="index">The position of the number in this RandomStream.</param>
+		/// <returns>The number at that position.</returns>
+		result_type Generate(uint64_t index) const { return Hash(m_Key + (index + 1) * c_Increment); }
+
+		/// <summary>
+		/// Maps a generated number to the range [0, 1) using as many of its high bits as the floating point type has mantissa bits.
+		/// </summary>
+		/// <param name="value">The generated number.</param>
+		/// <returns>A uniformly distributed number in the range [0, 1).</returns>
+		template <typename floatType>
+		static floatType ToUnitInterval(uint64_t value) {
+			constexpr int mantissaBits = std::numeric_limits<floatType>::digits;
+			static_assert(mantissaBits < 64, "RandomStream can't fill the mantissa of floating point types wider than double!");
+			return static_cast<floatType>(value >> (64 - mantissaBits)) * (floatType(1.0) / static_cast<floatType>(uint64_t(1) << mantissaBits));
+		}
+
+		/// <summary>
+		/// Clears all the member variables of this RandomStream, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear() { m_Key = 0; m_Counter = 0; m_ChildKeyCount = 0; }
+	};
+}
+#endif
@@ -0,0 +1,119 @@
+#include "RotatedSpriteCache.h"
+#include "PerformanceMan.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void RotatedSpriteCache::Clear() {
+		m_Entries.clear();
+		m_EntryLookup.clear();
+		m_MemoryBudget = static_cast<size_t>(c_DefaultMemoryBudget) * c_BytesPerMegabyte;
+		m_MemoryUsage = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void RotatedSpriteCache::Destroy() {
+		EvictToBudget(0);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void RotatedSpriteCache::SetMemoryBudget(int newBudget) {
+		m_MemoryBudget = static_cast<size_t>(std::max(newBudget, 0)) * c_BytesPerMegabyte;
+		EvictToBudget(m_MemoryBudget);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const RotatedSpriteCache::CachedSprite * RotatedSpriteCache::GetRotatedSprite(BITMAP *sprite, int fillColor, int colorDepth, int pivotX, int pivotY, float allegroAngle, float scale, bool hFlipped) {
+		if (m_MemoryBudget == 0) {
+			return nullptr;
+		}
+		int angleStep = static_cast<int>(std::lround(allegroAngle * (static_cast<float>(c_AngleSteps) / 256.0F))) % c_AngleSteps;
+		if (angleStep < 0) { angleStep += c_AngleSteps; }
+		CacheKey key = { sprite, fillColor, colorDepth, pivotX, pivotY, angleStep, scale, hFlipped };
+
+		if (std::unordered_map<CacheKey, std::list<CacheEntry>::iterator, CacheKeyHash>::iterator lookupEntry = m_EntryLookup.find(key); lookupEntry != m_EntryLookup.end()) {
+			m_Entries.splice(m_Entries.begin(), m_Entries, lookupEntry->second);
+			g_PerformanceMan.RecordRotatedSpriteCacheAccess(true);
+			return &lookupEntry->second->Sprite;
+		}
+		g_PerformanceMan.RecordRotatedSpriteCacheAccess(false);
+
+		int pivotOffset = CalculatePivotOffset(key, sprite->w, sprite->h);
+		size_t size = static_cast<size_t>(pivotOffset * 2) * static_cast<size_t>(pivotOffset * 2) * static_cast<size_t>((colorDepth + 7) / 8);
+		// A single huge sprite shouldn't be able to flush everything else out of the cache.
+		if (size > m_MemoryBudget / 4) {
+			return nullptr;
+		}
+		EvictToBudget(m_MemoryBudget - size);
+
+		m_Entries.push_front({ key, RenderSprite(key, sprite, pivotOffset), size });
+		m_EntryLookup.try_emplace(key, m_Entries.begin());
+		m_MemoryUsage += size;
+		return &m_Entries.front().Sprite;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	size_t RotatedSpriteCache::CacheKeyHash::operator()(const CacheKey &key) const {
+		size_t hash = std::hash<const BITMAP *>()(key.Sprite);
+		for (size_t field : { static_cast<size_t>(key.FillColor), static_cast<size_t>(key.ColorDepth), static_cast<size_t>(key.PivotX), static_cast<size_t>(key.PivotY), static_cast<size_t>(key.AngleStep), std::hash<float>()(key.Scale), static_cast<size_t>(key.HFlipped) }) {
+			hash ^= field + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+		}
+		return hash;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int RotatedSpriteCache::CalculatePivotOffset(const CacheKey &key, int spriteWidth, int spriteHeight) {
+		int pivotX = key.HFlipped ? spriteWidth - key.PivotX : key.PivotX;
+		float farthestCornerX = static_cast<float>(std::max(std::abs(pivotX), std::abs(spriteWidth - pivotX)));
+		float farthestCornerY = static_cast<float>(std::max(std::abs(key.PivotY), std::abs(spriteHeight - key.PivotY)));
+		// Pad by a pixel so rounding in pivot_scaled_sprite never clips the edges.
+		return static_cast<int>(std::ceil(std::hypot(farthestCornerX, farthestCornerY) * key.Scale)) + 1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	RotatedSpriteCache::CachedSprite RotatedSpriteCache::RenderSprite(const CacheKey &key, BITMAP *sprite, int pivotOffset) {
+		BITMAP *sourceBitmap = sprite;
+		BITMAP *silhouetteBitmap = nullptr;
+		BITMAP *flipBitmap = nullptr;
+
+		if (key.FillColor >= 0) {
+			silhouetteBitmap = create_bitmap_ex(key.ColorDepth, sprite->w, sprite->h);
+			clear_to_color(silhouetteBitmap, bitmap_mask_color(silhouetteBitmap));
+			draw_character_ex(silhouetteBitmap, sprite, 0, 0, key.FillColor, -1);
+			sourceBitmap = silhouetteBitmap;
+		}
+		if (key.HFlipped) {
+			flipBitmap = create_bitmap_ex(bitmap_color_depth(sourceBitmap), sourceBitmap->w, sourceBitmap->h);
+			clear_to_color(flipBitmap, bitmap_mask_color(flipBitmap));
+			draw_sprite_h_flip(flipBitmap, sourceBitmap, 0, 0);
+			sourceBitmap = flipBitmap;
+		}
+
+		BITMAP *rotatedBitmap = create_bitmap_ex(key.ColorDepth, pivotOffset * 2, pivotOffset * 2);
+		clear_to_color(rotatedBitmap, bitmap_mask_color(rotatedBitmap));
+		pivot_scaled_sprite(rotatedBitmap, sourceBitmap, pivotOffset, pivotOffset, key.HFlipped ? sourceBitmap->w - key.PivotX : key.PivotX, key.PivotY, ftofix(static_cast<float>(key.AngleStep) * (256.0F / static_cast<float>(c_AngleSteps))), ftofix(key.Scale));
+
+		destroy_bitmap(silhouetteBitmap);
+		destroy_bitmap(flipBitmap);
+		return { rotatedBitmap, pivotOffset };
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void RotatedSpriteCache::EvictToBudget(size_t budget) {
+		while (m_MemoryUsage > budget && !m_Entries.empty()) {
+			const CacheEntry &leastRecentlyUsed = m_Entries.back();
+			destroy_bitmap(leastRecentlyUsed.Sprite.Bitmap);
+			m_MemoryUsage -= leastRecentlyUsed.Size;
+			m_EntryLookup.erase(leastRecentlyUsed.Key);
+			m_Entries.pop_back();
+		}
+	}
+}
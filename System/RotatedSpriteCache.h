@@ -0,0 +1,172 @@
+#ifndef _RTEROTATEDSPRITECACHE_
+#define _RTEROTATEDSPRITECACHE_
+
+struct BITMAP;
+
+namespace RTE {
+
+	/// <summary>
+	/// A least recently used cache of sprite frames that have already been flipped, silhouetted, rotated and scaled, so objects that are drawn the same way frame after frame only pay for a plain blit.
+	/// Angles are snapped to a fixed number of steps so slowly spinning objects keep hitting the same entries. Not thread safe, same as the intermediate bitmaps MOSRotating draws through.
+	/// </summary>
+	class RotatedSpriteCache {
+
+	public:
+
+		/// <summary>
+		/// A pre-rotated sprite frame in the cache.
+		/// </summary>
+		struct CachedSprite {
+			BITMAP *Bitmap; //!< The rotated sprite, centered on the pivot point. Owned by the cache.
+			int PivotOffset; //!< The distance from the upper left corner of the bitmap to the pivot point, on both axes.
+		};
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a RotatedSpriteCache object in system memory.
+		/// </summary>
+		RotatedSpriteCache() { Clear(); }
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a RotatedSpriteCache object before deletion from system memory.
+		/// </summary>
+		~RotatedSpriteCache() { Destroy(); }
+
+		/// <summary>
+		/// Destroys every cached sprite. The memory budget is kept.
+		/// </summary>
+		void Destroy();
+#pragma endregion
+
+#pragma region Getters and Setters
+		/// <summary>
+		/// Gets the amount of memory the cached sprites are allowed to take up.
+		/// </summary>
+		/// <returns>The memory budget of this RotatedSpriteCache, in megabytes.</returns>
+		int GetMemoryBudget() const { return static_cast<int>(m_MemoryBudget / c_BytesPerMegabyte); }
+
+		/// <summary>
+		/// Sets the amount of memory the cached sprites are allowed to take up. Least recently used sprites are evicted right away if the cache is over the new budget.
+		/// </summary>
+		/// <param name="newBudget">The new memory budget, in megabytes. 0 disables the cache.</param>
+		void SetMemoryBudget(int newBudget);
+
+		/// <summary>
+		/// Gets the amount of memory the cached sprites currently take up.
+		/// </summary>
+		/// <returns>The memory used by the cached sprites, in bytes.</returns>
+		size_t GetMemoryUsage() const { return m_MemoryUsage; }
+
+		/// <summary>
+		/// Gets the number of sprites currently in the cache.
+		/// </summary>
+		/// <returns>The number of cached sprites.</returns>
+		int GetCount() const { return static_cast<int>(m_Entries.size()); }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Gets a sprite frame as pivot_scaled_sprite would draw it, rendering and caching it first if it isn't cached yet. Records the hit or miss with PerformanceMan.
+		/// </summary>
+		/// <param name="sprite">The sprite frame to draw. Has to outlive the cache, which holds for every bitmap loaded through ContentFile.</param>
+		/// <param name="fillColor">The color to fill every non-mask pixel of the sprite with, like draw_character_ex does, or -1 to keep the sprite's own colors.</param>
+		/// <param name="colorDepth">The color depth of the bitmap the sprite will be drawn on.</param>
+		/// <param name="pivotX">The X position of the pivot point within the unflipped sprite.</param>
+		/// <param name="pivotY">The Y position of the pivot point within the unflipped sprite.</param>
+		/// <param name="allegroAngle">The angle to rotate by, in Allegro's 256 steps per circle. Snapped to c_AngleSteps steps per circle.</param>
+		/// <param name="scale">The scale to draw at.</param>
+		/// <param name="hFlipped">Whether the sprite should be flipped horizontally before rotating.</param>
+		/// <returns>The cached sprite, or nullptr if it doesn't fit in the memory budget, in which case it should be drawn without the cache. Only valid until the next call.</returns>
+		const CachedSprite * GetRotatedSprite(BITMAP *sprite, int fillColor, int colorDepth, int pivotX, int pivotY, float allegroAngle, float scale, bool hFlipped);
+#pragma endregion
+
+	private:
+
+		static constexpr int c_DefaultMemoryBudget = 32; //!< The memory budget caches start out with, in megabytes.
+		static constexpr int c_AngleSteps = 512; //!< The number of steps per circle rotation angles are snapped to. Half an Allegro angle unit, about 0.7 degrees.
+		static constexpr size_t c_BytesPerMegabyte = 1024 * 1024; //!< The number of bytes in a megabyte, for converting the memory budget.
+
+		/// <summary>
+		/// Everything that decides what a cached sprite looks like.
+		/// </summary>
+		struct CacheKey {
+			const BITMAP *Sprite; //!< The sprite frame.
+			int FillColor; //!< The silhouette color, or -1 for the sprite's own colors.
+			int ColorDepth; //!< The color depth the sprite is rendered in.
+			int PivotX; //!< The X position of the pivot point within the unflipped sprite.
+			int PivotY; //!< The Y position of the pivot point within the unflipped sprite.
+			int AngleStep; //!< The rotation angle, in steps of c_AngleSteps per circle.
+			float Scale; //!< The scale.
+			bool HFlipped; //!< Whether the sprite is flipped horizontally.
+
+			/// <summary>
+			/// An equality operator for testing if any two CacheKeys are equal.
+			/// </summary>
+			/// <param name="rhs">A CacheKey reference as the right hand side operand.</param>
+			/// <returns>A boolean indicating whether the two operands are equal or not.</returns>
+			bool operator==(const CacheKey &rhs) const { return Sprite == rhs.Sprite && FillColor == rhs.FillColor && ColorDepth == rhs.ColorDepth && PivotX == rhs.PivotX && PivotY == rhs.PivotY && AngleStep == rhs.AngleStep && Scale == rhs.Scale && HFlipped == rhs.HFlipped; }
+		};
+
+		/// <summary>
+		/// Hash function object for CacheKeys.
+		/// </summary>
+		struct CacheKeyHash {
+			/// <summary>
+			/// Combines every field of a CacheKey into a single hash.
+			/// </summary>
+			/// <param name="key">The CacheKey to hash.</param>
+			/// <returns>The hash of the CacheKey.</returns>
+			size_t operator()(const CacheKey &key) const;
+		};
+
+		/// <summary>
+		/// A cached sprite along with the key it's stored under and the memory it takes up.
+		/// </summary>
+		struct CacheEntry {
+			CacheKey Key; //!< The key this entry is stored under.
+			CachedSprite Sprite; //!< The cached sprite.
+			size_t Size; //!< The memory the cached sprite's bitmap takes up, in bytes.
+		};
+
+		std::list<CacheEntry> m_Entries; //!< The cached sprites, most recently used first.
+		std::unordered_map<CacheKey, std::list<CacheEntry>::iterator, CacheKeyHash> m_EntryLookup; //!< The cached sprites by key, for finding them without searching the list.
+		size_t m_MemoryBudget; //!< The memory the cached sprites are allowed to take up, in bytes.
+		size_t m_MemoryUsage; //!< The memory the cached sprites currently take up, in bytes.
+
+		/// <summary>
+		/// Calculates how far the pivot point of a sprite rendered as described by a CacheKey needs to be from the edges of its bitmap for any rotation to fit.
+		/// </summary>
+		/// <param name="key">The CacheKey describing how the sprite is rendered.</param>
+		/// <param name="spriteWidth">The width of the sprite frame.</param>
+		/// <param name="spriteHeight">The height of the sprite frame.</param>
+		/// <returns>The distance from the upper left corner of the rendered bitmap to the pivot point, on both axes.</returns>
+		static int CalculatePivotOffset(const CacheKey &key, int spriteWidth, int spriteHeight);
+
+		/// <summary>
+		/// Renders a sprite frame into a new bitmap as described by a CacheKey.
+		/// </summary>
+		/// <param name="key">The CacheKey describing how to render the sprite.</param>
+		/// <param name="sprite">The sprite frame to render. Same as the one in the key, just not const.</param>
+		/// <param name="pivotOffset">The distance from the upper left corner of the new bitmap to the pivot point, as calculated by CalculatePivotOffset.</param>
+		/// <returns>The rendered sprite. Ownership IS transferred!</returns>
+		static CachedSprite RenderSprite(const CacheKey &key, BITMAP *sprite, int pivotOffset);
+
+		/// <summary>
+		/// Evicts the least recently used sprites until the cache fits in a memory budget.
+		/// </summary>
+		/// <param name="budget">The memory budget to fit in, in bytes.</param>
+		void EvictToBudget(size_t budget);
+
+		/// <summary>
+		/// Clears all the member variables of this RotatedSpriteCache, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		RotatedSpriteCache(const RotatedSpriteCache &reference) = delete;
+		RotatedSpriteCache & operator=(const RotatedSpriteCache &rhs) = delete;
+	};
+}
+#endif
@@ -0,0 +1,227 @@
+#include "SpatialPartitionGrid.h"
+#include "MovableObject.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::Clear() {
+		m_Width = 0;
+		m_Height = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
+		m_Columns = 0;
+		m_Rows = 0;
+		m_CellWidth = 1.0F;
+		m_CellHeight = 1.0F;
+		m_Cells.clear();
+		m_ObjectCount = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::Create(int width, int height, int cellSize, bool wrapsX, bool wrapsY) {
+		RTEAssert(width > 0 && height > 0 && cellSize > 0, "Tried to create a SpatialPartitionGrid with no area or cell size!");
+
+		m_Width = width;
+		m_Height = height;
+		m_WrapsX = wrapsX;
+		m_WrapsY = wrapsY;
+		m_Columns = std::max(static_cast<int>(std::round(static_cast<float>(width) / static_cast<float>(cellSize))), 1);
+		m_Rows = std::max(static_cast<int>(std::round(static_cast<float>(height) / static_cast<float>(cellSize))), 1);
+		m_CellWidth = static_cast<float>(width) / static_cast<float>(m_Columns);
+		m_CellHeight = static_cast<float>(height) / static_cast<float>(m_Rows);
+
+		m_Cells.clear();
+		m_Cells.resize(static_cast<size_t>(m_Columns * m_Rows));
+		m_ObjectCount = 0;
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::ClearObjects() {
+		for (std::vector<MovableObject *> &cell : m_Cells) {
+			cell.clear();
+		}
+		m_ObjectCount = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::Add(MovableObject *object) {
+		if (!object || m_Cells.empty()) {
+			return;
+		}
+		m_Cells[GetCellIndex(object->GetPos())].emplace_back(object);
+		m_ObjectCount++;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SpatialPartitionGrid::Remove(const MovableObject *object) {
+		if (!object || m_Cells.empty()) {
+			return false;
+		}
+		// The object has likely moved since it was added, so check the cell it's in now first and fall back to searching all of them.
+		std::vector<MovableObject *> &likelyCell = m_Cells[GetCellIndex(object->GetPos())];
+		if (std::vector<MovableObject *>::iterator objectEntry = std::find(likelyCell.begin(), likelyCell.end(), object); objectEntry != likelyCell.end()) {
+			likelyCell.erase(objectEntry);
+			m_ObjectCount--;
+			return true;
+		}
+		for (std::vector<MovableObject *> &cell : m_Cells) {
+			if (std::vector<MovableObject *>::iterator objectEntry = std::find(cell.begin(), cell.end(), object); objectEntry != cell.end()) {
+				cell.erase(objectEntry);
+				m_ObjectCount--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MovableObject * SpatialPartitionGrid::GetClosestObject(const Vector &point, float maxRadius, const std::function<bool(const MovableObject *)> &filter, Vector &getDistance) const {
+		if (m_ObjectCount == 0 || maxRadius <= 0) {
+			return nullptr;
+		}
+		MovableObject *closestObject = nullptr;
+		float shortestDistance = maxRadius;
+		Vector closestDistance;
+
+		// Objects can have moved a bit since they were added, so every search area is padded by a cell to still catch the ones that crossed into a neighbouring cell.
+		Vector cellPadding(m_CellWidth, m_CellHeight);
+		float searchRadius = std::min(std::max(m_CellWidth, m_CellHeight), maxRadius);
+		while (true) {
+			Vector searchExtents(searchRadius, searchRadius);
+			bool coveredWholeGrid = ForEachObjectInArea(point - searchExtents - cellPadding, point + searchExtents + cellPadding, [&](MovableObject *object) {
+				if (object == closestObject || (filter && !filter(object))) {
+					return;
+				}
+				Vector distance = ShortestDistance(object->GetPos(), point);
+				float distanceMagnitude = distance.GetMagnitude();
+				if (distanceMagnitude < shortestDistance) {
+					shortestDistance = distanceMagnitude;
+					closestObject = object;
+					closestDistance = distance;
+				}
+			});
+			// Anything closer than what was found would have to be within the searched radius, so there's no need to look further.
+			if ((closestObject && shortestDistance <= searchRadius) || coveredWholeGrid || searchRadius >= maxRadius) {
+				break;
+			}
+			searchRadius = std::min(searchRadius * 2.0F, maxRadius);
+		}
+		if (closestObject) { getDistance = closestDistance; }
+		return closestObject;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::GetObjectsInRadius(const Vector &center, float radius, const std::function<bool(const MovableObject *)> &filter, std::vector<MovableObject *> &objectsInRadius) const {
+		if (m_ObjectCount == 0 || radius <= 0) {
+			return;
+		}
+		Vector searchExtents(radius + m_CellWidth, radius + m_CellHeight);
+		ForEachObjectInArea(center - searchExtents, center + searchExtents, [&](MovableObject *object) {
+			if ((!filter || filter(object)) && ShortestDistance(object->GetPos(), center).GetMagnitude() <= radius) { objectsInRadius.emplace_back(object); }
+		});
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::GetObjectsInBox(const Box &box, const std::function<bool(const MovableObject *)> &filter, std::vector<MovableObject *> &objectsInBox) const {
+		if (m_ObjectCount == 0 || box.IsEmpty()) {
+			return;
+		}
+		Box unflippedBox = box;
+		unflippedBox.Unflip();
+		Vector boxMin = unflippedBox.GetCorner();
+		Vector boxMax = boxMin + Vector(unflippedBox.GetWidth(), unflippedBox.GetHeight());
+		Vector cellPadding(m_CellWidth, m_CellHeight);
+
+		ForEachObjectInArea(boxMin - cellPadding, boxMax + cellPadding, [&](MovableObject *object) {
+			if (filter && !filter(object)) {
+				return;
+			}
+			// Test every wrapped appearance of the object's position, since the Box itself may reach past the seam.
+			const Vector &objectPos = object->GetPos();
+			for (int xShift = (m_WrapsX ? -1 : 0); xShift <= (m_WrapsX ? 1 : 0); ++xShift) {
+				for (int yShift = (m_WrapsY ? -1 : 0); yShift <= (m_WrapsY ? 1 : 0); ++yShift) {
+					if (unflippedBox.IsWithinBox(Vector(objectPos.GetX() + static_cast<float>(xShift * m_Width), objectPos.GetY() + static_cast<float>(yShift * m_Height)))) {
+						objectsInBox.emplace_back(object);
+						return;
+					}
+				}
+			}
+		});
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::GetCellIndex(const Vector &position) const {
+		int column = static_cast<int>(std::floor(position.GetX() / m_CellWidth));
+		int row = static_cast<int>(std::floor(position.GetY() / m_CellHeight));
+		column = m_WrapsX ? ((column % m_Columns) + m_Columns) % m_Columns : std::clamp(column, 0, m_Columns - 1);
+		row = m_WrapsY ? ((row % m_Rows) + m_Rows) % m_Rows : std::clamp(row, 0, m_Rows - 1);
+		return row * m_Columns + column;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::pair<int, int> SpatialPartitionGrid::GetCellRange(float intervalStart, float intervalEnd, float cellSize, int cellCount, bool wraps) const {
+		int firstCell = static_cast<int>(std::floor(intervalStart / cellSize));
+		int lastCell = static_cast<int>(std::floor(intervalEnd / cellSize));
+		if (!wraps) {
+			return { std::clamp(firstCell, 0, cellCount - 1), std::clamp(lastCell, 0, cellCount - 1) };
+		}
+		if (lastCell - firstCell + 1 >= cellCount) {
+			return { 0, cellCount - 1 };
+		}
+		// Shift the range so it starts inside the grid, the end may then run past the last cell and gets wrapped when iterating.
+		int wrappedFirstCell = ((firstCell % cellCount) + cellCount) % cellCount;
+		return { wrappedFirstCell, wrappedFirstCell + (lastCell - firstCell) };
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SpatialPartitionGrid::ForEachObjectInArea(const Vector &areaMin, const Vector &areaMax, const std::function<void(MovableObject *)> &function) const {
+		auto [firstColumn, lastColumn] = GetCellRange(areaMin.GetX(), areaMax.GetX(), m_CellWidth, m_Columns, m_WrapsX);
+		auto [firstRow, lastRow] = GetCellRange(areaMin.GetY(), areaMax.GetY(), m_CellHeight, m_Rows, m_WrapsY);
+
+		for (int row = firstRow; row <= lastRow; ++row) {
+			int wrappedRow = row % m_Rows;
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				for (MovableObject *object : m_Cells[wrappedRow * m_Columns + (column % m_Columns)]) {
+					function(object);
+				}
+			}
+		}
+		return (lastColumn - firstColumn + 1 >= m_Columns) && (lastRow - firstRow + 1 >= m_Rows);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Vector SpatialPartitionGrid::ShortestDistance(const Vector &from, const Vector &to) const {
+		Vector distance = to - from;
+		float halfWidth = static_cast<float>(m_Width) / 2.0F;
+		float halfHeight = static_cast<float>(m_Height) / 2.0F;
+
+		if (m_WrapsX) {
+			if (distance.GetX() > halfWidth) {
+				distance.SetX(distance.GetX() - static_cast<float>(m_Width));
+			} else if (distance.GetX() < -halfWidth) {
+				distance.SetX(distance.GetX() + static_cast<float>(m_Width));
+			}
+		}
+		if (m_WrapsY) {
+			if (distance.GetY() > halfHeight) {
+				distance.SetY(distance.GetY() - static_cast<float>(m_Height));
+			} else if (distance.GetY() < -halfHeight) {
+				distance.SetY(distance.GetY() + static_cast<float>(m_Height));
+			}
+		}
+		return distance;
+	}
+}
@@ -0,0 +1,166 @@
+#ifndef _RTESPATIALPARTITIONGRID_
+#define _RTESPATIALPARTITIONGRID_
+
+#include "Box.h"
+
+namespace RTE {
+
+	class MovableObject;
+
+	/// <summary>
+	/// A uniform grid that buckets MovableObjects by their position, so proximity queries only have to look at the objects in nearby cells instead of every object in the Scene.
+	/// Takes Scene wrapping into account, both for which cells a query covers and for the distances it reports.
+	/// </summary>
+	class SpatialPartitionGrid {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a SpatialPartitionGrid object in system memory. Create() should be called before using the object.
+		/// </summary>
+		SpatialPartitionGrid() { Clear(); }
+
+		/// <summary>
+		/// Makes the SpatialPartitionGrid object ready for use, covering an area of the given size with cells as close to the given size as fits evenly.
+		/// </summary>
+		/// <param name="width">The width of the area to cover, in pixels. Usually the Scene width.</param>
+		/// <param name="height">The height of the area to cover, in pixels. Usually the Scene height.</param>
+		/// <param name="cellSize">The preferred width and height of each cell, in pixels. Cells get resized slightly so a whole number of them spans the area, which keeps wrapping exact.</param>
+		/// <param name="wrapsX">Whether the area wraps around horizontally.</param>
+		/// <param name="wrapsY">Whether the area wraps around vertically.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Create(int width, int height, int cellSize, bool wrapsX, bool wrapsY);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Resets the entire SpatialPartitionGrid, including its dimensions, to their default settings or values.
+		/// </summary>
+		void Reset() { Clear(); }
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets whether this SpatialPartitionGrid has been created with the given dimensions and wrapping, i.e. whether it can be reused for them without calling Create() again.
+		/// </summary>
+		/// <param name="width">The width of the area to check for.</param>
+		/// <param name="height">The height of the area to check for.</param>
+		/// <param name="wrapsX">Whether the area wraps around horizontally.</param>
+		/// <param name="wrapsY">Whether the area wraps around vertically.</param>
+		/// <returns>Whether this SpatialPartitionGrid matches the given dimensions and wrapping.</returns>
+		bool MatchesDimensions(int width, int height, bool wrapsX, bool wrapsY) const { return !m_Cells.empty() && m_Width == width && m_Height == height && m_WrapsX == wrapsX && m_WrapsY == wrapsY; }
+
+		/// <summary>
+		/// Gets the number of objects currently in this SpatialPartitionGrid.
+		/// </summary>
+		/// <returns>The number of objects currently in this SpatialPartitionGrid.</returns>
+		int GetObjectCount() const { return m_ObjectCount; }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Removes all objects from this SpatialPartitionGrid but keeps its dimensions and cell storage, so it can be refilled without reallocating.
+		/// </summary>
+		void ClearObjects();
+
+		/// <summary>
+		/// Adds an object to the cell its current position falls in. Positions outside the covered area are wrapped or clamped to the nearest cell.
+		/// </summary>
+		/// <param name="object">The object to add. Ownership is NOT transferred!</param>
+		void Add(MovableObject *object);
+
+		/// <summary>
+		/// Removes an object from this SpatialPartitionGrid, wherever it was added.
+		/// </summary>
+		/// <param name="object">The object to remove.</param>
+		/// <returns>Whether the object was found and removed.</returns>
+		bool Remove(const MovableObject *object);
+
+		/// <summary>
+		/// Finds the object closest to a point that passes a filter.
+		/// Searches outwards in steps, so nearby results are found without looking at the whole grid, and far away ones without checking any cell twice per step.
+		/// </summary>
+		/// <param name="point">The point to search from.</param>
+		/// <param name="maxRadius">Only objects closer than this are considered.</param>
+		/// <param name="filter">Function that returns whether an object should be considered at all.</param>
+		/// <param name="getDistance">Vector to be filled with the shortest distance from the point to the found object, if any was found.</param>
+		/// <returns>The closest object that passed the filter, or nullptr if there was none within range.</returns>
+		MovableObject * GetClosestObject(const Vector &point, float maxRadius, const std::function<bool(const MovableObject *)> &filter, Vector &getDistance) const;
+
+		/// <summary>
+		/// Finds every object within a radius of a point that passes a filter.
+		/// </summary>
+		/// <param name="center">The center of the search circle.</param>
+		/// <param name="radius">The radius of the search circle.</param>
+		/// <param name="filter">Function that returns whether an object should be considered at all. Can be empty to accept everything.</param>
+		/// <param name="objectsInRadius">Vector the found objects will be added to. Not cleared first.</param>
+		void GetObjectsInRadius(const Vector &center, float radius, const std::function<bool(const MovableObject *)> &filter, std::vector<MovableObject *> &objectsInRadius) const;
+
+		/// <summary>
+		/// Finds every object within a Box that passes a filter.
+		/// </summary>
+		/// <param name="box">The Box to search in. Wrapped appearances of it are searched too on wrapping axes.</param>
+		/// <param name="filter">Function that returns whether an object should be considered at all. Can be empty to accept everything.</param>
+		/// <param name="objectsInBox">Vector the found objects will be added to. Not cleared first.</param>
+		void GetObjectsInBox(const Box &box, const std::function<bool(const MovableObject *)> &filter, std::vector<MovableObject *> &objectsInBox) const;
+#pragma endregion
+
+	protected:
+
+		int m_Width; //!< The width of the covered area, in pixels.
+		int m_Height; //!< The height of the covered area, in pixels.
+		bool m_WrapsX; //!< Whether the covered area wraps around horizontally.
+		bool m_WrapsY; //!< Whether the covered area wraps around vertically.
+		int m_Columns; //!< The number of cell columns.
+		int m_Rows; //!< The number of cell rows.
+		float m_CellWidth; //!< The width of each cell, in pixels.
+		float m_CellHeight; //!< The height of each cell, in pixels.
+
+		std::vector<std::vector<MovableObject *>> m_Cells; //!< The objects in each cell, row by row. Objects are not owned.
+		int m_ObjectCount; //!< The number of objects currently in the grid.
+
+	private:
+
+		/// <summary>
+		/// Gets the index of the cell a position falls in, wrapping or clamping it into the covered area as appropriate.
+		/// </summary>
+		/// <param name="position">The position to get the cell of.</param>
+		/// <returns>The index of the cell in m_Cells.</returns>
+		int GetCellIndex(const Vector &position) const;
+
+		/// <summary>
+		/// Gets the range of cell columns or rows an interval covers along one axis. Wrapped ranges can end past the last column or row, and should be taken modulo the count.
+		/// </summary>
+		/// <param name="intervalStart">The start of the interval, in pixels.</param>
+		/// <param name="intervalEnd">The end of the interval, in pixels.</param>
+		/// <param name="cellSize">The size of each cell along this axis.</param>
+		/// <param name="cellCount">The number of cells along this axis.</param>
+		/// <param name="wraps">Whether this axis wraps around.</param>
+		/// <returns>The first and last cell along this axis. Never covers a cell twice.</returns>
+		std::pair<int, int> GetCellRange(float intervalStart, float intervalEnd, float cellSize, int cellCount, bool wraps) const;
+
+		/// <summary>
+		/// Calls a function for every object in the cells covering an area, visiting each cell at most once.
+		/// </summary>
+		/// <param name="areaMin">The upper left corner of the area.</param>
+		/// <param name="areaMax">The lower right corner of the area.</param>
+		/// <param name="function">The function to call for each object.</param>
+		/// <returns>Whether the area covered every cell in the grid.</returns>
+		bool ForEachObjectInArea(const Vector &areaMin, const Vector &areaMax, const std::function<void(MovableObject *)> &function) const;
+
+		/// <summary>
+		/// Gets the shortest distance between two points, taking wrapping into account the same way SceneMan::ShortestDistance does.
+		/// </summary>
+		/// <param name="from">The point to measure from.</param>
+		/// <param name="to">The point to measure to.</param>
+		/// <returns>The shortest vector from one point to the other.</returns>
+		Vector ShortestDistance(const Vector &from, const Vector &to) const;
+
+		/// <summary>
+		/// Clears all the member variables of this SpatialPartitionGrid, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+	};
+}
+#endif
@@ -51,6 +51,8 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <cctype>
 #include <string>
 #include <cstring>
@@ -69,6 +71,7 @@
 #include <fstream>
 #include <istream>
 #include <algorithm>
+#include <numeric>
 #include <cmath>
 #include <ctime>
 #include <cerrno>
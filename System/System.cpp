@@ -1,21 +1,30 @@
 ﻿#include "System.h"
 #include "unzip.h"
 
-#ifdef __unix__
+#ifdef _WIN32
+#include <psapi.h>
+#elif __unix__
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #endif
 
 namespace RTE {
 
 	bool System::s_Quit = false;
 	bool System::s_LogToCLI = false;
+#ifdef HEADLESS_BUILD
+	bool System::s_Headless = true;
+#else
+	bool System::s_Headless = false;
+#endif
 	std::string System::s_WorkingDirectory = ".";
 	std::vector<size_t> System::s_WorkingTree;
 	std::filesystem::file_time_type System::s_ProgramStartTime = std::filesystem::file_time_type::clock::now();
 	bool System::s_CaseSensitive = true;
 	const std::string System::s_ScreenshotDirectory = "_ScreenShots";
 	const std::string System::s_ModDirectory = "_Mods";
+	const std::string System::s_SceneTileCacheDirectory = "_SceneTileCache";
 	const std::string System::s_ModulePackageExtension = ".rte";
 	const std::string System::s_ZippedModulePackageExtension = ".rte.zip";
 	const std::unordered_set<std::string> System::s_SupportedExtensions = { ".ini", ".txt", ".lua", ".cfg", ".bmp", ".png", ".jpg", ".jpeg", ".wav", ".ogg", ".mp3", ".flac" };
@@ -288,4 +297,22 @@ namespace RTE {
 			return (std::search(rawData.begin(), rawData.end(), findString.begin(), findString.end()) != rawData.end()) ? 0 : 1;
 		}
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	size_t System::GetPeakMemoryUsage() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS memoryCounters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters))) {
+			return static_cast<size_t>(memoryCounters.PeakWorkingSetSize);
+		}
+#elif __unix__
+		rusage resourceUsage;
+		// Linux reports the maximum resident set size in kilobytes.
+		if (getrusage(RUSAGE_SELF, &resourceUsage) == 0) {
+			return static_cast<size_t>(resourceUsage.ru_maxrss) * 1024;
+		}
+#endif
+		return 0;
+	}
 }
@@ -55,6 +55,12 @@ namespace RTE {
 		/// <returns>Folder name of the mod directory.</returns>
 		static const std::string & GetModDirectory() { return s_ModDirectory; }
 
+		/// <summary>
+		/// Gets the scene tile cache directory name.
+		/// </summary>
+		/// <returns>Folder name of the directory network clients cache received scene tiles in.</returns>
+		static const std::string & GetSceneTileCacheDirectory() { return s_SceneTileCacheDirectory; }
+
 		/// <summary>
 		/// Gets the extension that determines a directory/file is an RTE module.
 		/// </summary>
@@ -120,6 +126,19 @@ namespace RTE {
 		static void PrintToCLI(const std::string &stringToPrint);
 #pragma endregion
 
+#pragma region Headless Mode
+		/// <summary>
+		/// Gets whether the program runs as a headless dedicated server, without a window, audio output or local input devices. Always true in builds configured with the headless option.
+		/// </summary>
+		/// <returns>Whether the program runs headless.</returns>
+		static bool IsHeadless() { return s_Headless; }
+
+		/// <summary>
+		/// Makes the program run headless. Needs to be done before Allegro and any of the managers are initialized, since they pick their devices based on it.
+		/// </summary>
+		static void EnableHeadlessMode() { s_Headless = true; }
+#pragma endregion
+
 #pragma region Archived DataModule Handling
 		/// <summary>
 		/// Extracts all files from a zipped DataModule, overwriting any corresponding files already existing.
@@ -143,12 +162,19 @@ namespace RTE {
 		/// <param name="">The exact string to look for. Case sensitive!</param>
 		/// <returns>0 if the string was found in the file or 1 if not. -1 if the file was inaccessible.</returns>
 		static int ASCIIFileContainsString(const std::string &filePath, const std::string &findString);
+
+		/// <summary>
+		/// Gets the most memory this process has had resident at any point since it started.
+		/// </summary>
+		/// <returns>The peak resident memory of this process, in bytes. 0 if it couldn't be queried.</returns>
+		static size_t GetPeakMemoryUsage();
 #pragma endregion
 
 	private:
 
 		static bool s_Quit; //!< Whether the user requested program termination through GUI or the window close button.
 		static bool s_LogToCLI; //!< Bool to tell whether to print the loading log and anything specified with PrintToCLI to command-line or not.
+		static bool s_Headless; //!< Whether the program runs as a headless dedicated server.
 		static std::string s_WorkingDirectory; //!< String containing the absolute path to current working directory.
 		static std::vector<size_t> s_WorkingTree; //!< Vector of the hashes of all file paths in the working directory.
 		static std::filesystem::file_time_type s_ProgramStartTime; //!< Low precision time point of program start for checking if a file was created after starting.
@@ -156,6 +182,7 @@ namespace RTE {
 		static bool s_CaseSensitive; //!< Whether case sensitivity is enforced when checking for file existence.
 		static const std::string s_ScreenshotDirectory; //!< String containing the folder name of the screenshots directory.
 		static const std::string s_ModDirectory; //!< String containing the folder name of the mod directory.
+		static const std::string s_SceneTileCacheDirectory; //!< String containing the folder name of the scene tile cache directory.
 		static const std::string s_ModulePackageExtension; //!< The extension that determines a directory/file is a RTE module.
 		static const std::string s_ZippedModulePackageExtension; //!< The extension that determines a file is a zipped RTE module.
 
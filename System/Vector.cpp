@@ -1,4 +1,6 @@
 #include "Vector.h"
+#include "Reader.h"
+#include "Writer.h"
 
 #pragma float_control(precise, on)
 
@@ -6,30 +8,6 @@ namespace RTE {
 
 	const std::string Vector::c_ClassName = "Vector";
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	int Vector::ReadProperty(const std::string_view &propName, Reader &reader) {
-		if (propName == "X") {
-			reader >> m_X;
-		} else if (propName == "Y") {
-			reader >> m_Y;
-		} else {
-			return Serializable::ReadProperty(propName, reader);
-		}
-		return 0;
-	}
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	int Vector::Save(Writer &writer) const {
-		Serializable::Save(writer);
-
-		writer.NewPropertyWithValue("X", m_X);
-		writer.NewPropertyWithValue("Y", m_Y);
-
-		return 0;
-	}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	Vector & Vector::SetMagnitude(const float newMag) {
@@ -81,16 +59,6 @@ namespace RTE {
 		return returnVector;
 	}
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	Vector & Vector::operator=(const Vector &rhs) {
-		if (*this != rhs) {
-			m_X = rhs.m_X;
-			m_Y = rhs.m_Y;
-		}
-		return *this;
-	}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	Vector & Vector::operator=(const std::deque<Vector> &rhs) {
@@ -103,4 +71,60 @@ namespace RTE {
 		}
 		return *this;
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Vector::NormalizeAll(Vector *vectors, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			float magnitude = vectors[i].GetMagnitude();
+			// Select instead of branching, so the loop body stays straight-line code.
+			float inverseMagnitude = (magnitude != 0) ? (1.0F / magnitude) : 0.0F;
+			vectors[i].m_X *= inverseMagnitude;
+			vectors[i].m_Y *= inverseMagnitude;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Vector::RadRotateAll(Vector *vectors, size_t count, float angle) {
+		// Same rotation as GetRadRotatedCopy, which rotates by the negated angle because the Y axis points down.
+		const float sinAngle = std::sin(-angle);
+		const float cosAngle = std::cos(-angle);
+		for (size_t i = 0; i < count; ++i) {
+			float rotatedX = vectors[i].m_X * cosAngle - vectors[i].m_Y * sinAngle;
+			vectors[i].m_Y = vectors[i].m_X * sinAngle + vectors[i].m_Y * cosAngle;
+			vectors[i].m_X = rotatedX;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Reader & operator>>(Reader &reader, Vector &operand) {
+		if (reader.ReadPropValue() != operand.GetClassName()) {
+			reader.ReportError("Wrong type in Reader when reading a Vector");
+			return reader;
+		}
+		while (reader.NextProperty()) {
+			std::string propName = reader.ReadPropName();
+			if (propName == "X") {
+				reader >> operand.m_X;
+			} else if (propName == "Y") {
+				reader >> operand.m_Y;
+			} else if (!propName.empty()) {
+				reader.ReadPropValue();
+				reader.ReportError("Could not match property");
+			}
+		}
+		return reader;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Writer & operator<<(Writer &writer, const Vector &operand) {
+		writer.ObjectStart(operand.GetClassName());
+		writer.NewPropertyWithValue("X", operand.m_X);
+		writer.NewPropertyWithValue("Y", operand.m_Y);
+		writer.ObjectEnd();
+		return writer;
+	}
 }
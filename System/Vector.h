@@ -1,23 +1,22 @@
 #ifndef _RTEVECTOR_
 #define _RTEVECTOR_
 
-#include "Serializable.h"
 #include "RTETools.h"
 
 namespace RTE {
 
+	class Reader;
+	class Writer;
+
 	enum Axes { X = 0, Y = 1 };
 
 	/// <summary>
-	/// A useful 2D float vector.
+	/// A useful 2D float vector. Deliberately not a Serializable, so it's just two floats with no vtable that can be copied around freely. INI reading and writing goes through the Reader and Writer operators below instead.
 	/// </summary>
-	class Vector : public Serializable {
+	class Vector {
 
 	public:
 
-		SerializableClassNameGetter;
-		SerializableOverrideMethods;
-
 		float m_X = 0.0F; //!< X value of this vector.
 		float m_Y = 0.0F; //!< Y value of this vector.
 
@@ -39,7 +38,7 @@ namespace RTE {
 		/// <summary>
 		/// Sets both the X and Y of this Vector to zero.
 		/// </summary>
-		void Reset() override { m_X = 0.0F; m_Y = 0.0F; }
+		void Reset() { m_X = 0.0F; m_Y = 0.0F; }
 #pragma endregion
 
 #pragma region Getters and Setters
@@ -148,7 +147,13 @@ namespace RTE {
 		/// Gets the magnitude of this Vector.
 		/// </summary>
 		/// <returns>A float describing the magnitude.</returns>
-		float GetMagnitude() const { return std::sqrt(std::pow(m_X, 2.0F) + std::pow(m_Y, 2.0F)); }
+		float GetMagnitude() const { return std::sqrt(GetSqrMagnitude()); }
+
+		/// <summary>
+		/// Gets the squared magnitude of this Vector. Cheaper than GetMagnitude when only comparing lengths.
+		/// </summary>
+		/// <returns>A float describing the squared magnitude.</returns>
+		float GetSqrMagnitude() const { return (m_X * m_X) + (m_Y * m_Y); }
 
 		/// <summary>
 		/// Sets the magnitude of this Vector. A negative magnitude will invert the Vector's direction.
@@ -348,7 +353,7 @@ namespace RTE {
 		/// </summary>
 		/// <param name="rhs">A Vector reference.</param>
 		/// <returns>A reference to the changed Vector.</returns>
-		Vector & operator=(const Vector &rhs);
+		Vector & operator=(const Vector &rhs) = default;
 
 		/// <summary>
 		/// An assignment operator for setting this Vector equal to the average of an std::deque of Vectors.
@@ -498,9 +503,54 @@ namespace RTE {
 		float & operator[](const int &rhs) { return (rhs == 0) ? m_X : m_Y; }
 #pragma endregion
 
+#pragma region Batch Operations
+		/// <summary>
+		/// Normalizes every Vector in an array. Zero Vectors stay zero, same as Normalize. Written without branches or calls so the loop vectorizes.
+		/// </summary>
+		/// <param name="vectors">The array of Vectors to normalize.</param>
+		/// <param name="count">The number of Vectors in the array.</param>
+		static void NormalizeAll(Vector *vectors, size_t count);
+
+		/// <summary>
+		/// Rotates every Vector in an array by the same angle, same as RadRotate but computing the sine and cosine only once.
+		/// </summary>
+		/// <param name="vectors">The array of Vectors to rotate.</param>
+		/// <param name="count">The number of Vectors in the array.</param>
+		/// <param name="angle">The angle in radians to rotate by. Positive angles rotate counter-clockwise.</param>
+		static void RadRotateAll(Vector *vectors, size_t count, float angle);
+#pragma endregion
+
+#pragma region Class Info
+		/// <summary>
+		/// Gets the class name of this Vector.
+		/// </summary>
+		/// <returns>A string with the friendly-formatted type name of this Vector.</returns>
+		const std::string & GetClassName() const { return c_ClassName; }
+#pragma endregion
+
 	private:
 
 		static const std::string c_ClassName; //!< A string with the friendly-formatted type name of this.
 	};
+
+	static_assert(sizeof(Vector) == 2 * sizeof(float) && std::is_trivially_copyable<Vector>::value, "Vector is meant to be exactly two floats that can be copied with memcpy!");
+
+#pragma region INI Handling
+	/// <summary>
+	/// A Reader extraction operator for filling a Vector from a Reader. Reads the same "Vector" object with X and Y properties as when Vector was a Serializable.
+	/// </summary>
+	/// <param name="reader">A Reader reference as the left hand side operand.</param>
+	/// <param name="operand">A Vector reference as the right hand side operand.</param>
+	/// <returns>A Reader reference for further use in an expression.</returns>
+	Reader & operator>>(Reader &reader, Vector &operand);
+
+	/// <summary>
+	/// A Writer insertion operator for sending a Vector to a Writer.
+	/// </summary>
+	/// <param name="writer">A Writer reference as the left hand side operand.</param>
+	/// <param name="operand">A Vector reference as the right hand side operand.</param>
+	/// <returns>A Writer reference for further use in an expression.</returns>
+	Writer & operator<<(Writer &writer, const Vector &operand);
+#pragma endregion
 }
 #endif